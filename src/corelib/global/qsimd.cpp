@@ -580,7 +580,10 @@ uint64_t QT_MANGLE_NAMESPACE(qDetectCpuFeatures)()
         while (char *token = strtok(disable, " ")) {
             disable = nullptr;
             for (uint i = 0; i < arraysize(features_indices); ++i) {
-                if (strcmp(token, features_string + features_indices[i]) == 0)
+                const char *name = features_string + features_indices[i];
+                if (*name == ' ')   // the names are stored with a leading space
+                    ++name;
+                if (strcmp(token, name) == 0)
                     f &= ~(Q_UINT64_C(1) << i);
             }
         }
@@ -14,6 +14,7 @@
 #include "qdatetime.h"
 #include "qbytearray.h"
 #include "qstringlist.h"
+#include "qvarlengtharray.h"
 #include "qendian.h"
 #include <qshareddata.h>
 #include <qplatformdefs.h>
@@ -25,6 +26,9 @@
 #include "private/qtools_p.h"
 #include "private/qsystemerror_p.h"
 
+#include <algorithm>
+#include <optional>
+
 #ifndef QT_NO_COMPRESS
 #  include <zconf.h>
 #  include <zlib.h>
@@ -75,6 +79,11 @@ RCC_FEATURE_SYMBOL(Zstd)
 
 #undef RCC_FEATURE_SYMBOL
 
+namespace {
+class QResourceRoot;
+}
+static void evictDecompressedData(const QResourceRoot *root);
+
 namespace {
 class QStringSplitter
 {
@@ -128,7 +137,7 @@ public:
 
     inline QResourceRoot(): tree(nullptr), names(nullptr), payloads(nullptr), version(0) {}
     inline QResourceRoot(int version, const uchar *t, const uchar *n, const uchar *d) { setSource(version, t, n, d); }
-    virtual ~QResourceRoot() { }
+    virtual ~QResourceRoot() { evictDecompressedData(this); }
     int findNode(const QString &path, const QLocale &locale=QLocale()) const;
     inline bool isContainer(int node) const { return flags(node) & Directory; }
     QResource::Compression compressionAlgo(int node)
@@ -190,6 +199,119 @@ static inline QRecursiveMutex &resourceMutex()
 static inline ResourceList *resourceList()
 { return &resourceGlobalData->resourceList; }
 
+namespace {
+// Decompressed contents of compressed resources (or of chunks of them), shared
+// by all QResource and QFile users so that each is only decompressed once.
+// Entries that are in use elsewhere are always kept, since dropping them would
+// not free anything; of the others, the most recently used ones are kept up to
+// a total of idleLimit bytes.
+class QResourceDecompressionCache
+{
+public:
+    struct Key
+    {
+        const QResourceRoot *root;
+        const uchar *data;
+        qsizetype chunk;        // -1 for the whole content
+
+        friend bool operator==(Key lhs, Key rhs) noexcept
+        { return lhs.root == rhs.root && lhs.data == rhs.data && lhs.chunk == rhs.chunk; }
+        friend size_t qHash(Key key, size_t seed = 0) noexcept
+        { return qHashMulti(seed, key.root, key.data, key.chunk); }
+    };
+
+    template <typename Decompress>
+    QByteArray findOrInsert(Key key, Decompress decompress);
+    void remove(const QResourceRoot *root);
+
+private:
+    void trim();
+
+    struct Entry
+    {
+        QByteArray data;
+        quint64 lastUse;
+    };
+
+    QMutex mutex;
+    QHash<Key, Entry> entries;
+    quint64 useCounter = 0;
+    const qsizetype idleLimit = [] {
+        bool ok;
+        const int kib = qEnvironmentVariableIntValue("QT_RESOURCE_CACHE_SIZE", &ok);
+        return ok && kib >= 0 ? qsizetype(kib) * 1024 : qsizetype(8 * 1024 * 1024);
+    }();
+};
+}
+Q_GLOBAL_STATIC(QResourceDecompressionCache, decompressionCache)
+
+template <typename Decompress>
+QByteArray QResourceDecompressionCache::findOrInsert(Key key, Decompress decompress)
+{
+    {
+        const auto locker = qt_scoped_lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            it->lastUse = ++useCounter;
+            return it->data;
+        }
+    }
+
+    // two threads may race to decompress the same data; only one result is kept
+    QByteArray data = decompress();
+    if (data.isNull())
+        return data;
+
+    const auto locker = qt_scoped_lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end())
+        it = entries.emplace(key, Entry{ data, 0 });
+    it->lastUse = ++useCounter;
+    data = it->data;
+    trim();
+    return data;
+}
+
+void QResourceDecompressionCache::trim()
+{
+    qsizetype idleSize = 0;
+    QVarLengthArray<std::pair<quint64, Key>, 64> idle;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        if (it->data.isDetached()) {
+            idleSize += it->data.size();
+            idle.emplace_back(it->lastUse, it.key());
+        }
+    }
+    if (idleSize <= idleLimit)
+        return;
+
+    std::sort(idle.begin(), idle.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first < rhs.first;
+    });
+    for (const auto &[lastUse, key] : std::as_const(idle)) {
+        auto it = entries.find(key);
+        idleSize -= it->data.size();
+        entries.erase(it);
+        if (idleSize <= idleLimit)
+            break;
+    }
+}
+
+void QResourceDecompressionCache::remove(const QResourceRoot *root)
+{
+    const auto locker = qt_scoped_lock(mutex);
+    entries.removeIf([root](const auto &it) { return it.key().root == root; });
+}
+
+// Called whenever a resource root goes away: its data may have been unmapped
+// or freed, and the addresses reused for other resources. Roots that were never
+// registered (like the temporaries in qRegisterResourceData()) own no entries.
+static void evictDecompressedData(const QResourceRoot *root)
+{
+    if (!decompressionCache.isDestroyed())
+        decompressionCache->remove(root);
+}
+
 /*!
     \class QResource
     \inmodule QtCore
@@ -290,6 +412,26 @@ public:
     qint64 uncompressedSize() const Q_DECL_PURE_FUNCTION;
     qsizetype decompress(char *buffer, qsizetype bufferSize) const;
 
+    // Seek table of zstd content compressed in chunks by rcc --zstd-chunk-size
+    struct ZstdChunks
+    {
+        qint64 chunkSize = 0;
+        qint64 uncompressedSize = 0;
+        QList<qsizetype> offsets;       // of each frame in data, plus the end
+        qsizetype count() const { return offsets.size() - 1; }
+    };
+    static bool hasZstdChunks(const uchar *data, qint64 size);
+    std::optional<ZstdChunks> zstdChunks() const;
+    QByteArray decompressedChunk(const ZstdChunks &chunks, qsizetype index) const;
+    static std::optional<ZstdChunks> zstdChunks(const QResource &resource)
+    {
+        resource.d_func()->ensureInitialized();
+        return resource.d_func()->zstdChunks();
+    }
+    static QByteArray decompressedChunk(const QResource &resource, const ZstdChunks &chunks,
+                                        qsizetype index)
+    { return resource.d_func()->decompressedChunk(chunks, index); }
+
     bool load(const QString &file);
     void clear();
 
@@ -440,6 +582,8 @@ qint64 QResourcePrivate::uncompressedSize() const
 
     case QResource::ZstdCompression: {
 #if QT_CONFIG(zstd)
+        if (hasZstdChunks(data, size))
+            return qFromLittleEndian<quint64>(data + 16);
         size_t n = ZSTD_getFrameContentSize(data, size);
         return ZSTD_isError(n) ? -1 : qint64(n);
 #else
@@ -497,6 +641,72 @@ qsizetype QResourcePrivate::decompress(char *buffer, qsizetype bufferSize) const
     return -1;
 }
 
+// Must match compressZstdChunked() in rcc.cpp
+static constexpr quint32 ZstdSeekTableMagic = 0x184D2A5A;
+static constexpr qsizetype ZstdSeekTableHeaderSize = 8 + 16;
+
+bool QResourcePrivate::hasZstdChunks(const uchar *data, qint64 size)
+{
+    return size >= ZstdSeekTableHeaderSize
+            && qFromLittleEndian<quint32>(data) == ZstdSeekTableMagic;
+}
+
+std::optional<QResourcePrivate::ZstdChunks> QResourcePrivate::zstdChunks() const
+{
+#if QT_CONFIG(zstd)
+    if (compressionAlgo != QResource::ZstdCompression || !hasZstdChunks(data, size))
+        return std::nullopt;
+
+    ZstdChunks chunks;
+    const qsizetype tableSize = qFromLittleEndian<quint32>(data + 4);
+    chunks.chunkSize = qFromLittleEndian<quint32>(data + 8);
+    const qsizetype count = qFromLittleEndian<quint32>(data + 12);
+    chunks.uncompressedSize = qFromLittleEndian<quint64>(data + 16);
+    if (tableSize != ZstdSeekTableHeaderSize - 8 + 4 * count || chunks.chunkSize <= 0
+            || ZstdSeekTableHeaderSize + 4 * count > size
+            || count != (chunks.uncompressedSize + chunks.chunkSize - 1) / chunks.chunkSize) {
+        return std::nullopt;
+    }
+
+    chunks.offsets.reserve(count + 1);
+    qsizetype offset = ZstdSeekTableHeaderSize + 4 * count;
+    for (qsizetype i = 0; i < count; ++i) {
+        chunks.offsets.append(offset);
+        offset += qFromLittleEndian<quint32>(data + ZstdSeekTableHeaderSize + 4 * i);
+    }
+    chunks.offsets.append(offset);
+    if (offset != size)
+        return std::nullopt;
+    return chunks;
+#else
+    return std::nullopt;
+#endif
+}
+
+QByteArray QResourcePrivate::decompressedChunk(const ZstdChunks &chunks, qsizetype index) const
+{
+#if QT_CONFIG(zstd)
+    return decompressionCache->findOrInsert({ related.constFirst(), data, index }, [&] {
+        const qint64 begin = index * chunks.chunkSize;
+        QByteArray result(qMin(chunks.chunkSize, chunks.uncompressedSize - begin),
+                          Qt::Uninitialized);
+        const qsizetype frame = chunks.offsets.at(index);
+        const size_t n = ZSTD_decompress(result.data(), result.size(), data + frame,
+                                         chunks.offsets.at(index + 1) - frame);
+        if (ZSTD_isError(n) || qsizetype(n) != result.size()) {
+            qWarning("QResource: error decompressing zstd content chunk %lld",
+                     qlonglong(index));
+            return QByteArray();
+        }
+        return result;
+    });
+#else
+    Q_UNUSED(chunks);
+    Q_UNUSED(index);
+    Q_UNREACHABLE_RETURN(QByteArray());
+#endif
+}
+
 /*!
     Constructs a QResource pointing to \a file. \a locale is used to
     load a specific localization of a resource data.
@@ -689,8 +899,12 @@ const uchar *QResource::data() const
     compressed. If the resource is a directory or an error occurs while
     decompressing, a null QByteArray is returned.
 
-    \note If the data was compressed, this function will decompress every time
-    it is called. The result is not cached between calls.
+    \note If the data was compressed, the decompressed data is shared with the
+    other users of the resource in the process, including QFile, and kept for
+    a while after the last of them releases it, so that it does not need to be
+    decompressed again. Set the \c QT_RESOURCE_CACHE_SIZE environment variable
+    to the number of KiB of unused decompressed data to keep (the default is
+    8192).
 
     \sa uncompressedSize(), size(), compressionAlgorithm(), isFile()
 */
@@ -708,14 +922,15 @@ QByteArray QResource::uncompressedData() const
     if (d->compressionAlgo == NoCompression)
         return QByteArray::fromRawData(reinterpret_cast<const char *>(d->data), n);
 
-    // decompress
-    QByteArray result(n, Qt::Uninitialized);
-    n = d->decompress(result.data(), n);
-    if (n < 0)
-        result.clear();
-    else
-        result.truncate(n);
-    return result;
+    return decompressionCache->findOrInsert({ d->related.constFirst(), d->data, -1 }, [d, n] {
+        QByteArray result(n, Qt::Uninitialized);
+        const qsizetype size = d->decompress(result.data(), n);
+        if (size < 0)
+            result.clear();
+        else
+            result.truncate(size);
+        return result;
+    });
 }
 
 /*!
@@ -1386,12 +1601,15 @@ private:
     uchar *map(qint64 offset, qint64 size, QFile::MemoryMapFlags flags);
     bool unmap(uchar *ptr);
     void uncompress() const;
+    qint64 readChunks(char *data, qint64 len);
     void mapUncompressed();
     bool mapUncompressed_sys();
     void unmapUncompressed_sys();
     qint64 offset = 0;
     QResource resource;
     mutable QByteArray uncompressed;
+    QByteArray privateCopy;     // of uncompressed, for MapPrivateOption
+    std::optional<QResourcePrivate::ZstdChunks> chunks;
     bool mustUnmap = false;
 
     // minimum size for which we'll try to re-open ourselves in mapUncompressed()
@@ -1439,8 +1657,11 @@ bool QResourceFileEngine::open(QIODevice::OpenMode flags,
     if (flags & QIODevice::WriteOnly)
         return false;
     if (d->resource.compressionAlgorithm() != QResource::NoCompression) {
-        d->uncompress();
-        if (d->uncompressed.isNull()) {
+        // content compressed in chunks is decompressed as it is read
+        d->chunks = QResourcePrivate::zstdChunks(d->resource);
+        if (!d->chunks)
+            d->uncompress();
+        if (!d->chunks && d->uncompressed.isNull()) {
             d->errorString = QSystemError::stdString(EIO);
             return false;
         }
@@ -1473,12 +1694,33 @@ qint64 QResourceFileEngine::read(char *data, qint64 len)
         return 0;
     if (!d->uncompressed.isNull())
         memcpy(data, d->uncompressed.constData() + d->offset, len);
+    else if (d->chunks)
+        return d->readChunks(data, len);
     else
         memcpy(data, d->resource.data() + d->offset, len);
     d->offset += len;
     return len;
 }
 
+qint64 QResourceFileEnginePrivate::readChunks(char *data, qint64 len)
+{
+    qint64 done = 0;
+    while (done < len) {
+        const qsizetype index = offset / chunks->chunkSize;
+        const qint64 chunkOffset = offset - index * chunks->chunkSize;
+        const QByteArray chunk = QResourcePrivate::decompressedChunk(resource, *chunks, index);
+        if (chunk.isNull()) {
+            q_func()->setError(QFile::ReadError, QSystemError::stdString(EIO));
+            return done ? done : -1;
+        }
+        const qint64 n = qMin(len - done, chunk.size() - chunkOffset);
+        memcpy(data + done, chunk.constData() + chunkOffset, n);
+        done += n;
+        offset += n;
+    }
+    return done;
+}
+
 qint64 QResourceFileEngine::size() const
 {
     Q_D(const QResourceFileEngine);
@@ -1620,6 +1862,8 @@ bool QResourceFileEngine::supportsExtension(Extension extension) const
 uchar *QResourceFileEnginePrivate::map(qint64 offset, qint64 size, QFile::MemoryMapFlags flags)
 {
     Q_Q(QResourceFileEngine);
+    if (chunks)
+        uncompress();   // can't map chunks in isolation
     Q_ASSERT_X(resource.compressionAlgorithm() == QResource::NoCompression
                || !uncompressed.isNull(), "QFile::map()",
                "open() should have uncompressed compressed resources");
@@ -1632,12 +1876,21 @@ uchar *QResourceFileEnginePrivate::map(qint64 offset, qint64 size, QFile::Memory
         return nullptr;
     }
 
-    const uchar *address = reinterpret_cast<const uchar *>(uncompressed.constBegin());
-    if (!uncompressed.isNull())
+    if (!uncompressed.isNull()) {
+        // Decompressed data is shared with the other users of the resource, so
+        // writable mappings of it get a copy of their own.
+        if (resource.compressionAlgorithm() != QResource::NoCompression
+                && (flags & QFile::MapPrivateOption)) {
+            if (privateCopy.isNull())
+                privateCopy = QByteArray(uncompressed.constData(), uncompressed.size());
+            return reinterpret_cast<uchar *>(privateCopy.data()) + offset;
+        }
+        const uchar *address = reinterpret_cast<const uchar *>(uncompressed.constData());
         return const_cast<uchar *>(address) + offset;
+    }
 
     // resource was not compressed
-    address = resource.data();
+    const uchar *address = resource.data();
     if (flags & QFile::MapPrivateOption) {
         // We need to provide read-write memory
         mapUncompressed();
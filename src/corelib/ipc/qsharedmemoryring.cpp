@@ -0,0 +1,590 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsharedmemoryring_p.h"
+
+#include <qendian.h>
+#include <qsocketnotifier.h>
+#include <qthread.h>
+
+#include <private/qcore_unix_p.h>
+#include <private/qfutex_p.h>
+
+#include <atomic>
+#include <limits>
+#include <new>
+
+#include <sys/eventfd.h>
+
+#ifndef QT_ALWAYS_USE_FUTEX
+#  error "QSharedMemoryRing requires futex support"
+#endif
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+using namespace QtLinuxFutex;
+
+/*!
+    \internal
+    \class QSharedMemoryRing
+    \inmodule QtCore
+
+    QSharedMemoryRing implements a message queue in a QSharedMemory segment
+    that processes can exchange messages through without taking the segment's
+    QSystemSemaphore lock.
+
+    The queue is a ring buffer of variable-length records. The producer
+    publishes a record by advancing the write index with release semantics and
+    the single consumer frees it by advancing the read index, so in the
+    uncontended case neither side makes a system call. A side that has to
+    block (consumer on empty, producer on full) announces so in the header and
+    sleeps on a process-shared futex, which the other side only wakes if
+    someone is actually waiting.
+
+    In MultipleProducers mode the producers serialize among themselves with a
+    futex-based lock in the segment. A process that crashes while holding that
+    lock leaves the ring unusable for the other producers.
+*/
+
+namespace {
+constexpr quint32 RingMagic = 0x51524e47;    // 'QRNG'
+constexpr quint32 RingVersion = 1;
+constexpr quint32 PaddingRecord = 0xffffffffU;
+constexpr qsizetype RecordAlignment = 8;
+constexpr qsizetype RecordHeaderSize = 8;
+
+static_assert(std::atomic<quint64>::is_always_lock_free,
+              "QSharedMemoryRing requires lock-free 64-bit atomics");
+
+constexpr qsizetype recordSize(qsizetype payload)
+{
+    return RecordHeaderSize + ((payload + RecordAlignment - 1) & ~(RecordAlignment - 1));
+}
+} // unnamed namespace
+
+struct QSharedMemoryRing::Header
+{
+    quint32 magic;
+    quint32 version;
+    quint32 capacity;
+    quint32 mode;
+
+    // written by the producer(s), read by the consumer
+    alignas(64) std::atomic<quint64> writeIndex;
+    QBasicAtomicInt dataSequence;
+    QBasicAtomicInt consumerWaiting;
+    QBasicAtomicInt producerLock;
+
+    // written by the consumer, read by the producer(s)
+    alignas(64) std::atomic<quint64> readIndex;
+    QBasicAtomicInt spaceSequence;
+    QBasicAtomicInt producersWaiting;
+};
+
+static constexpr qsizetype HeaderSize = (sizeof(QSharedMemoryRing::Header) + 63) & ~63;
+
+QSharedMemoryRing::QSharedMemoryRing()
+    = default;
+
+QSharedMemoryRing::~QSharedMemoryRing()
+    = default;
+
+QSharedMemoryRing::Header *QSharedMemoryRing::header() const
+{
+    return static_cast<Header *>(const_cast<void *>(memory.constData()));
+}
+
+char *QSharedMemoryRing::ringData() const
+{
+    return reinterpret_cast<char *>(header()) + HeaderSize;
+}
+
+/*!
+    Creates the shared memory segment identified by \a key with room for
+    \a capacity bytes of records and initializes an empty ring in it. The
+    capacity is rounded up to a multiple of 8 bytes.
+*/
+bool QSharedMemoryRing::create(const QNativeIpcKey &key, qsizetype capacity, ProducerMode mode)
+{
+    capacity = (capacity + RecordAlignment - 1) & ~(RecordAlignment - 1);
+    if (capacity < 4 * RecordHeaderSize || capacity > std::numeric_limits<qint32>::max()) {
+        error = QSharedMemory::tr("%1: invalid ring capacity").arg("QSharedMemoryRing::create"_L1);
+        return false;
+    }
+
+    memory.setNativeKey(key);
+    if (!memory.create(HeaderSize + capacity)) {
+        error = memory.errorString();
+        return false;
+    }
+
+    Header *h = new (memory.data()) Header;
+    h->capacity = quint32(capacity);
+    h->mode = quint32(mode);
+    h->writeIndex.store(0, std::memory_order_relaxed);
+    h->readIndex.store(0, std::memory_order_relaxed);
+    h->dataSequence.storeRelaxed(0);
+    h->consumerWaiting.storeRelaxed(0);
+    h->producerLock.storeRelaxed(0);
+    h->spaceSequence.storeRelaxed(0);
+    h->producersWaiting.storeRelaxed(0);
+    h->version = RingVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = RingMagic;
+    error.clear();
+    return true;
+}
+
+/*!
+    Attaches to a ring previously created by create() in another process (or
+    in this one) under \a key.
+*/
+bool QSharedMemoryRing::attach(const QNativeIpcKey &key)
+{
+    memory.setNativeKey(key);
+    if (!memory.attach()) {
+        error = memory.errorString();
+        return false;
+    }
+
+    const Header *h = header();
+    if (memory.size() < HeaderSize || h->magic != RingMagic || h->version != RingVersion
+            || HeaderSize + qsizetype(h->capacity) > memory.size()) {
+        memory.detach();
+        error = QSharedMemory::tr("%1: segment does not contain a compatible ring")
+                .arg("QSharedMemoryRing::attach"_L1);
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    error.clear();
+    return true;
+}
+
+bool QSharedMemoryRing::detach()
+{
+    return memory.detach();
+}
+
+bool QSharedMemoryRing::isAttached() const
+{
+    return memory.isAttached();
+}
+
+qsizetype QSharedMemoryRing::capacity() const
+{
+    return isAttached() ? qsizetype(header()->capacity) : 0;
+}
+
+/*!
+    Returns the size of the largest message that can be written. Limiting
+    records to half the ring guarantees that one always fits once the consumer
+    has caught up, even if it has to be preceded by a wrap-around padding
+    record.
+*/
+qsizetype QSharedMemoryRing::maximumMessageSize() const
+{
+    return capacity() / 2 - RecordHeaderSize;
+}
+
+QSharedMemoryRing::ProducerMode QSharedMemoryRing::producerMode() const
+{
+    return isAttached() ? ProducerMode(header()->mode) : SingleProducer;
+}
+
+void QSharedMemoryRing::lockProducers()
+{
+    QBasicAtomicInt &lock = header()->producerLock;
+    if (lock.testAndSetAcquire(0, 1))
+        return;
+    while (lock.fetchAndStoreAcquire(2) != 0)
+        sharedFutexWait(lock, 2);
+}
+
+void QSharedMemoryRing::unlockProducers()
+{
+    QBasicAtomicInt &lock = header()->producerLock;
+    if (lock.fetchAndStoreRelease(0) == 2)
+        sharedFutexWakeOne(lock);
+}
+
+// must be called with the producer lock held, if in MultipleProducers mode
+bool QSharedMemoryRing::writeLocked(QByteArrayView message)
+{
+    Header *h = header();
+    const quint64 cap = h->capacity;
+    const quint64 need = recordSize(message.size());
+    quint64 w = h->writeIndex.load(std::memory_order_relaxed);
+    const quint64 r = h->readIndex.load(std::memory_order_acquire);
+
+    quint64 pos = w % cap;
+    const quint64 tailRoom = cap - pos;
+    const quint64 padding = tailRoom < need ? tailRoom : 0;
+    if (cap - (w - r) < need + padding)
+        return false;
+
+    char *data = ringData();
+    if (padding) {
+        qToUnaligned(PaddingRecord, data + pos);
+        w += padding;
+        pos = 0;
+    }
+    qToUnaligned(quint32(message.size()), data + pos);
+    memcpy(data + pos + RecordHeaderSize, message.data(), message.size());
+    h->writeIndex.store(w + need, std::memory_order_release);
+
+    // pairs with the fence in waitForMessages()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (h->consumerWaiting.loadRelaxed()) {
+        h->dataSequence.fetchAndAddRelease(1);
+        sharedFutexWakeAll(h->dataSequence);
+    }
+    return true;
+}
+
+/*!
+    Appends \a message to the ring if there is room for it, without blocking.
+    Returns \c false if the ring is full or the message is larger than
+    maximumMessageSize().
+*/
+bool QSharedMemoryRing::tryWrite(QByteArrayView message)
+{
+    if (!isAttached() || message.size() > maximumMessageSize())
+        return false;
+
+    if (producerMode() == SingleProducer)
+        return writeLocked(message);
+
+    lockProducers();
+    bool ok = writeLocked(message);
+    unlockProducers();
+    return ok;
+}
+
+/*!
+    Appends \a message to the ring, blocking until the consumer has freed
+    enough room or until \a deadline expires.
+*/
+bool QSharedMemoryRing::write(QByteArrayView message, QDeadlineTimer deadline)
+{
+    if (!isAttached() || message.size() > maximumMessageSize())
+        return false;
+
+    while (!tryWrite(message)) {
+        if (!waitForSpace(deadline) && deadline.hasExpired())
+            return false;
+    }
+    return true;
+}
+
+bool QSharedMemoryRing::waitForSpace(QDeadlineTimer deadline)
+{
+    Header *h = header();
+    const quint64 r = h->readIndex.load(std::memory_order_acquire);
+    h->producersWaiting.fetchAndAddRelaxed(1);
+    const int sequence = h->spaceSequence.loadRelaxed();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // if the consumer made progress since we last tried, don't sleep
+    bool woken = true;
+    if (h->readIndex.load(std::memory_order_acquire) == r)
+        woken = sharedFutexWait(h->spaceSequence, sequence, deadline);
+    h->producersWaiting.fetchAndSubRelaxed(1);
+    return woken;
+}
+
+bool QSharedMemoryRing::hasMessages() const
+{
+    if (!isAttached())
+        return false;
+    const Header *h = header();
+    return h->writeIndex.load(std::memory_order_acquire)
+            != h->readIndex.load(std::memory_order_relaxed);
+}
+
+// frees the records before \a index and wakes the producers waiting for room
+void QSharedMemoryRing::releaseRecords(quint64 index)
+{
+    Header *h = header();
+    h->readIndex.store(index, std::memory_order_release);
+
+    // pairs with the fence in waitForSpace()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (h->producersWaiting.loadRelaxed()) {
+        h->spaceSequence.fetchAndAddRelease(1);
+        sharedFutexWakeAll(h->spaceSequence);
+    }
+}
+
+/*!
+    Removes the oldest message from the ring and stores it in \a message.
+    Returns \c false without blocking if the ring is empty.
+
+    The ring can be written by any process attached to the segment, so its
+    records are validated before being read. If one is malformed, all the
+    messages in the ring are discarded, errorString() describes the problem
+    and this function returns \c false.
+*/
+bool QSharedMemoryRing::tryRead(QByteArray *message)
+{
+    if (!isAttached())
+        return false;
+
+    Header *h = header();
+    const quint64 cap = h->capacity;
+    quint64 r = h->readIndex.load(std::memory_order_relaxed);
+    const quint64 w = h->writeIndex.load(std::memory_order_acquire);
+    if (w == r)
+        return false;
+
+    auto corrupted = [&] {
+        error = QSharedMemory::tr("%1: discarded malformed messages")
+                .arg("QSharedMemoryRing::tryRead"_L1);
+        releaseRecords(w);
+        return false;
+    };
+    if (cap < 4 * RecordHeaderSize || HeaderSize + qsizetype(cap) > memory.size()
+            || w - r > cap || r % RecordAlignment) {
+        return corrupted();
+    }
+
+    const char *data = ringData();
+    quint64 pos = r % cap;
+    quint32 length = qFromUnaligned<quint32>(data + pos);
+    if (length == PaddingRecord) {
+        if (w - r < cap - pos + RecordHeaderSize)
+            return corrupted();
+        r += cap - pos;
+        pos = 0;
+        length = qFromUnaligned<quint32>(data);
+    }
+    if (qsizetype(length) > maximumMessageSize() || pos + RecordHeaderSize + length > cap
+            || quint64(recordSize(length)) > w - r) {
+        return corrupted();
+    }
+    message->assign(QByteArrayView(data + pos + RecordHeaderSize, length));
+    releaseRecords(r + recordSize(length));
+    return true;
+}
+
+/*!
+    Removes the oldest message from the ring and stores it in \a message,
+    blocking until one is available or until \a deadline expires.
+*/
+bool QSharedMemoryRing::read(QByteArray *message, QDeadlineTimer deadline)
+{
+    while (!tryRead(message)) {
+        if (!isAttached() || (!waitForMessages(deadline) && deadline.hasExpired()))
+            return false;
+    }
+    return true;
+}
+
+/*!
+    Blocks until the ring has messages, \a deadline expires or wakeConsumer()
+    is called. Returns \c true if there are messages to read.
+
+    If \a stop is not null, this function does not block once it is non-zero.
+    A thread that sets it before calling wakeConsumer() is guaranteed to stop
+    the wait, even if the consumer had not started sleeping yet.
+*/
+bool QSharedMemoryRing::waitForMessages(QDeadlineTimer deadline, const QAtomicInt *stop)
+{
+    if (hasMessages())
+        return true;
+    if (!isAttached())
+        return false;
+
+    Header *h = header();
+    h->consumerWaiting.fetchAndAddRelaxed(1);
+    // pairs with the release in wakeConsumer(): if this sees its increment,
+    // it also sees the stop flag set before it, otherwise the futex wait
+    // returns because the sequence has changed
+    const int sequence = h->dataSequence.loadAcquire();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!hasMessages() && !(stop && stop->loadRelaxed()))
+        sharedFutexWait(h->dataSequence, sequence, deadline);
+    h->consumerWaiting.fetchAndSubRelaxed(1);
+    return hasMessages();
+}
+
+/*!
+    Wakes up the consumer if it is blocked in waitForMessages(), even if no
+    message has been written.
+*/
+void QSharedMemoryRing::wakeConsumer()
+{
+    if (!isAttached())
+        return;
+    Header *h = header();
+    h->dataSequence.fetchAndAddRelease(1);
+    sharedFutexWakeAll(h->dataSequence);
+}
+
+/*!
+    \internal
+    \class QSharedMemoryRingDevice
+    \inmodule QtCore
+
+    QSharedMemoryRingDevice is a sequential QIODevice on top of a
+    QSharedMemoryRing. Opened for writing, each write() is published as one
+    or more messages, blocking while the ring is full. Opened for reading, the
+    device emits readyRead() from the event loop: a helper thread sleeps on
+    the ring's futex and signals an eventfd that a QSocketNotifier watches,
+    so the thread owning the device never blocks.
+*/
+
+QSharedMemoryRingDevice::QSharedMemoryRingDevice(QSharedMemoryRing *ring, QObject *parent)
+    : QIODevice(parent), m_ring(ring)
+{
+}
+
+QSharedMemoryRingDevice::~QSharedMemoryRingDevice()
+{
+    close();
+}
+
+bool QSharedMemoryRingDevice::isSequential() const
+{
+    return true;
+}
+
+bool QSharedMemoryRingDevice::open(OpenMode mode)
+{
+    if ((mode & ReadWrite) == ReadWrite || !(mode & ReadWrite)) {
+        setErrorString(tr("A shared memory ring can only be opened for reading or for writing"));
+        return false;
+    }
+    if (!m_ring->isAttached()) {
+        setErrorString(tr("The shared memory ring is not attached"));
+        return false;
+    }
+
+    if (mode & ReadOnly) {
+        m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_eventFd < 0) {
+            setErrorString(qt_error_string());
+            return false;
+        }
+        m_stopping.storeRelaxed(0);
+        m_notifier = new QSocketNotifier(m_eventFd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &QSharedMemoryRingDevice::notified);
+        m_watcher = QThread::create(&QSharedMemoryRingDevice::watchRing, this);
+        m_watcher->setObjectName("QSharedMemoryRing watcher"_L1);
+        m_watcher->start();
+    }
+
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void QSharedMemoryRingDevice::close()
+{
+    if (m_watcher) {
+        m_stopping.storeRelaxed(1);
+        m_ring->wakeConsumer();
+        m_rearm.release();
+        m_watcher->wait();
+        delete std::exchange(m_watcher, nullptr);
+    }
+    delete std::exchange(m_notifier, nullptr);
+    if (m_eventFd >= 0)
+        qt_safe_close(std::exchange(m_eventFd, -1));
+    m_rearm.acquire(m_rearm.available());
+    m_pending.clear();
+    m_pendingOffset = 0;
+    QIODevice::close();
+}
+
+// runs in the watcher thread
+void QSharedMemoryRingDevice::watchRing()
+{
+    while (!m_stopping.loadRelaxed()) {
+        if (!m_ring->waitForMessages(QDeadlineTimer::Forever, &m_stopping))
+            continue;
+        if (m_stopping.loadRelaxed())
+            break;
+        eventfd_write(m_eventFd, 1);
+
+        // don't wake up again until the device has looked at the ring
+        m_rearm.acquire();
+    }
+}
+
+void QSharedMemoryRingDevice::notified()
+{
+    eventfd_t value;
+    eventfd_read(m_eventFd, &value);
+    const qsizetype before = m_pending.size() - m_pendingOffset;
+    fetchMessages();
+    m_rearm.release();
+    if (m_pending.size() - m_pendingOffset > before)
+        emit readyRead();
+}
+
+// moves all messages currently in the ring into m_pending, freeing the ring
+// for the producer
+void QSharedMemoryRingDevice::fetchMessages()
+{
+    if (m_pendingOffset) {
+        m_pending.remove(0, m_pendingOffset);
+        m_pendingOffset = 0;
+    }
+    QByteArray message;
+    while (m_ring->tryRead(&message))
+        m_pending += message;
+}
+
+qint64 QSharedMemoryRingDevice::bytesAvailable() const
+{
+    return m_pending.size() - m_pendingOffset + QIODevice::bytesAvailable();
+}
+
+bool QSharedMemoryRingDevice::waitForReadyRead(int msecs)
+{
+    if (!(openMode() & ReadOnly))
+        return false;
+    if (m_pending.size() > m_pendingOffset)
+        return true;
+
+    QDeadlineTimer deadline(msecs);
+    if (!m_ring->waitForMessages(deadline))
+        return false;
+    fetchMessages();
+    emit readyRead();
+    return true;
+}
+
+qint64 QSharedMemoryRingDevice::readData(char *data, qint64 maxlen)
+{
+    if (m_pending.size() == m_pendingOffset)
+        fetchMessages();
+
+    const qint64 n = qMin(maxlen, qint64(m_pending.size() - m_pendingOffset));
+    memcpy(data, m_pending.constData() + m_pendingOffset, n);
+    m_pendingOffset += n;
+    if (m_pendingOffset == m_pending.size()) {
+        m_pending.clear();
+        m_pendingOffset = 0;
+    }
+    return n;
+}
+
+qint64 QSharedMemoryRingDevice::writeData(const char *data, qint64 len)
+{
+    const qsizetype chunk = m_ring->maximumMessageSize();
+    qint64 written = 0;
+    while (written < len) {
+        const qsizetype n = qsizetype(qMin(len - written, qint64(chunk)));
+        if (!m_ring->write(QByteArrayView(data + written, n))) {
+            setErrorString(tr("Failed to write to the shared memory ring"));
+            return written ? written : -1;
+        }
+        written += n;
+    }
+    emit bytesWritten(written);
+    return written;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qsharedmemoryring_p.cpp"
@@ -0,0 +1,118 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSHAREDMEMORYRING_P_H
+#define QSHAREDMEMORYRING_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qsharedmemory.h>
+
+QT_REQUIRE_CONFIG(sharedmemory);
+
+QT_BEGIN_NAMESPACE
+
+class QSocketNotifier;
+class QThread;
+
+class Q_CORE_EXPORT QSharedMemoryRing
+{
+    Q_DISABLE_COPY_MOVE(QSharedMemoryRing)
+public:
+    enum ProducerMode {
+        SingleProducer,
+        MultipleProducers
+    };
+
+    struct Header;
+
+    QSharedMemoryRing();
+    ~QSharedMemoryRing();
+
+    bool create(const QNativeIpcKey &key, qsizetype capacity,
+                ProducerMode mode = SingleProducer);
+    bool attach(const QNativeIpcKey &key);
+    bool detach();
+    bool isAttached() const;
+
+    qsizetype capacity() const;
+    qsizetype maximumMessageSize() const;
+    ProducerMode producerMode() const;
+    QString errorString() const { return error; }
+
+    // producer side
+    bool tryWrite(QByteArrayView message);
+    bool write(QByteArrayView message, QDeadlineTimer deadline = QDeadlineTimer::Forever);
+
+    // consumer side (only one consumer is allowed)
+    bool hasMessages() const;
+    bool tryRead(QByteArray *message);
+    bool read(QByteArray *message, QDeadlineTimer deadline = QDeadlineTimer::Forever);
+    bool waitForMessages(QDeadlineTimer deadline = QDeadlineTimer::Forever,
+                         const QAtomicInt *stop = nullptr);
+    void wakeConsumer();
+
+private:
+    Header *header() const;
+    char *ringData() const;
+    bool writeLocked(QByteArrayView message);
+    bool waitForSpace(QDeadlineTimer deadline);
+    void releaseRecords(quint64 index);
+    void lockProducers();
+    void unlockProducers();
+
+    QSharedMemory memory;
+    QString error;
+};
+
+class Q_CORE_EXPORT QSharedMemoryRingDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit QSharedMemoryRingDevice(QSharedMemoryRing *ring, QObject *parent = nullptr);
+    ~QSharedMemoryRingDevice() override;
+
+    QSharedMemoryRing *ring() const { return m_ring; }
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+    bool waitForReadyRead(int msecs) override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    void fetchMessages();
+    void notified();
+    void watchRing();
+
+    QSharedMemoryRing *m_ring;
+    QByteArray m_pending;
+    qsizetype m_pendingOffset = 0;
+    QSocketNotifier *m_notifier = nullptr;
+    QThread *m_watcher = nullptr;
+    QSemaphore m_rearm;
+    QAtomicInt m_stopping;
+    int m_eventFd = -1;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSHAREDMEMORYRING_P_H
@@ -9,6 +9,7 @@
 #include <QtCore/qloggingcategory.h>
 #include <QThread>
 #include <QtCore/qmetaobject.h>
+#include <QtCore/qhash.h>
 
 #include "qobject_p.h"
 
@@ -112,20 +113,16 @@ struct QPropertyDelayedNotifications
     /*!
         \internal
         Called in Qt::endPropertyUpdateGroup. For the QPropertyProxyBindingData at position
-        \a index, it
-        \list
-            \li restores the original binding data that was modified in addProperty and
-            \li evaluates any bindings which depend on properties that were changed inside
-                the group.
-        \endlist
+        \a index, it restores the original binding data that was modified in addProperty and
+        returns the first of its observers, whose bindings need to be evaluated.
         Change notifications are sent later with notify (following the logic of separating
         binding updates and notifications used in non-deferred updates).
      */
-     void evaluateBindings(PendingBindingObserverList &bindingObservers, qsizetype index, QBindingStatus *status) {
+    QPropertyObserverPointer restoreBindingData(qsizetype index) {
         auto *delayed = delayedProperties + index;
         auto *bindingData = delayed->originalBindingData;
         if (!bindingData)
-            return;
+            return {};
 
         bindingData->d_ptr = delayed->d_ptr;
         Q_ASSERT(!(bindingData->d_ptr & QPropertyBindingData::DelayedNotificationBit));
@@ -135,9 +132,7 @@ struct QPropertyDelayedNotifications
         }
 
         QPropertyBindingDataPointer bindingDataPointer{bindingData};
-        QPropertyObserverPointer observer = bindingDataPointer.firstObserver();
-        if (observer)
-            observer.evaluateBindings(bindingObservers, status);
+        return bindingDataPointer.firstObserver();
     }
 
     /*!
@@ -165,6 +160,151 @@ struct QPropertyDelayedNotifications
     }
 };
 
+/*!
+    \internal
+
+    QPropertyGroupEvaluation evaluates the bindings that depend, directly or
+    indirectly, on the properties changed in a property update group.
+
+    Evaluating the dependents of each changed property recursively, as is
+    done outside of groups, evaluates a binding once for every changed
+    property it depends on. Instead, the dependency graph of the affected
+    bindings is sorted topologically, and each binding is evaluated at most
+    once: after all the bindings it depends on, and only if one of them or
+    one of the changed properties actually changed.
+
+    Evaluating a binding can change what it depends on. A binding found to
+    depend on one evaluated after it, or on one that the graph did not know
+    about, is evaluated recursively, as outside of groups.
+
+    \sa Qt::endPropertyUpdateGroup
+*/
+class QPropertyGroupEvaluation
+{
+public:
+    void addDependents(QPropertyObserverPointer observer);
+    void evaluate(PendingBindingObserverList &bindingObservers, QBindingStatus *status);
+    void notify();
+
+private:
+    struct Node
+    {
+        QPropertyBindingPrivatePtr binding;
+        bool dirty = false;
+        bool changed = false;
+
+        QPropertyBindingPrivate *get() const
+        { return static_cast<QPropertyBindingPrivate *>(binding.data()); }
+    };
+
+    QVarLengthArray<QPropertyBindingPrivate *, 16> roots;
+    QList<Node> nodes; // in topological order
+    QHash<QPropertyBindingPrivate *, qsizetype> positions;
+};
+
+/*!
+    \internal
+    Adds the bindings among \a observer and the observers following it to the
+    bindings to evaluate.
+*/
+void QPropertyGroupEvaluation::addDependents(QPropertyObserverPointer observer)
+{
+    for (; observer; observer = observer.nextObserver()) {
+        if (observer.notifiesBinding())
+            roots.append(observer.binding());
+    }
+}
+
+/*!
+    \internal
+    Evaluates the bindings added with addDependents() and all the bindings
+    depending on them, as needed. Bindings evaluated recursively are added to
+    \a bindingObservers, for their change notifications.
+*/
+void QPropertyGroupEvaluation::evaluate(PendingBindingObserverList &bindingObservers,
+                                        QBindingStatus *status)
+{
+    // A depth-first search yields the bindings in post-order; reversed, that
+    // is a topological order (apart from binding loops).
+    struct Frame
+    {
+        QPropertyBindingPrivate *binding;
+        QPropertyObserverPointer nextObserver;
+    };
+    QVarLengthArray<Frame, 32> stack;
+    QList<QPropertyBindingPrivate *> postOrder;
+    for (QPropertyBindingPrivate *root : std::as_const(roots)) {
+        if (positions.contains(root))
+            continue;
+        positions.insert(root, -1);
+        stack.append({ root, root->firstObserver });
+        while (!stack.isEmpty()) {
+            Frame &top = stack.last();
+            while (top.nextObserver && !top.nextObserver.notifiesBinding())
+                top.nextObserver = top.nextObserver.nextObserver();
+            if (!top.nextObserver) {
+                postOrder.append(top.binding);
+                stack.removeLast();
+                continue;
+            }
+            QPropertyBindingPrivate *dependent = top.nextObserver.binding();
+            top.nextObserver = top.nextObserver.nextObserver();
+            if (positions.contains(dependent))
+                continue;
+            positions.insert(dependent, -1);
+            stack.append({ dependent, dependent->firstObserver });
+        }
+    }
+
+    nodes.reserve(postOrder.size());
+    for (qsizetype i = postOrder.size(); i-- > 0; ) {
+        positions[postOrder.at(i)] = nodes.size();
+        nodes.append(Node{ QPropertyBindingPrivatePtr(postOrder.at(i)) });
+    }
+    for (QPropertyBindingPrivate *root : std::as_const(roots))
+        nodes[positions.value(root)].dirty = true;
+
+    PendingBindingObserverList outOfOrder;
+    for (qsizetype i = 0; i < nodes.size(); ++i) {
+        if (!nodes.at(i).dirty)
+            continue;
+        QPropertyBindingPrivate *binding = nodes.at(i).get();
+        if (!binding->propertyDataPtr)
+            continue; // removed from its property in the meantime
+        if (!binding->evaluate_inline(nullptr, status))
+            continue;
+        nodes[i].changed = true;
+
+        for (QPropertyObserverPointer observer = binding->firstObserver; observer;
+             observer = observer.nextObserver()) {
+            if (!observer.notifiesBinding())
+                continue;
+            const qsizetype position = positions.value(observer.binding(), -1);
+            if (position > i)
+                nodes[position].dirty = true;
+            else
+                outOfOrder.emplace_back(observer.ptr);
+        }
+        for (QBindingObserverPtr &observer : outOfOrder) {
+            if (observer.binding()->evaluateRecursive_inline(bindingObservers, status))
+                bindingObservers.push_back(std::move(observer));
+        }
+        outOfOrder.clear();
+    }
+}
+
+/*!
+    \internal
+    Sends the change notifications of the bindings evaluate() changed.
+*/
+void QPropertyGroupEvaluation::notify()
+{
+    for (const Node &node : std::as_const(nodes)) {
+        if (node.changed)
+            node.get()->notifyNonRecursive();
+    }
+}
+
 Q_CONSTINIT static thread_local QBindingStatus bindingStatus;
 
 /*!
@@ -218,14 +358,17 @@ void Qt::endPropertyUpdateGroup()
     groupUpdateData = nullptr;
     // ensures that bindings are kept alive until endPropertyUpdateGroup concludes
     PendingBindingObserverList bindingObservers;
-    // update all delayed properties
+    QPropertyGroupEvaluation evaluation;
+    // update all delayed properties, then the bindings depending on them
     auto start = data;
     while (data) {
         for (qsizetype i = 0; i < data->used; ++i)
-            data->evaluateBindings(bindingObservers, i, status);
+            evaluation.addDependents(data->restoreBindingData(i));
         data = data->next;
     }
+    evaluation.evaluate(bindingObservers, status);
     // notify all delayed notifications from binding evaluation
+    evaluation.notify();
     for (const QBindingObserverPtr &observer: bindingObservers) {
         QPropertyBindingPrivate *binding = observer.binding();
         binding->notifyNonRecursive();
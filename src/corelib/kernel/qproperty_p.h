@@ -169,6 +169,9 @@ struct QPropertyObserverPointer
 
     QPropertyObserverPointer nextObserver() const { return {ptr->next.data()}; }
 
+    bool notifiesBinding() const
+    { return ptr->next.tag() == QPropertyObserver::ObserverNotifiesBinding; }
+
     QPropertyBindingPrivate *binding() const
     {
         Q_ASSERT(ptr->next.tag() == QPropertyObserver::ObserverNotifiesBinding);
@@ -266,6 +269,7 @@ class Q_CORE_EXPORT QPropertyBindingPrivate : public QtPrivate::RefCounted
 private:
     friend struct QPropertyBindingDataPointer;
     friend class QPropertyBindingPrivatePtr;
+    friend class QPropertyGroupEvaluation;
 
     using ObserverArray = std::array<QPropertyObserver, 4>;
 
@@ -407,7 +411,10 @@ public:
 
     bool evaluateRecursive(PendingBindingObserverList &bindingObservers, QBindingStatus *status = nullptr);
 
-    bool Q_ALWAYS_INLINE evaluateRecursive_inline(PendingBindingObserverList &bindingObservers, QBindingStatus *status);
+    bool Q_ALWAYS_INLINE evaluateRecursive_inline(PendingBindingObserverList &bindingObservers, QBindingStatus *status)
+    { return evaluate_inline(&bindingObservers, status); }
+    // evaluates the bindings depending on this one too, unless bindingObservers is null
+    bool Q_ALWAYS_INLINE evaluate_inline(PendingBindingObserverList *bindingObservers, QBindingStatus *status);
 
     void notifyNonRecursive(const PendingBindingObserverList &bindingObservers);
     enum NotificationState : bool { Delayed, Sent };
@@ -831,7 +838,7 @@ struct QUntypedBindablePrivate
     }
 };
 
-inline bool QPropertyBindingPrivate::evaluateRecursive_inline(PendingBindingObserverList &bindingObservers, QBindingStatus *status)
+inline bool QPropertyBindingPrivate::evaluate_inline(PendingBindingObserverList *bindingObservers, QBindingStatus *status)
 {
     if (updating) {
         error = QPropertyBindingError(QPropertyBindingError::BindingLoop);
@@ -870,7 +877,8 @@ inline bool QPropertyBindingPrivate::evaluateRecursive_inline(PendingBindingObse
         return changed;
 
     firstObserver.noSelfDependencies(this);
-    firstObserver.evaluateBindings(bindingObservers, status);
+    if (bindingObservers)
+        firstObserver.evaluateBindings(*bindingObservers, status);
     return true;
 }
 
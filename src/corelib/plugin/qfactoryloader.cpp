@@ -13,6 +13,7 @@
 #include "qcbormap.h"
 #include "qcborstreamreader.h"
 #include "qcborvalue.h"
+#include "qdatetime.h"
 #include "qdirlisting.h"
 #include "qfileinfo.h"
 #include "qjsonarray.h"
@@ -22,14 +23,17 @@
 #include "qplugin.h"
 #include "qplugin_p.h"
 #include "qpluginloader.h"
+#include "qtimezone.h"
 
 #if QT_CONFIG(library)
 #  include "qlibrary_p.h"
+#  include "qpluginmetadatacache_p.h"
 #endif
 
 #include <qtcore_tracepoints_p.h>
 
 #include <map>
+#include <optional>
 #include <vector>
 
 QT_BEGIN_NAMESPACE
@@ -311,6 +315,10 @@ inline void QFactoryLoaderPrivate::updateSinglePath(const QString &path)
 #endif
                 QDirListing::IteratorFlag::FilesOnly);
 
+    std::optional<QPluginMetaDataCache> cache;
+    if (QPluginMetaDataCache::isEnabled())
+        cache.emplace(path, plugins.nameFilters());
+
     for (const auto &dirEntry : plugins) {
         const QString &fileName = dirEntry.fileName();
 #if defined(Q_PROCESSOR_X86)
@@ -325,7 +333,22 @@ inline void QFactoryLoaderPrivate::updateSinglePath(const QString &path)
 
         QLibraryPrivate::UniquePtr library;
         library.reset(QLibraryPrivate::findOrCreate(dirEntry.canonicalFilePath()));
-        if (!library->isPlugin()) {
+
+        QPluginMetaDataCache::FileStamp stamp;
+        bool cacheHit = false;
+        if (cache) {
+            stamp = { dirEntry.lastModified(QTimeZone::UTC).toMSecsSinceEpoch(), dirEntry.size() };
+            if (auto cached = cache->find(fileName, stamp)) {
+                qCDebug(lcFactoryLoader) << "using cached meta data for" << fileName;
+                library->setCachedMetaData(std::move(*cached));
+                cacheHit = true;
+            }
+        }
+
+        const bool isPlugin = library->isPlugin();
+        if (cache && !cacheHit)
+            cache->insert(fileName, stamp, library->metaData, library->errorString);
+        if (!isPlugin) {
             qCDebug(lcFactoryLoader) << library->errorString << Qt::endl
                                      << "         not a plugin";
             continue;
@@ -379,6 +402,9 @@ inline void QFactoryLoaderPrivate::updateSinglePath(const QString &path)
             libraries.push_back(std::move(library));
         }
     };
+
+    if (cache)
+        cache->save();
 }
 
 void QFactoryLoader::update()
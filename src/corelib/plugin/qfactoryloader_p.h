@@ -55,6 +55,15 @@ public:
     // if data is not a map, toMap() returns empty, so shall these functions
     QCborMap toCbor() const                         { return data.toMap(); }
     QCborValue value(QtPluginMetaDataKeys k) const  { return data[int(k)]; }
+
+    // used by QPluginMetaDataCache to store and restore already-parsed data
+    QCborValue cachedData() const                   { return data; }
+    static QPluginParsedMetaData fromCachedData(const QCborValue &cached)
+    {
+        QPluginParsedMetaData result;
+        result.data = cached;
+        return result;
+    }
 };
 
 class QFactoryLoaderPrivate;
@@ -777,6 +777,34 @@ void QLibraryPrivate::updatePluginState()
         return;
     }
 
+    checkPluginCompatibility();
+}
+
+/*
+    Sets the plugin metadata from a previous scan of this file, as found by
+    QPluginMetaDataCache, instead of opening the file to look for it. A
+    \a cached value in error state means the file is not a plugin.
+*/
+void QLibraryPrivate::setCachedMetaData(QPluginParsedMetaData &&cached)
+{
+    QMutexLocker locker(&mutex);
+    if (pluginState != MightBeAPlugin)
+        return;
+
+    if (cached.isError()) {
+        errorString = cached.errorString();
+        pluginState = IsNotAPlugin;
+        return;
+    }
+
+    errorString.clear();
+    metaData = std::move(cached);
+    checkPluginCompatibility();
+}
+
+// must be called with the mutex locked, after metaData has been populated
+void QLibraryPrivate::checkPluginCompatibility()
+{
     pluginState = IsNotAPlugin; // be pessimistic
 
     uint qt_version = uint(metaData.value(QtPluginMetaDataKeys::QtVersion).toInteger());
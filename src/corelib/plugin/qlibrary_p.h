@@ -93,11 +93,13 @@ public:
 
     void updatePluginState();
     bool isPlugin();
+    void setCachedMetaData(QPluginParsedMetaData &&cached);
 
 private:
     explicit QLibraryPrivate(const QString &canonicalFileName, const QString &version, QLibrary::LoadHints loadHints);
     ~QLibraryPrivate();
     void mergeLoadHints(QLibrary::LoadHints loadHints);
+    void checkPluginCompatibility();
 
     bool load_sys();
     bool unload_sys();
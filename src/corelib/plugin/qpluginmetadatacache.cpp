@@ -0,0 +1,209 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpluginmetadatacache_p.h"
+
+#include "qlibrary_p.h"
+
+#include <qcborarray.h>
+#include <qcbormap.h>
+#include <qcryptographichash.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qloggingcategory.h>
+#include <qsavefile.h>
+#include <qstandardpaths.h>
+#include <qsysinfo.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*
+    QPluginMetaDataCache stores the metadata QFactoryLoader extracted from the
+    plugins of a single directory, so the next process scanning the same
+    directory does not need to open and map each library and parse its
+    .qtmetadata section again.
+
+    Entries are keyed by file name and validated against the file's
+    modification time and size. The cache is written with QSaveFile, so
+    concurrent processes either see the previous or the new contents and the
+    last writer wins. Any version, ABI or parsing mismatch simply causes the
+    cache file to be ignored and rewritten.
+
+    The cache is off by default, as it writes to the user's cache directory.
+    It is enabled by setting QT_PLUGIN_METADATA_CACHE=1, which stores it in
+    the generic cache location, or by setting QT_PLUGIN_METADATA_CACHE_DIR to
+    the directory it should be stored in.
+*/
+
+namespace {
+enum class CacheKeys : int {
+    FormatVersion = 0,
+    QtVersion,
+    BuildAbi,
+    Directory,
+    Entries,
+};
+constexpr int CurrentFormatVersion = 1;
+} // unnamed namespace
+
+bool QPluginMetaDataCache::isEnabled()
+{
+    return qEnvironmentVariableIntValue("QT_PLUGIN_METADATA_CACHE")
+            || !qEnvironmentVariableIsEmpty("QT_PLUGIN_METADATA_CACHE_DIR");
+}
+
+QString QPluginMetaDataCache::cacheDirectory()
+{
+    QString dir = qEnvironmentVariable("QT_PLUGIN_METADATA_CACHE_DIR");
+    if (!dir.isEmpty())
+        return dir;
+    dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (dir.isEmpty())
+        return dir;
+    return dir + "/qt6/plugin-metadata"_L1;
+}
+
+QPluginMetaDataCache::QPluginMetaDataCache(const QString &directory, const QStringList &nameFilters)
+    : directory(directory)
+{
+    const QString baseDir = cacheDirectory();
+    if (baseDir.isEmpty())
+        return;
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(directory.constData()),
+                                directory.size() * sizeof(QChar)));
+    for (const QString &filter : nameFilters) {
+        hash.addData("\n");
+        hash.addData(QByteArrayView(reinterpret_cast<const char *>(filter.constData()),
+                                    filter.size() * sizeof(QChar)));
+    }
+    cacheFile = baseDir + u'/' + QLatin1StringView(hash.result().toHex()) + ".cbor"_L1;
+    load();
+}
+
+QPluginMetaDataCache::~QPluginMetaDataCache()
+    = default;
+
+void QPluginMetaDataCache::load()
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QCborParserError error;
+    const QCborMap root = QCborValue::fromCbor(file.readAll(), &error).toMap();
+    if (error.error != QCborError::NoError) {
+        qCDebug(qt_lcDebugPlugins, "Ignoring corrupt plugin metadata cache %ls: %ls",
+                qUtf16Printable(cacheFile), qUtf16Printable(error.errorString()));
+        return;
+    }
+
+    // anything that doesn't match exactly means we rebuild from scratch
+    if (root.value(int(CacheKeys::FormatVersion)).toInteger() != CurrentFormatVersion
+            || root.value(int(CacheKeys::QtVersion)).toInteger() != QT_VERSION
+            || root.value(int(CacheKeys::BuildAbi)).toString() != QSysInfo::buildAbi()
+            || root.value(int(CacheKeys::Directory)).toString() != directory) {
+        qCDebug(qt_lcDebugPlugins, "Ignoring stale plugin metadata cache %ls",
+                qUtf16Printable(cacheFile));
+        return;
+    }
+
+    const QCborMap map = root.value(int(CacheKeys::Entries)).toMap();
+    entries.reserve(map.size());
+    for (auto it : map) {
+        const QCborArray array = it.second.toArray();
+        if (array.size() != 3)
+            continue;
+        Entry entry;
+        entry.stamp = { array.at(0).toInteger(-1), array.at(1).toInteger(-1) };
+        entry.data = array.at(2);
+        if (!entry.data.isMap() && !entry.data.isString())
+            continue;
+        entries.insert(it.first.toString(), std::move(entry));
+    }
+    qCDebug(qt_lcDebugPlugins, "Loaded %lld entries from plugin metadata cache %ls",
+            qlonglong(entries.size()), qUtf16Printable(cacheFile));
+}
+
+/*
+    Returns the cached metadata for \a fileName if it exists and \a stamp
+    matches. Libraries that were found not to be plugins are returned as a
+    QPluginParsedMetaData in error state, carrying the error string.
+*/
+std::optional<QPluginParsedMetaData>
+QPluginMetaDataCache::find(const QString &fileName, FileStamp stamp)
+{
+    auto it = entries.find(fileName);
+    if (it == entries.end())
+        return std::nullopt;
+    it->seen = true;
+    if (it->stamp != stamp) {
+        entries.erase(it);
+        dirty = true;
+        return std::nullopt;
+    }
+    return QPluginParsedMetaData::fromCachedData(it->data);
+}
+
+void QPluginMetaDataCache::insert(const QString &fileName, FileStamp stamp,
+                                  const QPluginParsedMetaData &metaData,
+                                  const QString &errorString)
+{
+    if (!isValid() || stamp.lastModified < 0)
+        return;
+    Entry &entry = entries[fileName];
+    entry.stamp = stamp;
+    entry.data = metaData.isError() ? QCborValue(errorString) : metaData.cachedData();
+    entry.seen = true;
+    dirty = true;
+}
+
+/*
+    Writes the cache back to disk if anything changed since it was loaded,
+    dropping the entries of files that have disappeared from the directory.
+*/
+bool QPluginMetaDataCache::save()
+{
+    if (!isValid())
+        return false;
+
+    for (auto it = entries.begin(); it != entries.end(); ) {
+        if (it->seen) {
+            ++it;
+        } else {
+            it = entries.erase(it);
+            dirty = true;
+        }
+    }
+    if (!dirty)
+        return true;
+
+    QCborMap map;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+        map.insert(it.key(), QCborArray{ it->stamp.lastModified, it->stamp.size, it->data });
+
+    QCborMap root;
+    root.insert(int(CacheKeys::FormatVersion), CurrentFormatVersion);
+    root.insert(int(CacheKeys::QtVersion), QT_VERSION);
+    root.insert(int(CacheKeys::BuildAbi), QSysInfo::buildAbi());
+    root.insert(int(CacheKeys::Directory), directory);
+    root.insert(int(CacheKeys::Entries), map);
+
+    QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)
+            || file.write(root.toCborValue().toCbor()) < 0
+            || !file.commit()) {
+        qCDebug(qt_lcDebugPlugins, "Could not write plugin metadata cache %ls: %ls",
+                qUtf16Printable(cacheFile), qUtf16Printable(file.errorString()));
+        return false;
+    }
+    dirty = false;
+    return true;
+}
+
+QT_END_NAMESPACE
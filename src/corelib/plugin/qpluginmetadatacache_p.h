@@ -0,0 +1,78 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPLUGINMETADATACACHE_P_H
+#define QPLUGINMETADATACACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qfactoryloader_p.h"
+
+#include <QtCore/qcborvalue.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+#include <optional>
+
+QT_REQUIRE_CONFIG(library);
+
+QT_BEGIN_NAMESPACE
+
+class Q_CORE_EXPORT QPluginMetaDataCache
+{
+    Q_DISABLE_COPY_MOVE(QPluginMetaDataCache)
+public:
+    struct FileStamp
+    {
+        qint64 lastModified = -1;   // milliseconds since epoch, UTC
+        qint64 size = -1;
+
+        friend bool operator==(FileStamp lhs, FileStamp rhs) noexcept
+        { return lhs.lastModified == rhs.lastModified && lhs.size == rhs.size; }
+        friend bool operator!=(FileStamp lhs, FileStamp rhs) noexcept
+        { return !(lhs == rhs); }
+    };
+
+    QPluginMetaDataCache(const QString &directory, const QStringList &nameFilters);
+    ~QPluginMetaDataCache();
+
+    static bool isEnabled();
+    static QString cacheDirectory();
+
+    bool isValid() const { return !cacheFile.isEmpty(); }
+    QString fileName() const { return cacheFile; }
+
+    std::optional<QPluginParsedMetaData> find(const QString &fileName, FileStamp stamp);
+    void insert(const QString &fileName, FileStamp stamp, const QPluginParsedMetaData &metaData,
+                const QString &errorString);
+    bool save();
+
+private:
+    struct Entry
+    {
+        FileStamp stamp;
+        QCborValue data;            // map of metadata or error string
+        bool seen = false;
+    };
+
+    void load();
+
+    QString directory;
+    QString cacheFile;
+    QHash<QString, Entry> entries;
+    bool dirty = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPLUGINMETADATACACHE_P_H
@@ -1124,6 +1124,46 @@ qint64 QDataStream::readRawData(char *s, qint64 len)
     return readBlock(s, len);
 }
 
+static void byteSwapArray(const void *source, qsizetype count, qsizetype elementSize,
+                          void *dest)
+{
+    switch (elementSize) {
+    case 2:
+        qbswap<2>(source, count, dest);
+        break;
+    case 4:
+        qbswap<4>(source, count, dest);
+        break;
+    case 8:
+        qbswap<8>(source, count, dest);
+        break;
+    default:
+        Q_UNREACHABLE();
+    }
+}
+
+/*!
+    \internal
+
+    Reads \a count elements of \a elementSize bytes each into \a data, which
+    must be preallocated, swapping their bytes if the stream's byte order
+    differs from the host's. This is what reading each of them with
+    operator>>() does for the integer types, and for the floating point type
+    matching floatingPointPrecision().
+
+    Returns \c true on success; otherwise sets the status and returns \c false.
+*/
+bool QDataStream::readArrayData(void *data, qsizetype count, qsizetype elementSize)
+{
+    CHECK_STREAM_PRECOND(false)
+    const qint64 len = qint64(count) * elementSize;
+    if (readBlock(static_cast<char *>(data), len) != len)
+        return false;
+    if (!noswap && elementSize > 1)
+        byteSwapArray(data, count, elementSize, data);
+    return true;
+}
+
 /*! \fn template <class T1, class T2> QDataStream &operator>>(QDataStream &in, std::pair<T1, T2> &pair)
     \since 6.0
     \relates QDataStream
@@ -1420,6 +1460,41 @@ qint64 QDataStream::writeRawData(const char *s, qint64 len)
     return ret;
 }
 
+/*!
+    \internal
+
+    Writes \a count elements of \a elementSize bytes each from \a data, in the
+    stream's byte order. This is the counterpart of readArrayData().
+
+    Returns \c true on success; otherwise sets the status and returns \c false.
+*/
+bool QDataStream::writeArrayData(const void *data, qsizetype count, qsizetype elementSize)
+{
+    CHECK_STREAM_WRITE_PRECOND(false)
+    const char *src = static_cast<const char *>(data);
+    if (noswap || elementSize == 1) {
+        const qint64 len = qint64(count) * elementSize;
+        if (dev->write(src, len) != len) {
+            q_status = WriteFailed;
+            return false;
+        }
+        return true;
+    }
+
+    // swap through a buffer, the caller's data is const
+    alignas(quint64) char buffer[16 * 1024];
+    const qsizetype step = sizeof(buffer) / elementSize;
+    for (qsizetype i = 0; i < count; i += step) {
+        const qsizetype n = qMin(step, count - i);
+        byteSwapArray(src + i * elementSize, n, elementSize, buffer);
+        if (dev->write(buffer, n * elementSize) != n * elementSize) {
+            q_status = WriteFailed;
+            return false;
+        }
+    }
+    return true;
+}
+
 /*!
     \since 4.1
 
@@ -42,6 +42,17 @@ template <typename Container>
 QDataStream &writeAssociativeContainer(QDataStream &s, const Container &c);
 template <typename Container>
 QDataStream &writeAssociativeMultiContainer(QDataStream &s, const Container &c);
+
+// Types whose stream representation is their in-memory representation,
+// modulo byte order (and floating point precision, see canStreamInBulk()).
+template <typename T>
+constexpr bool IsDataStreamBulkType = std::disjunction_v<
+        std::is_same<T, char>, std::is_same<T, qint8>, std::is_same<T, quint8>,
+        std::is_same<T, qint16>, std::is_same<T, quint16>,
+        std::is_same<T, qint32>, std::is_same<T, quint32>,
+        std::is_same<T, qint64>, std::is_same<T, quint64>,
+        std::is_same<T, char16_t>, std::is_same<T, char32_t>,
+        std::is_same<T, float>, std::is_same<T, double>>;
 }
 class Q_CORE_EXPORT QDataStream : public QIODeviceBase
 {
@@ -236,6 +247,10 @@ private:
     qint64 readBlock(char *data, qint64 len);
     static inline qint64 readQSizeType(QDataStream &s);
     static inline bool writeQSizeType(QDataStream &s, qint64 value);
+    template <typename T>
+    inline bool canStreamInBulk() const;
+    bool readArrayData(void *data, qsizetype count, qsizetype elementSize);
+    bool writeArrayData(const void *data, qsizetype count, qsizetype elementSize);
     static constexpr quint32 NullCode = 0xffffffffu;
     static constexpr quint32 ExtendedSize = 0xfffffffeu;
 
@@ -296,6 +311,23 @@ QDataStream &readArrayBasedContainer(QDataStream &s, Container &c)
         return s;
     }
     c.reserve(n);
+    using T = typename Container::value_type;
+    if constexpr (IsDataStreamBulkType<T> && std::is_same_v<Container, QList<T>>) {
+        if (s.canStreamInBulk<T>()) {
+            // grow in steps so that a corrupt size doesn't make us touch
+            // more memory than the stream has data for
+            constexpr qsizetype Step = 1024 * 1024 / sizeof(T);
+            for (qsizetype i = 0; i < n; i += Step) {
+                const qsizetype count = qMin(Step, n - i);
+                c.resize(i + count);
+                if (!s.readArrayData(c.data() + i, count, sizeof(T))) {
+                    c.clear();
+                    break;
+                }
+            }
+            return s;
+        }
+    }
     for (qsizetype i = 0; i < n; ++i) {
         typename Container::value_type t;
         s >> t;
@@ -365,6 +397,13 @@ QDataStream &writeSequentialContainer(QDataStream &s, const Container &c)
 {
     if (!QDataStream::writeQSizeType(s, c.size()))
         return s;
+    using T = typename Container::value_type;
+    if constexpr (IsDataStreamBulkType<T> && std::is_same_v<Container, QList<T>>) {
+        if (s.canStreamInBulk<T>()) {
+            s.writeArrayData(c.constData(), c.size(), sizeof(T));
+            return s;
+        }
+    }
     for (const typename Container::value_type &t : c)
         s << t;
 
@@ -483,6 +522,20 @@ bool QDataStream::writeQSizeType(QDataStream &s, qint64 value)
     return true;
 }
 
+template <typename T>
+inline bool QDataStream::canStreamInBulk() const
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        // operator<<(float) and (double) convert to floatingPointPrecision()
+        constexpr FloatingPointPrecision precision =
+                sizeof(T) == sizeof(float) ? SinglePrecision : DoublePrecision;
+        return version() < Qt_4_6 || floatingPointPrecision() == precision;
+    } else {
+        // before Qt 3.3, 64-bit integers were streamed as two 32-bit halves
+        return sizeof(T) != sizeof(qint64) || version() >= Qt_3_3;
+    }
+}
+
 inline QDataStream &QDataStream::operator>>(char &i)
 { return *this >> reinterpret_cast<qint8&>(i); }
 
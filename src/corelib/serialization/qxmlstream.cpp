@@ -16,8 +16,10 @@
 #include <qcoreapplication.h>
 
 #include <private/qoffsetstringarray_p.h>
+#include <private/qsimd_p.h>
 #include <private/qtools_p.h>
 
+#include <algorithm>
 #include <iterator>
 #include "qxmlstream_p.h"
 #include "qxmlstreamparser_p.h"
@@ -999,6 +1001,85 @@ inline uint QXmlStreamReaderPrivate::peekChar()
     return c;
 }
 
+namespace {
+/*
+    Returns the length of the run of characters at the start of [begin, end)
+    that the fast scanners can copy to the text buffer without looking at them
+    individually: that excludes control characters (which includes line breaks,
+    needing line counting and normalization), the non-characters U+FFFE and
+    U+FFFF, and the \a Delimiters that end or interrupt the token.
+*/
+template <char16_t... Delimiters>
+qsizetype plainCharacterRunLength(const char16_t *begin, const char16_t *end) noexcept
+{
+    const char16_t *ptr = begin;
+#ifdef __SSE2__
+    // SSE2 has no unsigned 16-bit comparison, so flip the sign bit and
+    // compare signed instead
+    const __m128i signFlip = _mm_set1_epi16(short(0x8000));
+    const __m128i firstNonControl = _mm_set1_epi16(short(0x20 ^ 0x8000));
+    const __m128i lastCharacter = _mm_set1_epi16(short(0xfffd ^ 0x8000));
+    for ( ; end - ptr >= 8; ptr += 8) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        const __m128i flipped = _mm_xor_si128(data, signFlip);
+        __m128i special = _mm_or_si128(_mm_cmplt_epi16(flipped, firstNonControl),
+                                       _mm_cmpgt_epi16(flipped, lastCharacter));
+        ((special = _mm_or_si128(special,
+                                 _mm_cmpeq_epi16(data, _mm_set1_epi16(short(Delimiters))))), ...);
+        if (const uint mask = uint(_mm_movemask_epi8(special)))
+            return ptr - begin + qCountTrailingZeroBits(mask) / 2;
+    }
+#endif
+    for ( ; ptr != end; ++ptr) {
+        const char16_t c = *ptr;
+        if (c < 0x20 || c >= 0xfffe || ((c == Delimiters) || ...))
+            break;
+    }
+    return ptr - begin;
+}
+
+// Returns the length of the run of spaces and tabs at the start of [begin, end).
+qsizetype blankRunLength(const char16_t *begin, const char16_t *end) noexcept
+{
+    const char16_t *ptr = begin;
+#ifdef __SSE2__
+    const __m128i space = _mm_set1_epi16(' ');
+    const __m128i tab = _mm_set1_epi16('\t');
+    for ( ; end - ptr >= 8; ptr += 8) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        const __m128i blank = _mm_or_si128(_mm_cmpeq_epi16(data, space),
+                                           _mm_cmpeq_epi16(data, tab));
+        if (const uint mask = ~uint(_mm_movemask_epi8(blank)) & 0xffffu)
+            return ptr - begin + qCountTrailingZeroBits(mask) / 2;
+    }
+#endif
+    while (ptr != end && (*ptr == u' ' || *ptr == u'\t'))
+        ++ptr;
+    return ptr - begin;
+}
+} // unnamed namespace
+
+/*!
+  \internal
+
+  Copies the run of characters at the current position of the read buffer
+  that need no individual treatment (see plainCharacterRunLength()) into the
+  text buffer and returns its length. Does nothing if characters have been
+  pushed back, as those need to be consumed first.
+ */
+template <char16_t... Delimiters>
+inline qsizetype QXmlStreamReaderPrivate::fastScanPlainCharacters()
+{
+    if (!putStack.isEmpty() || readBufferPos >= readBuffer.size())
+        return 0;
+    const QStringView buffer = readBuffer;
+    const char16_t *begin = buffer.utf16() + readBufferPos;
+    const qsizetype n = plainCharacterRunLength<Delimiters...>(begin, buffer.utf16() + buffer.size());
+    textBuffer.append(QStringView(begin, n));
+    readBufferPos += n;
+    return n;
+}
+
 /*!
   \internal
 
@@ -1192,7 +1273,11 @@ inline qsizetype QXmlStreamReaderPrivate::fastScanLiteralContent()
 {
     qsizetype n = 0;
     uint c;
-    while ((c = getChar()) != StreamEOF) {
+    for (;;) {
+        // tabs are normalized to spaces, so they take the slow path
+        n += fastScanPlainCharacters<u'&', u'<', u'"', u'\'', u'\t'>();
+        if ((c = getChar()) == StreamEOF)
+            break;
         switch (ushort(c)) {
         case 0xfffe:
         case 0xffff:
@@ -1242,7 +1327,17 @@ inline qsizetype QXmlStreamReaderPrivate::fastScanSpace()
 {
     qsizetype n = 0;
     uint c;
-    while ((c = getChar()) != StreamEOF) {
+    for (;;) {
+        if (putStack.isEmpty() && readBufferPos < readBuffer.size()) {
+            const QStringView buffer = readBuffer;
+            const char16_t *begin = buffer.utf16() + readBufferPos;
+            const qsizetype blanks = blankRunLength(begin, buffer.utf16() + buffer.size());
+            textBuffer.append(QStringView(begin, blanks));
+            readBufferPos += blanks;
+            n += blanks;
+        }
+        if ((c = getChar()) == StreamEOF)
+            break;
         switch (c) {
         case '\r':
             if ((c = filterCarriageReturn()) == 0)
@@ -1275,7 +1370,19 @@ inline qsizetype QXmlStreamReaderPrivate::fastScanContentCharList()
 {
     qsizetype n = 0;
     uint c;
-    while ((c = getChar()) != StreamEOF) {
+    for (;;) {
+        const qsizetype runStart = textBuffer.size();
+        if (const qsizetype run = fastScanPlainCharacters<u'&', u'<', u']'>()) {
+            n += run;
+            if (isWhitespace) {
+                const QStringView text = QStringView(textBuffer).sliced(runStart);
+                isWhitespace = std::all_of(text.begin(), text.end(), [](QChar ch) {
+                    return ch == u' ' || ch == u'\t';
+                });
+            }
+        }
+        if ((c = getChar()) == StreamEOF)
+            break;
         switch (ushort(c)) {
         case 0xfffe:
         case 0xffff:
@@ -234,6 +234,7 @@ class QXmlStreamReaderPrivate : public QXmlStreamGrammar, public QXmlStreamPriva
 public:
     QXmlStreamReaderPrivate(QXmlStreamReader *q);
     ~QXmlStreamReaderPrivate();
+    static const QXmlStreamReaderPrivate *get(const QXmlStreamReader *q) { return q->d_func(); }
     void init();
 
     QByteArray rawReadBuffer;
@@ -507,6 +508,7 @@ public:
 
     // scan optimization functions. Not strictly necessary but LALR is
     // not very well suited for scanning fast
+    template <char16_t... Delimiters> inline qsizetype fastScanPlainCharacters();
     qsizetype fastScanLiteralContent();
     qsizetype fastScanSpace();
     qsizetype fastScanContentCharList();
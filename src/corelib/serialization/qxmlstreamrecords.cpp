@@ -0,0 +1,176 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qxmlstreamrecords_p.h"
+#include "qxmlstream_p.h"
+
+#include <qstringconverter.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*!
+    \internal
+    \class QXmlStreamRecordScanner
+    \inmodule QtCore
+
+    QXmlStreamRecordScanner locates the children of the document element
+    ("records") of an XML document without decoding or tokenizing it, so that
+    they can be handed to independent QXmlStreamReader instances, for
+    instance by qParseXmlRecordsConcurrently().
+
+    The scan works on bytes and only needs to recognize markup delimiters:
+    comments, CDATA sections, processing instructions, start and end tags
+    (skipping quoted attribute values). It does not check well-formedness
+    beyond that; the readers parsing the records do. Documents whose records
+    cannot be understood in isolation, i.e. ones with a DTD (which may declare
+    entities) or in an encoding other than UTF-8, are refused.
+*/
+
+bool QXmlStreamRecordScanner::fail(const QString &errorString)
+{
+    m_records.clear();
+    m_namespaceDeclarations.clear();
+    m_errorString = errorString;
+    return false;
+}
+
+/*!
+    Scans \a document and returns \c true if its records could be located;
+    otherwise returns \c false and sets errorString().
+*/
+bool QXmlStreamRecordScanner::scan(QByteArrayView document)
+{
+    m_records.clear();
+    m_namespaceDeclarations.clear();
+    m_errorString.clear();
+
+    // Detect the encoding the way QXmlStreamReader does, from a byte order
+    // mark or from how the '<' of the first markup is encoded. Only UTF-8
+    // can be scanned bytewise; a UTF-8 byte order mark is skipped below.
+    const std::optional<QStringConverter::Encoding> detected =
+            QStringDecoder::encodingForData(document, char16_t('<'));
+    if (detected && *detected != QStringConverter::Utf8)
+        return fail(u"unsupported encoding %1"_s.arg(
+                QLatin1StringView(QStringConverter::nameForEncoding(*detected))));
+
+    // Let a real reader handle the prolog: it tells us about the encoding,
+    // the DTD and the namespaces declared on the document element, which
+    // the records inherit.
+    {
+        QXmlStreamReader head(QByteArray::fromRawData(document.data(), document.size()));
+        while (!head.atEnd()) {
+            const QXmlStreamReader::TokenType token = head.readNext();
+            if (token == QXmlStreamReader::StartDocument) {
+                const QStringView encoding = head.documentEncoding();
+                if (!encoding.isEmpty() && encoding.compare("UTF-8"_L1, Qt::CaseInsensitive) != 0
+                        && encoding.compare("US-ASCII"_L1, Qt::CaseInsensitive) != 0) {
+                    return fail(u"unsupported encoding %1"_s.arg(encoding));
+                }
+            } else if (token == QXmlStreamReader::DTD) {
+                return fail(u"documents with a DTD are not supported"_s);
+            } else if (token == QXmlStreamReader::StartElement) {
+                m_namespaceDeclarations = head.namespaceDeclarations();
+                break;
+            }
+        }
+        if (head.hasError())
+            return fail(head.errorString());
+        if (head.tokenType() != QXmlStreamReader::StartElement)
+            return fail(u"no document element"_s);
+    }
+
+    const char *data = document.data();
+    const qsizetype size = document.size();
+    auto find = [&](QByteArrayView needle, qsizetype from) {
+        return document.indexOf(needle, from);
+    };
+
+    int depth = 0;
+    qsizetype recordStart = -1;
+    qsizetype pos = document.startsWith("\xef\xbb\xbf") ? 3 : 0;
+    while ((pos = find("<", pos)) >= 0) {
+        const qsizetype tagStart = pos;
+        const QByteArrayView rest = document.sliced(pos);
+        qsizetype end;
+        if (rest.startsWith("<?")) {
+            end = find("?>", pos + 2);
+            pos = end < 0 ? end : end + 2;
+        } else if (rest.startsWith("<!--")) {
+            end = find("-->", pos + 4);
+            pos = end < 0 ? end : end + 3;
+        } else if (rest.startsWith("<![CDATA[")) {
+            end = find("]]>", pos + 9);
+            pos = end < 0 ? end : end + 3;
+        } else if (rest.startsWith("<!")) {
+            // the reader above would have reported the DTD
+            return fail(u"unexpected markup declaration"_s);
+        } else if (rest.startsWith("</")) {
+            end = find(">", pos + 2);
+            if (end < 0)
+                break;
+            pos = end + 1;
+            if (--depth == 1 && recordStart >= 0) {
+                m_records.append({ recordStart, pos - recordStart });
+                recordStart = -1;
+            } else if (depth <= 0) {
+                return depth == 0 || fail(u"unbalanced end tag"_s);
+            }
+            continue;
+        } else {
+            // start tag: find its end, skipping over quoted attribute values
+            qsizetype i = pos + 1;
+            char quote = 0;
+            for ( ; i < size; ++i) {
+                const char c = data[i];
+                if (quote) {
+                    if (c == quote)
+                        quote = 0;
+                } else if (c == '"' || c == '\'') {
+                    quote = c;
+                } else if (c == '>') {
+                    break;
+                }
+            }
+            if (i == size)
+                break;
+            pos = i + 1;
+            const bool isEmptyElement = data[i - 1] == '/';
+            if (depth == 1 && recordStart < 0)
+                recordStart = tagStart;
+            if (!isEmptyElement) {
+                ++depth;
+            } else if (depth == 1) {
+                m_records.append({ recordStart, pos - recordStart });
+                recordStart = -1;
+            } else if (depth == 0) {
+                return true;    // <root/>
+            }
+            continue;
+        }
+        if (pos < 0)
+            break;
+    }
+    return fail(u"premature end of document"_s);
+}
+
+/*!
+    Returns the number of elements \a reader is currently inside of. Once it
+    has read an EndElement, the element no longer counts.
+*/
+qsizetype QXmlStreamRecordScanner::elementDepth(const QXmlStreamReader &reader)
+{
+    return QXmlStreamReaderPrivate::get(&reader)->tagStack.size();
+}
+
+void QtPrivate::setUpXmlRecordReader(QXmlStreamReader &reader, QByteArrayView document,
+                                     const QXmlStreamRecordScanner::Record &record,
+                                     const QXmlStreamNamespaceDeclarations &declarations)
+{
+    reader.addData(QByteArray::fromRawData(document.data() + record.offset, record.size));
+    reader.addExtraNamespaceDeclarations(declarations);
+    reader.readNextStartElement();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,167 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QXMLSTREAMRECORDS_P_H
+#define QXMLSTREAMRECORDS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qfutureinterface.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qxmlstream.h>
+
+#include <memory>
+#include <type_traits>
+
+QT_REQUIRE_CONFIG(xmlstreamreader);
+QT_REQUIRE_CONFIG(future);
+
+QT_BEGIN_NAMESPACE
+
+class Q_CORE_EXPORT QXmlStreamRecordScanner
+{
+public:
+    struct Record
+    {
+        qsizetype offset;
+        qsizetype size;
+    };
+
+    bool scan(QByteArrayView document);
+
+    const QList<Record> &records() const { return m_records; }
+    const QXmlStreamNamespaceDeclarations &namespaceDeclarations() const
+    { return m_namespaceDeclarations; }
+    QString errorString() const { return m_errorString; }
+
+    static qsizetype elementDepth(const QXmlStreamReader &reader);
+
+private:
+    bool fail(const QString &errorString);
+
+    QList<Record> m_records;
+    QXmlStreamNamespaceDeclarations m_namespaceDeclarations;
+    QString m_errorString;
+};
+
+namespace QtPrivate {
+template <typename Function>
+using XmlRecordResult = std::decay_t<std::invoke_result_t<Function &, QXmlStreamReader &>>;
+
+// Positions a reader for the record [offset, offset + size) of document at the
+// record's start element.
+Q_CORE_EXPORT void setUpXmlRecordReader(QXmlStreamReader &reader, QByteArrayView document,
+                                        const QXmlStreamRecordScanner::Record &record,
+                                        const QXmlStreamNamespaceDeclarations &declarations);
+}
+
+/*
+    Parses each child element of the document element of \a document with
+    \a parser on \a pool (or the global thread pool) and returns a QFuture
+    with one result per child, in document order.
+
+    \a parser is called as \c{parser(reader)} with a QXmlStreamReader
+    positioned at the record's StartElement and returns the result for it. It
+    may read as much of the record as it wants and must check the reader for
+    errors itself. \a parser is called concurrently from several threads.
+
+    Records are located with a byte-level pre-scan that only understands
+    UTF-8 (or ASCII) documents without a DTD; other documents are parsed
+    sequentially, in a single task, with the same semantics. \a document must
+    stay valid until the returned future has finished.
+*/
+template <typename Function, typename T = QtPrivate::XmlRecordResult<Function>>
+QFuture<T> qParseXmlRecordsConcurrently(QByteArrayView document, Function parser,
+                                        QThreadPool *pool = nullptr)
+{
+    if (!pool)
+        pool = QThreadPool::globalInstance();
+
+    struct State
+    {
+        QFutureInterface<T> future;
+        QByteArrayView document;
+        Function parser;
+        QXmlStreamRecordScanner scanner;
+        QAtomicInt pendingBatches;
+    };
+    auto state = std::make_shared<State>(State{ QFutureInterface<T>(), document,
+                                                std::move(parser), {}, {} });
+    QFutureInterface<T> &future = state->future;
+    future.setThreadPool(pool);
+    future.setFilterMode(true);     // deliver results in record order
+    future.reportStarted();
+    QFuture<T> result = future.future();
+
+    if (!state->scanner.scan(document)) {
+        // fall back to a single, sequential reader over the whole document
+        pool->start([state] {
+            QXmlStreamReader reader(QByteArray::fromRawData(state->document.data(),
+                                                             state->document.size()));
+            int index = 0;
+            if (reader.readNextStartElement()) {
+                while (reader.readNextStartElement() && !state->future.isCanceled()) {
+                    const qsizetype depth = QXmlStreamRecordScanner::elementDepth(reader);
+                    state->future.reportResult(state->parser(reader), index++);
+                    // skip whatever the parser left of the record
+                    while (QXmlStreamRecordScanner::elementDepth(reader) >= depth
+                           && !reader.atEnd()) {
+                        reader.readNext();
+                    }
+                }
+            }
+            state->future.reportFinished();
+        });
+        return result;
+    }
+
+    // group small records so each task amortizes its scheduling cost
+    constexpr qsizetype BatchBytes = 64 * 1024;
+    const QList<QXmlStreamRecordScanner::Record> &records = state->scanner.records();
+    QList<std::pair<qsizetype, qsizetype>> batches;     // [first, last) record
+    for (qsizetype first = 0; first < records.size(); ) {
+        qsizetype last = first;
+        qsizetype bytes = 0;
+        while (last < records.size() && (bytes < BatchBytes || last == first))
+            bytes += records.at(last++).size;
+        batches.emplace_back(first, last);
+        first = last;
+    }
+    if (batches.isEmpty()) {
+        future.reportFinished();
+        return result;
+    }
+
+    state->pendingBatches.storeRelaxed(int(batches.size()));
+    for (const auto &[first, last] : std::as_const(batches)) {
+        pool->start([state, first = first, last = last] {
+            const QList<QXmlStreamRecordScanner::Record> &records = state->scanner.records();
+            for (qsizetype i = first; i < last && !state->future.isCanceled(); ++i) {
+                QXmlStreamReader reader;
+                QtPrivate::setUpXmlRecordReader(reader, state->document, records.at(i),
+                                                state->scanner.namespaceDeclarations());
+                state->future.reportResult(state->parser(reader), int(i));
+            }
+            if (state->pendingBatches.fetchAndSubOrdered(1) == 1)
+                state->future.reportFinished();
+        });
+    }
+    return result;
+}
+
+QT_END_NAMESPACE
+
+#endif // QXMLSTREAMRECORDS_P_H
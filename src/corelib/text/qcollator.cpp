@@ -9,6 +9,15 @@
 #include "qdebug.h"
 #include "qlocale_p.h"
 #include "qthreadstorage.h"
+#include "qvarlengtharray.h"
+#if QT_CONFIG(thread)
+#include "qsemaphore.h"
+#include "qthreadpool.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
 QT_BEGIN_NAMESPACE
 QT_DEFINE_QESDP_SPECIALIZATION_DTOR(QCollatorSortKeyPrivate)
@@ -487,4 +496,224 @@ QCollatorSortKey& QCollatorSortKey::operator=(const QCollatorSortKey &other)
     \sa operator<()
 */
 
+/*!
+    \internal
+    \class QCollatorSortKeyArena
+    \inmodule QtCore
+
+    QCollatorSortKeyArena holds the sort keys of a whole list of strings, as
+    QCollator::sortKey() would compute them, in a single contiguous buffer of
+    bytes that order the way the keys do. This saves the allocation of one
+    QCollatorSortKey per string and lets the keys be sorted by their bytes,
+    with a multikey quicksort, instead of by calls to the collator.
+
+    Back-ends whose sort keys cannot be ordered by their bytes (Darwin's) do
+    not support it; build() then returns \c false.
+*/
+
+/*!
+    Computes the sort keys of \a strings according to \a collator, spreading
+    large lists over the threads of \a pool (or the global thread pool).
+    Returns \c false if the back-end does not support byte-ordered keys, in
+    which case the arena is left empty.
+*/
+bool QCollatorSortKeyArena::build(const QCollator &collator, QSpan<const QString> strings,
+                                  QThreadPool *pool)
+{
+    m_keys.clear();
+    m_offsets.clear();
+
+    // A collator of its own, set up like the given one, so that initializing
+    // it does not touch data shared with other copies of the collator.
+    // appendBinarySortKey() is const, and so thread-safe.
+    QCollatorPrivate collatorPrivate(collator.locale());
+    collatorPrivate.caseSensitivity = collator.caseSensitivity();
+    collatorPrivate.numericMode = collator.numericMode();
+    collatorPrivate.ignorePunctuation = collator.ignorePunctuation();
+    collatorPrivate.ensureInitialized();
+    const QCollatorPrivate *d = &collatorPrivate;
+
+    struct Block
+    {
+        QByteArray keys;
+        QList<qsizetype> ends;
+        bool ok = true;
+    };
+    const auto computeBlock = [d, strings](Block &block, qsizetype from, qsizetype to) {
+        block.ends.reserve(to - from);
+        for (qsizetype i = from; i < to; ++i) {
+            if (!d->appendBinarySortKey(block.keys, strings[i])) {
+                block.ok = false;
+                return;
+            }
+            block.ends.append(block.keys.size());
+        }
+    };
+
+    constexpr qsizetype BlockSize = 4096;
+    const qsizetype count = strings.size();
+    QVarLengthArray<Block, 16> blocks((count + BlockSize - 1) / BlockSize);
+#if QT_CONFIG(thread)
+    if (blocks.size() > 1) {
+        if (!pool)
+            pool = QThreadPool::globalInstance();
+        // The calling thread takes the first block, and any block the pool
+        // can't start right away; so this can't deadlock if called from a
+        // thread of a busy pool.
+        QSemaphore done;
+        int started = 0;
+        for (qsizetype b = 1; b < blocks.size(); ++b) {
+            const qsizetype from = b * BlockSize;
+            const qsizetype to = qMin(from + BlockSize, count);
+            Block *block = &blocks[b];
+            if (pool->tryStart([&computeBlock, &done, block, from, to] {
+                    computeBlock(*block, from, to);
+                    done.release();
+                })) {
+                ++started;
+            } else {
+                computeBlock(*block, from, to);
+            }
+        }
+        computeBlock(blocks[0], 0, qMin(BlockSize, count));
+        done.acquire(started);
+    } else
+#else
+    Q_UNUSED(pool);
+#endif
+    {
+        for (qsizetype b = 0; b < blocks.size(); ++b)
+            computeBlock(blocks[b], b * BlockSize, qMin((b + 1) * BlockSize, count));
+    }
+
+    qsizetype total = 0;
+    for (const Block &block : std::as_const(blocks)) {
+        if (!block.ok)
+            return false;
+        total += block.keys.size();
+    }
+
+    m_keys.reserve(total);
+    m_offsets.reserve(count + 1);
+    m_offsets.append(0);
+    for (const Block &block : std::as_const(blocks)) {
+        const qsizetype base = m_keys.size();
+        m_keys += block.keys;
+        for (qsizetype end : block.ends)
+            m_offsets.append(base + end);
+    }
+    return true;
+}
+
+/*!
+    Returns the indexes of the keys in the order they sort in. The order is
+    stable: keys that compare equal keep their relative order.
+*/
+QList<qsizetype> QCollatorSortKeyArena::sortedIndexes() const
+{
+    QList<qsizetype> indexes(size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    const char *keys = m_keys.constData();
+    const qsizetype *offsets = m_offsets.constData();
+    const auto length = [offsets](qsizetype i) { return offsets[i + 1] - offsets[i]; };
+    // the byte at depth, shifted so that the end of the key sorts first
+    const auto byteAt = [keys, offsets, length](qsizetype i, qsizetype depth) -> int {
+        return depth < length(i) ? uchar(keys[offsets[i] + depth]) + 1 : 0;
+    };
+    // full comparison of keys known to be equal up to depth; ties are
+    // broken by index, which keeps the sort stable
+    const auto lessFrom = [keys, offsets, length](qsizetype depth) {
+        return [=](qsizetype a, qsizetype b) {
+            const qsizetype la = length(a) - depth;
+            const qsizetype lb = length(b) - depth;
+            const int r = std::memcmp(keys + offsets[a] + depth, keys + offsets[b] + depth,
+                                      size_t(qMin(la, lb)));
+            if (r != 0)
+                return r < 0;
+            if (la != lb)
+                return la < lb;
+            return a < b;
+        };
+    };
+
+    // Multikey quicksort (Bentley & Sedgewick): partition three ways on the
+    // byte at the current depth and only move on to the next byte for the
+    // keys that share it. An explicit stack keeps long common prefixes from
+    // recursing deeply.
+    struct Range
+    {
+        qsizetype begin;
+        qsizetype end;
+        qsizetype depth;
+    };
+    QVarLengthArray<Range, 64> stack;
+    stack.append({ 0, indexes.size(), 0 });
+    qsizetype *idx = indexes.data();
+    while (!stack.isEmpty()) {
+        const Range range = stack.last();
+        stack.removeLast();
+        const qsizetype n = range.end - range.begin;
+        if (n < 2)
+            continue;
+        if (n < 16) {
+            std::sort(idx + range.begin, idx + range.end, lessFrom(range.depth));
+            continue;
+        }
+
+        const qsizetype depth = range.depth;
+        int a = byteAt(idx[range.begin], depth);
+        int b = byteAt(idx[range.begin + n / 2], depth);
+        int c = byteAt(idx[range.end - 1], depth);
+        if (a > b)
+            std::swap(a, b);
+        const int pivot = c < a ? a : (c > b ? b : c);
+
+        qsizetype lt = range.begin;
+        qsizetype gt = range.end;
+        for (qsizetype i = range.begin; i < gt; ) {
+            const int v = byteAt(idx[i], depth);
+            if (v < pivot)
+                std::swap(idx[lt++], idx[i++]);
+            else if (v > pivot)
+                std::swap(idx[i], idx[--gt]);
+            else
+                ++i;
+        }
+
+        stack.append({ range.begin, lt, depth });
+        stack.append({ gt, range.end, depth });
+        if (pivot != 0) {
+            stack.append({ lt, gt, depth + 1 });
+        } else {
+            // these keys ended, so they are equal: restore their input order,
+            // which the partitioning may have shuffled
+            std::sort(idx + lt, idx + gt);
+        }
+    }
+    return indexes;
+}
+
+/*!
+    Sorts \a strings according to \a collator, computing the sort keys on
+    \a pool (or the global thread pool) and sorting them by their bytes. The
+    sort is stable. Falls back to comparing with \a collator if its back-end
+    does not support byte-ordered keys.
+*/
+void QCollatorSortKeyArena::sort(QList<QString> &strings, const QCollator &collator,
+                                 QThreadPool *pool)
+{
+    QCollatorSortKeyArena arena;
+    if (!arena.build(collator, strings, pool)) {
+        std::stable_sort(strings.begin(), strings.end(), collator);
+        return;
+    }
+    const QList<qsizetype> order = arena.sortedIndexes();
+    QList<QString> sorted;
+    sorted.reserve(strings.size());
+    for (qsizetype i : order)
+        sorted.append(std::move(strings[i]));
+    strings = std::move(sorted);
+}
+
 QT_END_NAMESPACE
@@ -114,6 +114,36 @@ QCollatorSortKey QCollator::sortKey(const QString &string) const
     return QCollatorSortKey(new QCollatorSortKeyPrivate(QByteArray()));
 }
 
+bool QCollatorPrivate::appendBinarySortKey(QByteArray &keys, QStringView string) const
+{
+    // Same keys as QCollator::sortKey() creates, without the terminating '\0'
+    // that qstrcmp() relies on.
+    if (isC()) {
+        const qsizetype from = keys.size();
+        keys += string.toUtf8();
+        keys.truncate(from + qstrnlen(keys.constData() + from, keys.size() - from));
+        return true;
+    }
+    if (!collator)
+        return true;
+
+    const qsizetype from = keys.size();
+    qsizetype capacity = 16 + string.size() + (string.size() >> 2);
+    for (;;) {
+        keys.resize(from + capacity);
+        // truncating sizes (QTBUG-105038)
+        const int size = ucol_getSortKey(collator, reinterpret_cast<const UChar *>(string.data()),
+                                         string.size(),
+                                         reinterpret_cast<uint8_t *>(keys.data() + from),
+                                         capacity);
+        if (size <= capacity) {
+            keys.truncate(from + qMax(size - 1, 0));
+            return true;
+        }
+        capacity = size;
+    }
+}
+
 int QCollatorSortKey::compare(const QCollatorSortKey &otherKey) const
 {
     return qstrcmp(d->m_key, otherKey.d->m_key);
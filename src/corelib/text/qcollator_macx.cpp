@@ -108,6 +108,12 @@ QCollatorSortKey QCollator::sortKey(const QString &string) const
     return QCollatorSortKey(new QCollatorSortKeyPrivate(std::move(ret)));
 }
 
+bool QCollatorPrivate::appendBinarySortKey(QByteArray &, QStringView) const
+{
+    // UCCollationValue keys can only be ordered by UCCompareCollationKeys()
+    return false;
+}
+
 int QCollatorSortKey::compare(const QCollatorSortKey &key) const
 {
     if (!d.data())
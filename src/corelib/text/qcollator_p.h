@@ -19,6 +19,7 @@
 #include <QtCore/private/qglobal_p.h>
 #include "qcollator.h"
 #include <QList>
+#include <QtCore/qspan.h>
 #if QT_CONFIG(icu)
 #include <unicode/ucol.h>
 #elif defined(Q_OS_MACOS)
@@ -67,7 +68,7 @@ public:
 
     QCollatorPrivate(const QLocale &locale) : locale(locale) {}
     ~QCollatorPrivate() { cleanup(); }
-    bool isC() { return locale.language() == QLocale::C; }
+    bool isC() const { return locale.language() == QLocale::C; }
 
     void clear() {
         cleanup();
@@ -83,6 +84,7 @@ public:
     // Implemented by each back-end, in its own way:
     void init();
     void cleanup();
+    bool appendBinarySortKey(QByteArray &keys, QStringView string) const;
 
 private:
     Q_DISABLE_COPY_MOVE(QCollatorPrivate)
@@ -105,6 +107,27 @@ private:
     Q_DISABLE_COPY_MOVE(QCollatorSortKeyPrivate)
 };
 
+class QThreadPool;
+
+class Q_CORE_EXPORT QCollatorSortKeyArena
+{
+public:
+    bool build(const QCollator &collator, QSpan<const QString> strings,
+               QThreadPool *pool = nullptr);
+
+    qsizetype size() const { return m_offsets.isEmpty() ? 0 : m_offsets.size() - 1; }
+    QByteArrayView key(qsizetype i) const
+    { return QByteArrayView(m_keys).sliced(m_offsets.at(i), m_offsets.at(i + 1) - m_offsets.at(i)); }
+
+    QList<qsizetype> sortedIndexes() const;
+
+    static void sort(QList<QString> &strings, const QCollator &collator,
+                     QThreadPool *pool = nullptr);
+
+private:
+    QByteArray m_keys;
+    QList<qsizetype> m_offsets;
+};
 
 QT_END_NAMESPACE
 
@@ -6,9 +6,11 @@
 #include "qstringlist.h"
 #include "qstring.h"
 #include "qvarlengtharray.h"
+#include "qendian.h"
 
 #include <cstring>
 #include <cwchar>
+#include <type_traits>
 
 QT_BEGIN_NAMESPACE
 
@@ -86,6 +88,39 @@ QCollatorSortKey QCollator::sortKey(const QString &string) const
     return QCollatorSortKey(new QCollatorSortKeyPrivate(std::move(result)));
 }
 
+bool QCollatorPrivate::appendBinarySortKey(QByteArray &keys, QStringView string) const
+{
+    // Same keys as QCollator::sortKey() creates, with each wchar_t stored big
+    // endian and offset so that the bytes order the way std::wcscmp() orders them.
+    QVarLengthArray<wchar_t> original;
+    stringToWCharArray(original, string);
+    QVarLengthArray<wchar_t> transformed;
+    const wchar_t *key = original.constData();
+    if (!isC()) {
+        transformed.resize(original.size());
+        size_t needed = std::wcsxfrm(transformed.data(), original.constData(), transformed.size());
+        if (needed >= size_t(transformed.size())) {
+            transformed.resize(needed + 1);
+            needed = std::wcsxfrm(transformed.data(), original.constData(), transformed.size());
+        }
+        transformed[needed] = 0;
+        key = transformed.constData();
+    }
+
+    const qsizetype length = qsizetype(std::wcslen(key));
+    const qsizetype from = keys.size();
+    keys.resize(from + length * 4);
+    uchar *out = reinterpret_cast<uchar *>(keys.data() + from);
+    for (qsizetype i = 0; i < length; ++i) {
+        using Unsigned = std::make_unsigned_t<wchar_t>;
+        quint32 value = Unsigned(key[i]);
+        if constexpr (std::is_signed_v<wchar_t>)
+            value ^= 1u << (sizeof(wchar_t) * 8 - 1);
+        qToBigEndian(value, out + 4 * i);
+    }
+    return true;
+}
+
 int QCollatorSortKey::compare(const QCollatorSortKey &otherKey) const
 {
     return std::wcscmp(d->m_key.constData(), otherKey.d->m_key.constData());
@@ -7,6 +7,7 @@
 #include "qstring.h"
 
 #include <QDebug>
+#include <qendian.h>
 
 #include <qt_windows.h>
 #include <qsysinfo.h>
@@ -113,6 +114,31 @@ QCollatorSortKey QCollator::sortKey(const QString &string) const
     return QCollatorSortKey(new QCollatorSortKeyPrivate(std::move(ret)));
 }
 
+bool QCollatorPrivate::appendBinarySortKey(QByteArray &keys, QStringView string) const
+{
+    const qsizetype from = keys.size();
+    if (isC()) {
+        // ordered like QString::compare(), by UTF-16 code unit
+        keys.resize(from + string.size() * 2);
+        qToBigEndian<char16_t>(string.utf16(), string.size(), keys.data() + from);
+        return true;
+    }
+
+    // LCMAP_SORTKEY produces a byte string meant to be compared with memcmp,
+    // sized in bytes and terminated by a '\0' (not part of the key here).
+    // truncating sizes (QTBUG-105038)
+    const int size = LCMapStringW(localeID, LCMAP_SORTKEY | collator,
+                                  reinterpret_cast<const wchar_t *>(string.data()),
+                                  string.size(), 0, 0);
+    keys.resize(from + size);
+    const int finalSize = LCMapStringW(localeID, LCMAP_SORTKEY | collator,
+                                       reinterpret_cast<const wchar_t *>(string.data()),
+                                       string.size(),
+                                       reinterpret_cast<wchar_t *>(keys.data() + from), size);
+    keys.truncate(from + qMax(finalSize - 1, 0));
+    return finalSize != 0;
+}
+
 int QCollatorSortKey::compare(const QCollatorSortKey &otherKey) const
 {
     return d->m_key.compare(otherKey.d->m_key);
@@ -878,6 +878,15 @@ static bool isAscii_helper(const char16_t *&ptr, const char16_t *end)
     return true;
 }
 
+// Returns the number of ASCII characters [ptr, end) starts with. Used by the
+// Unicode segmentation in qunicodetools.cpp.
+qsizetype qt_ascii_prefix_length(const char16_t *ptr, const char16_t *end) noexcept
+{
+    const char16_t *const begin = ptr;
+    isAscii_helper(ptr, end);
+    return ptr - begin;
+}
+
 bool QtPrivate::isAscii(QStringView s) noexcept
 {
     const char16_t *ptr = s.utf16();
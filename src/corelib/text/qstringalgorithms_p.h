@@ -119,6 +119,9 @@ template <typename StringType> struct QStringAlgorithms
     }
 };
 
+// implemented in qstring.cpp
+qsizetype qt_ascii_prefix_length(const char16_t *ptr, const char16_t *end) noexcept;
+
 QT_END_NAMESPACE
 
 #endif // QSTRINGALGORITHMS_P_H
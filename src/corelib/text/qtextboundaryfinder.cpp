@@ -1,26 +1,102 @@
 // Copyright (C) 2022 The Qt Company Ltd.
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 #include <QtCore/qtextboundaryfinder.h>
+#include <QtCore/qmutex.h>
 #include <QtCore/qvarlengtharray.h>
 
 #include <private/qunicodetools_p.h>
 
+#include <atomic>
+#include <new>
+
 QT_BEGIN_NAMESPACE
 
+static QUnicodeTools::CharAttributeOptions attributeOptions(QTextBoundaryFinder::BoundaryType type)
+{
+    switch (type) {
+    case QTextBoundaryFinder::Grapheme: return QUnicodeTools::GraphemeBreaks;
+    case QTextBoundaryFinder::Word: return QUnicodeTools::WordBreaks;
+    case QTextBoundaryFinder::Sentence: return QUnicodeTools::SentenceBreaks;
+    case QTextBoundaryFinder::Line: return QUnicodeTools::LineBreaks;
+    }
+    return {};
+}
+
 static void init(QTextBoundaryFinder::BoundaryType type, QStringView str, QCharAttributes *attributes)
 {
     QUnicodeTools::ScriptItemArray scriptItems;
     QUnicodeTools::initScripts(str, &scriptItems);
+    QUnicodeTools::initCharAttributes(str, scriptItems.data(), scriptItems.size(), attributes,
+                                      attributeOptions(type));
+}
 
-    QUnicodeTools::CharAttributeOptions options;
-    switch (type) {
-    case QTextBoundaryFinder::Grapheme: options |= QUnicodeTools::GraphemeBreaks; break;
-    case QTextBoundaryFinder::Word: options |= QUnicodeTools::WordBreaks; break;
-    case QTextBoundaryFinder::Sentence: options |= QUnicodeTools::SentenceBreaks; break;
-    case QTextBoundaryFinder::Line: options |= QUnicodeTools::LineBreaks; break;
-    default: break;
+// The attributes buffers QTextBoundaryFinder allocates itself are filled
+// lazily, a segment of the string at a time, as the finder moves. They are
+// preceded by the number of attributes that have been computed. Buffers
+// passed by the user are filled in completely by the constructor.
+//
+// The const functions fill the buffer too, so that is done under a mutex,
+// and the attributes below the published count are never written again.
+namespace {
+struct LazyAttributes
+{
+    std::atomic<qsizetype> computed;
+    QBasicMutex mutex;
+
+    static QCharAttributes *allocate(qsizetype length, qsizetype computed = 0)
+    {
+        void *d = malloc(sizeof(LazyAttributes) + (length + 1) * sizeof(QCharAttributes));
+        Q_CHECK_PTR(d);
+        LazyAttributes *header = new (d) LazyAttributes;
+        header->computed.store(computed, std::memory_order_relaxed);
+        return reinterpret_cast<QCharAttributes *>(header + 1);
+    }
+
+    // LazyAttributes is trivially destructible
+    static void free(QCharAttributes *attributes)
+    {
+        ::free(of(attributes));
+    }
+
+    static QCharAttributes *copy(const QCharAttributes *attributes, bool lazy, qsizetype length)
+    {
+        const qsizetype computed = lazy
+                ? of(attributes)->computed.load(std::memory_order_acquire) : length + 1;
+        QCharAttributes *result = allocate(length, computed);
+        memcpy(result, attributes, computed * sizeof(QCharAttributes));
+        return result;
     }
-    QUnicodeTools::initCharAttributes(str, scriptItems.data(), scriptItems.size(), attributes, options);
+
+    static LazyAttributes *of(const QCharAttributes *attributes)
+    {
+        return const_cast<LazyAttributes *>(reinterpret_cast<const LazyAttributes *>(attributes)) - 1;
+    }
+};
+static_assert(std::is_trivially_destructible_v<LazyAttributes>);
+} // unnamed namespace
+
+// don't bother computing less than this many characters at a time
+static constexpr qsizetype MinimumSegmentLength = 4096;
+
+static QCharAttributes attributeAt(QTextBoundaryFinder::BoundaryType type, QStringView str,
+                                   QCharAttributes *attributes, bool lazy, qsizetype pos)
+{
+    if (lazy) {
+        LazyAttributes *d = LazyAttributes::of(attributes);
+        if (Q_UNLIKELY(pos >= d->computed.load(std::memory_order_acquire))) {
+            QMutexLocker locker(&d->mutex);
+            qsizetype from = d->computed.load(std::memory_order_relaxed);
+            while (pos >= from) {
+                const qsizetype to =
+                        QUnicodeTools::charAttributesSegmentEnd(str, from, MinimumSegmentLength);
+                QUnicodeTools::initCharAttributesOfSegment(str, from, to, attributes,
+                                                           attributeOptions(type));
+                from = to == str.size() ? to + 1 : to;
+                d->computed.store(from, std::memory_order_release);
+            }
+        }
+    }
+    return attributes[pos];
 }
 
 /*!
@@ -65,6 +141,11 @@ static void init(QTextBoundaryFinder::BoundaryType type, QStringView str, QCharA
     refers to the position before the first character. The last
     position at the length of the string is also valid and refers
     to the position after the last character.
+
+    Unless it is given a working buffer, QTextBoundaryFinder analyzes
+    long strings gradually, as it moves through them, rather than all
+    at once on construction. The const functions may still be called on
+    the same finder from several threads at once.
 */
 
 /*!
@@ -117,9 +198,7 @@ QTextBoundaryFinder::QTextBoundaryFinder(const QTextBoundaryFinder &other)
 {
     if (other.attributes) {
         Q_ASSERT(sv.size() > 0);
-        attributes = (QCharAttributes *) malloc((sv.size() + 1) * sizeof(QCharAttributes));
-        Q_CHECK_PTR(attributes);
-        memcpy(attributes, other.attributes, (sv.size() + 1) * sizeof(QCharAttributes));
+        attributes = LazyAttributes::copy(other.attributes, other.freeBuffer, sv.size());
     }
 }
 
@@ -131,27 +210,20 @@ QTextBoundaryFinder &QTextBoundaryFinder::operator=(const QTextBoundaryFinder &o
     if (&other == this)
         return *this;
 
+    QCharAttributes *newD = nullptr;
     if (other.attributes) {
         Q_ASSERT(other.sv.size() > 0);
-        size_t newCapacity = (size_t(other.sv.size()) + 1) * sizeof(QCharAttributes);
-        QCharAttributes *newD = (QCharAttributes *) realloc(freeBuffer ? attributes : nullptr, newCapacity);
-        Q_CHECK_PTR(newD);
-        freeBuffer = true;
-        attributes = newD;
+        newD = LazyAttributes::copy(other.attributes, other.freeBuffer, other.sv.size());
     }
+    if (freeBuffer && attributes)
+        LazyAttributes::free(attributes);
 
     t = other.t;
     s = other.s;
     sv = other.sv;
     pos = other.pos;
-
-    if (other.attributes) {
-        memcpy(attributes, other.attributes, (sv.size() + 1) * sizeof(QCharAttributes));
-    } else {
-        if (freeBuffer)
-            free(attributes);
-        attributes = nullptr;
-    }
+    freeBuffer = true;
+    attributes = newD;
 
     return *this;
 }
@@ -162,8 +234,8 @@ QTextBoundaryFinder &QTextBoundaryFinder::operator=(const QTextBoundaryFinder &o
 QTextBoundaryFinder::~QTextBoundaryFinder()
 {
     Q_UNUSED(unused);
-    if (freeBuffer)
-        free(attributes);
+    if (freeBuffer && attributes)
+        LazyAttributes::free(attributes);
 }
 
 /*!
@@ -175,11 +247,8 @@ QTextBoundaryFinder::QTextBoundaryFinder(BoundaryType type, const QString &strin
     , sv(s)
     , freeBuffer(true)
 {
-    if (sv.size() > 0) {
-        attributes = (QCharAttributes *) malloc((sv.size() + 1) * sizeof(QCharAttributes));
-        Q_CHECK_PTR(attributes);
-        init(t, sv, attributes);
-    }
+    if (sv.size() > 0)
+        attributes = LazyAttributes::allocate(sv.size());
 }
 
 /*!
@@ -212,11 +281,10 @@ QTextBoundaryFinder::QTextBoundaryFinder(BoundaryType type, QStringView string,
         if (buffer && bufferSize / int(sizeof(QCharAttributes)) >= sv.size() + 1) {
             attributes = reinterpret_cast<QCharAttributes *>(buffer);
             freeBuffer = false;
+            init(t, sv, attributes);
         } else {
-            attributes = (QCharAttributes *) malloc((sv.size() + 1) * sizeof(QCharAttributes));
-            Q_CHECK_PTR(attributes);
+            attributes = LazyAttributes::allocate(sv.size());
         }
-        init(t, sv, attributes);
     }
 }
 
@@ -304,19 +372,19 @@ qsizetype QTextBoundaryFinder::toNextBoundary()
     ++pos;
     switch(t) {
     case Grapheme:
-        while (pos < sv.size() && !attributes[pos].graphemeBoundary)
+        while (pos < sv.size() && !attributeAt(t, sv, attributes, freeBuffer, pos).graphemeBoundary)
             ++pos;
         break;
     case Word:
-        while (pos < sv.size() && !attributes[pos].wordBreak)
+        while (pos < sv.size() && !attributeAt(t, sv, attributes, freeBuffer, pos).wordBreak)
             ++pos;
         break;
     case Sentence:
-        while (pos < sv.size() && !attributes[pos].sentenceBoundary)
+        while (pos < sv.size() && !attributeAt(t, sv, attributes, freeBuffer, pos).sentenceBoundary)
             ++pos;
         break;
     case Line:
-        while (pos < sv.size() && !attributes[pos].lineBreak)
+        while (pos < sv.size() && !attributeAt(t, sv, attributes, freeBuffer, pos).lineBreak)
             ++pos;
         break;
     }
@@ -339,19 +407,19 @@ qsizetype QTextBoundaryFinder::toPreviousBoundary()
     --pos;
     switch(t) {
     case Grapheme:
-        while (pos > 0 && !attributes[pos].graphemeBoundary)
+        while (pos > 0 && !attributeAt(t, sv, attributes, freeBuffer, pos).graphemeBoundary)
             --pos;
         break;
     case Word:
-        while (pos > 0 && !attributes[pos].wordBreak)
+        while (pos > 0 && !attributeAt(t, sv, attributes, freeBuffer, pos).wordBreak)
             --pos;
         break;
     case Sentence:
-        while (pos > 0 && !attributes[pos].sentenceBoundary)
+        while (pos > 0 && !attributeAt(t, sv, attributes, freeBuffer, pos).sentenceBoundary)
             --pos;
         break;
     case Line:
-        while (pos > 0 && !attributes[pos].lineBreak)
+        while (pos > 0 && !attributeAt(t, sv, attributes, freeBuffer, pos).lineBreak)
             --pos;
         break;
     }
@@ -367,16 +435,17 @@ bool QTextBoundaryFinder::isAtBoundary() const
     if (!attributes || pos < 0 || pos > sv.size())
         return false;
 
+    const QCharAttributes attr = attributeAt(t, sv, attributes, freeBuffer, pos);
     switch(t) {
     case Grapheme:
-        return attributes[pos].graphemeBoundary;
+        return attr.graphemeBoundary;
     case Word:
-        return attributes[pos].wordBreak;
+        return attr.wordBreak;
     case Sentence:
-        return attributes[pos].sentenceBoundary;
+        return attr.sentenceBoundary;
     case Line:
         // ### TR#14 LB2 prohibits break at sot
-        return attributes[pos].lineBreak || pos == 0;
+        return attr.lineBreak || pos == 0;
     }
     return false;
 }
@@ -390,7 +459,7 @@ QTextBoundaryFinder::BoundaryReasons QTextBoundaryFinder::boundaryReasons() cons
     if (!attributes || pos < 0 || pos > sv.size())
         return reasons;
 
-    const QCharAttributes attr = attributes[pos];
+    const QCharAttributes attr = attributeAt(t, sv, attributes, freeBuffer, pos);
     switch (t) {
     case Grapheme:
         if (attr.graphemeBoundary) {
@@ -4,6 +4,7 @@
 #include "qunicodetools_p.h"
 
 #include "qunicodetables_p.h"
+#include "qstringalgorithms_p.h"
 #include "qvarlengtharray.h"
 #if QT_CONFIG(library)
 #include "qlibrary.h"
@@ -197,6 +198,22 @@ static void getGraphemeBreaks(const char16_t *string, qsizetype len, QCharAttrib
             attributes[pos].graphemeBoundary = true;
 
         lcls = cls;
+
+        if (ucs4 < 0x80) {
+            // No state survives an ASCII character, and the only pair of ASCII
+            // characters that isn't separated by a boundary is CR LF (GB3), so
+            // deal with a run of them in one go.
+            const qsizetype runEnd = i + 1 + qt_ascii_prefix_length(string + i + 1, string + len);
+            if (runEnd != i + 1) {
+                while (++i != runEnd) {
+                    if (string[i] != u'\n' || string[i - 1] != u'\r')
+                        attributes[i].graphemeBoundary = true;
+                }
+                --i;
+                lcls = QUnicodeTables::GraphemeBreakClass(
+                        QUnicodeTables::properties(string[i])->graphemeBreakClass);
+            }
+        }
     }
 
     attributes[len].graphemeBoundary = true; // GB2
@@ -728,8 +745,15 @@ static void getLineBreaks(const char16_t *string, qsizetype len, QCharAttributes
         }
 
         if (Q_UNLIKELY(ncls >= QUnicodeTables::LineBreak_SP)) {
-            if (ncls > QUnicodeTables::LineBreak_SP)
+            if (ncls > QUnicodeTables::LineBreak_SP) {
+                // LB25: a hard line break ends a number, like the end of the text does
+                if (Q_UNLIKELY(LB::NS::actionTable[nelast][LB::NS::XX] == LB::NS::Break)) {
+                    for (qsizetype j = nestart + 1; j < pos; ++j)
+                        attributes[j].lineBreak = false;
+                }
+                nelast = LB::NS::XX;
                 goto next; // LB6: x(BK|CR|LF|NL)
+            }
             goto next_no_cls_update; // LB7: xSP
         }
 
@@ -2417,6 +2441,50 @@ Q_CORE_EXPORT void initCharAttributes(QStringView string,
 }
 
 
+/*
+    Returns the end of the segment of \a string that starts at \a from and
+    is, if possible, at least \a minimumLength long: the position just after
+    a line feed, or the end of \a string.
+
+    All the segmentation algorithms start over after a line feed, so the
+    attributes of such segments can be computed separately, and lazily, with
+    initCharAttributesOfSegment().
+*/
+Q_CORE_EXPORT qsizetype charAttributesSegmentEnd(QStringView string, qsizetype from,
+                                                 qsizetype minimumLength)
+{
+    Q_ASSERT(minimumLength > 0);
+    if (string.size() - from <= minimumLength)
+        return string.size();
+    const qsizetype lineFeed = string.indexOf(u'\n', from + minimumLength - 1);
+    return lineFeed < 0 ? string.size() : lineFeed + 1;
+}
+
+/*
+    Computes the attributes of the segment [\a from, \a to) of \a string,
+    as returned by charAttributesSegmentEnd(), into \a attributes, which has
+    room for the whole \a string. The result is the same as that of
+    initCharAttributes() for the whole \a string, once the segments before
+    \a from have been computed. The attribute at \a to is provisional,
+    unless \a to is the end of \a string.
+*/
+Q_CORE_EXPORT void initCharAttributesOfSegment(QStringView string, qsizetype from, qsizetype to,
+                                               QCharAttributes *attributes,
+                                               CharAttributeOptions options)
+{
+    Q_ASSERT(from == 0 || string[from - 1] == u'\n');
+    const QStringView segment = string.sliced(from, to - from);
+    ScriptItemArray scriptItems;
+    initScripts(segment, &scriptItems);
+    initCharAttributes(segment, scriptItems.data(), scriptItems.size(), attributes + from,
+                       options & ~CharAttributeOptions(DontClearAttributes));
+    if (from > 0 && (options & LineBreaks)) {
+        // LB5: break after the line feed, which LB2 took back at the start
+        // of the segment
+        attributes[from].lineBreak = attributes[from].mandatoryBreak = true;
+    }
+}
+
 // ----------------------------------------------------------------------------
 //
 // The Unicode script property. See http://www.unicode.org/reports/tr24/tr24-24.html
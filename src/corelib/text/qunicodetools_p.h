@@ -65,6 +65,12 @@ Q_CORE_EXPORT void initCharAttributes(QStringView str,
                                       const ScriptItem *items, qsizetype numItems,
                                       QCharAttributes *attributes, CharAttributeOptions options);
 
+// computes the attributes lazily, a segment ending at a line feed at a time
+Q_CORE_EXPORT qsizetype charAttributesSegmentEnd(QStringView str, qsizetype from,
+                                                 qsizetype minimumLength);
+Q_CORE_EXPORT void initCharAttributesOfSegment(QStringView str, qsizetype from, qsizetype to,
+                                               QCharAttributes *attributes,
+                                               CharAttributeOptions options);
 
 Q_CORE_EXPORT void initScripts(QStringView str, ScriptItemArray *scripts);
 
@@ -87,7 +87,43 @@ template <typename Atomic> inline
 void futexWakeOp(Atomic &futex1, int wake1, int wake2, Atomic &futex2, quint32 op)
 {
     _q_futex(addr(&futex1), FUTEX_WAKE_OP, wake1, wake2, addr(&futex2), op);
-}} // namespace QtLinuxFutex
+}
+
+// The functions below operate on futexes that live in memory shared with other
+// processes (e.g. a QSharedMemory segment), so they must not use
+// FUTEX_PRIVATE_FLAG, which would key the futex on the process' address space.
+inline long _q_futex_shared(int *addr, int op, int val, quintptr val2 = 0,
+                            int *addr2 = nullptr, int val3 = 0) noexcept
+{
+    QtTsan::futexRelease(addr, addr2);
+    long result = syscall(__NR_futex, addr, op, val, val2, addr2, val3);
+    QtTsan::futexAcquire(addr, addr2);
+    return result;
+}
+
+template <typename Atomic>
+inline bool sharedFutexWait(Atomic &futex, typename Atomic::Type expectedValue,
+                            QDeadlineTimer deadline = QDeadlineTimer::Forever)
+{
+    if (deadline.isForever()) {
+        _q_futex_shared(addr(&futex), FUTEX_WAIT, qintptr(expectedValue));
+        return true;
+    }
+    auto timeout = deadline.deadline<std::chrono::steady_clock>().time_since_epoch();
+    struct timespec ts = durationToTimespec(timeout);
+    long r = _q_futex_shared(addr(&futex), FUTEX_WAIT_BITSET, qintptr(expectedValue),
+                             quintptr(&ts), nullptr, FUTEX_BITSET_MATCH_ANY);
+    return r == 0 || errno != ETIMEDOUT;
+}
+template <typename Atomic> inline void sharedFutexWakeOne(Atomic &futex)
+{
+    _q_futex_shared(addr(&futex), FUTEX_WAKE, 1);
+}
+template <typename Atomic> inline void sharedFutexWakeAll(Atomic &futex)
+{
+    _q_futex_shared(addr(&futex), FUTEX_WAKE, INT_MAX);
+}
+} // namespace QtLinuxFutex
 namespace QtFutex = QtLinuxFutex;
 
 QT_END_NAMESPACE
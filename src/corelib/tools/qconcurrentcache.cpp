@@ -0,0 +1,144 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qconcurrentcache_p.h"
+
+#include <QtCore/qmath.h>
+#include <QtCore/qthread.h>
+
+#include <algorithm>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \internal
+    \class QConcurrentCache
+    \inmodule QtCore
+
+    QConcurrentCache is a cache that can be used from several threads at the
+    same time. Like QCache, it maps keys to values that have a cost, and
+    evicts the least recently used ones to keep the total cost below
+    maxCost(). Unlike QCache, it stores copies of the values (which should be
+    cheap to copy, like implicitly shared classes), since an entry can be
+    evicted by another thread while a value is in use.
+
+    The cache is split into shardCount() independent shards, selected by the
+    high bits of the hash of the key (the shards' QHash tables use the low
+    bits), each protected by its own mutex and holding an equal
+    share of maxCost(). Threads working on different shards do not contend
+    with each other. An entry cannot cost more than one shard's share.
+
+    New entries are subject to TinyLFU admission: once a shard is full, an
+    entry is only inserted if its key was asked for more often, recently,
+    than the keys of the entries it would displace. Access frequencies are
+    estimated by a QtPrivate::QFrequencySketch per shard. This protects the
+    entries in frequent use from being flushed out by a scan over keys that
+    are used only once.
+
+    statistics() reports the number of hits, misses, insertions, rejected
+    insertions and evictions.
+*/
+
+/*!
+    \internal
+    \class QtPrivate::QFrequencySketch
+    \inmodule QtCore
+
+    QFrequencySketch is a count-min sketch of 4-bit counters, estimating how
+    often each hash was passed to increment(). Once ten times as many
+    increments as the capacity it was sized for were recorded, all counters
+    are halved, so that the estimates favor recent accesses.
+*/
+
+static constexpr size_t SketchSeeds[] = {
+    size_t(0x97cb3127a4d1bee5ULL), size_t(0xb492b66fbe98f273ULL),
+    size_t(0x9ae16a3b2f90404fULL), size_t(0xcbf29ce484222325ULL),
+};
+
+/*!
+    \internal
+    Makes sure the sketch has enough counters to tell \a entryCount keys
+    apart. The recorded frequencies are kept when the sketch grows.
+*/
+void QtPrivate::QFrequencySketch::ensureCapacity(qsizetype entryCount)
+{
+    // sixteen counters per row for each key keep collisions from inflating
+    // the estimates of rarely used keys
+    const qsizetype capacity = qMax(qsizetype(8), qsizetype(qNextPowerOfTwo(quint64(entryCount))));
+    if (4 * capacity <= m_words)
+        return;
+    const qsizetype words = 4 * capacity;
+    std::unique_ptr<quint64[]> table(new quint64[words]());
+    // A counter lives in the word selected by the low bits of its hash, so
+    // in the larger table it is in one of the copies of its old word. Each
+    // key keeps its estimate, which only collisions in the new bits lower
+    // back over time.
+    if (m_words) {
+        for (qsizetype i = 0; i < words; i += m_words)
+            std::copy_n(m_table.get(), m_words, table.get() + i);
+    }
+    m_table = std::move(table);
+    m_words = words;
+    m_sampleSize = 10 * capacity;
+}
+
+QtPrivate::QFrequencySketch::Counter
+QtPrivate::QFrequencySketch::counter(size_t hash, int row) const noexcept
+{
+    const size_t mixed = QHashPrivate::hash(hash, SketchSeeds[row]);
+    // each row uses its own quarter of the word's counters
+    const int inRow = int(mixed >> (std::numeric_limits<size_t>::digits - 2));
+    return { qsizetype(mixed & size_t(m_words - 1)), (row * 4 + inRow) * 4 };
+}
+
+void QtPrivate::QFrequencySketch::increment(size_t hash) noexcept
+{
+    if (!m_words)
+        ensureCapacity(0);
+    bool added = false;
+    for (int row = 0; row < Depth; ++row) {
+        const Counter c = counter(hash, row);
+        quint64 &word = m_table[c.word];
+        if (((word >> c.shift) & MaxCounter) != MaxCounter) {
+            word += quint64(1) << c.shift;
+            added = true;
+        }
+    }
+    if (added && ++m_additions == m_sampleSize)
+        halve();
+}
+
+int QtPrivate::QFrequencySketch::frequency(size_t hash) const noexcept
+{
+    if (!m_words)
+        return 0;
+    int result = int(MaxCounter);
+    for (int row = 0; row < Depth; ++row) {
+        const Counter c = counter(hash, row);
+        result = qMin(result, int((m_table[c.word] >> c.shift) & MaxCounter));
+    }
+    return result;
+}
+
+void QtPrivate::QFrequencySketch::halve() noexcept
+{
+    for (qsizetype i = 0; i < m_words; ++i)
+        m_table[i] = (m_table[i] >> 1) & Q_UINT64_C(0x7777777777777777);
+    m_additions /= 2;
+}
+
+/*!
+    \internal
+    Returns the number of shards to use for a QConcurrentCache when asked for
+    \a requested shards: a power of two, by default twice the ideal thread
+    count, rounded up.
+*/
+qsizetype QtPrivate::concurrentCacheShardCount(qsizetype requested)
+{
+    if (requested <= 0)
+        requested = 2 * QThread::idealThreadCount();
+    return qsizetype(qNextPowerOfTwo(quint32(qBound(1, int(requested), 1 << 16) - 1)));
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,345 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QCONCURRENTCACHE_P_H
+#define QCONCURRENTCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+
+#include <limits>
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtPrivate {
+
+class Q_CORE_EXPORT QFrequencySketch
+{
+public:
+    void ensureCapacity(qsizetype entryCount);
+    void increment(size_t hash) noexcept;
+    int frequency(size_t hash) const noexcept;
+
+private:
+    static constexpr int Depth = 4;
+    static constexpr quint64 MaxCounter = 15;
+
+    struct Counter
+    {
+        qsizetype word;
+        int shift;
+    };
+    Counter counter(size_t hash, int row) const noexcept;
+    void halve() noexcept;
+
+    std::unique_ptr<quint64[]> m_table; // sixteen 4-bit counters per word
+    qsizetype m_words = 0;
+    qsizetype m_additions = 0;
+    qsizetype m_sampleSize = 0;
+};
+
+Q_CORE_EXPORT qsizetype concurrentCacheShardCount(qsizetype requested);
+
+} // namespace QtPrivate
+
+template <class Key, class T>
+class QConcurrentCache
+{
+public:
+    struct Statistics
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 insertions = 0;
+        quint64 rejections = 0;
+        quint64 evictions = 0;
+
+        Statistics &operator+=(const Statistics &other) noexcept
+        {
+            hits += other.hits;
+            misses += other.misses;
+            insertions += other.insertions;
+            rejections += other.rejections;
+            evictions += other.evictions;
+            return *this;
+        }
+    };
+
+    explicit QConcurrentCache(qsizetype maxCost = 100, qsizetype shardCount = 0)
+        : m_shardCount(QtPrivate::concurrentCacheShardCount(shardCount)),
+          m_shardShift(std::numeric_limits<size_t>::digits
+                       - qCountTrailingZeroBits(quint64(m_shardCount))),
+          m_shards(new Shard[m_shardCount]),
+          m_seed(QHashSeed::globalSeed())
+    {
+        setMaxCost(maxCost);
+    }
+    Q_DISABLE_COPY_MOVE(QConcurrentCache)
+    ~QConcurrentCache() = default;
+
+    qsizetype shardCount() const noexcept { return m_shardCount; }
+
+    qsizetype maxCost() const
+    {
+        const QMutexLocker locker(&m_shards[0].mutex);
+        return m_shards[0].maxCost * m_shardCount;
+    }
+
+    void setMaxCost(qsizetype maxCost)
+    {
+        const qsizetype shardCost = (maxCost + m_shardCount - 1) / m_shardCount;
+        for (qsizetype i = 0; i < m_shardCount; ++i) {
+            Shard &shard = m_shards[i];
+            const QMutexLocker locker(&shard.mutex);
+            shard.maxCost = shardCost;
+            shard.trim(shardCost);
+        }
+    }
+
+    qsizetype totalCost() const
+    {
+        qsizetype result = 0;
+        for (qsizetype i = 0; i < m_shardCount; ++i) {
+            const QMutexLocker locker(&m_shards[i].mutex);
+            result += m_shards[i].totalCost;
+        }
+        return result;
+    }
+
+    qsizetype size() const
+    {
+        qsizetype result = 0;
+        for (qsizetype i = 0; i < m_shardCount; ++i) {
+            const QMutexLocker locker(&m_shards[i].mutex);
+            result += m_shards[i].entries.size();
+        }
+        return result;
+    }
+
+    bool insert(const Key &key, const T &value, qsizetype cost = 1)
+    { return emplace(key, value, cost); }
+    bool insert(const Key &key, T &&value, qsizetype cost = 1)
+    { return emplace(key, std::move(value), cost); }
+
+    std::optional<T> object(const Key &key)
+    {
+        const size_t hash = qHash(key, m_seed);
+        Shard &shard = shardFor(hash);
+        const QMutexLocker locker(&shard.mutex);
+        shard.sketch.increment(hash);
+        Entry *entry = shard.entries.value(key);
+        if (!entry) {
+            ++shard.statistics.misses;
+            return std::nullopt;
+        }
+        ++shard.statistics.hits;
+        shard.moveToFront(entry);
+        return entry->value;
+    }
+
+    bool contains(const Key &key) const
+    {
+        const size_t hash = qHash(key, m_seed);
+        const Shard &shard = shardFor(hash);
+        const QMutexLocker locker(&shard.mutex);
+        return shard.entries.contains(key);
+    }
+
+    bool remove(const Key &key)
+    {
+        const size_t hash = qHash(key, m_seed);
+        Shard &shard = shardFor(hash);
+        const QMutexLocker locker(&shard.mutex);
+        Entry *entry = shard.entries.value(key);
+        if (!entry)
+            return false;
+        shard.erase(entry);
+        return true;
+    }
+
+    void clear()
+    {
+        for (qsizetype i = 0; i < m_shardCount; ++i) {
+            const QMutexLocker locker(&m_shards[i].mutex);
+            m_shards[i].clear();
+        }
+    }
+
+    Statistics statistics() const
+    {
+        Statistics result;
+        for (qsizetype i = 0; i < m_shardCount; ++i) {
+            const QMutexLocker locker(&m_shards[i].mutex);
+            result += m_shards[i].statistics;
+        }
+        return result;
+    }
+
+    void resetStatistics()
+    {
+        for (qsizetype i = 0; i < m_shardCount; ++i) {
+            const QMutexLocker locker(&m_shards[i].mutex);
+            m_shards[i].statistics = {};
+        }
+    }
+
+private:
+    struct Link
+    {
+        Link *prev = this;
+        Link *next = this;
+    };
+
+    struct Entry : Link
+    {
+        template <typename V>
+        Entry(const Key &k, V &&v, qsizetype c, size_t h)
+            : key(k), value(std::forward<V>(v)), cost(c), hash(h)
+        {}
+
+        Key key;
+        T value;
+        qsizetype cost;
+        size_t hash;
+    };
+
+    // keep the shards' mutexes on separate cache lines
+    struct alignas(64) Shard
+    {
+        Shard() = default;
+        Q_DISABLE_COPY_MOVE(Shard)
+        ~Shard() { qDeleteAll(entries); }
+
+        void unlink(Link *link) noexcept
+        {
+            link->prev->next = link->next;
+            link->next->prev = link->prev;
+        }
+        void pushFront(Link *link) noexcept
+        {
+            link->next = lru.next;
+            link->prev = &lru;
+            lru.next->prev = link;
+            lru.next = link;
+        }
+        void moveToFront(Entry *entry) noexcept
+        {
+            unlink(entry);
+            pushFront(entry);
+        }
+        void erase(Entry *entry)
+        {
+            unlink(entry);
+            totalCost -= entry->cost;
+            entries.remove(entry->key);
+            delete entry;
+        }
+        void clear()
+        {
+            qDeleteAll(entries);
+            entries.clear();
+            lru.prev = lru.next = &lru;
+            totalCost = 0;
+        }
+        void trim(qsizetype cost)
+        {
+            while (totalCost > cost) {
+                erase(static_cast<Entry *>(lru.prev));
+                ++statistics.evictions;
+            }
+        }
+
+        mutable QMutex mutex;
+        QHash<Key, Entry *> entries;
+        Link lru;           // most recently used first
+        qsizetype totalCost = 0;
+        qsizetype maxCost = 0;
+        QtPrivate::QFrequencySketch sketch;
+        Statistics statistics;
+    };
+
+    // The entries of a shard's QHash are spread by the low bits of the same
+    // hash, so select the shard by the high bits to keep all the buckets in use.
+    Shard &shardFor(size_t hash) const noexcept
+    {
+        if (m_shardCount == 1)
+            return m_shards[0];
+        return m_shards[qsizetype(hash >> m_shardShift)];
+    }
+
+    template <typename V>
+    bool emplace(const Key &key, V &&value, qsizetype cost)
+    {
+        const size_t hash = qHash(key, m_seed);
+        Shard &shard = shardFor(hash);
+        const QMutexLocker locker(&shard.mutex);
+        if (cost > shard.maxCost) {
+            // like QCache, drop the entry that would have been replaced
+            if (Entry *entry = shard.entries.value(key))
+                shard.erase(entry);
+            ++shard.statistics.rejections;
+            return false;
+        }
+
+        shard.sketch.increment(hash);
+        if (Entry *entry = shard.entries.value(key)) {
+            entry->value = std::forward<V>(value);
+            shard.totalCost += cost - entry->cost;
+            entry->cost = cost;
+            shard.moveToFront(entry);
+            shard.trim(shard.maxCost);
+            ++shard.statistics.insertions;
+            return true;
+        }
+
+        const qsizetype excess = shard.totalCost + cost - shard.maxCost;
+        if (excess > 0) {
+            // TinyLFU admission: only let the new entry in if it has been
+            // asked for more often than the entries it would displace.
+            int victimFrequency = 0;
+            qsizetype freed = 0;
+            for (Link *link = shard.lru.prev; freed < excess; link = link->prev) {
+                const Entry *victim = static_cast<const Entry *>(link);
+                freed += victim->cost;
+                victimFrequency = qMax(victimFrequency, shard.sketch.frequency(victim->hash));
+            }
+            if (shard.sketch.frequency(hash) <= victimFrequency) {
+                ++shard.statistics.rejections;
+                return false;
+            }
+            shard.trim(shard.maxCost - cost);
+        }
+
+        Entry *entry = new Entry(key, std::forward<V>(value), cost, hash);
+        shard.entries.insert(key, entry);
+        shard.pushFront(entry);
+        shard.totalCost += cost;
+        shard.sketch.ensureCapacity(shard.entries.size());
+        ++shard.statistics.insertions;
+        return true;
+    }
+
+    const qsizetype m_shardCount;
+    const int m_shardShift;
+    const std::unique_ptr<Shard[]> m_shards;
+    const size_t m_seed;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCONCURRENTCACHE_P_H
@@ -5304,6 +5304,9 @@ void QImage::applyColorTransform(const QColorTransform &transform)
             }
         };
     }
+    // decided for the whole image, so that all segments are converted alike
+    if (QColorTransformPrivate::shouldUseLut3D(qsizetype(width()) * height()))
+        flags |= QColorTransformPrivate::UseLut3D;
 
 #if QT_CONFIG(thread) && !defined(Q_OS_WASM)
     int segments = (qsizetype(width()) * height()) >> 16;
@@ -5794,6 +5797,9 @@ QImage QImage::colorTransformed(const QColorTransform &transform, QImage::Format
             };
         }
     }
+    // decided for the whole image, so that all segments are converted alike
+    if (QColorTransformPrivate::shouldUseLut3D(qsizetype(width()) * height()))
+        transFlags |= QColorTransformPrivate::UseLut3D;
 
 #if QT_CONFIG(thread) && !defined(Q_OS_WASM)
     int segments = (qsizetype(width()) * height()) >> 16;
@@ -0,0 +1,717 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qimagecache_p.h"
+
+#include <qcolorspace.h>
+#include <qdatastream.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qhash.h>
+#include <qlist.h>
+#include <qmutex.h>
+#include <qset.h>
+#include <qtemporarydir.h>
+#include <qwaitcondition.h>
+
+#include <list>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+constexpr quint32 SpillMagic = 0x51494331; // "QIC1"
+
+// The rows are written without their padding and deflated at the fastest
+// level: spilled images are read back soon, if ever, so the point is to
+// keep the disk traffic small rather than the file.
+bool writeSpillFile(const QString &fileName, const QImage &image)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    const qsizetype lineBytes = (qsizetype(image.width()) * image.depth() + 7) / 8;
+    QByteArray pixels;
+    if (lineBytes == image.bytesPerLine()) {
+        pixels = qCompress(image.constBits(), image.sizeInBytes(), 1);
+    } else {
+        QByteArray packed(lineBytes * image.height(), Qt::Uninitialized);
+        for (int y = 0; y < image.height(); ++y)
+            memcpy(packed.data() + y * lineBytes, image.constScanLine(y), lineBytes);
+        pixels = qCompress(packed, 1);
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << SpillMagic << qint32(image.width()) << qint32(image.height())
+           << qint32(image.format()) << image.colorTable()
+           << image.devicePixelRatio() << qint32(image.dotsPerMeterX())
+           << qint32(image.dotsPerMeterY()) << image.colorSpace().iccProfile()
+           << qint32(image.offset().x()) << qint32(image.offset().y());
+    const QStringList textKeys = image.textKeys();
+    stream << qint32(textKeys.size());
+    for (const QString &key : textKeys)
+        stream << key << image.text(key);
+    stream << pixels;
+    return stream.status() == QDataStream::Ok && file.flush();
+}
+
+QImage readSpillFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QImage();
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic;
+    qint32 width, height, format, dotsPerMeterX, dotsPerMeterY, offsetX, offsetY, textCount;
+    QList<QRgb> colorTable;
+    qreal devicePixelRatio;
+    QByteArray iccProfile;
+    stream >> magic >> width >> height >> format >> colorTable >> devicePixelRatio
+           >> dotsPerMeterX >> dotsPerMeterY >> iccProfile >> offsetX >> offsetY >> textCount;
+    if (stream.status() != QDataStream::Ok || magic != SpillMagic
+        || format <= QImage::Format_Invalid || format >= QImage::NImageFormats) {
+        return QImage();
+    }
+
+    QImage image(width, height, QImage::Format(format));
+    if (image.isNull())
+        return QImage();
+    for (qint32 i = 0; i < textCount && stream.status() == QDataStream::Ok; ++i) {
+        QString key, value;
+        stream >> key >> value;
+        image.setText(key, value);
+    }
+    QByteArray pixels;
+    stream >> pixels;
+    if (stream.status() != QDataStream::Ok)
+        return QImage();
+    pixels = qUncompress(pixels);
+
+    const qsizetype lineBytes = (qsizetype(width) * image.depth() + 7) / 8;
+    if (pixels.size() != lineBytes * height)
+        return QImage();
+    for (int y = 0; y < height; ++y)
+        memcpy(image.scanLine(y), pixels.constData() + y * lineBytes, lineBytes);
+
+    image.setColorTable(colorTable);
+    image.setDevicePixelRatio(devicePixelRatio);
+    image.setDotsPerMeterX(dotsPerMeterX);
+    image.setDotsPerMeterY(dotsPerMeterY);
+    image.setOffset(QPoint(offsetX, offsetY));
+    if (!iccProfile.isEmpty())
+        image.setColorSpace(QColorSpace::fromIccProfile(iccProfile));
+    return image;
+}
+
+} // unnamed namespace
+
+class QImageCachePrivate : public std::enable_shared_from_this<QImageCachePrivate>
+{
+public:
+    struct MemoryEntry
+    {
+        QString key;
+        QImage image;
+        qsizetype cost;
+    };
+    struct DiskEntry
+    {
+        QString key;
+        QString fileName;
+        qsizetype size;
+    };
+    struct Spill
+    {
+        QString key;
+        QImage image;
+        QString fileName;
+        // keeps the directory the file is written to until it is written
+        std::shared_ptr<QTemporaryDir> dir;
+    };
+    // The images and files an operation lets go of while holding the
+    // mutex, to be written, deleted and freed once it is unlocked.
+    struct Released
+    {
+        std::vector<Spill> spills;
+        QStringList obsoleteFiles;
+    };
+    using MemoryList = std::list<MemoryEntry>;
+    using DiskList = std::list<DiskEntry>;
+
+    bool insertLocked(const QString &key, const QImage &image, Released *released);
+    void evictLocked(qsizetype targetCost, bool spill, Released *released);
+    void dropLocked(const QString &key, Released *released);
+    void trimDiskLocked(Released *released);
+    void relieveLocked(QImageCache::MemoryPressure level, Released *released);
+    QImage lookupLocked(QMutexLocker<QMutex> &locker, const QString &key, bool wait);
+    void release(Released &released);
+
+    mutable QMutex mutex;
+    QWaitCondition loaded;
+    qsizetype maxCost = 0;
+    qsizetype totalCost = 0;
+    MemoryList memory; // most recently used first
+    QHash<QString, MemoryList::iterator> memoryIndex;
+
+    QString spillDirectory;
+    std::shared_ptr<QTemporaryDir> spillDir; // shared with the spills being written
+    qsizetype maxSpillSize = qsizetype(256) << 20;
+    qsizetype spillSize = 0;
+    quint64 nextSpillId = 0;
+    DiskList disk; // most recently spilled first
+    QHash<QString, DiskList::iterator> diskIndex;
+    QHash<QString, QImage> spilling; // evicted, and being written to disk
+    QSet<QString> loading;           // being read back, or produced
+    quint64 generation = 0;          // bumped when keys being loaded are removed
+
+    QImageCache::Statistics statistics;
+};
+
+namespace {
+
+struct CacheRegistry
+{
+    QMutex mutex;
+    QList<QImageCachePrivate *> caches;
+};
+
+Q_GLOBAL_STATIC(CacheRegistry, cacheRegistry)
+
+} // unnamed namespace
+
+bool QImageCachePrivate::insertLocked(const QString &key, const QImage &image, Released *released)
+{
+    dropLocked(key, released);
+
+    // like QCache, an image larger than the whole cache is not kept
+    const qsizetype cost = QImageCache::cost(image);
+    if (image.isNull() || cost > maxCost)
+        return false;
+
+    evictLocked(maxCost - cost, true, released);
+    memory.push_front({ key, image, cost });
+    memoryIndex.insert(key, memory.begin());
+    totalCost += cost;
+    ++statistics.insertions;
+    return true;
+}
+
+void QImageCachePrivate::evictLocked(qsizetype targetCost, bool spill, Released *released)
+{
+    while (totalCost > targetCost && !memory.empty()) {
+        MemoryEntry &entry = memory.back();
+        totalCost -= entry.cost;
+        memoryIndex.remove(entry.key);
+        ++statistics.evictions;
+
+        Spill evicted{ std::move(entry.key), std::move(entry.image), QString(), nullptr };
+        if (spill && spillDir) {
+            evicted.fileName = spillDir->filePath(QString::number(nextSpillId++, 16));
+            evicted.dir = spillDir;
+            spilling.insert(evicted.key, evicted.image);
+        }
+        released->spills.push_back(std::move(evicted));
+        memory.pop_back();
+    }
+}
+
+void QImageCachePrivate::dropLocked(const QString &key, Released *released)
+{
+    if (loading.contains(key))
+        ++generation;
+    if (const auto it = memoryIndex.constFind(key); it != memoryIndex.cend()) {
+        totalCost -= (*it)->cost;
+        released->spills.push_back({ key, std::move((*it)->image), QString(), nullptr });
+        memory.erase(*it);
+        memoryIndex.erase(it);
+    }
+    spilling.remove(key);
+    if (const auto it = diskIndex.constFind(key); it != diskIndex.cend()) {
+        spillSize -= (*it)->size;
+        released->obsoleteFiles.append((*it)->fileName);
+        disk.erase(*it);
+        diskIndex.erase(it);
+    }
+}
+
+void QImageCachePrivate::trimDiskLocked(Released *released)
+{
+    while (spillSize > maxSpillSize && !disk.empty()) {
+        const DiskEntry &entry = disk.back();
+        spillSize -= entry.size;
+        released->obsoleteFiles.append(entry.fileName);
+        diskIndex.remove(entry.key);
+        disk.pop_back();
+    }
+}
+
+void QImageCachePrivate::relieveLocked(QImageCache::MemoryPressure level, Released *released)
+{
+    switch (level) {
+    case QImageCache::MemoryPressure::Moderate:
+        evictLocked(maxCost / 2, true, released);
+        break;
+    case QImageCache::MemoryPressure::Critical:
+        // writing to disk would need memory of its own
+        evictLocked(0, false, released);
+        break;
+    }
+}
+
+QImage QImageCachePrivate::lookupLocked(QMutexLocker<QMutex> &locker, const QString &key, bool wait)
+{
+    while (loading.contains(key)) {
+        if (!wait)
+            return QImage();
+        loaded.wait(&mutex);
+    }
+
+    if (const auto it = memoryIndex.constFind(key); it != memoryIndex.cend()) {
+        memory.splice(memory.begin(), memory, *it);
+        ++statistics.hits;
+        return (*it)->image;
+    }
+
+    // An image that is still being written out is handed back as it is.
+    QImage image = spilling.value(key);
+    if (!image.isNull()) {
+        ++statistics.hits;
+    } else {
+        const auto it = diskIndex.constFind(key);
+        if (it == diskIndex.cend())
+            return QImage();
+
+        // The spill file is taken out of the index while it is read, and
+        // anybody else asking for the key waits for it.
+        const QString fileName = (*it)->fileName;
+        // keeps the directory, should it be replaced while the file is read
+        std::shared_ptr<QTemporaryDir> dir = spillDir;
+        spillSize -= (*it)->size;
+        disk.erase(*it);
+        diskIndex.erase(it);
+        loading.insert(key);
+        const quint64 readGeneration = generation;
+        locker.unlock();
+        image = readSpillFile(fileName);
+        QFile::remove(fileName);
+        dir.reset();
+        locker.relock();
+        loading.remove(key);
+        loaded.wakeAll();
+
+        // the key may have been inserted again in the meantime
+        if (const auto inserted = memoryIndex.constFind(key); inserted != memoryIndex.cend())
+            return (*inserted)->image;
+        if (image.isNull())
+            return QImage();
+        ++statistics.diskHits;
+        // nor cached again if it was removed meanwhile
+        if (generation != readGeneration)
+            return image;
+    }
+
+    Released released;
+    insertLocked(key, image, &released);
+    locker.unlock();
+    release(released);
+    locker.relock();
+    return image;
+}
+
+void QImageCachePrivate::release(Released &released)
+{
+    for (Spill &spill : released.spills) {
+        if (spill.fileName.isEmpty())
+            continue;
+        const bool written = writeSpillFile(spill.fileName, spill.image);
+        const qsizetype size = written ? QFileInfo(spill.fileName).size() : 0;
+
+        QMutexLocker locker(&mutex);
+        // The key may have been inserted again, removed or read back from
+        // the pending image while the file was being written.
+        const auto it = spilling.constFind(spill.key);
+        if (!written || it == spilling.cend() || it->cacheKey() != spill.image.cacheKey()) {
+            released.obsoleteFiles.append(spill.fileName);
+            continue;
+        }
+        spilling.erase(it);
+        disk.push_front({ spill.key, spill.fileName, size });
+        diskIndex.insert(spill.key, disk.begin());
+        spillSize += size;
+        ++statistics.spills;
+        trimDiskLocked(&released);
+    }
+
+    for (const QString &fileName : std::as_const(released.obsoleteFiles))
+        QFile::remove(fileName);
+    released.obsoleteFiles.clear();
+    // a directory that was replaced is removed here, after its last file
+    released.spills.clear();
+}
+
+/*!
+    \internal
+    \class QImageCache
+    \inmodule QtGui
+
+    QImageCache is a cache of decoded images that can be shared between
+    threads, for instance between the workers decoding images and the GUI
+    thread showing them. Unlike QPixmapCache, it can be used from any
+    thread, and every operation is thread-safe.
+
+    The cost of an entry is the number of bytes its image takes up, as
+    returned by cost(), and the cache evicts the least recently used
+    images when the total exceeds maxCost(). If a spill directory is set,
+    evicted images are written to disk in a compact format, and read back
+    when they are asked for again, until the files exceed maxSpillSize().
+
+    findOrInsert() lets only one thread produce a missing image, while the
+    others asking for the same key wait for it, so that an image is never
+    decoded twice at the same time.
+
+    Memory pressure can be relieved with handleMemoryPressure() on a single
+    cache, or with notifyMemoryPressure() on all the caches in the process.
+*/
+
+/*!
+    \enum QImageCache::MemoryPressure
+
+    \value Moderate The cache is trimmed to half of its maximum cost, and
+           the evicted images are spilled to disk if that is enabled.
+    \value Critical All images are dropped from memory, without spilling.
+*/
+
+/*!
+    Constructs an image cache that keeps up to \a maxCost bytes of images
+    in memory.
+*/
+QImageCache::QImageCache(qsizetype maxCost)
+    : d(std::make_shared<QImageCachePrivate>())
+{
+    d->maxCost = maxCost;
+    CacheRegistry *registry = cacheRegistry();
+    QMutexLocker locker(&registry->mutex);
+    registry->caches.append(d.get());
+}
+
+/*!
+    Destroys the cache and deletes its spill files.
+*/
+QImageCache::~QImageCache()
+{
+    if (CacheRegistry *registry = cacheRegistry()) {
+        QMutexLocker locker(&registry->mutex);
+        registry->caches.removeOne(d.get());
+    }
+    clear();
+}
+
+qsizetype QImageCache::maxCost() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maxCost;
+}
+
+/*!
+    Sets the number of \a bytes the images in memory may take up to, and
+    evicts images if they take up more.
+*/
+void QImageCache::setMaxCost(qsizetype bytes)
+{
+    QImageCachePrivate::Released released;
+    QMutexLocker locker(&d->mutex);
+    d->maxCost = bytes;
+    d->evictLocked(bytes, true, &released);
+    locker.unlock();
+    d->release(released);
+}
+
+/*!
+    Returns the number of bytes taken up by the images in memory.
+*/
+qsizetype QImageCache::totalCost() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->totalCost;
+}
+
+/*!
+    Returns the number of images in memory.
+*/
+qsizetype QImageCache::count() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->memoryIndex.size();
+}
+
+QString QImageCache::spillDirectory() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->spillDirectory;
+}
+
+/*!
+    Sets the directory evicted images are spilled to, to \a path. The
+    files are kept in a temporary directory created inside \a path, which
+    is removed along with the cache. An empty path, the default, disables
+    spilling. Images that were spilled to a previous directory are lost.
+*/
+void QImageCache::setSpillDirectory(const QString &path)
+{
+    std::shared_ptr<QTemporaryDir> spillDir;
+    if (!path.isEmpty()) {
+        QDir().mkpath(path);
+        spillDir = std::make_shared<QTemporaryDir>(
+                QDir(path).filePath(QStringLiteral("qimagecache-XXXXXX")));
+        if (!spillDir->isValid()) {
+            qWarning("QImageCache: Cannot create a spill directory in %ls: %ls",
+                     qUtf16Printable(path), qUtf16Printable(spillDir->errorString()));
+            spillDir.reset();
+        }
+    }
+
+    QMutexLocker locker(&d->mutex);
+    d->spillDirectory = path;
+    d->spillDir.swap(spillDir);
+    d->disk.clear();
+    d->diskIndex.clear();
+    d->spilling.clear();
+    d->spillSize = 0;
+    locker.unlock();
+    // The previous directory is removed along with its files here, or
+    // once the images still being written to it are.
+}
+
+qsizetype QImageCache::maxSpillSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maxSpillSize;
+}
+
+/*!
+    Sets the number of \a bytes the spill files may take up to. The
+    oldest files are deleted when they take up more. The default is
+    256 megabytes.
+*/
+void QImageCache::setMaxSpillSize(qsizetype bytes)
+{
+    QImageCachePrivate::Released released;
+    QMutexLocker locker(&d->mutex);
+    d->maxSpillSize = bytes;
+    d->trimDiskLocked(&released);
+    locker.unlock();
+    d->release(released);
+}
+
+/*!
+    Returns the number of bytes taken up by the spill files.
+*/
+qsizetype QImageCache::spillSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->spillSize;
+}
+
+/*!
+    Inserts \a image into the cache under \a key, replacing any image that
+    was cached under it, in memory or on disk. Returns \c false if the image
+    is null or larger than maxCost(), in which case it is not cached.
+*/
+bool QImageCache::insert(const QString &key, const QImage &image)
+{
+    QImageCachePrivate::Released released;
+    QMutexLocker locker(&d->mutex);
+    const bool inserted = d->insertLocked(key, image, &released);
+    locker.unlock();
+    d->release(released);
+    return inserted;
+}
+
+/*!
+    Returns the image cached under \a key, or a null image if there is
+    none. An image that was spilled to disk is read back into memory.
+
+    This does not wait for an image that another thread is producing with
+    findOrInsert(); it returns a null image instead.
+*/
+QImage QImageCache::find(const QString &key)
+{
+    QMutexLocker locker(&d->mutex);
+    QImage image = d->lookupLocked(locker, key, false);
+    if (image.isNull())
+        ++d->statistics.misses;
+    return image;
+}
+
+/*!
+    Returns the image cached under \a key. If there is none, \a produce is
+    called to create it, without holding any lock, and the image it returns
+    is inserted into the cache. While one thread produces the image, other
+    threads calling findOrInsert() or find() with the same key do not
+    produce it again: the former wait for it, and the latter miss.
+
+    If \a produce returns a null image, nothing is cached, and one of the
+    waiting threads gets to try in turn.
+*/
+QImage QImageCache::findOrInsert(const QString &key, qxp::function_ref<QImage()> produce)
+{
+    QMutexLocker locker(&d->mutex);
+    QImage image = d->lookupLocked(locker, key, true);
+    if (!image.isNull())
+        return image;
+
+    ++d->statistics.misses;
+    d->loading.insert(key);
+    locker.unlock();
+    image = produce();
+    locker.relock();
+    d->loading.remove(key);
+    d->loaded.wakeAll();
+
+    QImageCachePrivate::Released released;
+    d->insertLocked(key, image, &released);
+    locker.unlock();
+    d->release(released);
+    return image;
+}
+
+/*!
+    Returns \c true if an image is cached under \a key, in memory or on
+    disk.
+*/
+bool QImageCache::contains(const QString &key) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->memoryIndex.contains(key) || d->spilling.contains(key)
+            || d->diskIndex.contains(key);
+}
+
+/*!
+    Removes the image cached under \a key, from memory and from disk.
+    Returns \c true if there was one.
+*/
+bool QImageCache::remove(const QString &key)
+{
+    QImageCachePrivate::Released released;
+    QMutexLocker locker(&d->mutex);
+    const bool found = d->memoryIndex.contains(key) || d->spilling.contains(key)
+            || d->diskIndex.contains(key);
+    d->dropLocked(key, &released);
+    locker.unlock();
+    d->release(released);
+    return found;
+}
+
+/*!
+    Removes all images, from memory and from disk.
+*/
+void QImageCache::clear()
+{
+    QImageCachePrivate::MemoryList memory;
+    QImageCachePrivate::Released released;
+    QMutexLocker locker(&d->mutex);
+    memory.swap(d->memory);
+    d->memoryIndex.clear();
+    d->totalCost = 0;
+    for (const auto &entry : std::as_const(d->disk))
+        released.obsoleteFiles.append(entry.fileName);
+    d->disk.clear();
+    d->diskIndex.clear();
+    d->spilling.clear();
+    d->spillSize = 0;
+    if (!d->loading.isEmpty())
+        ++d->generation;
+    locker.unlock();
+    d->release(released);
+}
+
+/*!
+    Evicts the least recently used images until the images in memory take
+    up at most \a bytes, spilling them to disk if that is enabled. Returns
+    the number of bytes that were freed.
+*/
+qsizetype QImageCache::trim(qsizetype bytes)
+{
+    QImageCachePrivate::Released released;
+    QMutexLocker locker(&d->mutex);
+    const qsizetype before = d->totalCost;
+    d->evictLocked(bytes, true, &released);
+    const qsizetype freed = before - d->totalCost;
+    locker.unlock();
+    d->release(released);
+    return freed;
+}
+
+/*!
+    Frees memory according to the pressure \a level the system is under.
+*/
+void QImageCache::handleMemoryPressure(MemoryPressure level)
+{
+    QImageCachePrivate::Released released;
+    QMutexLocker locker(&d->mutex);
+    d->relieveLocked(level, &released);
+    locker.unlock();
+    d->release(released);
+}
+
+/*!
+    Calls handleMemoryPressure() with \a level on every image cache in the
+    process. This is meant to be called by the platform integration when
+    the system reports that it runs low on memory, as the iOS plugin does
+    with Critical when the application receives a memory warning.
+
+    The images are evicted from all the caches first, and only then
+    spilled to disk, so that the caches can be used, and created or
+    destroyed, while the files are written.
+*/
+void QImageCache::notifyMemoryPressure(MemoryPressure level)
+{
+    CacheRegistry *registry = cacheRegistry();
+    if (!registry)
+        return;
+
+    // A cache destroyed in the meantime keeps its private data until its
+    // images are written, and then discards the files.
+    std::vector<std::pair<std::shared_ptr<QImageCachePrivate>, QImageCachePrivate::Released>> pending;
+    {
+        QMutexLocker locker(&registry->mutex);
+        pending.reserve(registry->caches.size());
+        for (QImageCachePrivate *cache : std::as_const(registry->caches)) {
+            QImageCachePrivate::Released released;
+            QMutexLocker cacheLocker(&cache->mutex);
+            cache->relieveLocked(level, &released);
+            cacheLocker.unlock();
+            pending.emplace_back(cache->shared_from_this(), std::move(released));
+        }
+    }
+    for (auto &[cache, released] : pending)
+        cache->release(released);
+}
+
+/*!
+    Returns the number of lookups that were served from memory or from
+    disk, and that missed, along with the number of insertions, evictions
+    and images spilled to disk since the cache was created.
+*/
+QImageCache::Statistics QImageCache::statistics() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->statistics;
+}
+
+/*!
+    Returns the number of bytes \a image takes up in memory: its pixels
+    and its color table.
+*/
+qsizetype QImageCache::cost(const QImage &image)
+{
+    return image.sizeInBytes() + image.colorCount() * qsizetype(sizeof(QRgb));
+}
+
+QT_END_NAMESPACE
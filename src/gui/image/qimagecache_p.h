@@ -0,0 +1,85 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QIMAGECACHE_P_H
+#define QIMAGECACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qimage.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qxpfunctional.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QImageCachePrivate;
+
+class Q_GUI_EXPORT QImageCache
+{
+public:
+    enum class MemoryPressure {
+        Moderate,
+        Critical
+    };
+
+    struct Statistics
+    {
+        quint64 hits = 0;
+        quint64 diskHits = 0;
+        quint64 misses = 0;
+        quint64 insertions = 0;
+        quint64 evictions = 0;
+        quint64 spills = 0;
+    };
+
+    explicit QImageCache(qsizetype maxCost = qsizetype(64) << 20);
+    ~QImageCache();
+
+    qsizetype maxCost() const;
+    void setMaxCost(qsizetype bytes);
+    qsizetype totalCost() const;
+    qsizetype count() const;
+
+    QString spillDirectory() const;
+    void setSpillDirectory(const QString &path);
+    qsizetype maxSpillSize() const;
+    void setMaxSpillSize(qsizetype bytes);
+    qsizetype spillSize() const;
+
+    bool insert(const QString &key, const QImage &image);
+    QImage find(const QString &key);
+    QImage findOrInsert(const QString &key, qxp::function_ref<QImage()> produce);
+    bool contains(const QString &key) const;
+    bool remove(const QString &key);
+    void clear();
+
+    qsizetype trim(qsizetype bytes);
+    void handleMemoryPressure(MemoryPressure level);
+    static void notifyMemoryPressure(MemoryPressure level);
+
+    Statistics statistics() const;
+
+    static qsizetype cost(const QImage &image);
+
+private:
+    Q_DISABLE_COPY_MOVE(QImageCache)
+
+    // shared with notifyMemoryPressure() while it spills the evicted images
+    std::shared_ptr<QImageCachePrivate> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QIMAGECACHE_P_H
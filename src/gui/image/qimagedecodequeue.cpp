@@ -0,0 +1,338 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qimagedecodequeue_p.h"
+
+#include <qdeadlinetimer.h>
+#include <qfileinfo.h>
+#include <qhash.h>
+#include <qimagereader.h>
+#include <qmutex.h>
+#include <qpromise.h>
+#include <qthreadpool.h>
+#include <qwaitcondition.h>
+#include <private/qthreadpool_p.h>
+
+#include <algorithm>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+struct DecodeRequest
+{
+    QString fileName;
+    QIODevice *device;
+    QSize targetSize;
+    QImage::Format format;
+    int priority;
+    quint64 sequence;
+    QPromise<QImage> promise;
+};
+
+// Orders the heap of pending requests: the highest priority comes first,
+// and requests of the same priority are decoded in the order of arrival.
+bool decodesLater(const std::unique_ptr<DecodeRequest> &a, const std::unique_ptr<DecodeRequest> &b)
+{
+    if (a->priority != b->priority)
+        return a->priority < b->priority;
+    return a->sequence > b->sequence;
+}
+
+} // unnamed namespace
+
+class QImageDecodeQueuePrivate
+{
+public:
+    QFuture<QImage> enqueue(std::unique_ptr<DecodeRequest> request);
+    void run();
+    QImage decode(DecodeRequest *request);
+    void reserveMemory(qsizetype bytes);
+    void releaseMemory(qsizetype bytes);
+
+    QThreadPool *pool = nullptr;
+    int maxThreadCount = 0;
+    qsizetype memoryBudget = qsizetype(256) << 20;
+
+    mutable QMutex mutex;
+    QWaitCondition memoryReleased;
+    QWaitCondition done;
+    std::vector<std::unique_ptr<DecodeRequest>> pending;
+    QHash<QString, QByteArray> formatForSuffix;
+    quint64 nextSequence = 0;
+    int runnerCount = 0;
+    qsizetype memoryInUse = 0;
+};
+
+QFuture<QImage> QImageDecodeQueuePrivate::enqueue(std::unique_ptr<DecodeRequest> request)
+{
+    QFuture<QImage> future = request->promise.future();
+    request->promise.start();
+
+    QMutexLocker locker(&mutex);
+    request->sequence = nextSequence++;
+    pending.push_back(std::move(request));
+    std::push_heap(pending.begin(), pending.end(), decodesLater);
+    if (runnerCount < maxThreadCount) {
+        ++runnerCount;
+        locker.unlock();
+        pool->start([this] { run(); });
+    }
+    return future;
+}
+
+void QImageDecodeQueuePrivate::run()
+{
+    QMutexLocker locker(&mutex);
+    while (!pending.empty()) {
+        std::pop_heap(pending.begin(), pending.end(), decodesLater);
+        std::unique_ptr<DecodeRequest> request = std::move(pending.back());
+        pending.pop_back();
+        locker.unlock();
+
+        // A request whose future was canceled before it got its turn is
+        // dropped without being decoded.
+        if (!request->promise.isCanceled())
+            request->promise.addResult(decode(request.get()));
+        request->promise.finish();
+        request.reset();
+
+        locker.relock();
+    }
+    if (--runnerCount == 0)
+        done.wakeAll();
+}
+
+QImage QImageDecodeQueuePrivate::decode(DecodeRequest *request)
+{
+    QImageReader reader;
+    QString suffix;
+    if (request->device) {
+        reader.setDevice(request->device);
+    } else {
+        // Probing the contents against every plugin is only done for the
+        // first file with a given suffix. The following ones go straight
+        // to the plugin that read it, and are still probed if it fails.
+        suffix = QFileInfo(request->fileName).suffix().toLower();
+        QMutexLocker locker(&mutex);
+        const QByteArray format = formatForSuffix.value(suffix);
+        locker.unlock();
+        reader.setFileName(request->fileName);
+        reader.setFormat(format);
+    }
+
+    const QSize imageSize = reader.size();
+    QSize size = imageSize;
+    if (request->targetSize.isValid() && size.isValid()
+        && (size.width() > request->targetSize.width()
+            || size.height() > request->targetSize.height())) {
+        size.scale(request->targetSize, Qt::KeepAspectRatio);
+        reader.setScaledSize(size.expandedTo(QSize(1, 1)));
+    }
+
+    // Decoding waits while the images being decoded by other threads
+    // would, together with this one, exceed the memory budget. Handlers
+    // that cannot decode at a smaller size decode the whole image, which
+    // QImageReader scales afterwards.
+    if (!reader.supportsOption(QImageIOHandler::ScaledSize))
+        size = imageSize;
+    const QImage::Format imageFormat = reader.imageFormat();
+    const int depth = imageFormat == QImage::Format_Invalid
+            ? 32 : qMax(QImage::toPixelFormat(imageFormat).bitsPerPixel(), 8u);
+    const qsizetype bytes = size.isValid() ? qsizetype(size.width()) * size.height() * depth / 8 : 0;
+    reserveMemory(bytes);
+
+    QImage image;
+    const bool success = !request->promise.isCanceled() && reader.read(&image);
+    releaseMemory(bytes);
+    if (!success)
+        return QImage();
+
+    if (!suffix.isEmpty()) {
+        QMutexLocker locker(&mutex);
+        formatForSuffix.insert(suffix, reader.format());
+    }
+    if (request->format != QImage::Format_Invalid)
+        image.convertTo(request->format);
+    return image;
+}
+
+void QImageDecodeQueuePrivate::reserveMemory(qsizetype bytes)
+{
+    QMutexLocker locker(&mutex);
+    // An image larger than the whole budget is still decoded, on its own.
+    while (memoryInUse > 0 && memoryInUse + bytes > memoryBudget)
+        memoryReleased.wait(&mutex);
+    memoryInUse += bytes;
+}
+
+void QImageDecodeQueuePrivate::releaseMemory(qsizetype bytes)
+{
+    QMutexLocker locker(&mutex);
+    memoryInUse -= bytes;
+    memoryReleased.wakeAll();
+}
+
+/*!
+    \internal
+    \class QImageDecodeQueue
+    \inmodule QtGui
+
+    QImageDecodeQueue decodes images with QImageReader on the threads of a
+    thread pool, and delivers them through QFuture. It is meant for views
+    that load many images at once, like a gallery of thumbnails.
+
+    Each request can ask for the image to fit in a target size, in which
+    case the image handler is asked to scale while decoding, and for the
+    image to be converted to a given format. Pending requests are decoded
+    highest priority first, so that visible items can be given precedence
+    over the ones scrolled out of view. Canceling the future of a request
+    that has not started yet drops it.
+
+    The image format of a file is only probed for the first file with a
+    given suffix; the format that was found is tried first for the
+    following ones. The number of images decoded at the same time is
+    bounded by maxThreadCount() and by memoryBudget().
+*/
+
+/*!
+    Constructs a decode queue that runs on \a pool. If \a pool is
+    \nullptr, the thread pool shared by Qt GUI is used.
+*/
+QImageDecodeQueue::QImageDecodeQueue(QThreadPool *pool)
+    : d(new QImageDecodeQueuePrivate)
+{
+    d->pool = pool ? pool : QThreadPoolPrivate::qtGuiInstance();
+    if (!d->pool)
+        d->pool = QThreadPool::globalInstance();
+    d->maxThreadCount = d->pool->maxThreadCount();
+}
+
+/*!
+    Destroys the queue. Requests that have not started are canceled, and
+    the destructor waits for the ones being decoded.
+*/
+QImageDecodeQueue::~QImageDecodeQueue()
+{
+    clear();
+    waitForDone();
+}
+
+/*!
+    Returns the thread pool the images are decoded on.
+*/
+QThreadPool *QImageDecodeQueue::threadPool() const
+{
+    return d->pool;
+}
+
+/*!
+    Sets the maximum number of images that are decoded at the same time
+    to \a count. The default is the maximum thread count of threadPool().
+*/
+void QImageDecodeQueue::setMaxThreadCount(int count)
+{
+    QMutexLocker locker(&d->mutex);
+    d->maxThreadCount = qMax(count, 1);
+}
+
+int QImageDecodeQueue::maxThreadCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maxThreadCount;
+}
+
+/*!
+    Sets the number of \a bytes the images being decoded at the same time
+    may take up to. The size of an image is estimated from its header
+    before it is decoded. An image that is larger than the budget on its
+    own is decoded when no other image is. The default is 256 megabytes.
+
+    The images that have been delivered do not count against the budget.
+*/
+void QImageDecodeQueue::setMemoryBudget(qsizetype bytes)
+{
+    QMutexLocker locker(&d->mutex);
+    d->memoryBudget = bytes;
+    d->memoryReleased.wakeAll();
+}
+
+qsizetype QImageDecodeQueue::memoryBudget() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->memoryBudget;
+}
+
+/*!
+    Queues the image file \a fileName to be decoded, and returns the future
+    that will hold the image. If \a targetSize is valid, the image is
+    scaled down to fit in it, keeping its aspect ratio. If \a format is
+    not QImage::Format_Invalid, the image is converted to it. Requests of
+    higher \a priority are decoded first.
+
+    The future holds a null image if the file could not be read.
+*/
+QFuture<QImage> QImageDecodeQueue::decode(const QString &fileName, QSize targetSize,
+                                          QImage::Format format, int priority)
+{
+    return d->enqueue(std::unique_ptr<DecodeRequest>(
+            new DecodeRequest{ fileName, nullptr, targetSize, format, priority, 0, {} }));
+}
+
+/*!
+    \overload
+
+    Queues the image to be read from \a device. The device is not owned by
+    the queue, and must stay valid until the future has finished. It is only
+    accessed from the thread decoding it.
+*/
+QFuture<QImage> QImageDecodeQueue::decode(QIODevice *device, QSize targetSize,
+                                          QImage::Format format, int priority)
+{
+    return d->enqueue(std::unique_ptr<DecodeRequest>(
+            new DecodeRequest{ QString(), device, targetSize, format, priority, 0, {} }));
+}
+
+/*!
+    Returns the number of requests that have not started to decode.
+*/
+qsizetype QImageDecodeQueue::pendingCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return qsizetype(d->pending.size());
+}
+
+/*!
+    Cancels all requests that have not started to decode. Images being
+    decoded are still delivered.
+*/
+void QImageDecodeQueue::clear()
+{
+    std::vector<std::unique_ptr<DecodeRequest>> canceled;
+    {
+        QMutexLocker locker(&d->mutex);
+        canceled.swap(d->pending);
+    }
+    for (const auto &request : canceled) {
+        request->promise.future().cancel();
+        request->promise.finish();
+    }
+}
+
+/*!
+    Waits up to \a msecs milliseconds, or forever if \a msecs is -1, for
+    all requests to be decoded. Returns \c true if the queue is idle.
+*/
+bool QImageDecodeQueue::waitForDone(int msecs)
+{
+    QDeadlineTimer deadline(msecs);
+    QMutexLocker locker(&d->mutex);
+    while (d->runnerCount > 0) {
+        if (!d->done.wait(&d->mutex, deadline))
+            return false;
+    }
+    return true;
+}
+
+QT_END_NAMESPACE
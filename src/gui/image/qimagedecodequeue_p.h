@@ -0,0 +1,64 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QIMAGEDECODEQUEUE_P_H
+#define QIMAGEDECODEQUEUE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qimage.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qsize.h>
+
+#include <memory>
+
+QT_REQUIRE_CONFIG(future);
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+class QThreadPool;
+class QImageDecodeQueuePrivate;
+
+class Q_GUI_EXPORT QImageDecodeQueue
+{
+public:
+    explicit QImageDecodeQueue(QThreadPool *pool = nullptr);
+    ~QImageDecodeQueue();
+
+    QThreadPool *threadPool() const;
+
+    void setMaxThreadCount(int count);
+    int maxThreadCount() const;
+
+    void setMemoryBudget(qsizetype bytes);
+    qsizetype memoryBudget() const;
+
+    QFuture<QImage> decode(const QString &fileName, QSize targetSize = QSize(),
+                           QImage::Format format = QImage::Format_Invalid, int priority = 0);
+    QFuture<QImage> decode(QIODevice *device, QSize targetSize = QSize(),
+                           QImage::Format format = QImage::Format_Invalid, int priority = 0);
+
+    qsizetype pendingCount() const;
+    void clear();
+    bool waitForDone(int msecs = -1);
+
+private:
+    Q_DISABLE_COPY_MOVE(QImageDecodeQueue)
+
+    std::unique_ptr<QImageDecodeQueuePrivate> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QIMAGEDECODEQUEUE_P_H
@@ -225,6 +225,7 @@
 */
 
 #include "qimageiohandler.h"
+#include "qimageiohandler_p.h"
 #include "qimage_p.h"
 
 #include <qbytearray.h>
@@ -236,21 +237,6 @@ QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(lcImageIo, "qt.gui.imageio")
 
-class QIODevice;
-
-class QImageIOHandlerPrivate
-{
-    Q_DECLARE_PUBLIC(QImageIOHandler)
-public:
-    QImageIOHandlerPrivate(QImageIOHandler *q);
-    virtual ~QImageIOHandlerPrivate();
-
-    QIODevice *device;
-    mutable QByteArray format;
-
-    QImageIOHandler *q_ptr;
-};
-
 QImageIOHandlerPrivate::QImageIOHandlerPrivate(QImageIOHandler *q)
 {
     device = nullptr;
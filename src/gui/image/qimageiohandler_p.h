@@ -0,0 +1,56 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QIMAGEIOHANDLER_P_H
+#define QIMAGEIOHANDLER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qimageiohandler.h>
+#include <QtCore/qbytearray.h>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+
+class Q_GUI_EXPORT QImageIOHandlerPrivate
+{
+    Q_DECLARE_PUBLIC(QImageIOHandler)
+public:
+    // Called by handlers that decode row by row, once the scan lines
+    // [firstLine, firstLine + lineCount) of image hold their final pixels.
+    // Returning false stops the decoding, and read() then fails.
+    using ScanLineCallback = std::function<bool(const QImage &image, int firstLine, int lineCount)>;
+
+    QImageIOHandlerPrivate(QImageIOHandler *q);
+    virtual ~QImageIOHandlerPrivate();
+
+    static QImageIOHandlerPrivate *get(QImageIOHandler *handler) { return handler->d_func(); }
+
+    bool reportScanLines(const QImage &image, int firstLine, int lineCount) const
+    {
+        return !scanLineCallback || scanLineCallback(image, firstLine, lineCount);
+    }
+
+    QIODevice *device;
+    mutable QByteArray format;
+    ScanLineCallback scanLineCallback;
+
+    QImageIOHandler *q_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QIMAGEIOHANDLER_P_H
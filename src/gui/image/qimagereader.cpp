@@ -95,6 +95,7 @@
     QImageReader.
 */
 #include "qimagereader.h"
+#include "qimagereader_p.h"
 
 #include <qbytearray.h>
 #ifdef QIMAGEREADER_DEBUG
@@ -426,43 +427,6 @@ static QImageIOHandler *createReadHandlerHelper(QIODevice *device,
     return handler;
 }
 
-class QImageReaderPrivate
-{
-public:
-    QImageReaderPrivate(QImageReader *qq);
-    ~QImageReaderPrivate();
-
-    // device
-    QByteArray format;
-    bool autoDetectImageFormat;
-    bool ignoresFormatAndExtension;
-    QIODevice *device;
-    bool deleteDevice;
-    QImageIOHandler *handler;
-    bool initHandler();
-
-    // image options
-    QRect clipRect;
-    QSize scaledSize;
-    QRect scaledClipRect;
-    int quality;
-    QMap<QString, QString> text;
-    void getText();
-    enum {
-        UsePluginDefault,
-        ApplyTransform,
-        DoNotApplyTransform
-    } autoTransform;
-
-    // error
-    QImageReader::ImageReaderError imageReaderError;
-    QString errorString;
-
-    QImageReader *q;
-
-    static int maxAlloc;
-};
-
 int QImageReaderPrivate::maxAlloc = 256; // 256 MB is enough for an 8K 64bpp image
 
 /*!
@@ -563,6 +527,49 @@ void QImageReaderPrivate::getText()
         text = qt_getImageTextFromDescription(handler->option(QImageIOHandler::Description).toString());
 }
 
+// the innermost scope of the current thread
+Q_CONSTINIT static thread_local QImageReaderScanLineScope *currentScanLineScope = nullptr;
+
+/*!
+    \internal
+    \class QImageReaderScanLineScope
+    \inmodule QtGui
+
+    QImageReaderScanLineScope has the handlers that stream their rows report
+    them to a callback, while one QImageReader reads images on the current
+    thread, for as long as the scope exists. QImageReader keeps its private
+    data to itself, so the callback is handed over through the reading
+    thread.
+*/
+QImageReaderScanLineScope::QImageReaderScanLineScope(const QImageReader *reader,
+                                                     QImageIOHandlerPrivate::ScanLineCallback callback)
+    : reader(reader), callback(std::move(callback)), previous(currentScanLineScope)
+{
+    currentScanLineScope = this;
+}
+
+QImageReaderScanLineScope::~QImageReaderScanLineScope()
+{
+    Q_ASSERT(currentScanLineScope == this);
+    currentScanLineScope = previous;
+}
+
+/*!
+    \internal
+    Returns the callback of the innermost scope for \a reader on the
+    current thread, or an empty callback if there is none.
+*/
+QImageIOHandlerPrivate::ScanLineCallback
+QImageReaderScanLineScope::callbackFor(const QImageReader *reader)
+{
+    for (const QImageReaderScanLineScope *scope = currentScanLineScope; scope;
+         scope = scope->previous) {
+        if (scope->reader == reader)
+            return scope->callback;
+    }
+    return {};
+}
+
 /*!
     Constructs an empty QImageReader object. Before reading an image,
     call setDevice() or setFileName().
@@ -1201,6 +1208,8 @@ bool QImageReader::read(QImage *image)
         d->handler->setOption(QImageIOHandler::ScaledClipRect, d->scaledClipRect);
     if (supportsOption(QImageIOHandler::Quality))
         d->handler->setOption(QImageIOHandler::Quality, d->quality);
+    QImageIOHandlerPrivate::get(d->handler)->scanLineCallback =
+            QImageReaderScanLineScope::callbackFor(this);
 
     // read the image
     QString filename = fileName();
@@ -0,0 +1,87 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QIMAGEREADER_P_H
+#define QIMAGEREADER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/private/qimageiohandler_p.h>
+#include <QtGui/qimagereader.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qrect.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q_GUI_EXPORT QImageReaderPrivate
+{
+public:
+    QImageReaderPrivate(QImageReader *qq);
+    ~QImageReaderPrivate();
+
+    // device
+    QByteArray format;
+    bool autoDetectImageFormat;
+    bool ignoresFormatAndExtension;
+    QIODevice *device;
+    bool deleteDevice;
+    QImageIOHandler *handler;
+    bool initHandler();
+
+    // image options
+    QRect clipRect;
+    QSize scaledSize;
+    QRect scaledClipRect;
+    int quality;
+    QMap<QString, QString> text;
+    void getText();
+    enum {
+        UsePluginDefault,
+        ApplyTransform,
+        DoNotApplyTransform
+    } autoTransform;
+
+    // error
+    QImageReader::ImageReaderError imageReaderError;
+    QString errorString;
+
+    QImageReader *q;
+
+    static int maxAlloc;
+};
+
+// Passes a scan line callback to the handlers that stream their rows, see
+// QImageIOHandlerPrivate, for the reads of one reader on the current thread
+// while the object exists. The rows are reported as the handler produces
+// them, that is before QImageReader applies the options the handler does
+// not support itself, or the image transformation.
+class Q_GUI_EXPORT QImageReaderScanLineScope
+{
+public:
+    QImageReaderScanLineScope(const QImageReader *reader,
+                              QImageIOHandlerPrivate::ScanLineCallback callback);
+    ~QImageReaderScanLineScope();
+
+    static QImageIOHandlerPrivate::ScanLineCallback callbackFor(const QImageReader *reader);
+
+private:
+    Q_DISABLE_COPY_MOVE(QImageReaderScanLineScope)
+
+    const QImageReader *reader;
+    QImageIOHandlerPrivate::ScanLineCallback callback;
+    QImageReaderScanLineScope *previous;
+};
+
+QT_END_NAMESPACE
+
+#endif // QIMAGEREADER_P_H
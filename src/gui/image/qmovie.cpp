@@ -98,8 +98,13 @@
 /*! \fn void QMovie::updated(const QRect &rect)
 
     This signal is emitted when the rect \a rect in the current frame has been
-    updated. You can call currentImage() or currentPixmap() to get a copy of the
-    updated frame.
+    updated. You can call currentImage() or currentPixmap() to get a copy of
+    the updated frame.
+
+    With QMovie::CacheAll, when a frame only differs from the previous one in
+    part, \a rect covers just that part, and the signal is not emitted for a
+    frame that equals the previous one. Otherwise \a rect covers the whole
+    frame.
 */
 
 /*! \fn void QMovie::frameChanged(int frameNumber)
@@ -148,9 +153,12 @@
 #include "qbuffer.h"
 #include "qdir.h"
 #include "qloggingcategory.h"
+#include "qcolorspace.h"
 #include "private/qobject_p.h"
 #include "private/qproperty_p.h"
 
+#include <optional>
+
 #define QMOVIE_INVALID_DELAY -1
 
 QT_BEGIN_NAMESPACE
@@ -161,6 +169,8 @@ class QFrameInfo
 {
 public:
     QPixmap pixmap;
+    // the part that differs from the previously returned frame, if known
+    std::optional<QRect> changedRect;
     int delay;
     bool endMark;
     inline QFrameInfo(bool endMark)
@@ -188,6 +198,291 @@ public:
 };
 Q_DECLARE_TYPEINFO(QFrameInfo, Q_RELOCATABLE_TYPE);
 
+/*!
+    \internal
+
+    Holds the frames of a movie in QMovie::CacheAll mode.
+
+    Frames are stored compressed. Every KeyFrameInterval-th frame, and
+    every frame whose size, format or color table differs from the
+    previous one, is stored whole; the others only store the rectangle in
+    which they differ from the previous frame, and are composed onto it
+    when played back. Frames are also kept as pixmaps for as long as those
+    fit into \c pixmapBudget bytes, so that small animations play without
+    decompressing anything.
+*/
+class QMovieFrameCache
+{
+public:
+    explicit QMovieFrameCache(qsizetype pixmapBudget) : pixmapBudget(pixmapBudget) { }
+
+    void clear();
+    QFrameInfo append(int frameNumber, QImage &&image, int delay);
+    QFrameInfo frame(int frameNumber);
+
+    static QRect changedRect(const QImage &previous, const QImage &image);
+
+private:
+    static constexpr int KeyFrameInterval = 16;
+
+    struct Frame
+    {
+        QByteArray pixels; // the rows of rect, compressed
+        QRect rect;
+        QSize size;
+        QImage::Format format = QImage::Format_Invalid;
+        QList<QRgb> colorTable;
+        qreal devicePixelRatio = 1;
+        QColorSpace colorSpace;
+        QPixmap pixmap;
+        int delay = QMOVIE_INVALID_DELAY;
+        bool keyFrame = true;
+    };
+
+    static bool sameLayout(const QImage &a, const QImage &b);
+    static QByteArray compress(const QImage &image, const QRect &rect);
+    static bool uncompress(const QByteArray &pixels, const QRect &rect, QImage *image);
+    QImage restore(int index);
+    void keepPixmap(Frame &frame, const QPixmap &pixmap, qsizetype bytes);
+
+    QList<Frame> frames;
+    int firstFrameNumber = 0;
+    // the most recently appended frame
+    QImage tail;
+    // the most recently appended or restored frame, and its index
+    QImage last;
+    int lastIndex = -1;
+    qsizetype pixmapBudget;
+    qsizetype pixmapBytes = 0;
+};
+
+void QMovieFrameCache::clear()
+{
+    frames.clear();
+    firstFrameNumber = 0;
+    tail = QImage();
+    last = QImage();
+    lastIndex = -1;
+    pixmapBytes = 0;
+}
+
+bool QMovieFrameCache::sameLayout(const QImage &a, const QImage &b)
+{
+    return a.size() == b.size() && a.format() == b.format()
+        && a.colorTable() == b.colorTable()
+        && a.devicePixelRatio() == b.devicePixelRatio()
+        && a.colorSpace() == b.colorSpace();
+}
+
+/*!
+    \internal
+
+    Returns the smallest rectangle outside of which \a image equals \a
+    previous; this is an empty rectangle if the two are equal. If the two
+    images can not be compared pixel by pixel, the rectangle of \a image
+    is returned.
+*/
+QRect QMovieFrameCache::changedRect(const QImage &previous, const QImage &image)
+{
+    if (image.depth() < 8 || !sameLayout(previous, image))
+        return image.rect();
+
+    const int width = image.width();
+    const int height = image.height();
+    const int bpp = image.depth() / 8;
+    const size_t rowBytes = size_t(width) * bpp;
+    const auto rowChanged = [&](int y) {
+        return memcmp(previous.constScanLine(y), image.constScanLine(y), rowBytes) != 0;
+    };
+
+    int top = 0;
+    while (top < height && !rowChanged(top))
+        ++top;
+    if (top == height)
+        return QRect();
+    int bottom = height - 1;
+    while (bottom > top && !rowChanged(bottom))
+        --bottom;
+
+    // only look at the columns that are not known to have changed yet
+    int left = width;
+    int right = -1;
+    for (int y = top; y <= bottom; ++y) {
+        const uchar *a = previous.constScanLine(y);
+        const uchar *b = image.constScanLine(y);
+        int x = 0;
+        while (x < left && memcmp(a + x * bpp, b + x * bpp, bpp) == 0)
+            ++x;
+        left = x < left ? x : left;
+        x = width - 1;
+        while (x > right && memcmp(a + x * bpp, b + x * bpp, bpp) == 0)
+            --x;
+        right = x > right ? x : right;
+    }
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+QByteArray QMovieFrameCache::compress(const QImage &image, const QRect &rect)
+{
+    if (rect.isEmpty())
+        return QByteArray();
+    if (rect == image.rect())
+        return qCompress(image.constBits(), image.sizeInBytes(), 1);
+
+    // only delta frames are stored in parts, and those have a depth of 8 or more
+    const qsizetype rowBytes = qsizetype(rect.width()) * (image.depth() / 8);
+    const qsizetype offset = qsizetype(rect.x()) * (image.depth() / 8);
+    QByteArray rows(rowBytes * rect.height(), Qt::Uninitialized);
+    char *dst = rows.data();
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        memcpy(dst, image.constScanLine(y) + offset, rowBytes);
+        dst += rowBytes;
+    }
+    return qCompress(rows, 1);
+}
+
+bool QMovieFrameCache::uncompress(const QByteArray &pixels, const QRect &rect, QImage *image)
+{
+    if (rect.isEmpty())
+        return true;
+    const QByteArray rows = qUncompress(pixels);
+    if (rect == image->rect()) {
+        if (rows.size() != image->sizeInBytes())
+            return false;
+        memcpy(image->bits(), rows.constData(), rows.size());
+        return true;
+    }
+
+    const qsizetype rowBytes = qsizetype(rect.width()) * (image->depth() / 8);
+    const qsizetype offset = qsizetype(rect.x()) * (image->depth() / 8);
+    if (rows.size() != rowBytes * rect.height())
+        return false;
+    const char *src = rows.constData();
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        memcpy(image->scanLine(y) + offset, src, rowBytes);
+        src += rowBytes;
+    }
+    return true;
+}
+
+void QMovieFrameCache::keepPixmap(Frame &frame, const QPixmap &pixmap, qsizetype bytes)
+{
+    if (pixmapBytes + bytes > pixmapBudget)
+        return;
+    frame.pixmap = pixmap;
+    pixmapBytes += bytes;
+}
+
+/*!
+    \internal
+
+    Stores \a image as the frame \a frameNumber of the movie, to be shown
+    for \a delay milliseconds, and returns it. Frames are expected in
+    order; if \a frameNumber does not follow the last stored frame, the
+    frames stored so far are dropped.
+*/
+QFrameInfo QMovieFrameCache::append(int frameNumber, QImage &&image, int delay)
+{
+    if (frames.isEmpty() || frameNumber != firstFrameNumber + frames.size()) {
+        clear();
+        firstFrameNumber = frameNumber;
+    }
+
+    Frame frame;
+    frame.delay = delay;
+    frame.size = image.size();
+    frame.format = image.format();
+    frame.colorTable = image.colorTable();
+    frame.devicePixelRatio = image.devicePixelRatio();
+    frame.colorSpace = image.colorSpace();
+
+    std::optional<QRect> changed;
+    if (!frames.isEmpty())
+        changed = changedRect(tail, image);
+    frame.keyFrame = !changed || *changed == image.rect()
+            || frames.size() % KeyFrameInterval == 0;
+    frame.rect = frame.keyFrame ? image.rect() : *changed;
+    frame.pixels = compress(image, frame.rect);
+
+    QFrameInfo info(QPixmap::fromImage(image), delay);
+    info.changedRect = changed;
+    keepPixmap(frame, info.pixmap, image.sizeInBytes());
+    frames.append(std::move(frame));
+    tail = std::move(image);
+    last = tail;
+    lastIndex = int(frames.size()) - 1;
+    return info;
+}
+
+/*!
+    \internal
+
+    Returns the frame at \a index, composing it from the closest
+    preceding key frame if necessary.
+*/
+QImage QMovieFrameCache::restore(int index)
+{
+    int keyFrame = index;
+    while (!frames.at(keyFrame).keyFrame)
+        --keyFrame;
+
+    QImage image;
+    int from;
+    if (lastIndex >= keyFrame && lastIndex <= index) {
+        image = last;
+        from = lastIndex + 1;
+    } else {
+        const Frame &key = frames.at(keyFrame);
+        image = QImage(key.size, key.format);
+        if (image.isNull())
+            return QImage();
+        image.setColorTable(key.colorTable);
+        image.setDevicePixelRatio(key.devicePixelRatio);
+        image.setColorSpace(key.colorSpace);
+        if (!uncompress(key.pixels, key.rect, &image))
+            return QImage();
+        from = keyFrame + 1;
+    }
+    for (int i = from; i <= index; ++i) {
+        if (!uncompress(frames.at(i).pixels, frames.at(i).rect, &image))
+            return QImage();
+    }
+
+    last = image;
+    lastIndex = index;
+    return image;
+}
+
+/*!
+    \internal
+
+    Returns the info for the stored frame \a frameNumber, or an invalid
+    QFrameInfo if there is no such frame.
+*/
+QFrameInfo QMovieFrameCache::frame(int frameNumber)
+{
+    const qsizetype index = qsizetype(frameNumber) - firstFrameNumber;
+    if (index < 0 || index >= frames.size())
+        return QFrameInfo(); // Invalid
+
+    Frame &frame = frames[index];
+    QFrameInfo info;
+    info.delay = frame.delay;
+    if (!frame.pixmap.isNull()) {
+        info.pixmap = frame.pixmap;
+    } else {
+        QImage image = restore(int(index));
+        if (image.isNull())
+            return QFrameInfo(); // Invalid
+        const qsizetype bytes = image.sizeInBytes();
+        info.pixmap = QPixmap::fromImage(std::move(image));
+        keepPixmap(frame, info.pixmap, bytes);
+    }
+    if (!frame.keyFrame)
+        info.changedRect = frame.rect;
+    return info;
+}
+
 class QMoviePrivate : public QObjectPrivate
 {
     Q_DECLARE_PUBLIC(QMovie)
@@ -220,6 +515,8 @@ public:
 
     QMovie::MovieState movieState = QMovie::NotRunning;
     QRect frameRect;
+    // the part of currentPixmap that differs from the previous frame
+    QRect changedRect;
     QPixmap currentPixmap;
     int currentFrameNumber = -1;
     int nextFrameNumber = 0;
@@ -231,15 +528,31 @@ public:
                                          QMovie::CacheNone)
     bool haveReadAll = false;
     bool isFirstIteration = true;
-    QMap<int, QFrameInfo> frameMap;
+    QMovieFrameCache frameCache;
     QString absoluteFilePath;
 
     QTimer nextImageTimer;
 };
 
+/*!
+    \internal
+
+    Returns how many bytes of decoded frames QMovie::CacheAll keeps as
+    pixmaps; the remaining frames are only kept compressed. The limit is
+    32 MB, unless the \c QT_MOVIE_CACHE_LIMIT environment variable sets
+    another value in megabytes.
+*/
+static qsizetype cachedPixmapsLimit()
+{
+    bool ok = false;
+    const int megabytes = qEnvironmentVariableIntValue("QT_MOVIE_CACHE_LIMIT", &ok);
+    return qsizetype(ok && megabytes >= 0 ? megabytes : 32) << 20;
+}
+
 /*! \internal
  */
 QMoviePrivate::QMoviePrivate(QMovie *qq)
+    : frameCache(cachedPixmapsLimit())
 {
     q_ptr = qq;
     nextImageTimer.setSingleShot(true);
@@ -259,7 +572,7 @@ void QMoviePrivate::reset()
     playCounter = -1;
     haveReadAll = false;
     isFirstIteration = true;
-    frameMap.clear();
+    frameCache.clear();
 }
 
 /*! \internal
@@ -362,6 +675,7 @@ QFrameInfo QMoviePrivate::infoForFrame(int frameNumber)
             }
             if (frameNumber > greatestFrameNumber)
                 greatestFrameNumber = frameNumber;
+            // no previous frame is kept to compare with, so all of it changed
             return QFrameInfo(QPixmap::fromImage(std::move(anImage)), nextFrameDelay());
         } else if (frameNumber != 0) {
             // We've read all frames now. Return an end marker
@@ -390,10 +704,11 @@ QFrameInfo QMoviePrivate::infoForFrame(int frameNumber)
                     return QFrameInfo(); // Invalid
                 }
                 greatestFrameNumber = i;
-                QFrameInfo info(QPixmap::fromImage(std::move(anImage)), nextFrameDelay());
                 // Cache it!
-                frameMap.insert(i, info);
+                QFrameInfo info = frameCache.append(i, std::move(anImage), nextFrameDelay());
                 if (i == frameNumber) {
+                    if (frameNumber != currentFrameNumber + 1)
+                        info.changedRect.reset();
                     return info;
                 }
             } else {
@@ -404,7 +719,10 @@ QFrameInfo QMoviePrivate::infoForFrame(int frameNumber)
         }
     }
     // Return info for requested (cached) frame
-    return frameMap.value(frameNumber);
+    QFrameInfo info = frameCache.frame(frameNumber);
+    if (frameNumber != currentFrameNumber + 1)
+        info.changedRect.reset();
+    return info;
 }
 
 /*!
@@ -449,6 +767,11 @@ bool QMoviePrivate::next()
     // Image and delay OK, update internal state
     currentFrameNumber = nextFrameNumber++;
     currentPixmap = info.pixmap;
+    // updated() reports device pixels, which only match for a ratio of 1
+    if (info.changedRect && currentPixmap.devicePixelRatio() == 1)
+        changedRect = *info.changedRect;
+    else
+        changedRect = currentPixmap.rect();
 
     if (!speed)
         return true;
@@ -481,10 +804,13 @@ void QMoviePrivate::_q_loadNextFrame(bool starting)
 
         if (frameRect.size() != currentPixmap.rect().size()) {
             frameRect = currentPixmap.rect();
+            changedRect = frameRect;
             emit q->resized(frameRect.size());
         }
 
-        emit q->updated(frameRect);
+        // nothing to repaint for a frame that equals the previous one
+        if (!changedRect.isEmpty())
+            emit q->updated(changedRect);
         emit q->frameChanged(currentFrameNumber);
 
         if (speed && movieState == QMovie::Running)
@@ -1030,6 +1356,12 @@ QList<QByteArray> QMovie::supportedFormats()
     frames, at the added memory cost of keeping the frames in memory for the
     lifetime of the object.
 
+    Cached frames are kept compressed, storing for most frames only the part
+    that differs from the previous frame. Up to 32 MB of frames are also kept
+    decoded, so that small animations play back without decompressing them;
+    the \c QT_MOVIE_CACHE_LIMIT environment variable sets another limit, in
+    megabytes.
+
     By default, this property is set to \l CacheNone.
 
     \sa QMovie::CacheMode
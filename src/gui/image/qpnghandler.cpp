@@ -13,12 +13,23 @@
 #include <qvariant.h>
 
 #include <private/qimage_p.h> // for qt_getImageText
+#include <private/qimageiohandler_p.h>
 
 #include <qcolorspace.h>
+#include <qvarlengtharray.h>
 #include <private/qcolorspace_p.h>
+#if QT_CONFIG(thread)
+#include <qsemaphore.h>
+#include <qthreadpool.h>
+#include <private/qthreadpool_p.h>
+#endif
 
 #include <png.h>
 #include <pngconf.h>
+#include <zlib.h>
+
+#include <atomic>
+#include <vector>
 
 #if PNG_LIBPNG_VER >= 10400 && PNG_LIBPNG_VER <= 10502 \
         && defined(PNG_PEDANTIC_WARNINGS_SUPPORTED)
@@ -77,7 +88,8 @@ public:
 
     QPngHandlerPrivate(QPngHandler *qq)
         : gamma(0.0), fileGamma(0.0), quality(50), compression(50), colorSpaceState(Undefined),
-          png_ptr(nullptr), info_ptr(nullptr), end_info(nullptr), row_pointers(nullptr), state(Ready), q(qq)
+          png_ptr(nullptr), info_ptr(nullptr), end_info(nullptr), row_pointers(nullptr),
+          row_buffer(nullptr), state(Ready), q(qq)
     { }
 
     float gamma;
@@ -88,14 +100,18 @@ public:
     QStringList readTexts;
     QColorSpace colorSpace;
     ColorSpaceState colorSpaceState;
+    QRect clipRect;
 
     png_struct *png_ptr;
     png_info *info_ptr;
     png_info *end_info;
     png_byte **row_pointers;
+    png_byte *row_buffer;
 
     bool readPngHeader();
     bool readPngImage(QImage *image);
+    bool readPngRows(QImage *image, const QRect &clip, bool *readAll);
+    void cleanupRead();
     void readPngTexts(png_info *info);
 
     QImage::Format readImageFormat();
@@ -183,7 +199,7 @@ void qpiw_flush_fn(png_structp /* png_ptr */)
 }
 
 static
-bool setup_qt(QImage& image, png_structp png_ptr, png_infop info_ptr)
+bool setup_qt(QImage& image, png_structp png_ptr, png_infop info_ptr, QSize size)
 {
     png_uint_32 width = 0;
     png_uint_32 height = 0;
@@ -195,7 +211,6 @@ bool setup_qt(QImage& image, png_structp png_ptr, png_infop info_ptr)
     png_colorp palette = nullptr;
     int num_palette;
     png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
-    QSize size(width, height);
     png_set_interlace_handling(png_ptr);
 
     if (color_type == PNG_COLOR_TYPE_GRAY) {
@@ -271,7 +286,6 @@ bool setup_qt(QImage& image, png_structp png_ptr, png_infop info_ptr)
             png_set_packing(png_ptr);
         png_read_update_info(png_ptr, info_ptr);
         png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
-        size = QSize(width, height);
         QImage::Format format = bit_depth == 1 ? QImage::Format_Mono : QImage::Format_Indexed8;
         if (!QImageIOHandler::allocateImage(size, format, &image))
             return false;
@@ -495,6 +509,77 @@ bool QPngHandlerPrivate::readPngHeader()
     return true;
 }
 
+void QPngHandlerPrivate::cleanupRead()
+{
+    png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
+    png_ptr = nullptr;
+    delete[] row_pointers;
+    row_pointers = nullptr;
+    delete[] row_buffer;
+    row_buffer = nullptr;
+}
+
+static void sanitizePaletteIndexes(uchar *line, int width, int colorCount)
+{
+    for (uchar *end = line + width; line < end; ++line) {
+        if (*line >= colorCount)
+            *line = 0;
+    }
+}
+
+/*!
+    \internal
+
+    Reads the rows of a non-interlaced image one at a time, writing the
+    part of each row that lies inside \a clip into \a image. The rows
+    above the clip still have to be inflated, as every row is filtered
+    against the previous one, but they are never stored, and decoding
+    stops after the last row of the clip. \a readAll is set to whether
+    all image data was consumed.
+*/
+bool QPngHandlerPrivate::readPngRows(QImage *image, const QRect &clip, bool *readAll)
+{
+    QImageIOHandlerPrivate *handlerPrivate = QImageIOHandlerPrivate::get(q);
+    const png_uint_32 width = png_get_image_width(png_ptr, info_ptr);
+    const png_uint_32 height = png_get_image_height(png_ptr, info_ptr);
+    const bool sanitize = image->format() == QImage::Format_Indexed8;
+    const int colorCount = image->colorCount();
+
+    // Only go through a separate row buffer when part of each row is thrown away.
+    qsizetype offset = 0;
+    qsizetype length = 0;
+    if (clip.width() != int(width)) {
+        row_buffer = new png_byte[png_get_rowbytes(png_ptr, info_ptr)];
+        if (image->depth() < 8) {
+            // only used for Mono, the clip starts on a byte boundary
+            offset = clip.x() / 8;
+            length = (clip.width() + 7) / 8;
+        } else {
+            offset = qsizetype(clip.x()) * (image->depth() / 8);
+            length = qsizetype(clip.width()) * (image->depth() / 8);
+        }
+    }
+
+    for (int y = 0; y <= clip.bottom(); ++y) {
+        const int line = y - clip.y();
+        if (line < 0 || row_buffer) {
+            png_read_row(png_ptr, row_buffer ? row_buffer : image->scanLine(0), nullptr);
+            if (line < 0)
+                continue;
+            memcpy(image->scanLine(line), row_buffer + offset, length);
+        } else {
+            png_read_row(png_ptr, image->scanLine(line), nullptr);
+        }
+        if (sanitize)
+            sanitizePaletteIndexes(image->scanLine(line), clip.width(), colorCount);
+        if (!handlerPrivate->reportScanLines(*image, line, 1))
+            return false;
+    }
+
+    *readAll = clip.bottom() == int(height) - 1;
+    return true;
+}
+
 bool QPngHandlerPrivate::readPngImage(QImage *outImage)
 {
     if (state == Error)
@@ -506,10 +591,9 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
     }
 
     row_pointers = nullptr;
+    row_buffer = nullptr;
     if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-        png_ptr = nullptr;
-        delete[] row_pointers;
+        cleanupRead();
         state = Error;
         return false;
     }
@@ -522,14 +606,6 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
         colorSpaceState = GammaChrm;
     }
 
-    if (!setup_qt(*outImage, png_ptr, info_ptr)) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-        png_ptr = nullptr;
-        delete[] row_pointers;
-        state = Error;
-        return false;
-    }
-
     png_uint_32 width = 0;
     png_uint_32 height = 0;
     png_int_32 offset_x = 0;
@@ -537,17 +613,57 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
 
     int bit_depth = 0;
     int color_type = 0;
+    int interlace_type = PNG_INTERLACE_NONE;
     int unit_type = PNG_OFFSET_PIXEL;
-    png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
+    png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, &interlace_type, nullptr, nullptr);
     png_get_oFFs(png_ptr, info_ptr, &offset_x, &offset_y, &unit_type);
-    uchar *data = outImage->bits();
-    qsizetype bpl = outImage->bytesPerLine();
-    row_pointers = new png_bytep[height];
 
-    for (uint y = 0; y < height; y++)
-        row_pointers[y] = data + y * bpl;
+    const QRect imageRect(0, 0, width, height);
+    const QRect clip = clipRect.isNull() ? imageRect : clipRect.intersected(imageRect);
+    // Mono images keep 8 pixels per byte, so their rows can only be
+    // cropped on a byte boundary.
+    const bool packedPixels = bit_depth == 1
+            && (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_PALETTE);
+    const bool rowByRow = interlace_type == PNG_INTERLACE_NONE
+            && (!packedPixels || clip.x() % 8 == 0);
+
+    // Without row access the whole image is decoded and clipped afterwards.
+    if (!setup_qt(*outImage, png_ptr, info_ptr, rowByRow ? clip.size() : imageRect.size())) {
+        cleanupRead();
+        state = Error;
+        return false;
+    }
 
-    png_read_image(png_ptr, row_pointers);
+    bool readAll = true;
+    if (rowByRow) {
+        if (!readPngRows(outImage, clip, &readAll)) {
+            cleanupRead();
+            state = Error;
+            return false;
+        }
+    } else {
+        uchar *data = outImage->bits();
+        qsizetype bpl = outImage->bytesPerLine();
+        row_pointers = new png_bytep[height];
+
+        for (uint y = 0; y < height; y++)
+            row_pointers[y] = data + y * bpl;
+
+        png_read_image(png_ptr, row_pointers);
+
+        // sanity check palette entries
+        if (outImage->format() == QImage::Format_Indexed8) {
+            for (int y = 0; y < int(height); ++y)
+                sanitizePaletteIndexes(FAST_SCAN_LINE(data, bpl, y), width, outImage->colorCount());
+        }
+        if (clip != imageRect)
+            *outImage = outImage->copy(clip);
+        if (!QImageIOHandlerPrivate::get(q)->reportScanLines(*outImage, 0, outImage->height())) {
+            cleanupRead();
+            state = Error;
+            return false;
+        }
+    }
 
     outImage->setDotsPerMeterX(png_get_x_pixels_per_meter(png_ptr,info_ptr));
     outImage->setDotsPerMeterY(png_get_y_pixels_per_meter(png_ptr,info_ptr));
@@ -555,31 +671,17 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
     if (unit_type == PNG_OFFSET_PIXEL)
         outImage->setOffset(QPoint(offset_x, offset_y));
 
-           // sanity check palette entries
-    if (color_type == PNG_COLOR_TYPE_PALETTE && outImage->format() == QImage::Format_Indexed8) {
-        int color_table_size = outImage->colorCount();
-        for (int y=0; y<(int)height; ++y) {
-            uchar *p = FAST_SCAN_LINE(data, bpl, y);
-            uchar *end = p + width;
-            while (p < end) {
-                if (*p >= color_table_size)
-                    *p = 0;
-                ++p;
-            }
-        }
+    // The chunks after the image data are only read when the decoding
+    // did not stop early at the end of the clip rect.
+    if (readAll) {
+        state = ReadingEnd;
+        png_read_end(png_ptr, end_info);
+        readPngTexts(end_info);
     }
-
-    state = ReadingEnd;
-    png_read_end(png_ptr, end_info);
-
-    readPngTexts(end_info);
     for (int i = 0; i < readTexts.size()-1; i+=2)
         outImage->setText(readTexts.at(i), readTexts.at(i+1));
 
-    png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-    png_ptr = nullptr;
-    delete[] row_pointers;
-    row_pointers = nullptr;
+    cleanupRead();
     state = Ready;
 
     if (colorSpaceState > Undefined && colorSpace.isValid())
@@ -723,6 +825,310 @@ static void set_text(const QImage &image, png_structp png_ptr, png_infop info_pt
     delete [] text_ptr;
 }
 
+/*
+    How the rows are filtered before compression. Filtering only pays
+    off when the data is actually compressed, and the adaptive choice
+    between the five PNG filters costs more than the deflate pass at the
+    fastest levels.
+*/
+enum class PngFilterStrategy {
+    None,       // stored data, level 0
+    Up,         // a single filter at the fast levels 1 to 3
+    Adaptive    // libpng's heuristic, from level 4
+};
+
+static PngFilterStrategy pngFilterStrategy(int compressionLevel)
+{
+    if (compressionLevel == 0)
+        return PngFilterStrategy::None;
+    if (compressionLevel > 0 && compressionLevel <= 3)
+        return PngFilterStrategy::Up;
+    return PngFilterStrategy::Adaptive;
+}
+
+/*
+    Large 8 bit per channel images are compressed in horizontal strips on
+    a thread pool, the way pigz does it. Each strip is a raw deflate
+    stream ending on a byte boundary with a sync flush, primed with the
+    last 32 KB of the data before it, so the strips concatenate into the
+    single zlib stream that the IDAT chunks have to hold.
+*/
+class QPngStripEncoder
+{
+public:
+    static bool canEncode(const QImage &image);
+
+    QPngStripEncoder(const QImage &image, int compressionLevel);
+    // Returns the zlib stream, in one piece per strip.
+    QList<QByteArray> encode();
+
+private:
+    void encodeStrip(int strip);
+    void filterRows(int begin, int end, QByteArray *out) const;
+    void rawRow(int y, uchar *out) const;
+
+    const QImage &m_image;
+    int m_level;
+    PngFilterStrategy m_strategy;
+    int m_channels;
+    qsizetype m_rowBytes;
+    int m_stripRows;
+    int m_stripCount;
+
+    struct Strip {
+        QByteArray data;
+        uLong adler = 0;
+        qsizetype length = 0;
+        bool ok = false;
+    };
+    std::vector<Strip> m_strips;
+};
+
+bool QPngStripEncoder::canEncode(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_Grayscale8:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_RGB888:
+    case QImage::Format_BGR888:
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888:
+        break;
+    default:
+        return false;
+    }
+    // Below two strips there is nothing to share.
+    return image.sizeInBytes() >= 2 * 1024 * 1024 && image.height() >= 32;
+}
+
+QPngStripEncoder::QPngStripEncoder(const QImage &image, int compressionLevel)
+    : m_image(image),
+      m_level(compressionLevel),
+      m_strategy(pngFilterStrategy(compressionLevel))
+{
+    if (image.format() == QImage::Format_Grayscale8)
+        m_channels = 1;
+    else
+        m_channels = image.hasAlphaChannel() ? 4 : 3;
+    m_rowBytes = qsizetype(image.width()) * m_channels;
+    // about a megabyte of image data per strip
+    m_stripRows = int(qBound(qsizetype(16), (1024 * 1024) / m_rowBytes, qsizetype(image.height())));
+    m_stripCount = (image.height() + m_stripRows - 1) / m_stripRows;
+    m_strips.resize(m_stripCount);
+}
+
+// Converts a row to the PNG sample layout.
+void QPngStripEncoder::rawRow(int y, uchar *out) const
+{
+    const uchar *in = m_image.constScanLine(y);
+    const int width = m_image.width();
+    switch (m_image.format()) {
+    case QImage::Format_Grayscale8:
+    case QImage::Format_RGB888:
+    case QImage::Format_RGBA8888:
+        memcpy(out, in, m_rowBytes);
+        break;
+    case QImage::Format_BGR888:
+        for (int x = 0; x < width; ++x, in += 3, out += 3) {
+            out[0] = in[2];
+            out[1] = in[1];
+            out[2] = in[0];
+        }
+        break;
+    case QImage::Format_RGBX8888:
+        for (int x = 0; x < width; ++x, in += 4, out += 3) {
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2];
+        }
+        break;
+    default: {
+        const QRgb *pixels = reinterpret_cast<const QRgb *>(in);
+        for (int x = 0; x < width; ++x) {
+            const QRgb pixel = pixels[x];
+            *out++ = qRed(pixel);
+            *out++ = qGreen(pixel);
+            *out++ = qBlue(pixel);
+            if (m_channels == 4)
+                *out++ = qAlpha(pixel);
+        }
+        break;
+    }
+    }
+}
+
+static inline uchar paethPredictor(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = qAbs(p - a);
+    const int pb = qAbs(p - b);
+    const int pc = qAbs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+// Filters the rows [begin, end) into out, each prefixed by its filter type.
+void QPngStripEncoder::filterRows(int begin, int end, QByteArray *out) const
+{
+    const qsizetype n = m_rowBytes;
+    const int bpp = m_channels;
+    QVarLengthArray<uchar, 4096> rows(2 * n);
+    uchar *prev = rows.data();
+    uchar *cur = prev + n;
+    if (begin > 0)
+        rawRow(begin - 1, prev);
+    else
+        memset(prev, 0, n);
+
+    QVarLengthArray<uchar, 4096> candidates(PNG_FILTER_VALUE_LAST * (n + 1));
+    out->resize(qsizetype(end - begin) * (n + 1));
+    uchar *dst = reinterpret_cast<uchar *>(out->data());
+
+    for (int y = begin; y < end; ++y) {
+        rawRow(y, cur);
+        int first = PNG_FILTER_VALUE_NONE;
+        int last = PNG_FILTER_VALUE_NONE;
+        if (m_strategy == PngFilterStrategy::Up && y > 0) {
+            first = last = PNG_FILTER_VALUE_UP;
+        } else if (m_strategy == PngFilterStrategy::Adaptive) {
+            last = PNG_FILTER_VALUE_PAETH;
+        }
+
+        uchar *best = nullptr;
+        quint64 bestSum = ~quint64(0);
+        for (int type = first; type <= last; ++type) {
+            uchar *f = candidates.data() + type * (n + 1);
+            f[0] = uchar(type);
+            uchar *d = f + 1;
+            switch (type) {
+            case PNG_FILTER_VALUE_NONE:
+                memcpy(d, cur, n);
+                break;
+            case PNG_FILTER_VALUE_SUB:
+                for (qsizetype i = 0; i < n; ++i)
+                    d[i] = cur[i] - (i >= bpp ? cur[i - bpp] : 0);
+                break;
+            case PNG_FILTER_VALUE_UP:
+                for (qsizetype i = 0; i < n; ++i)
+                    d[i] = cur[i] - prev[i];
+                break;
+            case PNG_FILTER_VALUE_AVG:
+                for (qsizetype i = 0; i < n; ++i)
+                    d[i] = cur[i] - ((i >= bpp ? cur[i - bpp] : 0) + prev[i]) / 2;
+                break;
+            case PNG_FILTER_VALUE_PAETH:
+                for (qsizetype i = 0; i < n; ++i) {
+                    d[i] = cur[i] - paethPredictor(i >= bpp ? cur[i - bpp] : 0, prev[i],
+                                                   i >= bpp ? prev[i - bpp] : 0);
+                }
+                break;
+            }
+            if (first == last) {
+                best = f;
+                break;
+            }
+            // the minimum sum of absolute differences, as libpng does
+            quint64 sum = 0;
+            for (qsizetype i = 0; i < n; ++i)
+                sum += d[i] < 128 ? d[i] : 256 - d[i];
+            if (sum < bestSum) {
+                bestSum = sum;
+                best = f;
+            }
+        }
+        memcpy(dst, best, n + 1);
+        dst += n + 1;
+        std::swap(prev, cur);
+    }
+}
+
+void QPngStripEncoder::encodeStrip(int strip)
+{
+    Strip &result = m_strips[strip];
+    const int begin = strip * m_stripRows;
+    const int end = qMin(begin + m_stripRows, m_image.height());
+
+    QByteArray filtered;
+    filterRows(begin, end, &filtered);
+    result.length = filtered.size();
+    result.adler = adler32(adler32(0, nullptr, 0),
+                           reinterpret_cast<const Bytef *>(filtered.constData()), uInt(filtered.size()));
+
+    z_stream stream = {};
+    if (deflateInit2(&stream, m_level < 0 ? Z_DEFAULT_COMPRESSION : m_level, Z_DEFLATED,
+                     -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return;
+    }
+    if (strip > 0) {
+        // the window the previous strip ends with
+        const int rowsInWindow = int(qMin(qsizetype(begin), (32768 + m_rowBytes) / (m_rowBytes + 1)));
+        QByteArray dictionary;
+        filterRows(begin - rowsInWindow, begin, &dictionary);
+        const qsizetype size = qMin(dictionary.size(), qsizetype(32768));
+        deflateSetDictionary(&stream,
+                             reinterpret_cast<const Bytef *>(dictionary.constData() + dictionary.size() - size),
+                             uInt(size));
+    }
+
+    const bool last = strip == m_stripCount - 1;
+    result.data.resize(qsizetype(deflateBound(&stream, uLong(filtered.size()))) + 16);
+    stream.next_in = reinterpret_cast<Bytef *>(filtered.data());
+    stream.avail_in = uInt(filtered.size());
+    stream.next_out = reinterpret_cast<Bytef *>(result.data.data());
+    stream.avail_out = uInt(result.data.size());
+    const int status = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    result.ok = (last ? status == Z_STREAM_END : status == Z_OK) && stream.avail_in == 0;
+    result.data.resize(result.data.size() - stream.avail_out);
+    deflateEnd(&stream);
+}
+
+QList<QByteArray> QPngStripEncoder::encode()
+{
+    // The calling thread works through the strips as well, and workers are
+    // only started on idle threads, so this never waits for a busy pool.
+    std::atomic<int> nextStrip = 0;
+    auto work = [this, &nextStrip] {
+        for (int strip; (strip = nextStrip.fetch_add(1, std::memory_order_relaxed)) < m_stripCount;)
+            encodeStrip(strip);
+    };
+#if QT_CONFIG(thread)
+    QSemaphore finished;
+    int workers = 0;
+    if (QThreadPool *pool = QThreadPoolPrivate::qtGuiInstance()) {
+        for (; workers < m_stripCount - 1; ++workers) {
+            if (!pool->tryStart([&] { work(); finished.release(); }))
+                break;
+        }
+    }
+    work();
+    finished.acquire(workers);
+#else
+    work();
+#endif
+
+    QList<QByteArray> stream;
+    stream.reserve(m_stripCount);
+    uLong adler = adler32(0, nullptr, 0);
+    for (const Strip &strip : m_strips) {
+        if (!strip.ok)
+            return {};
+        stream.append(strip.data);
+        adler = adler32_combine(adler, strip.adler, z_off_t(strip.length));
+    }
+
+    // zlib header: deflate with a 32 KB window, and the level hint
+    const int cmf = 0x78;
+    int flg = (m_level < 0 || m_level == 6) ? 2 : m_level < 2 ? 0 : m_level < 6 ? 1 : 3;
+    flg <<= 6;
+    flg += 31 - (cmf * 256 + flg) % 31;
+    stream.first().prepend(char(flg)).prepend(char(cmf));
+    const char trailer[4] = { char(adler >> 24), char(adler >> 16), char(adler >> 8), char(adler) };
+    stream.last().append(trailer, 4);
+    return stream;
+}
+
 bool QPNGImageWriter::writeImage(const QImage& image, int off_x, int off_y)
 {
     return writeImage(image, -1, QString(), off_x, off_y);
@@ -807,6 +1213,20 @@ bool QPNGImageWriter::writeImage(const QImage& image, int compression_in, const
                  bpc, // per channel
                  color_type, 0, 0, 0);       // sets #channels
 
+    // libpng already leaves palette and low bit depth images unfiltered
+    if (color_type != PNG_COLOR_TYPE_PALETTE && bpc >= 8) {
+        switch (pngFilterStrategy(compression)) {
+        case PngFilterStrategy::None:
+            png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+            break;
+        case PngFilterStrategy::Up:
+            png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_UP);
+            break;
+        case PngFilterStrategy::Adaptive:
+            break;
+        }
+    }
+
 #ifdef PNG_iCCP_SUPPORTED
     QColorSpace cs = image.colorSpace();
     // Support the old gamma making it override transferfunction (if possible)
@@ -952,6 +1372,22 @@ bool QPNGImageWriter::writeImage(const QImage& image, int compression_in, const
         png_write_chunk(png_ptr, const_cast<png_bytep>((const png_byte *)"gIFg"), data, 4);
     }
 
+    if (QPngStripEncoder::canEncode(image)) {
+        const QList<QByteArray> stream = QPngStripEncoder(image, compression).encode();
+        if (!stream.isEmpty()) {
+            for (const QByteArray &data : stream) {
+                png_write_chunk(png_ptr, const_cast<png_bytep>((const png_byte *)"IDAT"),
+                                reinterpret_cast<png_bytep>(const_cast<char *>(data.constData())),
+                                data.size());
+            }
+            // png_write_end() refuses to run without libpng having written the IDAT chunks itself
+            png_write_chunk(png_ptr, const_cast<png_bytep>((const png_byte *)"IEND"), nullptr, 0);
+            frames_written++;
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return true;
+        }
+    }
+
     int height = image.height();
     int width = image.width();
     switch (image.format()) {
@@ -1081,7 +1517,8 @@ bool QPngHandler::supportsOption(ImageOption option) const
         || option == ImageFormat
         || option == Quality
         || option == CompressionRatio
-        || option == Size;
+        || option == Size
+        || option == ClipRect;
 }
 
 QVariant QPngHandler::option(ImageOption option) const
@@ -1104,6 +1541,8 @@ QVariant QPngHandler::option(ImageOption option) const
                      png_get_image_height(d->png_ptr, d->info_ptr));
     else if (option == ImageFormat)
         return d->readImageFormat();
+    else if (option == ClipRect)
+        return d->clipRect;
     return QVariant();
 }
 
@@ -1117,6 +1556,8 @@ void QPngHandler::setOption(ImageOption option, const QVariant &value)
         d->compression = value.toInt();
     else if (option == Description)
         d->description = value.toString();
+    else if (option == ClipRect)
+        d->clipRect = value.toRect();
 }
 
 QT_END_NAMESPACE
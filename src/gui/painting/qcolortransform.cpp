@@ -22,6 +22,100 @@
 
 QT_BEGIN_NAMESPACE
 
+// A transform baked into a regular grid over the encoded input, read back
+// with tetrahedral interpolation. Each grid point holds the color the rest
+// of the transform would compute for it, up to the final encoding step.
+class QColorLut3D
+{
+public:
+    static constexpr int GridPoints = 33;
+    static constexpr qsizetype TableSize = qsizetype(GridPoints) * GridPoints * GridPoints;
+
+    QColorLut3D() : table(new QColorVector[TableSize]) { }
+
+    void apply(QColorVector *buffer, qsizetype len) const;
+
+    std::unique_ptr<QColorVector[]> table; // indexed by x, then y, then z
+};
+
+static inline float lut3DCoordinate(float v)
+{
+    constexpr float Scale = QColorLut3D::GridPoints - 1;
+    // also maps NaN, from loading premultiplied pixels with no alpha, to 0
+    return v > 0.0f ? (v < 1.0f ? v * Scale : Scale) : 0.0f;
+}
+
+void QColorLut3D::apply(QColorVector *buffer, qsizetype len) const
+{
+    constexpr qsizetype StrideX = GridPoints * GridPoints;
+    constexpr qsizetype StrideY = GridPoints;
+    constexpr qsizetype StrideZ = 1;
+    for (qsizetype i = 0; i < len; ++i) {
+        const float x = lut3DCoordinate(buffer[i].x);
+        const float y = lut3DCoordinate(buffer[i].y);
+        const float z = lut3DCoordinate(buffer[i].z);
+        const int ix = std::min(int(x), GridPoints - 2);
+        const int iy = std::min(int(y), GridPoints - 2);
+        const int iz = std::min(int(z), GridPoints - 2);
+        const float fx = x - ix;
+        const float fy = y - iy;
+        const float fz = z - iz;
+
+        // The cube around the color is split into six tetrahedra along its
+        // diagonal. The one holding the color is walked from the lowest to
+        // the highest corner, along the axes in the order of their fractions.
+        qsizetype corner1, corner2;
+        float t1, t2, t3;
+        if (fx >= fy) {
+            if (fy >= fz) {
+                corner1 = StrideX;
+                corner2 = StrideX + StrideY;
+                t1 = fx; t2 = fy; t3 = fz;
+            } else if (fx >= fz) {
+                corner1 = StrideX;
+                corner2 = StrideX + StrideZ;
+                t1 = fx; t2 = fz; t3 = fy;
+            } else {
+                corner1 = StrideZ;
+                corner2 = StrideX + StrideZ;
+                t1 = fz; t2 = fx; t3 = fy;
+            }
+        } else {
+            if (fz >= fy) {
+                corner1 = StrideZ;
+                corner2 = StrideY + StrideZ;
+                t1 = fz; t2 = fy; t3 = fx;
+            } else if (fz >= fx) {
+                corner1 = StrideY;
+                corner2 = StrideY + StrideZ;
+                t1 = fy; t2 = fz; t3 = fx;
+            } else {
+                corner1 = StrideY;
+                corner2 = StrideX + StrideY;
+                t1 = fy; t2 = fx; t3 = fz;
+            }
+        }
+
+        const QColorVector *c0 = table.get() + ix * StrideX + iy * StrideY + iz * StrideZ;
+        const QColorVector *c1 = c0 + corner1;
+        const QColorVector *c2 = c0 + corner2;
+        const QColorVector *c3 = c0 + (StrideX + StrideY + StrideZ);
+#if defined(__SSE2__)
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(&c0->x), _mm_set1_ps(1.0f - t1));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(&c1->x), _mm_set1_ps(t1 - t2)));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(&c2->x), _mm_set1_ps(t2 - t3)));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(&c3->x), _mm_set1_ps(t3)));
+        _mm_storeu_ps(&buffer[i].x, v);
+#else
+        buffer[i] = *c0 * (1.0f - t1) + *c1 * (t1 - t2) + *c2 * (t2 - t3) + *c3 * t3;
+#endif
+    }
+}
+
+QColorTransformPrivate::QColorTransformPrivate() = default;
+
+QColorTransformPrivate::~QColorTransformPrivate() = default;
+
 void QColorTransformPrivate::updateLutsIn() const
 {
     if (colorSpaceIn->lut.generated.loadAcquire())
@@ -1820,6 +1914,10 @@ template<typename T>
 constexpr bool CanUseThreeComponent = !std::is_same_v<T, QCmyk32>;
 template<typename T>
 constexpr bool UnclampedValues = std::is_same_v<T, QRgbaFloat16> || std::is_same_v<T, QRgbaFloat32>;
+// The table is checked to 8 bit precision, so 16 bit output is converted directly.
+template<typename D, typename S>
+constexpr bool CanUseLut3D = (std::is_same_v<S, QRgb> || std::is_same_v<S, QRgba64>)
+        && (std::is_same_v<D, QRgb> || std::is_same_v<D, QCmyk32>);
 
 // Possible combos for data and color spaces:
 //  DataCM     ColorSpaceCM    ColorSpacePM     Notes
@@ -1943,6 +2041,201 @@ void QColorTransformPrivate::applyConvertOut(D *dst, const S *src, QColorVector
     }
 }
 
+/*!
+    \internal
+    Returns \c true if the transform would gain from being baked into a
+    3D lookup table: it has RGB input, and at least one side goes through
+    element based processing, like the CLUTs of ICC profiles. A transform
+    between matrix-shaper color spaces is faster to compute directly.
+*/
+bool QColorTransformPrivate::canUseLut3D() const
+{
+    return colorSpaceIn->colorModel == QColorSpace::ColorModel::Rgb
+        && (!colorSpaceIn->isThreeComponentMatrix() || !colorSpaceOut->isThreeComponentMatrix());
+}
+
+/*!
+    \internal
+    Returns \c true if converting \a pixelCount pixels, like those of an
+    image, is worth baking the transform into a 3D lookup table for. Baking
+    and checking the table cost about as much as converting two pixels per
+    grid point, once per transform.
+
+    The decision is made once for all the pixels, and passed to apply() as
+    the UseLut3D flag, so that they are all converted the same way.
+*/
+bool QColorTransformPrivate::shouldUseLut3D(qsizetype pixelCount)
+{
+    return pixelCount >= 2 * QColorLut3D::TableSize;
+}
+
+/*!
+    \internal
+    Returns the baked lookup table, baking it first if needed, or \nullptr
+    if the table is not accurate enough for this transform.
+*/
+const QColorLut3D *QColorTransformPrivate::ensureLut3D() const
+{
+    if (const QColorLut3D *lut = lut3D.loadAcquire())
+        return lut;
+    if (lut3DRejected.loadAcquire())
+        return nullptr;
+    // Other threads wait for the table, rather than converting their
+    // part of the image directly.
+    QMutexLocker locker(&lut3DMutex);
+    if (!lut3D.loadRelaxed() && !lut3DRejected.loadRelaxed())
+        bakeLut3D();
+    return lut3D.loadRelaxed();
+}
+
+/*!
+    \internal
+    Runs \a len encoded input colors in \a buffer through the transform,
+    up to the output transfer function of a matrix-shaper output, which is
+    applied after reading from the lookup table. The output is not clamped.
+*/
+void QColorTransformPrivate::convertForLut3D(QColorVector *buffer, qsizetype len) const
+{
+    // the same steps as applyConvertIn() and applyConvertOut()
+    if (colorSpaceIn->isThreeComponentMatrix()) {
+        for (qsizetype i = 0; i < len; ++i) {
+            buffer[i].x = colorSpaceIn->trc[0].apply(buffer[i].x);
+            buffer[i].y = colorSpaceIn->trc[1].apply(buffer[i].y);
+            buffer[i].z = colorSpaceIn->trc[2].apply(buffer[i].z);
+        }
+        applyMatrix<DoClamp>(buffer, len, colorMatrix);
+    } else {
+        for (auto &&element : colorSpaceIn->mAB)
+            std::visit([buffer, len](auto &&elm) { visitElement(elm, buffer, len); }, element);
+    }
+    pcsAdapt(buffer, len);
+    // The output is clamped after interpolating, so that colors next to the
+    // edge of the gamut are not pulled off it.
+    if (colorSpaceOut->isThreeComponentMatrix()) {
+        applyMatrix<DoNotClamp>(buffer, len, colorMatrix);
+    } else {
+        for (auto &&element : colorSpaceOut->mBA)
+            std::visit([buffer, len](auto &&elm) { visitElement(elm, buffer, len); }, element);
+    }
+}
+
+/*!
+    \internal
+    Bakes the transform into a 3D lookup table, and checks it against the
+    direct conversion in the middle of every cell, where interpolating is
+    least accurate. Profiles that clamp or bend sharply inside a cell, like
+    some going through a Lab connection space, are not followed closely
+    enough by the grid; their table is dropped, and they keep being
+    converted directly.
+*/
+void QColorTransformPrivate::bakeLut3D() const
+{
+    if (colorSpaceIn->isThreeComponentMatrix())
+        updateLutsIn();
+    if (colorSpaceOut->isThreeComponentMatrix())
+        updateLutsOut();
+
+    auto lut = std::make_unique<QColorLut3D>();
+    constexpr int GridPoints = QColorLut3D::GridPoints;
+    constexpr float f = 1.0f / (GridPoints - 1);
+    QColorVector *row = lut->table.get();
+    for (int x = 0; x < GridPoints; ++x) {
+        for (int y = 0; y < GridPoints; ++y, row += GridPoints) {
+            for (int z = 0; z < GridPoints; ++z)
+                row[z] = QColorVector(x * f, y * f, z * f);
+            convertForLut3D(row, GridPoints);
+        }
+    }
+
+    // Compared in the encoded output, as stored, and allowing for one step
+    // of 8 bit rounding. CMYK output keeps K in w, which is interpolated
+    // along with the other components.
+    constexpr float MaximumError = 1.0f / 255;
+    constexpr int Cells = GridPoints - 1;
+    const bool hasK = colorSpaceOut->colorModel == QColorSpace::ColorModel::Cmyk;
+    auto encode = [this, hasK](QColorVector *buffer, qsizetype len) {
+        clampIfNeeded<DoClamp>(buffer, len);
+        if (hasK) {
+            for (qsizetype i = 0; i < len; ++i)
+                buffer[i].w = std::clamp(buffer[i].w, 0.0f, 1.0f);
+        }
+        if (!colorSpaceOut->isThreeComponentMatrix())
+            return;
+        for (qsizetype i = 0; i < len; ++i) {
+            buffer[i].x = colorSpaceOut->trc[0].applyInverse(buffer[i].x);
+            buffer[i].y = colorSpaceOut->trc[1].applyInverse(buffer[i].y);
+            buffer[i].z = colorSpaceOut->trc[2].applyInverse(buffer[i].z);
+        }
+    };
+    QColorVector direct[Cells];
+    QColorVector interpolated[Cells];
+    for (int x = 0; x < Cells; ++x) {
+        for (int y = 0; y < Cells; ++y) {
+            for (int z = 0; z < Cells; ++z)
+                direct[z] = QColorVector((x + 0.5f) * f, (y + 0.5f) * f, (z + 0.5f) * f);
+            std::copy(direct, direct + Cells, interpolated);
+            convertForLut3D(direct, Cells);
+            lut->apply(interpolated, Cells);
+            encode(direct, Cells);
+            encode(interpolated, Cells);
+            for (int z = 0; z < Cells; ++z) {
+                if (std::abs(direct[z].x - interpolated[z].x) > MaximumError
+                    || std::abs(direct[z].y - interpolated[z].y) > MaximumError
+                    || std::abs(direct[z].z - interpolated[z].z) > MaximumError
+                    || (hasK && std::abs(direct[z].w - interpolated[z].w) > MaximumError)) {
+                    lut3DRejected.storeRelease(1);
+                    return;
+                }
+            }
+        }
+    }
+
+    lut3DData = std::move(lut);
+    lut3D.storeRelease(lut3DData.get());
+}
+
+/*!
+    \internal
+    Bakes the transform into a 3D lookup table now, instead of on the first
+    conversion with the UseLut3D flag. Returns \c true if those conversions
+    use the table for 8 and 16 bit RGB input.
+
+    \sa canUseLut3D(), shouldUseLut3D()
+*/
+bool QColorTransformPrivate::prepareLut3D()
+{
+    return canUseLut3D() && ensureLut3D();
+}
+
+template<typename D, typename S>
+void QColorTransformPrivate::applyLut3D(const QColorLut3D &lut, D *dst, const S *src, QColorVector *buffer,
+                                        qsizetype len, TransformFlags flags) const
+{
+    if (flags & InputPremultiplied)
+        loadPremultipliedLUT(buffer, src, len);
+    else
+        loadUnpremultipliedLUT(buffer, src, len);
+
+    lut.apply(buffer, len);
+    clampIfNeeded<DoClamp>(buffer, len);
+
+    if constexpr (CanUseThreeComponent<D>) {
+        if (colorSpaceOut->isThreeComponentMatrix()) {
+            if (flags & InputOpaque)
+                storeOpaque(dst, buffer, len, this);
+            else if (flags & OutputPremultiplied)
+                storePremultiplied(dst, src, buffer, len, this);
+            else
+                storeUnpremultiplied(dst, src, buffer, len, this);
+            return;
+        }
+    }
+    if (flags & OutputPremultiplied)
+        storePremultipliedLUT(dst, src, buffer, len);
+    else
+        storeUnpremultipliedLUT(dst, src, buffer, len);
+}
+
 /*!
     \internal
     Adapt Profile Connection Spaces.
@@ -1976,11 +2269,25 @@ void QColorTransformPrivate::apply(D *dst, const S *src, qsizetype count, Transf
     if (colorSpaceOut->isThreeComponentMatrix())
         updateLutsOut();
 
+    const QColorLut3D *lut = nullptr;
+    if constexpr (CanUseLut3D<D, S>) {
+        if ((flags & UseLut3D) && canUseLut3D())
+            lut = ensureLut3D();
+    }
+
     QUninitialized<QColorVector, WorkBlockSize> buffer;
     qsizetype i = 0;
     while (i < count) {
         const qsizetype len = qMin(count - i, WorkBlockSize);
 
+        if constexpr (CanUseLut3D<D, S>) {
+            if (lut) {
+                applyLut3D(*lut, dst + i, src + i, buffer, len, flags);
+                i += len;
+                continue;
+            }
+        }
+
         applyConvertIn(src + i, buffer, len, flags);
 
         pcsAdapt(buffer, len);
@@ -2002,6 +2309,7 @@ void QColorTransformPrivate::apply(D *dst, const S *src, qsizetype count, Transf
     \value InputPremultiplied The input is premultiplied.
     \value OutputPremultiplied The output should be premultiplied.
     \value Premultiplied Both input and output should both be premultiplied.
+    \value UseLut3D Use a 3D lookup table for RGB input, if the transform has use for one.
 */
 
 /*!
@@ -18,11 +18,16 @@
 #include "qcolormatrix_p.h"
 #include "qcolorspace_p.h"
 
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
 #include <QtCore/qshareddata.h>
 #include <QtGui/qrgbafloat.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 class QCmyk32;
+class QColorLut3D;
 
 class QColorTransformPrivate : public QSharedData
 {
@@ -31,6 +36,9 @@ public:
     QExplicitlySharedDataPointer<const QColorSpacePrivate> colorSpaceIn;
     QExplicitlySharedDataPointer<const QColorSpacePrivate> colorSpaceOut;
 
+    QColorTransformPrivate();
+    ~QColorTransformPrivate();
+
     static QColorTransformPrivate *get(const QColorTransform &q)
     { return q.d.data(); }
 
@@ -39,15 +47,19 @@ public:
     bool isIdentity() const;
 
     Q_GUI_EXPORT void prepare();
+    Q_GUI_EXPORT bool prepareLut3D();
     enum TransformFlag {
         Unpremultiplied = 0,
         InputOpaque = 1,
         InputPremultiplied = 2,
         OutputPremultiplied = 4,
-        Premultiplied = (InputPremultiplied | OutputPremultiplied)
+        Premultiplied = (InputPremultiplied | OutputPremultiplied),
+        UseLut3D = 8
     };
     Q_DECLARE_FLAGS(TransformFlags, TransformFlag)
 
+    Q_GUI_EXPORT static bool shouldUseLut3D(qsizetype pixelCount);
+
     QColorVector map(QColorVector color) const;
     QColorVector mapExtended(QColorVector color) const;
 
@@ -60,6 +72,19 @@ private:
     void applyConvertIn(const S *src, QColorVector *buffer, qsizetype len, TransformFlags flags) const;
     template<typename D, typename S>
     void applyConvertOut(D *dst, const S *src, QColorVector *buffer, qsizetype len, TransformFlags flags) const;
+
+    bool canUseLut3D() const;
+    const QColorLut3D *ensureLut3D() const;
+    void convertForLut3D(QColorVector *buffer, qsizetype len) const;
+    void bakeLut3D() const;
+    template<typename D, typename S>
+    void applyLut3D(const QColorLut3D &lut, D *dst, const S *src, QColorVector *buffer, qsizetype len, TransformFlags flags) const;
+
+    // Baked on demand, see ensureLut3D()
+    mutable QAtomicPointer<const QColorLut3D> lut3D;
+    mutable std::unique_ptr<const QColorLut3D> lut3DData;
+    mutable QMutex lut3DMutex;
+    mutable QAtomicInt lut3DRejected;
 };
 
 QT_END_NAMESPACE
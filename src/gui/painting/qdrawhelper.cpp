@@ -6379,6 +6379,10 @@ void qt_memfill32(quint32 *dest, quint32 color, qsizetype count)
 #ifdef QT_COMPILER_SUPPORTS_SSE4_1
 template<QtPixelOrder> void QT_FASTCALL storeA2RGB30PMFromARGB32PM_sse4(uchar *dest, const uint *src, int index, int count, const QList<QRgb> *, QDitherInfo *);
 #endif
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+template<QtPixelOrder> void QT_FASTCALL convertA2RGB30PMToARGB32PM_avx2(uint *buffer, int count, const QList<QRgb> *);
+template<QtPixelOrder> const uint *QT_FASTCALL fetchA2RGB30PMToARGB32PM_avx2(uint *buffer, const uchar *s, int index, int count, const QList<QRgb> *, QDitherInfo *dither);
+#endif
 
 extern void qInitBlendFunctions();
 
@@ -6559,6 +6563,10 @@ static void qInitDrawhelperFunctions()
         qt_functionForMode_C[QPainter::CompositionMode_Source] = comp_func_Source_avx2;
         qt_functionForMode_C[QPainter::CompositionMode_SourceOver] = comp_func_SourceOver_avx2;
         qt_functionForModeSolid_C[QPainter::CompositionMode_SourceOver] = comp_func_solid_SourceOver_avx2;
+        extern void QT_FASTCALL comp_func_Plus_avx2(uint *destPixels, const uint *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_Plus_avx2(uint *destPixels, int length, uint color, uint const_alpha);
+        qt_functionForMode_C[QPainter::CompositionMode_Plus] = comp_func_Plus_avx2;
+        qt_functionForModeSolid_C[QPainter::CompositionMode_Plus] = comp_func_solid_Plus_avx2;
 #if QT_CONFIG(raster_64bit)
         extern void QT_FASTCALL comp_func_Source_rgb64_avx2(QRgba64 *destPixels, const QRgba64 *srcPixels, int length, uint const_alpha);
         extern void QT_FASTCALL comp_func_SourceOver_rgb64_avx2(QRgba64 *destPixels, const QRgba64 *srcPixels, int length, uint const_alpha);
@@ -6566,6 +6574,10 @@ static void qInitDrawhelperFunctions()
         qt_functionForMode64_C[QPainter::CompositionMode_Source] = comp_func_Source_rgb64_avx2;
         qt_functionForMode64_C[QPainter::CompositionMode_SourceOver] = comp_func_SourceOver_rgb64_avx2;
         qt_functionForModeSolid64_C[QPainter::CompositionMode_SourceOver] = comp_func_solid_SourceOver_rgb64_avx2;
+        extern void QT_FASTCALL comp_func_Plus_rgb64_avx2(QRgba64 *destPixels, const QRgba64 *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_Plus_rgb64_avx2(QRgba64 *destPixels, int length, QRgba64 color, uint const_alpha);
+        qt_functionForMode64_C[QPainter::CompositionMode_Plus] = comp_func_Plus_rgb64_avx2;
+        qt_functionForModeSolid64_C[QPainter::CompositionMode_Plus] = comp_func_solid_Plus_rgb64_avx2;
 #endif
 #if QT_CONFIG(raster_fp)
         extern void QT_FASTCALL comp_func_Source_rgbafp_avx2(QRgbaFloat32 *destPixels, const QRgbaFloat32 *srcPixels, int length, uint const_alpha);
@@ -6576,6 +6588,10 @@ static void qInitDrawhelperFunctions()
         qt_functionForModeFP_C[QPainter::CompositionMode_SourceOver] = comp_func_SourceOver_rgbafp_avx2;
         qt_functionForModeSolidFP_C[QPainter::CompositionMode_Source] = comp_func_solid_Source_rgbafp_avx2;
         qt_functionForModeSolidFP_C[QPainter::CompositionMode_SourceOver] = comp_func_solid_SourceOver_rgbafp_avx2;
+        extern void QT_FASTCALL comp_func_Plus_rgbafp_avx2(QRgbaFloat32 *destPixels, const QRgbaFloat32 *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_Plus_rgbafp_avx2(QRgbaFloat32 *destPixels, int length, QRgbaFloat32 color, uint const_alpha);
+        qt_functionForModeFP_C[QPainter::CompositionMode_Plus] = comp_func_Plus_rgbafp_avx2;
+        qt_functionForModeSolidFP_C[QPainter::CompositionMode_Plus] = comp_func_solid_Plus_rgbafp_avx2;
 #endif
 
         extern void QT_FASTCALL fetchTransformedBilinearARGB32PM_simple_scale_helper_avx2(uint *b, uint *end, const QTextureData &image,
@@ -6610,6 +6626,20 @@ static void qInitDrawhelperFunctions()
         qPixelLayouts[QImage::Format_ARGB32].fetchToRGBA64PM = fetchARGB32ToRGBA64PM_avx2;
         qPixelLayouts[QImage::Format_RGBX8888].fetchToRGBA64PM = fetchRGBA8888ToRGBA64PM_avx2;
         qPixelLayouts[QImage::Format_RGBA64].fetchToRGBA64PM = fetchRGBA64ToRGBA64PM_avx2;
+        extern void QT_FASTCALL storeRGBA64FromARGB32_avx2(uchar *, const uint *, int, int, const QList<QRgb> *, QDitherInfo *);
+        extern void QT_FASTCALL storeRGB64FromRGB32_avx2(uchar *, const uint *, int, int, const QList<QRgb> *, QDitherInfo *);
+        qPixelLayouts[QImage::Format_RGBX64].storeFromRGB32 = storeRGB64FromRGB32_avx2;
+        qPixelLayouts[QImage::Format_RGBA64].storeFromRGB32 = storeRGB64FromRGB32_avx2;
+        qPixelLayouts[QImage::Format_RGBA64_Premultiplied].storeFromARGB32PM = storeRGBA64FromARGB32_avx2;
+        qPixelLayouts[QImage::Format_RGBA64_Premultiplied].storeFromRGB32 = storeRGB64FromRGB32_avx2;
+        qPixelLayouts[QImage::Format_BGR30].convertToARGB32PM = convertA2RGB30PMToARGB32PM_avx2<PixelOrderBGR>;
+        qPixelLayouts[QImage::Format_BGR30].fetchToARGB32PM = fetchA2RGB30PMToARGB32PM_avx2<PixelOrderBGR>;
+        qPixelLayouts[QImage::Format_A2BGR30_Premultiplied].convertToARGB32PM = convertA2RGB30PMToARGB32PM_avx2<PixelOrderBGR>;
+        qPixelLayouts[QImage::Format_A2BGR30_Premultiplied].fetchToARGB32PM = fetchA2RGB30PMToARGB32PM_avx2<PixelOrderBGR>;
+        qPixelLayouts[QImage::Format_RGB30].convertToARGB32PM = convertA2RGB30PMToARGB32PM_avx2<PixelOrderRGB>;
+        qPixelLayouts[QImage::Format_RGB30].fetchToARGB32PM = fetchA2RGB30PMToARGB32PM_avx2<PixelOrderRGB>;
+        qPixelLayouts[QImage::Format_A2RGB30_Premultiplied].convertToARGB32PM = convertA2RGB30PMToARGB32PM_avx2<PixelOrderRGB>;
+        qPixelLayouts[QImage::Format_A2RGB30_Premultiplied].fetchToARGB32PM = fetchA2RGB30PMToARGB32PM_avx2<PixelOrderRGB>;
 
         extern const uint *QT_FASTCALL fetchRGB16FToRGB32_avx2(uint *buffer, const uchar *src, int index, int count, const QList<QRgb> *, QDitherInfo *);
         extern const uint *QT_FASTCALL fetchRGBA16FToARGB32PM_avx2(uint *buffer, const uchar *src, int index, int count, const QList<QRgb> *, QDitherInfo *);
@@ -84,27 +84,14 @@ INTERPOLATE_PIXEL_255_AVX2(__m256i srcVector, __m256i &dstVector, __m256i alphaC
     dstVector = _mm256_or_si256(finalAG, finalRB);
 }
 
+// Like interpolate65535(), the two products are rounded separately, so that
+// the result is the same as on the generic code path.
 inline static void Q_DECL_VECTORCALL
 INTERPOLATE_PIXEL_RGB64_AVX2(__m256i srcVector, __m256i &dstVector, __m256i alphaChannel, __m256i oneMinusAlphaChannel, __m256i colorMask, __m256i half)
 {
-    const __m256i srcVectorAG = _mm256_srli_epi32(srcVector, 16);
-    const __m256i dstVectorAG = _mm256_srli_epi32(dstVector, 16);
-    const __m256i srcVectorRB = _mm256_and_si256(srcVector, colorMask);
-    const __m256i dstVectorRB = _mm256_and_si256(dstVector, colorMask);
-    const __m256i srcVectorAGalpha = _mm256_mullo_epi32(srcVectorAG, alphaChannel);
-    const __m256i srcVectorRBalpha = _mm256_mullo_epi32(srcVectorRB, alphaChannel);
-    const __m256i dstVectorAGoneMinusAlpha = _mm256_mullo_epi32(dstVectorAG, oneMinusAlphaChannel);
-    const __m256i dstVectorRBoneMinusAlpha = _mm256_mullo_epi32(dstVectorRB, oneMinusAlphaChannel);
-    __m256i finalAG = _mm256_add_epi32(srcVectorAGalpha, dstVectorAGoneMinusAlpha);
-    __m256i finalRB = _mm256_add_epi32(srcVectorRBalpha, dstVectorRBoneMinusAlpha);
-    finalAG = _mm256_add_epi32(finalAG, _mm256_srli_epi32(finalAG, 16));
-    finalRB = _mm256_add_epi32(finalRB, _mm256_srli_epi32(finalRB, 16));
-    finalAG = _mm256_add_epi32(finalAG, half);
-    finalRB = _mm256_add_epi32(finalRB, half);
-    finalAG = _mm256_andnot_si256(colorMask, finalAG);
-    finalRB = _mm256_srli_epi32(finalRB, 16);
-
-    dstVector = _mm256_or_si256(finalAG, finalRB);
+    BYTE_MUL_RGB64_AVX2(srcVector, alphaChannel, colorMask, half);
+    BYTE_MUL_RGB64_AVX2(dstVector, oneMinusAlphaChannel, colorMask, half);
+    dstVector = _mm256_add_epi16(srcVector, dstVector);
 }
 
 // See BLEND_SOURCE_OVER_ARGB32_SSE2 for details.
@@ -682,6 +669,255 @@ void QT_FASTCALL comp_func_solid_SourceOver_rgbafp_avx2(QRgbaFloat32 *dst, int l
 }
 #endif
 
+void QT_FASTCALL comp_func_Plus_avx2(uint *dst, const uint *src, int length, uint const_alpha)
+{
+    int x = 0;
+
+    if (const_alpha == 255) {
+        // 1) prologue, align on 32 bytes
+        ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+            dst[x] = comp_func_Plus_one_pixel(dst[x], src[x]);
+
+        // 2) composition with AVX2
+        for (; x < length - 7; x += 8) {
+            const __m256i srcVector = _mm256_lddqu_si256((const __m256i *)&src[x]);
+            const __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            _mm256_store_si256((__m256i *)&dst[x], _mm256_adds_epu8(srcVector, dstVector));
+        }
+
+        // 3) Epilogue
+        SIMD_EPILOGUE(x, length, 7)
+            dst[x] = comp_func_Plus_one_pixel(dst[x], src[x]);
+    } else {
+        const int one_minus_const_alpha = 255 - const_alpha;
+
+        // 1) prologue, align on 32 bytes
+        ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+            dst[x] = comp_func_Plus_one_pixel_const_alpha(dst[x], src[x], const_alpha, one_minus_const_alpha);
+
+        // 2) composition with AVX2
+        const __m256i half = _mm256_set1_epi16(0x80);
+        const __m256i colorMask = _mm256_set1_epi32(0x00ff00ff);
+        const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha);
+        const __m256i oneMinusConstAlpha = _mm256_set1_epi16(one_minus_const_alpha);
+        for (; x < length - 7; x += 8) {
+            const __m256i srcVector = _mm256_lddqu_si256((const __m256i *)&src[x]);
+            __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            const __m256i result = _mm256_adds_epu8(srcVector, dstVector);
+            INTERPOLATE_PIXEL_255_AVX2(result, dstVector, constAlphaVector, oneMinusConstAlpha, colorMask, half);
+            _mm256_store_si256((__m256i *)&dst[x], dstVector);
+        }
+
+        // 3) Epilogue
+        SIMD_EPILOGUE(x, length, 7)
+            dst[x] = comp_func_Plus_one_pixel_const_alpha(dst[x], src[x], const_alpha, one_minus_const_alpha);
+    }
+}
+
+void QT_FASTCALL comp_func_solid_Plus_avx2(uint *dst, int length, uint color, uint const_alpha)
+{
+    int x = 0;
+    const __m256i colorVector = _mm256_set1_epi32(color);
+
+    if (const_alpha == 255) {
+        ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+            dst[x] = comp_func_Plus_one_pixel(dst[x], color);
+
+        for (; x < length - 7; x += 8) {
+            const __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            _mm256_store_si256((__m256i *)&dst[x], _mm256_adds_epu8(colorVector, dstVector));
+        }
+
+        SIMD_EPILOGUE(x, length, 7)
+            dst[x] = comp_func_Plus_one_pixel(dst[x], color);
+    } else {
+        const int one_minus_const_alpha = 255 - const_alpha;
+
+        ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+            dst[x] = comp_func_Plus_one_pixel_const_alpha(dst[x], color, const_alpha, one_minus_const_alpha);
+
+        const __m256i half = _mm256_set1_epi16(0x80);
+        const __m256i colorMask = _mm256_set1_epi32(0x00ff00ff);
+        const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha);
+        const __m256i oneMinusConstAlpha = _mm256_set1_epi16(one_minus_const_alpha);
+        for (; x < length - 7; x += 8) {
+            __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            const __m256i result = _mm256_adds_epu8(colorVector, dstVector);
+            INTERPOLATE_PIXEL_255_AVX2(result, dstVector, constAlphaVector, oneMinusConstAlpha, colorMask, half);
+            _mm256_store_si256((__m256i *)&dst[x], dstVector);
+        }
+
+        SIMD_EPILOGUE(x, length, 7)
+            dst[x] = comp_func_Plus_one_pixel_const_alpha(dst[x], color, const_alpha, one_minus_const_alpha);
+    }
+}
+
+#if QT_CONFIG(raster_64bit)
+void QT_FASTCALL comp_func_Plus_rgb64_avx2(QRgba64 *dst, const QRgba64 *src, int length, uint const_alpha)
+{
+    Q_ASSERT(const_alpha < 256); // const_alpha is in [0-255]
+    int x = 0;
+
+    if (const_alpha == 255) {
+        for (; x < length && (quintptr(dst + x) & 31); ++x)
+            dst[x] = addWithSaturation(dst[x], src[x]);
+
+        for (; x < length - 3; x += 4) {
+            const __m256i srcVector = _mm256_lddqu_si256((const __m256i *)&src[x]);
+            const __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            _mm256_store_si256((__m256i *)&dst[x], _mm256_adds_epu16(srcVector, dstVector));
+        }
+
+        SIMD_EPILOGUE(x, length, 3)
+            dst[x] = addWithSaturation(dst[x], src[x]);
+    } else {
+        const uint ia = 255 - const_alpha;
+
+        for (; x < length && (quintptr(dst + x) & 31); ++x)
+            dst[x] = interpolate255(addWithSaturation(dst[x], src[x]), const_alpha, dst[x], ia);
+
+        const __m256i half = _mm256_set1_epi32(0x8000);
+        const __m256i colorMask = _mm256_set1_epi32(0x0000ffff);
+        const __m256i constAlphaVector = _mm256_set1_epi32(const_alpha * 257);
+        const __m256i oneMinusConstAlpha = _mm256_set1_epi32(ia * 257);
+        for (; x < length - 3; x += 4) {
+            const __m256i srcVector = _mm256_lddqu_si256((const __m256i *)&src[x]);
+            __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            const __m256i result = _mm256_adds_epu16(srcVector, dstVector);
+            INTERPOLATE_PIXEL_RGB64_AVX2(result, dstVector, constAlphaVector, oneMinusConstAlpha, colorMask, half);
+            _mm256_store_si256((__m256i *)&dst[x], dstVector);
+        }
+
+        SIMD_EPILOGUE(x, length, 3)
+            dst[x] = interpolate255(addWithSaturation(dst[x], src[x]), const_alpha, dst[x], ia);
+    }
+}
+
+void QT_FASTCALL comp_func_solid_Plus_rgb64_avx2(QRgba64 *dst, int length, QRgba64 color, uint const_alpha)
+{
+    Q_ASSERT(const_alpha < 256); // const_alpha is in [0-255]
+    int x = 0;
+    const __m256i colorVector = _mm256_set1_epi64x(color);
+
+    if (const_alpha == 255) {
+        for (; x < length && (quintptr(dst + x) & 31); ++x)
+            dst[x] = addWithSaturation(dst[x], color);
+
+        for (; x < length - 3; x += 4) {
+            const __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            _mm256_store_si256((__m256i *)&dst[x], _mm256_adds_epu16(colorVector, dstVector));
+        }
+
+        SIMD_EPILOGUE(x, length, 3)
+            dst[x] = addWithSaturation(dst[x], color);
+    } else {
+        const uint ia = 255 - const_alpha;
+
+        for (; x < length && (quintptr(dst + x) & 31); ++x)
+            dst[x] = interpolate255(addWithSaturation(dst[x], color), const_alpha, dst[x], ia);
+
+        const __m256i half = _mm256_set1_epi32(0x8000);
+        const __m256i colorMask = _mm256_set1_epi32(0x0000ffff);
+        const __m256i constAlphaVector = _mm256_set1_epi32(const_alpha * 257);
+        const __m256i oneMinusConstAlpha = _mm256_set1_epi32(ia * 257);
+        for (; x < length - 3; x += 4) {
+            __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            const __m256i result = _mm256_adds_epu16(colorVector, dstVector);
+            INTERPOLATE_PIXEL_RGB64_AVX2(result, dstVector, constAlphaVector, oneMinusConstAlpha, colorMask, half);
+            _mm256_store_si256((__m256i *)&dst[x], dstVector);
+        }
+
+        SIMD_EPILOGUE(x, length, 3)
+            dst[x] = interpolate255(addWithSaturation(dst[x], color), const_alpha, dst[x], ia);
+    }
+}
+#endif
+
+#if QT_CONFIG(raster_fp)
+// Like RgbaFPOperations::plus(), only the alpha is clamped
+static inline __m256 Q_DECL_VECTORCALL plus_rgbafp_avx2(__m256 a, __m256 b)
+{
+    a = _mm256_add_ps(a, b);
+    const __m256 aa = _mm256_max_ps(_mm256_min_ps(a, _mm256_set1_ps(1.0f)), _mm256_setzero_ps());
+    return _mm256_blend_ps(a, aa, 0x88);
+}
+
+static inline __m128 Q_DECL_VECTORCALL plus_rgbafp_avx2(__m128 a, __m128 b)
+{
+    a = _mm_add_ps(a, b);
+    const __m128 aa = _mm_max_ps(_mm_min_ps(a, _mm_set1_ps(1.0f)), _mm_setzero_ps());
+    return _mm_blend_ps(a, aa, 0x8);
+}
+
+void QT_FASTCALL comp_func_Plus_rgbafp_avx2(QRgbaFloat32 *dst, const QRgbaFloat32 *src, int length, uint const_alpha)
+{
+    Q_ASSERT(const_alpha < 256); // const_alpha is in [0-255]
+    int x = 0;
+    if (const_alpha == 255) {
+        for (; x < length - 1; x += 2) {
+            const __m256 srcVector = _mm256_loadu_ps((const float *)&src[x]);
+            const __m256 dstVector = _mm256_loadu_ps((const float *)&dst[x]);
+            _mm256_storeu_ps((float *)&dst[x], plus_rgbafp_avx2(dstVector, srcVector));
+        }
+        if (x < length) {
+            const __m128 srcVector = _mm_loadu_ps((const float *)&src[x]);
+            const __m128 dstVector = _mm_loadu_ps((const float *)&dst[x]);
+            _mm_storeu_ps((float *)&dst[x], plus_rgbafp_avx2(dstVector, srcVector));
+        }
+    } else {
+        const __m256 constAlphaVector = _mm256_set1_ps(const_alpha * (1.0f / 255.0f));
+        const __m256 oneMinusConstAlpha = _mm256_set1_ps((255 - const_alpha) * (1.0f / 255.0f));
+        for (; x < length - 1; x += 2) {
+            const __m256 srcVector = _mm256_loadu_ps((const float *)&src[x]);
+            const __m256 dstVector = _mm256_loadu_ps((const float *)&dst[x]);
+            const __m256 result = plus_rgbafp_avx2(dstVector, srcVector);
+            _mm256_storeu_ps((float *)&dst[x], _mm256_add_ps(_mm256_mul_ps(result, constAlphaVector),
+                                                             _mm256_mul_ps(dstVector, oneMinusConstAlpha)));
+        }
+        if (x < length) {
+            const __m128 srcVector = _mm_loadu_ps((const float *)&src[x]);
+            const __m128 dstVector = _mm_loadu_ps((const float *)&dst[x]);
+            const __m128 result = plus_rgbafp_avx2(dstVector, srcVector);
+            _mm_storeu_ps((float *)&dst[x], _mm_add_ps(_mm_mul_ps(result, _mm256_castps256_ps128(constAlphaVector)),
+                                                       _mm_mul_ps(dstVector, _mm256_castps256_ps128(oneMinusConstAlpha))));
+        }
+    }
+}
+
+void QT_FASTCALL comp_func_solid_Plus_rgbafp_avx2(QRgbaFloat32 *dst, int length, QRgbaFloat32 color, uint const_alpha)
+{
+    Q_ASSERT(const_alpha < 256); // const_alpha is in [0-255]
+    const __m128 colorVector = _mm_loadu_ps((const float *)&color);
+    const __m256 colorVector256 = _mm256_insertf128_ps(_mm256_castps128_ps256(colorVector), colorVector, 1);
+    int x = 0;
+    if (const_alpha == 255) {
+        for (; x < length - 1; x += 2) {
+            const __m256 dstVector = _mm256_loadu_ps((const float *)&dst[x]);
+            _mm256_storeu_ps((float *)&dst[x], plus_rgbafp_avx2(dstVector, colorVector256));
+        }
+        if (x < length) {
+            const __m128 dstVector = _mm_loadu_ps((const float *)&dst[x]);
+            _mm_storeu_ps((float *)&dst[x], plus_rgbafp_avx2(dstVector, colorVector));
+        }
+    } else {
+        const __m256 constAlphaVector = _mm256_set1_ps(const_alpha * (1.0f / 255.0f));
+        const __m256 oneMinusConstAlpha = _mm256_set1_ps((255 - const_alpha) * (1.0f / 255.0f));
+        for (; x < length - 1; x += 2) {
+            const __m256 dstVector = _mm256_loadu_ps((const float *)&dst[x]);
+            const __m256 result = plus_rgbafp_avx2(dstVector, colorVector256);
+            _mm256_storeu_ps((float *)&dst[x], _mm256_add_ps(_mm256_mul_ps(result, constAlphaVector),
+                                                             _mm256_mul_ps(dstVector, oneMinusConstAlpha)));
+        }
+        if (x < length) {
+            const __m128 dstVector = _mm_loadu_ps((const float *)&dst[x]);
+            const __m128 result = plus_rgbafp_avx2(dstVector, colorVector);
+            _mm_storeu_ps((float *)&dst[x], _mm_add_ps(_mm_mul_ps(result, _mm256_castps256_ps128(constAlphaVector)),
+                                                       _mm_mul_ps(dstVector, _mm256_castps256_ps128(oneMinusConstAlpha))));
+        }
+    }
+}
+#endif
+
 #define interpolate_4_pixels_16_avx2(tlr1, tlr2, blr1, blr2, distx, disty, colorMask, v_256, b)  \
 { \
     /* Correct for later unpack */ \
@@ -1359,6 +1595,101 @@ const QRgba64 *QT_FASTCALL fetchRGBA64ToRGBA64PM_avx2(QRgba64 *buffer, const uch
     return buffer;
 }
 
+template<bool RGBA>
+static void storeRGBA64FromARGB32_avx2(QRgba64 *d, const uint *src, int count)
+{
+    // ARGB32 has the bytes B, G, R, A in memory, and RGBA64 the channels R, G, B, A
+    const __m128i rgbaMask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    const __m128i alphaMask = _mm_set1_epi32(RGBA ? 0 : 0xff000000);
+    int i = 0;
+    for (; i < count - 3; i += 4) {
+        __m128i vs = _mm_loadu_si128((const __m128i *)(src + i));
+        vs = _mm_shuffle_epi8(_mm_or_si128(vs, alphaMask), rgbaMask);
+        // c * 257 expands 8 bits to 16 bits exactly, like QRgba64::fromArgb32()
+        __m256i vd = _mm256_cvtepu8_epi16(vs);
+        vd = _mm256_or_si256(vd, _mm256_slli_epi16(vd, 8));
+        _mm256_storeu_si256((__m256i *)(d + i), vd);
+    }
+    SIMD_EPILOGUE(i, count, 3)
+        d[i] = QRgba64::fromArgb32(RGBA ? src[i] : (src[i] | 0xff000000));
+}
+
+void QT_FASTCALL storeRGBA64FromARGB32_avx2(uchar *dest, const uint *src, int index, int count,
+                                            const QList<QRgb> *, QDitherInfo *)
+{
+    storeRGBA64FromARGB32_avx2<true>(reinterpret_cast<QRgba64 *>(dest) + index, src, count);
+}
+
+void QT_FASTCALL storeRGB64FromRGB32_avx2(uchar *dest, const uint *src, int index, int count,
+                                          const QList<QRgb> *, QDitherInfo *)
+{
+    storeRGBA64FromARGB32_avx2<false>(reinterpret_cast<QRgba64 *>(dest) + index, src, count);
+}
+
+template<QtPixelOrder PixelOrder>
+static void convertA2RGB30PMToARGB32PM_avx2(uint *buffer, const uint *src, qsizetype count)
+{
+    const __m256i alphaFactor = _mm256_set1_epi32(0x55);
+    const __m256i redMask = _mm256_set1_epi32(0x00ff0000);
+    const __m256i greenMask = _mm256_set1_epi32(0x0000ff00);
+    const __m256i blueMask = _mm256_set1_epi32(0x000000ff);
+
+    qsizetype i = 0;
+    for (; i < count - 7; i += 8) {
+        const __m256i vs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        // the 2-bit alpha times 0x55 always fits in the low 16 bits of each pixel
+        __m256i va = _mm256_mullo_epi16(_mm256_srli_epi32(vs, 30), alphaFactor);
+        va = _mm256_slli_epi32(va, 24);
+        const __m256i vg = _mm256_and_si256(_mm256_srli_epi32(vs, 4), greenMask);
+        __m256i vr, vb;
+        if (PixelOrder == PixelOrderRGB) {
+            vr = _mm256_and_si256(_mm256_srli_epi32(vs, 6), redMask);
+            vb = _mm256_and_si256(_mm256_srli_epi32(vs, 2), blueMask);
+        } else {
+            vr = _mm256_and_si256(_mm256_slli_epi32(vs, 14), redMask);
+            vb = _mm256_and_si256(_mm256_srli_epi32(vs, 22), blueMask);
+        }
+        const __m256i vd = _mm256_or_si256(_mm256_or_si256(va, vr), _mm256_or_si256(vg, vb));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer + i), vd);
+    }
+
+    SIMD_EPILOGUE(i, count, 7)
+        buffer[i] = qConvertA2rgb30ToArgb32<PixelOrder>(src[i]);
+}
+
+template<QtPixelOrder PixelOrder>
+void QT_FASTCALL convertA2RGB30PMToARGB32PM_avx2(uint *buffer, int count, const QList<QRgb> *)
+{
+    convertA2RGB30PMToARGB32PM_avx2<PixelOrder>(buffer, buffer, count);
+}
+
+template<QtPixelOrder PixelOrder>
+const uint *QT_FASTCALL fetchA2RGB30PMToARGB32PM_avx2(uint *buffer, const uchar *s, int index, int count,
+                                                      const QList<QRgb> *, QDitherInfo *dither)
+{
+    const uint *src = reinterpret_cast<const uint *>(s) + index;
+    if (!dither) {
+        convertA2RGB30PMToARGB32PM_avx2<PixelOrder>(buffer, src, count);
+    } else {
+        for (int i = 0; i < count; ++i) {
+            const short d10 = (qt_bayer_matrix[dither->y & 15][(dither->x + i) & 15] << 2);
+            buffer[i] = qConvertA2rgb30ToArgb32Dithered<PixelOrder>(src[i], d10);
+        }
+    }
+    return buffer;
+}
+
+template
+void QT_FASTCALL convertA2RGB30PMToARGB32PM_avx2<PixelOrderBGR>(uint *buffer, int count, const QList<QRgb> *);
+template
+void QT_FASTCALL convertA2RGB30PMToARGB32PM_avx2<PixelOrderRGB>(uint *buffer, int count, const QList<QRgb> *);
+template
+const uint *QT_FASTCALL fetchA2RGB30PMToARGB32PM_avx2<PixelOrderBGR>(uint *buffer, const uchar *s, int index, int count,
+                                                                     const QList<QRgb> *, QDitherInfo *dither);
+template
+const uint *QT_FASTCALL fetchA2RGB30PMToARGB32PM_avx2<PixelOrderRGB>(uint *buffer, const uchar *s, int index, int count,
+                                                                     const QList<QRgb> *, QDitherInfo *dither);
+
 const uint *QT_FASTCALL fetchRGB16FToRGB32_avx2(uint *buffer, const uchar *src, int index, int count,
                                                 const QList<QRgb> *, QDitherInfo *)
 {
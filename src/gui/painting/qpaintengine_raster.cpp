@@ -15,6 +15,7 @@
 #include <qbitmap.h>
 #include "qmath_p.h"
 #include <qrandom.h>
+#include <qhash.h>
 
 //   #include <private/qdatabuffer_p.h>
 //   #include <private/qpainter_p.h>
@@ -36,6 +37,10 @@
 
 #include <limits.h>
 #include <algorithm>
+#include <array>
+#include <list>
+#include <memory>
+#include <vector>
 
 #ifdef Q_OS_WIN
 #  include <qvarlengtharray.h>
@@ -231,9 +236,16 @@ static void qt_debug_path(const QPainterPath &path)
 }
 #endif
 
+static bool qt_path_cache_enabled_by_default()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_RASTER_PATH_CACHE") != 0;
+    return enabled;
+}
+
 QRasterPaintEnginePrivate::QRasterPaintEnginePrivate() :
     QPaintEngineExPrivate(),
-    cachedLines(0)
+    cachedLines(0),
+    pathCacheEnabled(qt_path_cache_enabled_by_default())
 {
 }
 
@@ -1605,9 +1617,16 @@ void QRasterPaintEngine::stroke(const QVectorPath &path, const QPen &pen)
                 d->rasterizeLine_dashed(line, width, &dIndex, &dOffset, &inD);
             }
         }
-    }
-    else
+    } else if (d->pathCacheEnabled && qpen_style(pen) == Qt::SolidLine && !pen.isCosmetic()) {
+        // The stroke is filled with the pen's brush; see QPaintEngineEx::stroke()
+        ensureBrush(pen.brush());
+        if (!s->brushData.blend)
+            return;
+        if (!d->drawCachedPath(path, &pen))
+            QPaintEngineEx::stroke(path, pen);
+    } else {
         QPaintEngineEx::stroke(path, pen);
+    }
 }
 
 QRect QRasterPaintEngine::toNormalizedFillRect(const QRectF &rect)
@@ -1647,6 +1666,13 @@ void QRasterPaintEngine::fill(const QVectorPath &path, const QBrush &brush)
     if (!s->brushData.blend)
         return;
 
+    if (d->pathCacheRecording) {
+        // Filling the outline of a stroke that is being cached
+        ensureOutlineMapper();
+        if (d->recordPath(path, d->pathCacheRecording))
+            return;
+    }
+
     if (path.shape() == QVectorPath::RectangleHint) {
         if (!s->flags.antialiased && s->matrix.type() <= QTransform::TxScale) {
             const qreal *p = path.points();
@@ -1693,9 +1719,406 @@ void QRasterPaintEngine::fill(const QVectorPath &path, const QBrush &brush)
 //         }
 
     ensureOutlineMapper();
+    if (d->pathCacheEnabled && d->drawCachedPath(path, nullptr))
+        return;
     d->rasterize(d->outlineMapper->convertPath(path), blend, &s->brushData, d->rasterBuffer.data());
 }
 
+/*******************************************************************************
+ * Path cache
+ *
+ * Keeps the coverage spans that a path was rasterized to, so that drawing the
+ * same QPainterPath again with the same scale, rotation and pen only has to
+ * blend them, also when it has been moved by a translation. Like the OpenGL
+ * engine, a path is only cached when it is drawn the second time. The spans
+ * are kept per thread, for all the raster paint engines used on it, and are
+ * looked up by the contents of the path, so that the QVectorPath, which may
+ * be shared with other threads, is never written to. The paths drawn least
+ * recently are evicted when the cache is full, and the rest are released when
+ * the thread finishes.
+ */
+static constexpr int PathCacheMaxVariants = 4;
+static constexpr int PathCacheMaxExtent = 8192;
+static constexpr size_t PathCacheMaxSpans = 64 * 1024;
+static constexpr qsizetype PathCacheMaxBytes = 64 * 1024 * 1024;
+static constexpr size_t PathCacheSeenPaths = 32;
+static constexpr uint PathCacheHintMask = QVectorPath::ShapeMask | QVectorPath::OddEvenFill
+        | QVectorPath::WindingFill | QVectorPath::ImplicitClose | QVectorPath::ExplicitOpen;
+
+// held by the caches of all threads
+Q_CONSTINIT static QBasicAtomicInteger<qsizetype> pathCacheBytes = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+struct QRasterPathCacheKey
+{
+    qreal m11, m12, m21, m22;
+    qreal fractionalDx, fractionalDy;
+    qreal penWidth; // negative for fills
+    qreal miterLimit;
+    int capStyle;
+    int joinStyle;
+    bool antialiased;
+    bool windingFill;
+
+    friend bool operator==(const QRasterPathCacheKey &a, const QRasterPathCacheKey &b)
+    {
+        return a.m11 == b.m11 && a.m12 == b.m12 && a.m21 == b.m21 && a.m22 == b.m22
+            && a.fractionalDx == b.fractionalDx && a.fractionalDy == b.fractionalDy
+            && a.penWidth == b.penWidth && a.miterLimit == b.miterLimit
+            && a.capStyle == b.capStyle && a.joinStyle == b.joinStyle
+            && a.antialiased == b.antialiased && a.windingFill == b.windingFill;
+    }
+};
+
+struct QRasterCachedSpans
+{
+    QRasterPathCacheKey key;
+    QPoint origin; // integer part of the translation the spans were rasterized with
+    QRect bounds;
+    std::vector<QT_FT_Span> spans;
+};
+
+struct QRasterPathCacheRecording
+{
+    std::vector<QT_FT_Span> spans;
+    bool recorded = false;
+};
+
+struct QRasterPathCacheEntry
+{
+    size_t hash;
+    uint hints;
+    std::vector<qreal> points;
+    std::vector<QPainterPath::ElementType> elements;
+    std::vector<QRasterCachedSpans> variants; // most recently used first
+    qsizetype bytes = 0;
+
+    bool matches(const QVectorPath &path) const
+    {
+        const int count = path.elementCount();
+        if (hints != (path.hints() & PathCacheHintMask) || points.size() != size_t(count) * 2
+            || elements.size() != (path.elements() ? size_t(count) : 0)) {
+            return false;
+        }
+        return memcmp(points.data(), path.points(), points.size() * sizeof(qreal)) == 0
+            && (elements.empty()
+                || memcmp(elements.data(), path.elements(),
+                          elements.size() * sizeof(QPainterPath::ElementType)) == 0);
+    }
+};
+
+static size_t qt_path_cache_hash(const QVectorPath &path)
+{
+    const size_t count = size_t(path.elementCount());
+    size_t seed = qHash(path.hints() & PathCacheHintMask);
+    seed = qHashBits(path.points(), count * 2 * sizeof(qreal), seed);
+    if (path.elements())
+        seed = qHashBits(path.elements(), count * sizeof(QPainterPath::ElementType), seed);
+    return seed;
+}
+
+class QRasterPathCache
+{
+public:
+    ~QRasterPathCache() { pathCacheBytes.fetchAndSubRelaxed(bytes); }
+
+    QRasterPathCacheEntry *find(size_t hash, const QVectorPath &path);
+    bool markSeen(size_t hash);
+    void insert(size_t hash, const QVectorPath &path, QRasterCachedSpans &&variant);
+
+private:
+    void erase(std::list<QRasterPathCacheEntry>::iterator it);
+
+    std::list<QRasterPathCacheEntry> entries; // most recently used first
+    QHash<size_t, std::list<QRasterPathCacheEntry>::iterator> index;
+    std::array<size_t, PathCacheSeenPaths> seen = {};
+    size_t nextSeen = 0;
+    qsizetype bytes = 0;
+};
+
+static QRasterPathCache *qt_path_cache()
+{
+    static thread_local QRasterPathCache cache;
+    return &cache;
+}
+
+QRasterPathCacheEntry *QRasterPathCache::find(size_t hash, const QVectorPath &path)
+{
+    const auto it = index.constFind(hash);
+    if (it == index.cend() || !(*it)->matches(path))
+        return nullptr;
+    entries.splice(entries.begin(), entries, *it);
+    return &entries.front();
+}
+
+/*
+    Returns whether a path with \a hash was drawn recently, and remembers it
+    if it was not.
+*/
+bool QRasterPathCache::markSeen(size_t hash)
+{
+    if (std::find(seen.cbegin(), seen.cend(), hash) != seen.cend())
+        return true;
+    seen[nextSeen] = hash;
+    nextSeen = (nextSeen + 1) % seen.size();
+    return false;
+}
+
+void QRasterPathCache::erase(std::list<QRasterPathCacheEntry>::iterator it)
+{
+    bytes -= it->bytes;
+    pathCacheBytes.fetchAndSubRelaxed(it->bytes);
+    index.remove(it->hash);
+    entries.erase(it);
+}
+
+void QRasterPathCache::insert(size_t hash, const QVectorPath &path, QRasterCachedSpans &&variant)
+{
+    auto it = entries.end();
+    if (const auto found = index.constFind(hash); found != index.cend()) {
+        if ((*found)->matches(path))
+            it = *found;
+        else
+            erase(*found); // a different path with the same hash
+    }
+
+    if (it == entries.end()) {
+        const int count = path.elementCount();
+        QRasterPathCacheEntry entry;
+        entry.hash = hash;
+        entry.hints = path.hints() & PathCacheHintMask;
+        entry.points.assign(path.points(), path.points() + count * 2);
+        if (path.elements())
+            entry.elements.assign(path.elements(), path.elements() + count);
+        entry.bytes = qsizetype(entry.points.size() * sizeof(qreal)
+                                + entry.elements.size() * sizeof(QPainterPath::ElementType));
+        bytes += entry.bytes;
+        pathCacheBytes.fetchAndAddRelaxed(entry.bytes);
+        entries.push_front(std::move(entry));
+        index.insert(hash, entries.begin());
+    } else {
+        entries.splice(entries.begin(), entries, it);
+    }
+    QRasterPathCacheEntry &entry = entries.front();
+    const qsizetype needed = qsizetype(variant.spans.size() * sizeof(QT_FT_Span));
+
+    if (entry.variants.size() == PathCacheMaxVariants) {
+        const qsizetype evicted = qsizetype(entry.variants.back().spans.size() * sizeof(QT_FT_Span));
+        entry.bytes -= evicted;
+        bytes -= evicted;
+        pathCacheBytes.fetchAndSubRelaxed(evicted);
+        entry.variants.pop_back();
+    }
+    while (pathCacheBytes.loadRelaxed() + needed > PathCacheMaxBytes && entries.size() > 1)
+        erase(std::prev(entries.end()));
+    if (pathCacheBytes.loadRelaxed() + needed > PathCacheMaxBytes) {
+        // the other threads hold the rest
+        if (entry.variants.empty())
+            erase(entries.begin());
+        return;
+    }
+
+    entry.variants.insert(entry.variants.begin(), std::move(variant));
+    entry.bytes += needed;
+    bytes += needed;
+    pathCacheBytes.fetchAndAddRelaxed(needed);
+}
+
+static void qt_span_record(int count, const QT_FT_Span *spans, void *userData)
+{
+    QRasterPathCacheRecording *recording = static_cast<QRasterPathCacheRecording *>(userData);
+    recording->spans.insert(recording->spans.end(), spans, spans + count);
+}
+
+/*!
+    \internal
+
+    Enables caching of the coverage of paths that are filled or stroked
+    repeatedly. The cache is disabled by default, unless the
+    \c QT_RASTER_PATH_CACHE environment variable is set to a non-zero value.
+*/
+void QRasterPaintEngine::setPathCacheEnabled(bool enabled)
+{
+    Q_D(QRasterPaintEngine);
+    d->pathCacheEnabled = enabled;
+}
+
+/*!
+    \internal
+*/
+bool QRasterPaintEngine::isPathCacheEnabled() const
+{
+    Q_D(const QRasterPaintEngine);
+    return d->pathCacheEnabled;
+}
+
+/*!
+    \internal
+
+    Returns how often this engine drew a path from the cache, and how often
+    it had to rasterize one to cache it. The cached bytes are those held by
+    the caches of all threads in the process.
+*/
+QRasterPaintEngine::PathCacheStatistics QRasterPaintEngine::pathCacheStatistics() const
+{
+    Q_D(const QRasterPaintEngine);
+    PathCacheStatistics statistics = d->pathCacheStatistics;
+    statistics.cachedBytes = pathCacheBytes.loadRelaxed();
+    return statistics;
+}
+
+/*!
+    \internal
+
+    Rasterizes \a path with the current transform into \a recording instead
+    of drawing it. Returns \c false, without rasterizing anything, if the path
+    is too large to be cached.
+*/
+bool QRasterPaintEnginePrivate::recordPath(const QVectorPath &path, QRasterPathCacheRecording *recording)
+{
+    Q_Q(QRasterPaintEngine);
+    QRasterPaintEngineState *s = q->state();
+
+    const QRectF bounds = s->matrix.mapRect(path.controlPointRect());
+    const QRectF limit(QPointF(-QT_RASTER_COORD_LIMIT / 2, -QT_RASTER_COORD_LIMIT / 2),
+                       QPointF(QT_RASTER_COORD_LIMIT / 2, QT_RASTER_COORD_LIMIT / 2));
+    if (!(bounds.width() <= PathCacheMaxExtent && bounds.height() <= PathCacheMaxExtent)
+        || !limit.contains(bounds)) {
+        return false;
+    }
+
+    // Rasterize all of the path, not just what is on the device, so that the
+    // spans can be reused wherever the path is moved to
+    const QRect clipRect = bounds.toAlignedRect().adjusted(-1, -1, 1, 1);
+    outlineMapper->setClipRect(clipRect);
+    rasterize(outlineMapper->convertPath(path), qt_span_record, recording, clipRect);
+    outlineMapper->setClipRect(deviceRect);
+    recording->recorded = true;
+    return true;
+}
+
+/*!
+    \internal
+
+    Blends the spans in \a cached, moved to the integer translation
+    \a origin, with \a data.
+*/
+void QRasterPaintEnginePrivate::drawCachedSpans(const QRasterCachedSpans &cached, const QPoint &origin,
+                                                QSpanData *data)
+{
+    const QPoint offset = origin - cached.origin;
+    const QRect clipped = cached.bounds.translated(offset) & deviceRect;
+    if (clipped.isEmpty())
+        return;
+    ProcessSpans blend = getBrushFunc(clipped, data);
+    if (!blend)
+        return;
+
+    constexpr int BufferSize = 256;
+    QT_FT_Span buffer[BufferSize];
+    int count = 0;
+    for (const QT_FT_Span &span : cached.spans) {
+        const int y = span.y + offset.y();
+        if (y < clipped.top() || y > clipped.bottom())
+            continue;
+        const int x1 = qMax(span.x + offset.x(), clipped.left());
+        const int x2 = qMin(span.x + offset.x() + span.len, clipped.right() + 1);
+        if (x1 >= x2)
+            continue;
+        buffer[count++] = { x1, x2 - x1, y, span.coverage };
+        if (count == BufferSize) {
+            blend(count, buffer, data);
+            count = 0;
+        }
+    }
+    if (count)
+        blend(count, buffer, data);
+}
+
+/*!
+    \internal
+
+    Fills \a path with the current brush, or strokes it with \a pen if that
+    is not null, from the spans cached for it. Returns \c false if nothing
+    was drawn, and the path has to be drawn without the cache.
+*/
+bool QRasterPaintEnginePrivate::drawCachedPath(const QVectorPath &path, const QPen *pen)
+{
+    Q_Q(QRasterPaintEngine);
+    QRasterPaintEngineState *s = q->state();
+
+    const QTransform &m = s->matrix;
+    if (m.type() >= QTransform::TxProject
+        || !(qAbs(m.dx()) < QT_RASTER_COORD_LIMIT && qAbs(m.dy()) < QT_RASTER_COORD_LIMIT)) {
+        return false;
+    }
+
+    QRasterPathCache *cache = qt_path_cache();
+    const size_t hash = qt_path_cache_hash(path);
+    QRasterPathCacheEntry *entry = cache->find(hash, path);
+    // Only remember the path the first time, so that it is cached if it is drawn again
+    if (!entry && !cache->markSeen(hash))
+        return false;
+
+    const QPoint origin(qFloor(m.dx()), qFloor(m.dy()));
+    QRasterPathCacheKey key = { m.m11(), m.m12(), m.m21(), m.m22(),
+                                m.dx() - origin.x(), m.dy() - origin.y(),
+                                -1, 0, 0, 0, bool(s->flags.antialiased), path.hasWindingFill() };
+    if (pen) {
+        key.penWidth = pen->widthF();
+        key.miterLimit = pen->miterLimit();
+        key.capStyle = pen->capStyle();
+        key.joinStyle = pen->joinStyle();
+    }
+    if (entry) {
+        auto &variants = entry->variants;
+        const auto it = std::find_if(variants.begin(), variants.end(),
+                                     [&key](const QRasterCachedSpans &variant) {
+            return variant.key == key;
+        });
+        if (it != variants.end()) {
+            std::rotate(variants.begin(), it, it + 1);
+            ++pathCacheStatistics.hits;
+            drawCachedSpans(variants.front(), origin, &s->brushData);
+            return true;
+        }
+    }
+    ++pathCacheStatistics.misses;
+
+    QRasterPathCacheRecording recording;
+    if (pen) {
+        // The stroke's outline is recorded when QPaintEngineEx::stroke() fills it
+        pathCacheRecording = &recording;
+        q->QPaintEngineEx::stroke(path, *pen);
+        pathCacheRecording = nullptr;
+        if (!recording.recorded)
+            return true;
+    } else if (!recordPath(path, &recording)) {
+        return false;
+    }
+
+    QRasterCachedSpans variant;
+    variant.key = key;
+    variant.origin = origin;
+    variant.spans = std::move(recording.spans);
+    if (!variant.spans.empty()) {
+        int x1 = INT_MAX, y1 = INT_MAX, x2 = INT_MIN, y2 = INT_MIN;
+        for (const QT_FT_Span &span : variant.spans) {
+            x1 = qMin(x1, span.x);
+            x2 = qMax(x2, span.x + span.len - 1);
+            y1 = qMin(y1, span.y);
+            y2 = qMax(y2, span.y);
+        }
+        variant.bounds = QRect(QPoint(x1, y1), QPoint(x2, y2));
+    }
+    drawCachedSpans(variant, origin, &s->brushData);
+
+    if (variant.spans.size() > PathCacheMaxSpans)
+        return true;
+    variant.spans.shrink_to_fit();
+    cache->insert(hash, path, std::move(variant));
+    return true;
+}
+
 void QRasterPaintEngine::fillRect(const QRectF &r, QSpanData *data)
 {
     Q_D(QRasterPaintEngine);
@@ -3572,6 +3995,13 @@ static inline uchar *alignAddress(uchar *address, quintptr alignmentMask)
 void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
                                           ProcessSpans callback,
                                           void *userData, QRasterBuffer *)
+{
+    rasterize(outline, callback, userData, deviceRect);
+}
+
+void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
+                                          ProcessSpans callback,
+                                          void *userData, const QRect &clipRect)
 {
     if (!callback || !outline)
         return;
@@ -3581,7 +4011,7 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
 
     if (!s->flags.antialiased) {
         rasterizer->setAntialiased(s->flags.antialiased);
-        rasterizer->setClipRect(deviceRect);
+        rasterizer->setClipRect(clipRect);
         rasterizer->initialize(callback, userData);
 
         const Qt::FillRule fillRule = outline->flags == QT_FT_OUTLINE_NONE
@@ -3605,10 +4035,10 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
 
     void *data = userData;
 
-    QT_FT_BBox clip_box = { deviceRect.x(),
-                            deviceRect.y(),
-                            deviceRect.x() + deviceRect.width(),
-                            deviceRect.y() + deviceRect.height() };
+    QT_FT_BBox clip_box = { clipRect.x(),
+                            clipRect.y(),
+                            clipRect.x() + clipRect.width(),
+                            clipRect.y() + clipRect.height() };
 
     QT_FT_Raster_Params rasterParams;
     rasterParams.target = nullptr;
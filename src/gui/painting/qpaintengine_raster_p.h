@@ -35,6 +35,8 @@ class QOutlineMapper;
 class QRasterPaintEnginePrivate;
 class QRasterBuffer;
 class QClipData;
+struct QRasterCachedSpans;
+struct QRasterPathCacheRecording;
 
 class QRasterPaintEngineState : public QPainterState
 {
@@ -188,6 +190,16 @@ public:
     bool requiresPretransformedGlyphPositions(QFontEngine *fontEngine, const QTransform &m) const override;
     bool shouldDrawCachedGlyphs(QFontEngine *fontEngine, const QTransform &m) const override;
 
+    struct PathCacheStatistics
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        qsizetype cachedBytes = 0;
+    };
+    void setPathCacheEnabled(bool enabled);
+    bool isPathCacheEnabled() const;
+    PathCacheStatistics pathCacheStatistics() const;
+
 protected:
     QRasterPaintEngine(QRasterPaintEnginePrivate &d, QPaintDevice *);
 private:
@@ -239,6 +251,7 @@ public:
                               int *dashIndex, qreal *dashOffset, bool *inDash);
     void rasterize(QT_FT_Outline *outline, ProcessSpans callback, QSpanData *spanData, QRasterBuffer *rasterBuffer);
     void rasterize(QT_FT_Outline *outline, ProcessSpans callback, void *userData, QRasterBuffer *rasterBuffer);
+    void rasterize(QT_FT_Outline *outline, ProcessSpans callback, void *userData, const QRect &clipRect);
     void updateMatrixData(QSpanData *spanData, const QBrush &brush, const QTransform &brushMatrix);
     void updateClipping();
 
@@ -272,6 +285,10 @@ public:
     bool canUseFastImageBlending(QPainter::CompositionMode mode, const QImage &image) const;
     bool canUseImageBlitting(QPainter::CompositionMode mode, const QImage &image, const QPointF &pt, const QRectF &sr) const;
 
+    bool drawCachedPath(const QVectorPath &path, const QPen *pen);
+    bool recordPath(const QVectorPath &path, QRasterPathCacheRecording *recording);
+    void drawCachedSpans(const QRasterCachedSpans &cached, const QPoint &origin, QSpanData *data);
+
     QPaintDevice *device;
     QScopedPointer<QOutlineMapper> outlineMapper;
     QScopedPointer<QRasterBuffer>  rasterBuffer;
@@ -304,6 +321,10 @@ public:
     uint outlinemapper_xform_dirty : 1;
 
     QScopedPointer<QRasterizer> rasterizer;
+
+    bool pathCacheEnabled;
+    QRasterPaintEngine::PathCacheStatistics pathCacheStatistics;
+    QRasterPathCacheRecording *pathCacheRecording = nullptr;
 };
 
 
@@ -416,7 +437,7 @@ public:
     QPainter::CompositionMode compositionMode;
     QImage::Format format;
     QColorSpace colorSpace;
-    QImage colorizeBitmap(const QImage &image, const QColor &color);
+    static QImage colorizeBitmap(const QImage &image, const QColor &color);
 
 private:
     int m_width;
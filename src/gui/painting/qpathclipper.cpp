@@ -14,9 +14,10 @@
 
   1. Find all intersections between the two paths (including self-intersections),
      and build a winged edge structure of non-intersecting parts.
-  2. While there are more unhandled edges:
+  2. While there are more unhandled edges, tallest first:
     3. Pick a y-coordinate from an unhandled edge.
-    4. Intersect the horizontal line at y-coordinate with all edges.
+    4. Intersect the horizontal line at y-coordinate with all edges, looking the
+       crossing edges up in a segment tree over the y-coordinates of the vertices.
     5. Traverse intersections left to right deciding whether each subpath should be added or not.
     6. If the subpath should be added, traverse the winged-edge structure and add the edges to
        a separate winged edge structure.
@@ -1441,12 +1442,17 @@ static void clear(QWingedEdge& list, int edge, QPathEdge::Traversal traversal)
     } while (status.edge != edge);
 }
 
+// finds the first value in the sorted range that compares fuzzily equal to val
 template <typename InputIterator>
 InputIterator qFuzzyFind(InputIterator first, InputIterator last, qreal val)
 {
-    while (first != last && !QT_PREPEND_NAMESPACE(qFuzzyCompare)(qreal(*first), qreal(val)))
-        ++first;
-    return first;
+    // only the neighbors of the insertion point can compare equal
+    InputIterator it = std::lower_bound(first, last, val);
+    if (it != first && QT_PREPEND_NAMESPACE(qFuzzyCompare)(qreal(*(it - 1)), qreal(val)))
+        return it - 1;
+    if (it != last && QT_PREPEND_NAMESPACE(qFuzzyCompare)(qreal(*it), qreal(val)))
+        return it;
+    return last;
 }
 
 static bool fuzzyCompare(qreal a, qreal b)
@@ -1582,6 +1588,174 @@ QPainterPath QPathClipper::clip(Operation operation)
     return path;
 }
 
+struct QCrossingEdge
+{
+    int edge;
+    qreal x;
+
+    bool operator<(const QCrossingEdge &edge) const
+    {
+        return x < edge.x;
+    }
+};
+Q_DECLARE_TYPEINFO(QCrossingEdge, Q_PRIMITIVE_TYPE);
+
+namespace {
+
+// Finds the biggest gap between consecutive y-coordinates in a range of them
+// in constant time, using a sparse table of the biggest gaps in ranges of
+// power of two length.
+class QBiggestGapFinder
+{
+public:
+    explicit QBiggestGapFinder(const QList<qreal> &coords);
+
+    // returns the index i in [first, last) with the biggest gap between
+    // coords[i] and coords[i + 1], the lowest one if there are several
+    int find(int first, int last) const;
+
+private:
+    qreal gap(int i) const { return m_coords.at(i + 1) - m_coords.at(i); }
+    int bigger(int a, int b) const
+    {
+        const qreal ga = gap(a);
+        const qreal gb = gap(b);
+        return gb > ga || (gb == ga && b < a) ? b : a;
+    }
+
+    const QList<qreal> &m_coords;
+    QList<QList<int>> m_levels;
+};
+
+QBiggestGapFinder::QBiggestGapFinder(const QList<qreal> &coords)
+    : m_coords(coords)
+{
+    const int gaps = int(coords.size()) - 1;
+    if (gaps <= 0)
+        return;
+
+    QList<int> level(gaps);
+    for (int i = 0; i < gaps; ++i)
+        level[i] = i;
+    m_levels << level;
+    for (int length = 2; length <= gaps; length *= 2) {
+        const QList<int> &previous = m_levels.last();
+        QList<int> next(gaps - length + 1);
+        for (int i = 0; i < next.size(); ++i)
+            next[i] = bigger(previous.at(i), previous.at(i + length / 2));
+        m_levels << next;
+    }
+}
+
+int QBiggestGapFinder::find(int first, int last) const
+{
+    if (last - first <= 1)
+        return first;
+    const int level = 31 - qCountLeadingZeroBits(quint32(last - first));
+    const QList<int> &gaps = m_levels.at(level);
+    return bigger(gaps.at(first), gaps.at(last - (1 << level)));
+}
+
+// Finds the edges crossing a horizontal line between two consecutive
+// y-coordinates of the vertices. The edges are stored in a segment tree over
+// the gaps between the y-coordinates, which reports the edges spanning a gap
+// without testing every edge of the winged edge structure.
+class QCrossingEdgeFinder
+{
+public:
+    QCrossingEdgeFinder(const QWingedEdge &list, const QList<qreal> &coords);
+
+    // finds the edges crossing y, which lies in the given gap
+    void find(int gap, qreal y, QList<QCrossingEdge> *crossings) const;
+
+private:
+    template <typename Visitor>
+    void forEachNode(int first, int last, Visitor visit) const;
+
+    const QWingedEdge &m_list;
+    int m_gaps;
+    QList<int> m_nodeOffsets;
+    QList<int> m_edges;
+    mutable QList<int> m_candidates;
+};
+
+template <typename Visitor>
+void QCrossingEdgeFinder::forEachNode(int first, int last, Visitor visit) const
+{
+    // the nodes covering the gaps [first, last] in a bottom-up segment tree
+    for (first += m_gaps, last += m_gaps + 1; first < last; first >>= 1, last >>= 1) {
+        if (first & 1)
+            visit(first++);
+        if (last & 1)
+            visit(--last);
+    }
+}
+
+QCrossingEdgeFinder::QCrossingEdgeFinder(const QWingedEdge &list, const QList<qreal> &coords)
+    : m_list(list),
+      m_gaps(qMax(int(coords.size()) - 1, 1))
+{
+    QList<int> gapRanges;
+    gapRanges.reserve(2 * list.edgeCount());
+    for (int i = 0; i < list.edgeCount(); ++i) {
+        const QPathEdge *edge = list.edge(i);
+        const qreal y0 = list.vertex(edge->first)->y;
+        const qreal y1 = list.vertex(edge->second)->y;
+        if (y0 == y1) {
+            // never crosses a horizontal line
+            gapRanges << 0 << -1;
+            continue;
+        }
+        int first = qFuzzyFind(coords.cbegin(), coords.cend(), qMin(y0, y1)) - coords.cbegin();
+        int last = qFuzzyFind(coords.cbegin(), coords.cend(), qMax(y0, y1)) - coords.cbegin();
+        if (first >= coords.size() || last >= coords.size()) {
+            first = 0;
+            last = m_gaps - 1;
+        }
+        // include the neighboring gaps, so that the edges found are a superset
+        // of those crossing, however fuzzily the coordinates were merged
+        gapRanges << qMax(first - 1, 0) << qMin(last, m_gaps - 1);
+    }
+
+    m_nodeOffsets.fill(0, 2 * m_gaps + 1);
+    for (int i = 0; i < list.edgeCount(); ++i)
+        forEachNode(gapRanges.at(2 * i), gapRanges.at(2 * i + 1), [&](int node) { ++m_nodeOffsets[node + 1]; });
+    for (int node = 0; node < 2 * m_gaps; ++node)
+        m_nodeOffsets[node + 1] += m_nodeOffsets.at(node);
+
+    QList<int> next = m_nodeOffsets;
+    m_edges.resize(m_nodeOffsets.last());
+    for (int i = 0; i < list.edgeCount(); ++i)
+        forEachNode(gapRanges.at(2 * i), gapRanges.at(2 * i + 1), [&](int node) { m_edges[next[node]++] = i; });
+}
+
+void QCrossingEdgeFinder::find(int gap, qreal y, QList<QCrossingEdge> *crossings) const
+{
+    // the nodes containing a gap are those on the path from its leaf to the root
+    m_candidates.clear();
+    for (int node = gap + m_gaps; node > 0; node >>= 1) {
+        for (int i = m_nodeOffsets.at(node); i < m_nodeOffsets.at(node + 1); ++i)
+            m_candidates << m_edges.at(i);
+    }
+    // handle the edges in the same order as testing all of them would
+    std::sort(m_candidates.begin(), m_candidates.end());
+
+    crossings->clear();
+    for (int i : std::as_const(m_candidates)) {
+        const QPathEdge *edge = m_list.edge(i);
+        QPointF a = *m_list.vertex(edge->first);
+        QPointF b = *m_list.vertex(edge->second);
+
+        if ((a.y() < y && b.y() > y) || (a.y() > y && b.y() < y)) {
+            const qreal intersection = a.x() + (b.x() - a.x()) * (y - a.y()) / (b.y() - a.y());
+            const QCrossingEdge crossing = { i, intersection };
+            *crossings << crossing;
+        }
+    }
+}
+
+} // unnamed namespace
+
 bool QPathClipper::doClip(QWingedEdge &list, ClipperMode mode)
 {
     QList<qreal> y_coords;
@@ -1599,68 +1773,56 @@ bool QPathClipper::doClip(QWingedEdge &list, ClipperMode mode)
     }
 #endif
 
-    bool found;
-    do {
-        found = false;
-        int index = 0;
-        qreal maxHeight = 0;
-        for (int i = 0; i < list.edgeCount(); ++i) {
-            QPathEdge *edge = list.edge(i);
-
-            // have both sides of this edge already been handled?
-            if ((edge->flag & 0x3) == 0x3)
-                continue;
-
-            QPathVertex *a = list.vertex(edge->first);
-            QPathVertex *b = list.vertex(edge->second);
-
-            if (qFuzzyCompare(a->y, b->y))
-                continue;
-
-            found = true;
+    // Handle the edges tallest first. The edges handled along with another
+    // one are marked as such, and skipped when it is their turn.
+    QList<int> edges;
+    edges.reserve(list.edgeCount());
+    for (int i = 0; i < list.edgeCount(); ++i) {
+        const QPathEdge *edge = list.edge(i);
+        if (!qFuzzyCompare(list.vertex(edge->first)->y, list.vertex(edge->second)->y))
+            edges << i;
+    }
+    const auto height = [&list](int i) {
+        const QPathEdge *edge = list.edge(i);
+        return qAbs(list.vertex(edge->first)->y - list.vertex(edge->second)->y);
+    };
+    std::stable_sort(edges.begin(), edges.end(), [&height](int a, int b) {
+        return height(a) > height(b);
+    });
 
-            qreal height = qAbs(a->y - b->y);
-            if (height > maxHeight) {
-                index = i;
-                maxHeight = height;
-            }
-        }
+    const QBiggestGapFinder gapFinder(y_coords);
+    const QCrossingEdgeFinder crossingFinder(list, y_coords);
+    QList<QCrossingEdge> crossings;
 
-        if (found) {
-            QPathEdge *edge = list.edge(index);
+    for (int index : std::as_const(edges)) {
+        QPathEdge *edge = list.edge(index);
 
-            QPathVertex *a = list.vertex(edge->first);
-            QPathVertex *b = list.vertex(edge->second);
+        // have both sides of this edge already been handled?
+        if ((edge->flag & 0x3) == 0x3)
+            continue;
 
-            // FIXME: this can be optimized by using binary search
-            const int first = qFuzzyFind(y_coords.cbegin(), y_coords.cend(), qMin(a->y, b->y)) - y_coords.cbegin();
-            const int last = qFuzzyFind(y_coords.cbegin() + first, y_coords.cend(), qMax(a->y, b->y)) - y_coords.cbegin();
+        QPathVertex *a = list.vertex(edge->first);
+        QPathVertex *b = list.vertex(edge->second);
 
-            Q_ASSERT(first < y_coords.size() - 1);
-            Q_ASSERT(last < y_coords.size());
+        const int first = qFuzzyFind(y_coords.cbegin(), y_coords.cend(), qMin(a->y, b->y)) - y_coords.cbegin();
+        const int last = qFuzzyFind(y_coords.cbegin() + first, y_coords.cend(), qMax(a->y, b->y)) - y_coords.cbegin();
 
-            qreal biggestGap = y_coords.at(first + 1) - y_coords.at(first);
-            int bestIdx = first;
-            for (int i = first + 1; i < last; ++i) {
-                qreal gap = y_coords.at(i + 1) - y_coords.at(i);
+        Q_ASSERT(first < y_coords.size() - 1);
+        Q_ASSERT(last < y_coords.size());
 
-                if (gap > biggestGap) {
-                    bestIdx = i;
-                    biggestGap = gap;
-                }
-            }
-            const qreal bestY = 0.5 * (y_coords.at(bestIdx) + y_coords.at(bestIdx + 1));
+        const int bestIdx = gapFinder.find(first, last);
+        const qreal bestY = 0.5 * (y_coords.at(bestIdx) + y_coords.at(bestIdx + 1));
 
 #ifdef QDEBUG_CLIPPER
-            printf("y: %.9f, gap: %.9f\n", bestY, biggestGap);
+        printf("y: %.9f, gap: %.9f\n", bestY, y_coords.at(bestIdx + 1) - y_coords.at(bestIdx));
 #endif
 
-            if (handleCrossingEdges(list, bestY, mode) && mode == CheckMode)
-                return true;
+        crossingFinder.find(bestIdx, bestY, &crossings);
+        if (handleCrossingEdges(list, crossings, mode) && mode == CheckMode)
+            return true;
 
-            edge->flag |= 0x3;
-        }
-    } while (found);
+        edge->flag |= 0x3;
+    }
 
     if (mode == ClipMode)
         list.simplify();
@@ -1690,18 +1852,6 @@ static void traverse(QWingedEdge &list, int edge, QPathEdge::Traversal traversal
     } while (status.edge != edge);
 }
 
-struct QCrossingEdge
-{
-    int edge;
-    qreal x;
-
-    bool operator<(const QCrossingEdge &edge) const
-    {
-        return x < edge.x;
-    }
-};
-Q_DECLARE_TYPEINFO(QCrossingEdge, Q_PRIMITIVE_TYPE);
-
 static bool bool_op(bool a, bool b, QPathClipper::Operation op)
 {
     switch (op) {
@@ -1744,27 +1894,9 @@ bool QWingedEdge::isInside(qreal x, qreal y) const
     return winding & 1;
 }
 
-static QList<QCrossingEdge> findCrossings(const QWingedEdge &list, qreal y)
+bool QPathClipper::handleCrossingEdges(QWingedEdge &list, QList<QCrossingEdge> &crossings,
+                                       ClipperMode mode)
 {
-    QList<QCrossingEdge> crossings;
-    for (int i = 0; i < list.edgeCount(); ++i) {
-        const QPathEdge *edge = list.edge(i);
-        QPointF a = *list.vertex(edge->first);
-        QPointF b = *list.vertex(edge->second);
-
-        if ((a.y() < y && b.y() > y) || (a.y() > y && b.y() < y)) {
-            const qreal intersection = a.x() + (b.x() - a.x()) * (y - a.y()) / (b.y() - a.y());
-            const QCrossingEdge edge = { i, intersection };
-            crossings << edge;
-        }
-    }
-    return crossings;
-}
-
-bool QPathClipper::handleCrossingEdges(QWingedEdge &list, qreal y, ClipperMode mode)
-{
-    QList<QCrossingEdge> crossings = findCrossings(list, y);
-
     Q_ASSERT(!crossings.isEmpty());
     std::sort(crossings.begin(), crossings.end());
 
@@ -1796,7 +1928,7 @@ bool QPathClipper::handleCrossingEdges(QWingedEdge &list, qreal y, ClipperMode m
         const bool add = inD ^ inside;
 
 #ifdef QDEBUG_CLIPPER
-        printf("y %f, x %f, inA: %d, inB: %d, inD: %d, inside: %d, flag: %x, bezier: %p, edge: %d\n", y, crossings.at(i).x, inA, inB, inD, inside, edge->flag, edge->bezier, ei);
+        printf("x %f, inA: %d, inB: %d, inD: %d, inside: %d, flag: %x, bezier: %p, edge: %d\n", crossings.at(i).x, inA, inB, inD, inside, edge->flag, edge->bezier, ei);
 #endif
 
         if (add) {
@@ -27,6 +27,7 @@ QT_BEGIN_NAMESPACE
 
 
 class QWingedEdge;
+struct QCrossingEdge;
 
 class Q_GUI_EXPORT QPathClipper
 {
@@ -57,7 +58,7 @@ private:
         CheckMode // for contains/intersects (only interested in whether the result path is non-empty)
     };
 
-    bool handleCrossingEdges(QWingedEdge &list, qreal y, ClipperMode mode);
+    bool handleCrossingEdges(QWingedEdge &list, QList<QCrossingEdge> &crossings, ClipperMode mode);
     bool doClip(QWingedEdge &list, ClipperMode mode);
 
     QPainterPath subjectPath;
@@ -1275,19 +1275,8 @@ static const uint *QT_FASTCALL fetchA2RGB30PMToARGB32PM(uint *buffer, const ucha
         UNALIASED_CONVERSION_LOOP(buffer, src, count, qConvertA2rgb30ToArgb32<PixelOrder>);
     } else {
         for (int i = 0; i < count; ++i) {
-            const uint c = src[i];
-            short d10 = (qt_bayer_matrix[dither->y & 15][(dither->x + i) & 15] << 2);
-            short a10 = (c >> 30) * 0x155;
-            short r10 = ((c >> 20) & 0x3ff);
-            short g10 = ((c >> 10) & 0x3ff);
-            short b10 = (c & 0x3ff);
-            if (PixelOrder == PixelOrderBGR)
-                std::swap(r10, b10);
-            short a8 = (a10 + ((d10 - a10) >> 8)) >> 2;
-            short r8 = (r10 + ((d10 - r10) >> 8)) >> 2;
-            short g8 = (g10 + ((d10 - g10) >> 8)) >> 2;
-            short b8 = (b10 + ((d10 - b10) >> 8)) >> 2;
-            buffer[i] = qRgba(r8, g8, b8, a8);
+            const short d10 = (qt_bayer_matrix[dither->y & 15][(dither->x + i) & 15] << 2);
+            buffer[i] = qConvertA2rgb30ToArgb32Dithered<PixelOrder>(src[i], d10);
         }
     }
     return buffer;
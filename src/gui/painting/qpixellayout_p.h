@@ -123,6 +123,23 @@ inline QRgb qConvertA2rgb30ToArgb32<PixelOrderRGB>(uint c)
         | ((c >> 2) & 0x000000ff);
 }
 
+// Dithered down-conversion of one A2RGB30 pixel, with \a d10 the 10-bit dither threshold.
+template<enum QtPixelOrder PixelOrder>
+inline QRgb qConvertA2rgb30ToArgb32Dithered(uint c, short d10)
+{
+    short a10 = (c >> 30) * 0x155;
+    short r10 = ((c >> 20) & 0x3ff);
+    short g10 = ((c >> 10) & 0x3ff);
+    short b10 = (c & 0x3ff);
+    if (PixelOrder == PixelOrderBGR)
+        std::swap(r10, b10);
+    short a8 = (a10 + ((d10 - a10) >> 8)) >> 2;
+    short r8 = (r10 + ((d10 - r10) >> 8)) >> 2;
+    short g8 = (g10 + ((d10 - g10) >> 8)) >> 2;
+    short b8 = (b10 + ((d10 - b10) >> 8)) >> 2;
+    return qRgba(r8, g8, b8, a8);
+}
+
 template<enum QtPixelOrder> inline QRgba64 qConvertA2rgb30ToRgb64(uint rgb);
 
 template<>
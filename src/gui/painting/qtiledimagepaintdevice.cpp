@@ -0,0 +1,853 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qtiledimagepaintdevice_p.h"
+
+#include <qcolorspace.h>
+#include <qimage.h>
+#include <qpaintengine.h>
+#include <qpainter.h>
+#include <qpainterpath.h>
+#include <qpixmap.h>
+#include <qregion.h>
+#if QT_CONFIG(thread)
+#include <qsemaphore.h>
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <private/qthreadpool_p.h>
+#endif
+
+#include <private/qfontengine_p.h>
+#include <private/qpaintengine_raster_p.h>
+#include <private/qtextengine_p.h>
+#include <private/qvectorpath_p.h>
+
+#include <memory>
+#include <variant>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+struct Begin { };
+
+struct StateChange
+{
+    QPaintEngine::DirtyFlags flags;
+    QPen pen;
+    QBrush brush;
+    QPointF brushOrigin;
+    QFont font;
+    Qt::BGMode backgroundMode;
+    QBrush backgroundBrush;
+    QTransform transform;
+    bool clipEnabled;
+    Qt::ClipOperation clipOperation;
+    QRegion clipRegion;
+    QPainterPath clipPath;
+    QPainter::RenderHints renderHints;
+    QPainter::CompositionMode compositionMode;
+    qreal opacity;
+};
+
+template <typename T> struct Rects { QList<T> rects; };
+template <typename T> struct Lines { QList<T> lines; };
+template <typename T> struct Points { QList<T> points; };
+template <typename T> struct Ellipse { T rect; };
+template <typename T>
+struct Polygon
+{
+    QList<T> points;
+    QPaintEngine::PolygonDrawMode mode;
+};
+struct Path { QPainterPath path; };
+struct Pixmap { QRectF rect; QPixmap pixmap; QRectF sourceRect; }; // bitmaps only
+struct TiledPixmap { QRectF rect; QPixmap pixmap; QPointF offset; };
+struct Image { QRectF rect; QImage image; QRectF sourceRect; Qt::ImageConversionFlags flags; };
+
+// A copy of the glyphs of a text item, which only point into the layout
+// while the painter draws them.
+class RecordedTextItem
+{
+public:
+    explicit RecordedTextItem(const QTextItemInt &ti);
+    ~RecordedTextItem();
+
+    const QTextItemInt &textItem() const { return item; }
+
+private:
+    Q_DISABLE_COPY_MOVE(RecordedTextItem)
+
+    QFont font;
+    QString chars;
+    QList<unsigned short> logClusters;
+    QVarLengthGlyphLayoutArray glyphs;
+    QTextItemInt item;
+};
+
+RecordedTextItem::RecordedTextItem(const QTextItemInt &ti)
+    : font(ti.font()),
+      chars(ti.chars, ti.chars ? ti.num_chars : 0),
+      glyphs(ti.glyphs.numGlyphs),
+      item(glyphs, &font, chars.constData(), int(chars.size()), ti.fontEngine)
+{
+    if (ti.logClusters && ti.chars)
+        logClusters = QList<unsigned short>(ti.logClusters, ti.logClusters + ti.num_chars);
+    QGlyphLayout source = ti.glyphs;
+    glyphs.copy(&source);
+    item.logClusters = logClusters.isEmpty() ? nullptr : logClusters.constData();
+    item.descent = ti.descent;
+    item.ascent = ti.ascent;
+    item.width = ti.width;
+    item.justified = ti.justified;
+    // QPainter draws the decorations separately
+    item.flags = ti.flags & ~(QTextItem::Underline | QTextItem::Overline | QTextItem::StrikeOut);
+    item.fontEngine->ref.ref();
+}
+
+RecordedTextItem::~RecordedTextItem()
+{
+    if (!item.fontEngine->ref.deref())
+        delete item.fontEngine;
+}
+
+struct Text { QPointF position; std::shared_ptr<const RecordedTextItem> item; };
+
+using Command = std::variant<Begin, StateChange,
+                             Rects<QRect>, Rects<QRectF>, Lines<QLine>, Lines<QLineF>,
+                             Points<QPoint>, Points<QPointF>, Ellipse<QRect>, Ellipse<QRectF>,
+                             Polygon<QPoint>, Polygon<QPointF>, Path,
+                             Pixmap, TiledPixmap, Image, Text>;
+
+} // unnamed namespace
+
+extern bool qHasPixmapTexture(const QBrush &);
+
+// Pixmaps can only be used on the GUI thread, and a brush converts its
+// pixmap texture to an image lazily, without locking. Replay textures as
+// the images the raster engine would make of them, which any thread can
+// read.
+static QBrush imageTextureBrush(const QBrush &brush)
+{
+    if (!qHasPixmapTexture(brush))
+        return brush;
+    const QPixmap texture = brush.texture();
+    QBrush result = brush;
+    result.setTextureImage(texture.isQBitmap()
+                                   ? QRasterBuffer::colorizeBitmap(texture.toImage(), brush.color())
+                                   : texture.toImage());
+    return result;
+}
+
+// A path fills in its vector path and bounds on first use, without locking,
+// and the threads replaying tiles all draw or clip with the same recorded
+// path. Replay a copy of its own, which does not share data with the
+// painter's path, and fill those in here, on the recording thread.
+static QPainterPath replayablePath(const QPainterPath &path)
+{
+    QPainterPath result = path;
+    if (result.elementCount() == 0)
+        return result;
+    const QPainterPath::Element first = result.elementAt(0);
+    result.setElementPositionAt(0, first.x, first.y); // detaches
+    result.boundingRect();
+    result.controlPointRect();
+    qtVectorPathForPath(result).controlPointRect();
+    return result;
+}
+
+/*!
+    \internal
+
+    QTiledRecordingPaintEngine records what is painted on a
+    QTiledImagePaintDevice, together with the device rectangle each drawing
+    command can touch, and replays the commands one tile at a time, or on
+    the whole image for the commands that tiling would change.
+*/
+class QTiledRecordingPaintEngine : public QPaintEngine
+{
+public:
+    QTiledRecordingPaintEngine() : QPaintEngine(AllFeatures) { }
+
+    bool begin(QPaintDevice *device) override;
+    bool end() override { return true; }
+    void updateState(const QPaintEngineState &state) override;
+
+    void drawRects(const QRect *rects, int rectCount) override;
+    void drawRects(const QRectF *rects, int rectCount) override;
+    void drawLines(const QLine *lines, int lineCount) override;
+    void drawLines(const QLineF *lines, int lineCount) override;
+    void drawEllipse(const QRectF &rect) override;
+    void drawEllipse(const QRect &rect) override;
+    void drawPath(const QPainterPath &path) override;
+    void drawPoints(const QPointF *points, int pointCount) override;
+    void drawPoints(const QPoint *points, int pointCount) override;
+    void drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode) override;
+    void drawPolygon(const QPoint *points, int pointCount, PolygonDrawMode mode) override;
+    void drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr) override;
+    void drawTextItem(const QPointF &p, const QTextItem &textItem) override;
+    void drawTiledPixmap(const QRectF &r, const QPixmap &pixmap, const QPointF &s) override;
+    void drawImage(const QRectF &r, const QImage &image, const QRectF &sr,
+                   Qt::ImageConversionFlags flags) override;
+
+    Type type() const override { return User; }
+
+    qsizetype commandCount() const { return commands.size(); }
+    void render(QImage *image, const QSize &tileSize, QThreadPool *pool);
+
+private:
+    struct Replay;
+
+    void record(Command &&command, QRectF rect, bool stroked);
+    void replay(Replay *replay, qsizetype index) const;
+
+    QList<Command> commands;
+    QList<QRect> bounds;             // for each command, in device coordinates
+    QList<qsizetype> stateCommands;  // indexes of the commands that are not drawing
+    QList<qsizetype> serialCommands; // indexes of the drawing commands not split in tiles
+    QRect deviceRect;
+    QTransform transform;
+    QPen pen;
+    QBrush brush;
+};
+
+bool QTiledRecordingPaintEngine::begin(QPaintDevice *device)
+{
+    deviceRect = QRect(0, 0, device->width(), device->height());
+    transform = QTransform();
+    pen = QPen();
+    brush = QBrush();
+    stateCommands.append(commands.size());
+    commands.append(Begin());
+    bounds.append(QRect());
+    if (device->depth() == 1) {
+        // start with the same pen and brush as QPainter::begin() does on the
+        // image; they reach updateState() before the first drawing command
+        painter()->setPen(QPen(Qt::color1));
+        painter()->setBrush(QBrush(Qt::color0));
+    }
+    return true;
+}
+
+void QTiledRecordingPaintEngine::updateState(const QPaintEngineState &state)
+{
+    StateChange change;
+    change.flags = state.state();
+    if (change.flags & DirtyPen) {
+        pen = change.pen = state.pen();
+        if (qHasPixmapTexture(pen.brush()))
+            change.pen.setBrush(imageTextureBrush(pen.brush()));
+    }
+    if (change.flags & DirtyBrush)
+        brush = change.brush = imageTextureBrush(state.brush());
+    if (change.flags & DirtyBrushOrigin)
+        change.brushOrigin = state.brushOrigin();
+    if (change.flags & DirtyFont)
+        change.font = state.font();
+    if (change.flags & (DirtyBackground | DirtyBackgroundMode)) {
+        change.backgroundMode = state.backgroundMode();
+        change.backgroundBrush = imageTextureBrush(state.backgroundBrush());
+    }
+    if (change.flags & DirtyTransform)
+        transform = change.transform = state.transform();
+    if (change.flags & DirtyClipEnabled)
+        change.clipEnabled = state.isClipEnabled();
+    if (change.flags & (DirtyClipRegion | DirtyClipPath))
+        change.clipOperation = state.clipOperation();
+    if (change.flags & DirtyClipRegion)
+        change.clipRegion = state.clipRegion();
+    if (change.flags & DirtyClipPath)
+        change.clipPath = replayablePath(state.clipPath());
+    if (change.flags & DirtyHints)
+        change.renderHints = state.renderHints();
+    if (change.flags & DirtyCompositionMode)
+        change.compositionMode = state.compositionMode();
+    if (change.flags & DirtyOpacity)
+        change.opacity = state.opacity();
+
+    stateCommands.append(commands.size());
+    commands.append(std::move(change));
+    bounds.append(QRect());
+}
+
+void QTiledRecordingPaintEngine::record(Command &&command, QRectF rect, bool stroked)
+{
+    QRect deviceBounds = deviceRect;
+    if (transform.type() < QTransform::TxProject) {
+        // The pen can reach half its width past the shape, or further with
+        // miter joins; cosmetic pens are as wide in device coordinates.
+        qreal extent = 0;
+        if (stroked && pen.style() != Qt::NoPen) {
+            extent = qMax(pen.widthF(), qreal(1)) * qMax(pen.miterLimit(), qreal(1));
+            if (!pen.isCosmetic())
+                rect.adjust(-extent, -extent, extent, extent);
+        }
+        // antialiasing and rounding reach a bit further
+        const qreal margin = (stroked && pen.isCosmetic() ? extent : 0) + 2;
+        deviceBounds = transform.mapRect(rect)
+                               .adjusted(-margin, -margin, margin, margin)
+                               .toAlignedRect()
+                               .intersected(deviceRect);
+    }
+    if (deviceBounds.isEmpty())
+        return;
+
+    // Clipped to a tile, the raster engine starts strokes, dash patterns,
+    // gradients and transformed image fetches at the edges of the clip, and
+    // rounds them differently. Only fills with a plain brush and images
+    // drawn without rotation come out the same; the rest is replayed on the
+    // whole image, as is text, whose glyph caches are not thread-safe, and
+    // the pixmaps that are not recorded as images.
+    bool tiled = transform.type() <= QTransform::TxScale && !std::holds_alternative<Text>(command)
+                 && !std::holds_alternative<Pixmap>(command)
+                 && !std::holds_alternative<TiledPixmap>(command);
+    if (stroked) {
+        tiled = tiled && pen.style() == Qt::NoPen && !brush.gradient()
+                && brush.transform().type() <= QTransform::TxScale;
+    }
+    if (!tiled)
+        serialCommands.append(commands.size());
+    commands.append(std::move(command));
+    bounds.append(deviceBounds);
+}
+
+template <typename T>
+static QRectF boundingRectOf(const T *items, int count)
+{
+    QRectF result;
+    for (int i = 0; i < count; ++i) {
+        const QRectF rect = QRectF(items[i]).normalized();
+        result = i ? result.united(rect) : rect;
+    }
+    return result;
+}
+
+template <typename T>
+static QRectF boundingRectOfLines(const T *lines, int count)
+{
+    QRectF result;
+    for (int i = 0; i < count; ++i) {
+        const QRectF rect = QRectF(QPointF(lines[i].p1()), QPointF(lines[i].p2())).normalized();
+        result = i ? result.united(rect) : rect;
+    }
+    return result;
+}
+
+template <typename T>
+static QRectF boundingRectOfPoints(const T *points, int count)
+{
+    if (!count)
+        return QRectF();
+    qreal left = points[0].x(), right = left, top = points[0].y(), bottom = top;
+    for (int i = 1; i < count; ++i) {
+        left = qMin(left, qreal(points[i].x()));
+        right = qMax(right, qreal(points[i].x()));
+        top = qMin(top, qreal(points[i].y()));
+        bottom = qMax(bottom, qreal(points[i].y()));
+    }
+    return QRectF(QPointF(left, top), QPointF(right, bottom));
+}
+
+void QTiledRecordingPaintEngine::drawRects(const QRect *rects, int rectCount)
+{
+    record(Rects<QRect>{ QList<QRect>(rects, rects + rectCount) },
+           boundingRectOf(rects, rectCount), true);
+}
+
+void QTiledRecordingPaintEngine::drawRects(const QRectF *rects, int rectCount)
+{
+    record(Rects<QRectF>{ QList<QRectF>(rects, rects + rectCount) },
+           boundingRectOf(rects, rectCount), true);
+}
+
+void QTiledRecordingPaintEngine::drawLines(const QLine *lines, int lineCount)
+{
+    record(Lines<QLine>{ QList<QLine>(lines, lines + lineCount) },
+           boundingRectOfLines(lines, lineCount), true);
+}
+
+void QTiledRecordingPaintEngine::drawLines(const QLineF *lines, int lineCount)
+{
+    record(Lines<QLineF>{ QList<QLineF>(lines, lines + lineCount) },
+           boundingRectOfLines(lines, lineCount), true);
+}
+
+void QTiledRecordingPaintEngine::drawEllipse(const QRectF &rect)
+{
+    record(Ellipse<QRectF>{ rect }, rect.normalized(), true);
+}
+
+void QTiledRecordingPaintEngine::drawEllipse(const QRect &rect)
+{
+    record(Ellipse<QRect>{ rect }, QRectF(rect).normalized(), true);
+}
+
+void QTiledRecordingPaintEngine::drawPath(const QPainterPath &path)
+{
+    QPainterPath recorded = replayablePath(path);
+    const QRectF rect = recorded.controlPointRect();
+    record(Path{ std::move(recorded) }, rect, true);
+}
+
+void QTiledRecordingPaintEngine::drawPoints(const QPointF *points, int pointCount)
+{
+    record(Points<QPointF>{ QList<QPointF>(points, points + pointCount) },
+           boundingRectOfPoints(points, pointCount), true);
+}
+
+void QTiledRecordingPaintEngine::drawPoints(const QPoint *points, int pointCount)
+{
+    record(Points<QPoint>{ QList<QPoint>(points, points + pointCount) },
+           boundingRectOfPoints(points, pointCount), true);
+}
+
+void QTiledRecordingPaintEngine::drawPolygon(const QPointF *points, int pointCount,
+                                             PolygonDrawMode mode)
+{
+    record(Polygon<QPointF>{ QList<QPointF>(points, points + pointCount), mode },
+           boundingRectOfPoints(points, pointCount), true);
+}
+
+void QTiledRecordingPaintEngine::drawPolygon(const QPoint *points, int pointCount,
+                                             PolygonDrawMode mode)
+{
+    record(Polygon<QPoint>{ QList<QPoint>(points, points + pointCount), mode },
+           boundingRectOfPoints(points, pointCount), true);
+}
+
+void QTiledRecordingPaintEngine::drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr)
+{
+    // The raster engine draws a pixmap as its image, except for bitmaps,
+    // which it draws in the pen color.
+    if (pm.depth() == 1)
+        record(Pixmap{ r, pm, sr }, r.normalized(), false);
+    else
+        record(Image{ r, pm.toImage(), sr, Qt::AutoColor }, r.normalized(), false);
+}
+
+void QTiledRecordingPaintEngine::drawTiledPixmap(const QRectF &r, const QPixmap &pixmap,
+                                                 const QPointF &s)
+{
+    record(TiledPixmap{ r, pixmap, s }, r.normalized(), false);
+}
+
+void QTiledRecordingPaintEngine::drawImage(const QRectF &r, const QImage &image, const QRectF &sr,
+                                           Qt::ImageConversionFlags flags)
+{
+    record(Image{ r, image, sr, flags }, r.normalized(), false);
+}
+
+void QTiledRecordingPaintEngine::drawTextItem(const QPointF &p, const QTextItem &textItem)
+{
+    // Record the glyphs, so that they are drawn as laid out by the painter.
+    const QTextItemInt &ti = static_cast<const QTextItemInt &>(textItem);
+    if (!ti.fontEngine || !ti.glyphs.numGlyphs)
+        return;
+    const qreal ascent = ti.fontEngine->ascent().toReal();
+    const qreal height = ascent + ti.fontEngine->descent().toReal();
+    QRectF rect(p.x(), p.y() - ascent, ti.width.toReal(), height);
+    // be generous, for glyphs extending past their advance
+    rect.adjust(-height, -height, height, height);
+    record(Text{ p, std::make_shared<const RecordedTextItem>(ti) }, rect, false);
+}
+
+namespace {
+
+// The clipping recorded from the painter, kept separately so that it can be
+// intersected with the tile whenever it changes. A null tile replays the
+// clipping alone, on the whole image.
+struct TileClip
+{
+    struct Step
+    {
+        QTransform transform;
+        QRegion region;
+        QPainterPath path;
+        bool isPath;
+    };
+
+    void update(const StateChange &change, const QTransform &transform);
+    void apply(QPainter *painter) const;
+
+    QRect tile;
+    QList<Step> steps;
+    bool enabled = false;
+};
+
+void TileClip::update(const StateChange &change, const QTransform &transform)
+{
+    // as QPainter keeps its clip info
+    const QPaintEngine::DirtyFlags flags = change.flags;
+    if (flags & (QPaintEngine::DirtyClipRegion | QPaintEngine::DirtyClipPath)) {
+        if (change.clipOperation != Qt::IntersectClip)
+            steps.clear();
+        if (change.clipOperation != Qt::NoClip) {
+            if (flags & QPaintEngine::DirtyClipPath)
+                steps.append({ transform, QRegion(), change.clipPath, true });
+            else
+                steps.append({ transform, change.clipRegion, QPainterPath(), false });
+        }
+        enabled = !steps.isEmpty();
+    }
+    if (flags & QPaintEngine::DirtyClipEnabled)
+        enabled = change.clipEnabled && !steps.isEmpty();
+}
+
+void TileClip::apply(QPainter *painter) const
+{
+    const QTransform transform = painter->transform();
+    painter->resetTransform();
+    if (!tile.isNull())
+        painter->setClipRect(tile);
+    if (enabled) {
+        Qt::ClipOperation operation = tile.isNull() ? Qt::ReplaceClip : Qt::IntersectClip;
+        for (const Step &step : steps) {
+            painter->setTransform(step.transform);
+            if (step.isPath)
+                painter->setClipPath(step.path, operation);
+            else
+                painter->setClipRegion(step.region, operation);
+            operation = Qt::IntersectClip;
+        }
+    } else if (tile.isNull()) {
+        painter->setClipping(false);
+    }
+    painter->setTransform(transform);
+}
+
+} // unnamed namespace
+
+static void applyState(QPainter *painter, const StateChange &change, TileClip *clip)
+{
+    const QPaintEngine::DirtyFlags flags = change.flags;
+    if (flags & QPaintEngine::DirtyPen)
+        painter->setPen(change.pen);
+    if (flags & QPaintEngine::DirtyBrush)
+        painter->setBrush(change.brush);
+    if (flags & QPaintEngine::DirtyBrushOrigin)
+        painter->setBrushOrigin(change.brushOrigin);
+    if (flags & QPaintEngine::DirtyFont)
+        painter->setFont(change.font);
+    if (flags & (QPaintEngine::DirtyBackground | QPaintEngine::DirtyBackgroundMode)) {
+        painter->setBackgroundMode(change.backgroundMode);
+        painter->setBackground(change.backgroundBrush);
+    }
+    if (flags & QPaintEngine::DirtyTransform)
+        painter->setTransform(change.transform);
+    if (flags & (QPaintEngine::DirtyClipEnabled | QPaintEngine::DirtyClipRegion
+                 | QPaintEngine::DirtyClipPath)) {
+        clip->update(change, painter->transform());
+        clip->apply(painter);
+    }
+    if (flags & QPaintEngine::DirtyHints) {
+        painter->setRenderHints(painter->renderHints(), false);
+        painter->setRenderHints(change.renderHints);
+    }
+    if (flags & QPaintEngine::DirtyCompositionMode)
+        painter->setCompositionMode(change.compositionMode);
+    if (flags & QPaintEngine::DirtyOpacity)
+        painter->setOpacity(change.opacity);
+}
+
+template <typename T>
+static void replayPolygon(QPainter *painter, const Polygon<T> &polygon)
+{
+    const T *points = polygon.points.constData();
+    const int count = int(polygon.points.size());
+    switch (polygon.mode) {
+    case QPaintEngine::OddEvenMode:
+        painter->drawPolygon(points, count, Qt::OddEvenFill);
+        break;
+    case QPaintEngine::WindingMode:
+        painter->drawPolygon(points, count, Qt::WindingFill);
+        break;
+    case QPaintEngine::ConvexMode:
+        painter->drawConvexPolygon(points, count);
+        break;
+    case QPaintEngine::PolylineMode:
+        painter->drawPolyline(points, count);
+        break;
+    }
+}
+
+// A painter replaying the recorded commands on the image, either clipped to
+// one tile or on the whole image. It keeps its state from one batch of
+// drawing commands to the next.
+struct QTiledRecordingPaintEngine::Replay
+{
+    Replay(QImage *image, uchar *bits, const QRect &tile);
+
+    QImage target;
+    QPainter painter;
+    TileClip clip;
+    qsizetype nextState = 0;
+};
+
+QTiledRecordingPaintEngine::Replay::Replay(QImage *image, uchar *bits, const QRect &tile)
+    : target(bits, image->width(), image->height(), image->bytesPerLine(), image->format())
+{
+    // Paint on the whole image, in place, with the same coordinates as when
+    // painting on it directly, but clipped to the tile. The raster engine
+    // lays out dash patterns and clips strokes and images within the device
+    // rectangle, so the tile is clipped through the painter rather than by
+    // making a smaller image or setting a system clip.
+    target.setColorTable(image->colorTable());
+    target.setDotsPerMeterX(image->dotsPerMeterX());
+    target.setDotsPerMeterY(image->dotsPerMeterY());
+    target.setColorSpace(image->colorSpace());
+    clip.tile = tile;
+}
+
+void QTiledRecordingPaintEngine::replay(Replay *replay, qsizetype index) const
+{
+    QPainter &painter = replay->painter;
+
+    // replay all state changes up to the drawing command, including the ones
+    // preceding drawing commands of other tiles
+    while (replay->nextState < stateCommands.size()
+           && stateCommands.at(replay->nextState) < index) {
+        const Command &command = commands.at(stateCommands.at(replay->nextState++));
+        if (std::holds_alternative<Begin>(command)) {
+            if (painter.isActive())
+                painter.end();
+            painter.begin(&replay->target);
+            replay->clip = TileClip{ replay->clip.tile, {}, false };
+            replay->clip.apply(&painter);
+        } else {
+            applyState(&painter, std::get<StateChange>(command), &replay->clip);
+        }
+    }
+
+    std::visit([&painter](const auto &c) {
+        using C = std::decay_t<decltype(c)>;
+        if constexpr (std::is_same_v<C, Rects<QRect>> || std::is_same_v<C, Rects<QRectF>>)
+            painter.drawRects(c.rects.constData(), int(c.rects.size()));
+        else if constexpr (std::is_same_v<C, Lines<QLine>> || std::is_same_v<C, Lines<QLineF>>)
+            painter.drawLines(c.lines.constData(), int(c.lines.size()));
+        else if constexpr (std::is_same_v<C, Points<QPoint>> || std::is_same_v<C, Points<QPointF>>)
+            painter.drawPoints(c.points.constData(), int(c.points.size()));
+        else if constexpr (std::is_same_v<C, Ellipse<QRect>> || std::is_same_v<C, Ellipse<QRectF>>)
+            painter.drawEllipse(c.rect);
+        else if constexpr (std::is_same_v<C, Polygon<QPoint>> || std::is_same_v<C, Polygon<QPointF>>)
+            replayPolygon(&painter, c);
+        else if constexpr (std::is_same_v<C, Path>)
+            painter.drawPath(c.path);
+        else if constexpr (std::is_same_v<C, Pixmap>)
+            painter.drawPixmap(c.rect, c.pixmap, c.sourceRect);
+        else if constexpr (std::is_same_v<C, TiledPixmap>)
+            painter.drawTiledPixmap(c.rect, c.pixmap, c.offset);
+        else if constexpr (std::is_same_v<C, Image>)
+            painter.drawImage(c.rect, c.image, c.sourceRect, c.flags);
+        else if constexpr (std::is_same_v<C, Text>)
+            painter.drawTextItem(c.position, c.item->textItem());
+    }, commands.at(index));
+}
+
+void QTiledRecordingPaintEngine::render(QImage *image, const QSize &tileSize, QThreadPool *pool)
+{
+    // Tiles need to start on a byte boundary; with less than eight bits per
+    // pixel, use bands as wide as the image.
+    const int tileWidth = image->depth() < 8 ? image->width()
+                                             : qBound(1, tileSize.width(), image->width());
+    const int tileHeight = qBound(1, tileSize.height(), image->height());
+    const int columns = (image->width() + tileWidth - 1) / tileWidth;
+    const int rows = (image->height() + tileHeight - 1) / tileHeight;
+    uchar *bits = image->bits();
+    std::vector<std::unique_ptr<Replay>> tileReplays(qsizetype(columns) * rows);
+    QList<QList<qsizetype>> draws(qsizetype(columns) * rows);
+    QList<qsizetype> tiles;
+    auto renderTile = [&](qsizetype i) {
+        const qsizetype index = tiles.at(i);
+        std::unique_ptr<Replay> &replay = tileReplays[index];
+        if (!replay) {
+            const int row = int(index / columns);
+            const int column = int(index % columns);
+            const QRect tile = QRect(column * tileWidth, row * tileHeight, tileWidth, tileHeight)
+                                       .intersected(QRect(QPoint(0, 0), image->size()));
+            replay = std::make_unique<Replay>(image, bits, tile);
+        }
+        for (qsizetype command : std::as_const(draws.at(index)))
+            this->replay(replay.get(), command);
+    };
+
+#if QT_CONFIG(thread)
+    if (!pool)
+        pool = QThreadPoolPrivate::qtGuiInstance();
+    const bool parallel = pool && pool->maxThreadCount() > 1
+                          && !pool->contains(QThread::currentThread());
+#else
+    Q_UNUSED(pool);
+#endif
+
+    // The commands replayed on the whole image split the others in batches,
+    // each of which is rasterized tile by tile.
+    Replay wholeImage(image, bits, QRect());
+    qsizetype from = 0;
+    for (qsizetype serial = 0; ; ++serial) {
+        const qsizetype to = serial < serialCommands.size() ? serialCommands.at(serial)
+                                                            : commands.size();
+        tiles.clear();
+        for (qsizetype i = from; i < to; ++i) {
+            const QRect &rect = bounds.at(i);
+            if (rect.isEmpty())
+                continue;
+            for (int row = rect.top() / tileHeight; row <= rect.bottom() / tileHeight; ++row) {
+                for (int column = rect.left() / tileWidth; column <= rect.right() / tileWidth;
+                     ++column) {
+                    const qsizetype tile = qsizetype(row) * columns + column;
+                    if (draws.at(tile).isEmpty())
+                        tiles.append(tile);
+                    draws[tile].append(i);
+                }
+            }
+        }
+
+#if QT_CONFIG(thread)
+        const int segments = parallel ? int(qMin(tiles.size(), qsizetype(pool->maxThreadCount())))
+                                      : 1;
+        if (segments > 1) {
+            // tiles are handed out in interleaved order, since neighbouring
+            // tiles tend to be equally busy
+            QSemaphore semaphore;
+            for (int segment = 1; segment < segments; ++segment) {
+                pool->start([&, segment]() {
+                    for (qsizetype i = segment; i < tiles.size(); i += segments)
+                        renderTile(i);
+                    semaphore.release(1);
+                });
+            }
+            for (qsizetype i = 0; i < tiles.size(); i += segments)
+                renderTile(i);
+            semaphore.acquire(segments - 1);
+        } else
+#endif
+        {
+            for (qsizetype i = 0; i < tiles.size(); ++i)
+                renderTile(i);
+        }
+        for (qsizetype tile : std::as_const(tiles))
+            draws[tile].clear();
+
+        if (to == commands.size())
+            break;
+        replay(&wholeImage, to);
+        from = to + 1;
+    }
+    tileReplays.clear();
+    wholeImage.painter.end();
+
+    commands.clear();
+    bounds.clear();
+    stateCommands.clear();
+    serialCommands.clear();
+}
+
+/*!
+    \internal
+    \class QTiledImagePaintDevice
+    \inmodule QtGui
+
+    QTiledImagePaintDevice defers painting on a QImage, so that it can be
+    rasterized in parallel. QPainter commands issued on the device are
+    recorded along with the part of the image each of them can touch. When
+    flush() is called, the image is split into tiles of tileSize(), and the
+    tiles are rasterized concurrently on a thread pool, each replaying the
+    state changes and only the drawing commands that intersect it.
+
+    Replaying a command on a tile rasterizes it with the same raster paint
+    engine and the same device transformation as painting on the image
+    directly, with the painter's clip intersected with the tile, and gives
+    the same pixels. Only fills with a solid, pattern or texture brush and
+    images drawn without rotation are split in tiles; strokes, gradients,
+    rotated drawing and text would be rasterized differently within a tile,
+    and are replayed in order on the whole image, between the batches of
+    tiled commands. Text is recorded as the glyphs laid out by the painter.
+
+    Pixmaps, and the textures of pixmap brushes, are converted to images
+    when they are recorded, so that the tiles do not use them outside the
+    GUI thread. Bitmaps and tiled pixmaps are kept as pixmaps, and are
+    replayed on the whole image by the thread calling flush().
+*/
+
+/*!
+    Constructs a paint device that records painting to be rasterized on
+    \a image in tiles of \a tileSize.
+*/
+QTiledImagePaintDevice::QTiledImagePaintDevice(QImage *image, const QSize &tileSize)
+    : m_image(image),
+      m_tileSize(tileSize),
+      m_engine(new QTiledRecordingPaintEngine)
+{
+}
+
+/*!
+    Destroys the device, discarding any recorded painting that was not
+    flushed.
+*/
+QTiledImagePaintDevice::~QTiledImagePaintDevice() = default;
+
+/*!
+    Returns the number of recorded commands waiting for flush().
+*/
+qsizetype QTiledImagePaintDevice::commandCount() const
+{
+    return m_engine->commandCount();
+}
+
+/*!
+    Rasterizes the recorded painting on the image, using the threads of
+    \a pool, or of an internal thread pool if \a pool is \nullptr.
+    No painter may be active on the device.
+*/
+void QTiledImagePaintDevice::flush(QThreadPool *pool)
+{
+    if (m_engine->isActive()) {
+        qWarning("QTiledImagePaintDevice::flush: The device is still being painted on");
+        return;
+    }
+    if (m_engine->commandCount() && !m_image->isNull())
+        m_engine->render(m_image, m_tileSize, pool);
+}
+
+QPaintEngine *QTiledImagePaintDevice::paintEngine() const
+{
+    return m_engine.get();
+}
+
+int QTiledImagePaintDevice::metric(PaintDeviceMetric metric) const
+{
+    switch (metric) {
+    case PdmWidth:
+        return m_image->width();
+    case PdmHeight:
+        return m_image->height();
+    case PdmWidthMM:
+        return m_image->widthMM();
+    case PdmHeightMM:
+        return m_image->heightMM();
+    case PdmNumColors:
+        return m_image->colorCount();
+    case PdmDepth:
+        return m_image->depth();
+    case PdmDpiX:
+        return m_image->logicalDpiX();
+    case PdmDpiY:
+        return m_image->logicalDpiY();
+    case PdmPhysicalDpiX:
+        return m_image->physicalDpiX();
+    case PdmPhysicalDpiY:
+        return m_image->physicalDpiY();
+    case PdmDevicePixelRatio:
+        return int(m_image->devicePixelRatio());
+    case PdmDevicePixelRatioScaled:
+        return int(m_image->devicePixelRatio() * devicePixelRatioFScale());
+    case PdmDevicePixelRatioF_EncodedA:
+    case PdmDevicePixelRatioF_EncodedB:
+        return QPaintDevice::encodeMetricF(metric, m_image->devicePixelRatio());
+    default:
+        return QPaintDevice::metric(metric);
+    }
+}
+
+QT_END_NAMESPACE
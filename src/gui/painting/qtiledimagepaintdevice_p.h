@@ -0,0 +1,57 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QTILEDIMAGEPAINTDEVICE_P_H
+#define QTILEDIMAGEPAINTDEVICE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qpaintdevice.h>
+#include <QtCore/qsize.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QImage;
+class QThreadPool;
+class QTiledRecordingPaintEngine;
+
+class Q_GUI_EXPORT QTiledImagePaintDevice : public QPaintDevice
+{
+public:
+    explicit QTiledImagePaintDevice(QImage *image, const QSize &tileSize = QSize(256, 256));
+    ~QTiledImagePaintDevice() override;
+
+    QImage *image() const { return m_image; }
+    QSize tileSize() const { return m_tileSize; }
+    qsizetype commandCount() const;
+
+    void flush(QThreadPool *pool = nullptr);
+
+    QPaintEngine *paintEngine() const override;
+
+protected:
+    int metric(PaintDeviceMetric metric) const override;
+
+private:
+    Q_DISABLE_COPY_MOVE(QTiledImagePaintDevice)
+
+    QImage *m_image;
+    QSize m_tileSize;
+    std::unique_ptr<QTiledRecordingPaintEngine> m_engine;
+};
+
+QT_END_NAMESPACE
+
+#endif // QTILEDIMAGEPAINTDEVICE_P_H
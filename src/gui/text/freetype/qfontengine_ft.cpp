@@ -24,6 +24,8 @@
 #include <qmath.h>
 #include <qendian.h>
 
+#include <algorithm>
+#include <array>
 #include <memory>
 
 #include <ft2build.h>
@@ -108,9 +110,17 @@ public:
         {}
     };
 
+    // The face and the parameters that decide how the glyphs of a glyph set
+    // are rendered
+    struct GlyphAtlasKey {
+        const QFreetypeFace *face;
+        std::array<qint64, 16> parameters;
+    };
+
     FT_Library library;
     QHash<QFontEngine::FaceId, QFreetypeFace *> faces;
     QHash<FaceStyle, int> faceIndices;
+    QHash<GlyphAtlasKey, std::weak_ptr<QFontEngineFT::GlyphAtlas>> glyphAtlases;
 };
 
 QtFreetypeData::~QtFreetypeData()
@@ -135,6 +145,16 @@ inline size_t qHash(const QtFreetypeData::FaceStyle &style, size_t seed)
     return qHashMulti(seed, style.faceFileName, style.styleName);
 }
 
+inline bool operator==(const QtFreetypeData::GlyphAtlasKey &key1, const QtFreetypeData::GlyphAtlasKey &key2)
+{
+    return key1.face == key2.face && key1.parameters == key2.parameters;
+}
+
+inline size_t qHash(const QtFreetypeData::GlyphAtlasKey &key, size_t seed)
+{
+    return qHashRange(key.parameters.begin(), key.parameters.end(), qHash(key.face, seed));
+}
+
 Q_GLOBAL_STATIC(QThreadStorage<QtFreetypeData *>, theFreetypeData)
 
 QtFreetypeData *qt_getFreetypeData()
@@ -1012,7 +1032,14 @@ void QFontEngineFT::setQtDefaultHintStyle(QFont::HintingPreference hintingPrefer
 
 void QFontEngineFT::setDefaultHintStyle(HintStyle style)
 {
+    if (default_hint_style == style)
+        return;
     default_hint_style = style;
+
+    // The glyphs loaded so far were hinted differently, and the engines that
+    // share their atlas still hint them that way
+    defaultGlyphSet.clear();
+    transformedGlyphSets.clear();
 }
 
 bool QFontEngineFT::expectsGammaCorrectedBlending() const
@@ -1055,6 +1082,18 @@ int QFontEngineFT::loadFlags(QGlyphSet *set, GlyphFormat format, int flags,
     return load_flags;
 }
 
+static inline int glyphBitmapPitch(QFontEngine::GlyphFormat format, int width)
+{
+    return format == QFontEngine::Format_Mono ? ((width + 31) & ~31) >> 3
+            : (format == QFontEngine::Format_A8 ? (width + 3) & ~3 : width * 4);
+}
+
+static inline size_t glyphBitmapSize(const QFontEngineFT::Glyph *glyph)
+{
+    return size_t(glyph->height)
+            * glyphBitmapPitch(QFontEngine::GlyphFormat(glyph->format), glyph->width);
+}
+
 static inline bool areMetricsTooLarge(const QFontEngineFT::GlyphInfo &info)
 {
     // false if exceeds QFontEngineFT::Glyph metrics
@@ -1109,6 +1148,9 @@ QFontEngineFT::Glyph *QFontEngineFT::loadGlyph(QGlyphSet *set, uint glyph,
         format = defaultFormat != Format_None ? defaultFormat : Format_Mono;
     Q_ASSERT(format != Format_None);
 
+    if (set && !set->atlas)
+        attachGlyphAtlas(set);
+
     Glyph *g = set ? set->getGlyph(glyph, subPixelPosition) : nullptr;
     if (g && g->format == format && (fetchMetricsOnly || g->data))
         return g;
@@ -1210,7 +1252,7 @@ QFontEngineFT::Glyph *QFontEngineFT::loadGlyph(QGlyphSet *set, uint glyph,
         if (areMetricsTooLarge(info))
             return nullptr;
 
-        g = new Glyph;
+        g = set ? set->atlas->allocateGlyph() : new Glyph;
         g->data = nullptr;
         g->linearAdvance = info.linearAdvance;
         g->width = info.width;
@@ -1227,7 +1269,8 @@ QFontEngineFT::Glyph *QFontEngineFT::loadGlyph(QGlyphSet *set, uint glyph,
     }
 
     int glyph_buffer_size = 0;
-    std::unique_ptr<uchar[]> glyph_buffer;
+    std::unique_ptr<uchar[]> owned_glyph_buffer;
+    uchar *glyph_buffer = nullptr;
     FT_Render_Mode renderMode = (default_hint_style == HintLight) ? FT_RENDER_MODE_LIGHT : FT_RENDER_MODE_NORMAL;
     switch (format) {
     case Format_Mono:
@@ -1264,15 +1307,19 @@ QFontEngineFT::Glyph *QFontEngineFT::loadGlyph(QGlyphSet *set, uint glyph,
     if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_LCD_V)
         info.height = info.height / vfactor;
 
-    int pitch = (format == Format_Mono ? ((info.width + 31) & ~31) >> 3 :
-                 (format == Format_A8 ? (info.width + 3) & ~3 : info.width * 4));
+    int pitch = glyphBitmapPitch(format, info.width);
 
     glyph_buffer_size = info.height * pitch;
-    glyph_buffer.reset(new uchar[glyph_buffer_size]);
+    if (set) {
+        glyph_buffer = set->atlas->allocateBitmap(glyph_buffer_size);
+    } else {
+        owned_glyph_buffer.reset(new uchar[glyph_buffer_size]);
+        glyph_buffer = owned_glyph_buffer.get();
+    }
 
     if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
         uchar *src = slot->bitmap.buffer;
-        uchar *dst = glyph_buffer.get();
+        uchar *dst = glyph_buffer;
         int h = slot->bitmap.rows;
         // Some fonts return bitmaps even when we requested something else:
         if (format == Format_Mono) {
@@ -1301,7 +1348,7 @@ QFontEngineFT::Glyph *QFontEngineFT::loadGlyph(QGlyphSet *set, uint glyph,
     } else if (slot->bitmap.pixel_mode == 7 /*FT_PIXEL_MODE_BGRA*/) {
         Q_ASSERT(format == Format_ARGB);
         uchar *src = slot->bitmap.buffer;
-        uchar *dst = glyph_buffer.get();
+        uchar *dst = glyph_buffer;
         int h = slot->bitmap.rows;
         while (h--) {
 #if Q_BYTE_ORDER == Q_BIG_ENDIAN
@@ -1321,7 +1368,7 @@ QFontEngineFT::Glyph *QFontEngineFT::loadGlyph(QGlyphSet *set, uint glyph,
     } else if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY) {
         Q_ASSERT(format == Format_A8);
         uchar *src = slot->bitmap.buffer;
-        uchar *dst = glyph_buffer.get();
+        uchar *dst = glyph_buffer;
         int h = slot->bitmap.rows;
         int bytes = info.width;
         while (h--) {
@@ -1331,18 +1378,23 @@ QFontEngineFT::Glyph *QFontEngineFT::loadGlyph(QGlyphSet *set, uint glyph,
         }
     } else if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_LCD) {
         Q_ASSERT(format == Format_A32);
-        convertRGBToARGB(slot->bitmap.buffer, (uint *)glyph_buffer.get(), info.width, info.height, slot->bitmap.pitch, subpixelType != Subpixel_RGB);
+        convertRGBToARGB(slot->bitmap.buffer, (uint *)glyph_buffer, info.width, info.height, slot->bitmap.pitch, subpixelType != Subpixel_RGB);
     } else if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_LCD_V) {
         Q_ASSERT(format == Format_A32);
-        convertRGBToARGB_V(slot->bitmap.buffer, (uint *)glyph_buffer.get(), info.width, info.height, slot->bitmap.pitch, subpixelType != Subpixel_VRGB);
+        convertRGBToARGB_V(slot->bitmap.buffer, (uint *)glyph_buffer, info.width, info.height, slot->bitmap.pitch, subpixelType != Subpixel_VRGB);
     } else {
         qWarning("QFontEngine: Glyph rendered in unknown pixel_mode=%d", slot->bitmap.pixel_mode);
+        if (set)
+            set->atlas->releaseBitmap(glyph_buffer, glyph_buffer_size);
         return nullptr;
     }
 
     if (!g) {
-        g = new Glyph;
+        g = set ? set->atlas->allocateGlyph() : new Glyph;
         g->data = nullptr;
+    } else if (g->data) {
+        // rendered before, in another format
+        set->atlas->releaseBitmap(g->data, glyphBitmapSize(g));
     }
 
     g->linearAdvance = info.linearAdvance;
@@ -1352,8 +1404,7 @@ QFontEngineFT::Glyph *QFontEngineFT::loadGlyph(QGlyphSet *set, uint glyph,
     g->y = info.y;
     g->advance = info.xOff;
     g->format = format;
-    delete [] g->data;
-    g->data = glyph_buffer.release();
+    g->data = set ? glyph_buffer : owned_glyph_buffer.release();
 
     if (set)
         set->setGlyph(glyph, subPixelPosition, g);
@@ -1542,6 +1593,14 @@ QFontEngineFT::QGlyphSet *QFontEngineFT::TransformedGlyphSets::findSet(const QTr
     return gs;
 }
 
+void QFontEngineFT::TransformedGlyphSets::clear()
+{
+    for (QGlyphSet *set : sets) {
+        if (set)
+            set->clear();
+    }
+}
+
 void QFontEngineFT::TransformedGlyphSets::moveToFront(int i)
 {
     QGlyphSet *g = sets[i];
@@ -2203,6 +2262,167 @@ FT_Face QFontEngineFT::non_locked_face() const
 }
 
 
+QFontEngineFT::GlyphAtlas::~GlyphAtlas()
+{
+    // The bitmaps are owned by the pages, not by the glyphs
+    for (Glyph &glyph : m_glyphs)
+        glyph.data = nullptr;
+}
+
+void QFontEngineFT::GlyphAtlas::rehash(quint32 capacity)
+{
+    std::unique_ptr<Entry[]> entries = std::move(m_entries);
+    const quint32 oldCapacity = m_capacity;
+
+    m_entries.reset(new Entry[capacity]());
+    m_capacity = capacity;
+    m_shift = 64 - qCountTrailingZeroBits(capacity);
+
+    const quint32 mask = m_capacity - 1;
+    for (quint32 i = 0; i < oldCapacity; ++i) {
+        const Entry &entry = entries[i];
+        if (!entry.glyph)
+            continue;
+        quint32 j = bucket(entry.index, entry.x, entry.y);
+        while (m_entries[j].glyph)
+            j = (j + 1) & mask;
+        m_entries[j] = entry;
+    }
+}
+
+void QFontEngineFT::GlyphAtlas::insert(glyph_t index, const QFixedPoint &subPixelPosition,
+                                       Glyph *glyph)
+{
+    Q_ASSERT(glyph);
+
+    // Keep the table at most half full, so that the probe sequences are short
+    if ((m_count + 1) * 2 > m_capacity)
+        rehash(m_capacity ? m_capacity * 2 : 64);
+
+    const int x = subPixelPosition.x.value();
+    const int y = subPixelPosition.y.value();
+    const quint32 mask = m_capacity - 1;
+    quint32 i = bucket(index, x, y);
+    for (; m_entries[i].glyph; i = (i + 1) & mask) {
+        Entry &entry = m_entries[i];
+        if (entry.index == index && entry.x == x && entry.y == y) {
+            if (entry.glyph != glyph)
+                releaseGlyph(entry.glyph);
+            entry.glyph = glyph;
+            return;
+        }
+    }
+    m_entries[i] = Entry{ index, x, y, glyph };
+    ++m_count;
+}
+
+void QFontEngineFT::GlyphAtlas::remove(glyph_t index, const QFixedPoint &subPixelPosition)
+{
+    if (m_count == 0)
+        return;
+
+    const int x = subPixelPosition.x.value();
+    const int y = subPixelPosition.y.value();
+    const quint32 mask = m_capacity - 1;
+    quint32 i = bucket(index, x, y);
+    for (;; i = (i + 1) & mask) {
+        const Entry &entry = m_entries[i];
+        if (!entry.glyph)
+            return;
+        if (entry.index == index && entry.x == x && entry.y == y)
+            break;
+    }
+    releaseGlyph(m_entries[i].glyph);
+
+    // Move the entries that follow back into the hole, unless that would
+    // place them before their bucket
+    for (quint32 j = (i + 1) & mask; m_entries[j].glyph; j = (j + 1) & mask) {
+        const Entry &entry = m_entries[j];
+        const quint32 k = bucket(entry.index, entry.x, entry.y);
+        const bool movable = i <= j ? (k <= i || k > j) : (k <= i && k > j);
+        if (movable) {
+            m_entries[i] = entry;
+            i = j;
+        }
+    }
+    m_entries[i] = Entry{};
+    --m_count;
+}
+
+QFontEngineFT::Glyph *QFontEngineFT::GlyphAtlas::allocateGlyph()
+{
+    if (!m_freeGlyphs.empty()) {
+        Glyph *glyph = m_freeGlyphs.back();
+        m_freeGlyphs.pop_back();
+        return glyph;
+    }
+    return &m_glyphs.emplace_back();
+}
+
+void QFontEngineFT::GlyphAtlas::releaseGlyph(Glyph *glyph)
+{
+    if (glyph->data)
+        releaseBitmap(glyph->data, glyphBitmapSize(glyph));
+    glyph->data = nullptr;
+    m_freeGlyphs.push_back(glyph);
+}
+
+uchar *QFontEngineFT::GlyphAtlas::allocateBitmap(size_t size)
+{
+    size = (size + BitmapAlignment - 1) & ~(BitmapAlignment - 1);
+    if (size > MaximumPackedBitmapSize) {
+        m_bitmapPages.emplace_back(new uchar[size]);
+        m_bitmapMemory += size;
+        return m_bitmapPages.back().get();
+    }
+
+    const size_t sizeClass = size / BitmapAlignment;
+    if (sizeClass < m_freeBitmaps.size() && !m_freeBitmaps[sizeClass].empty()) {
+        uchar *data = m_freeBitmaps[sizeClass].back();
+        m_freeBitmaps[sizeClass].pop_back();
+        return data;
+    }
+
+    // The pages grow with the atlas, so that a font that is only used for a
+    // few glyphs does not pay for a large page
+    if (!m_bitmapPage || m_bitmapPageUsed + size > m_bitmapPageSize) {
+        m_bitmapPageSize = m_bitmapPageSize ? qMin(m_bitmapPageSize * 2, MaximumPageSize)
+                                            : MinimumPageSize;
+        m_bitmapPages.emplace_back(new uchar[m_bitmapPageSize]);
+        m_bitmapPage = m_bitmapPages.back().get();
+        m_bitmapPageUsed = 0;
+        m_bitmapMemory += m_bitmapPageSize;
+    }
+
+    uchar *data = m_bitmapPage + m_bitmapPageUsed;
+    m_bitmapPageUsed += size;
+    return data;
+}
+
+void QFontEngineFT::GlyphAtlas::releaseBitmap(uchar *bitmap, size_t size)
+{
+    size = (size + BitmapAlignment - 1) & ~(BitmapAlignment - 1);
+    if (size > MaximumPackedBitmapSize) {
+        const auto it = std::find_if(m_bitmapPages.begin(), m_bitmapPages.end(),
+                                     [bitmap](const auto &page) { return page.get() == bitmap; });
+        Q_ASSERT(it != m_bitmapPages.end());
+        m_bitmapPages.erase(it);
+        m_bitmapMemory -= size;
+        return;
+    }
+
+    const size_t sizeClass = size / BitmapAlignment;
+    if (sizeClass >= m_freeBitmaps.size())
+        m_freeBitmaps.resize(sizeClass + 1);
+    m_freeBitmaps[sizeClass].push_back(bitmap);
+}
+
+size_t QFontEngineFT::GlyphAtlas::memoryUsage() const
+{
+    return m_bitmapMemory + m_glyphs.size() * sizeof(Glyph) + m_capacity * sizeof(Entry)
+            + size_t(missingGlyphs.capacity()) * sizeof(glyph_t);
+}
+
 QFontEngineFT::QGlyphSet::QGlyphSet()
     : outline_drawing(false)
 {
@@ -2210,8 +2430,6 @@ QFontEngineFT::QGlyphSet::QGlyphSet()
     transformationMatrix.yy = 0x10000;
     transformationMatrix.xy = 0;
     transformationMatrix.yx = 0;
-    memset(fast_glyph_data, 0, sizeof(fast_glyph_data));
-    fast_glyph_count = 0;
 }
 
 QFontEngineFT::QGlyphSet::~QGlyphSet()
@@ -2221,45 +2439,66 @@ QFontEngineFT::QGlyphSet::~QGlyphSet()
 
 void QFontEngineFT::QGlyphSet::clear()
 {
-    if (fast_glyph_count > 0) {
-        for (int i = 0; i < 256; ++i) {
-            if (fast_glyph_data[i]) {
-                delete fast_glyph_data[i];
-                fast_glyph_data[i] = nullptr;
-            }
-        }
-        fast_glyph_count = 0;
-    }
-    qDeleteAll(glyph_data);
-    glyph_data.clear();
+    // Other glyph sets may still use the atlas
+    atlas.reset();
 }
 
 void QFontEngineFT::QGlyphSet::removeGlyphFromCache(glyph_t index,
                                                     const QFixedPoint &subPixelPosition)
 {
-    if (useFastGlyphData(index, subPixelPosition)) {
-        if (fast_glyph_data[index]) {
-            delete fast_glyph_data[index];
-            fast_glyph_data[index] = nullptr;
-            if (fast_glyph_count > 0)
-                --fast_glyph_count;
-        }
-    } else {
-        delete glyph_data.take(GlyphAndSubPixelPosition(index, subPixelPosition));
-    }
+    if (atlas)
+        atlas->remove(index, subPixelPosition);
 }
 
 void QFontEngineFT::QGlyphSet::setGlyph(glyph_t index,
                                         const QFixedPoint &subPixelPosition,
                                         Glyph *glyph)
 {
-    if (useFastGlyphData(index, subPixelPosition)) {
-        if (!fast_glyph_data[index])
-            ++fast_glyph_count;
-        fast_glyph_data[index] = glyph;
-    } else {
-        glyph_data.insert(GlyphAndSubPixelPosition(index, subPixelPosition), glyph);
+    Q_ASSERT(atlas);
+    if (glyph)
+        atlas->insert(index, subPixelPosition, glyph);
+    else
+        atlas->remove(index, subPixelPosition);
+}
+
+void QFontEngineFT::attachGlyphAtlas(QGlyphSet *set) const
+{
+    Q_ASSERT(!set->atlas);
+
+    constexpr int Antialias = 0x01;
+    constexpr int Embolden = 0x02;
+    constexpr int Obliquen = 0x04;
+    constexpr int EmbeddedBitmap = 0x08;
+    constexpr int ForceAutoHint = 0x10;
+    constexpr int StemDarkening = 0x20;
+    constexpr int OutlineDrawing = 0x40;
+    const int flags = (antialias ? Antialias : 0) | (embolden ? Embolden : 0)
+            | (obliquen ? Obliquen : 0) | (embeddedbitmap ? EmbeddedBitmap : 0)
+            | (forceAutoHint ? ForceAutoHint : 0) | (stemDarkeningDriver ? StemDarkening : 0)
+            | (set->outline_drawing ? OutlineDrawing : 0);
+
+    const QtFreetypeData::GlyphAtlasKey key{ freetype, {
+        xsize, ysize,
+        matrix.xx, matrix.xy, matrix.yx, matrix.yy,
+        set->transformationMatrix.xx, set->transformationMatrix.xy,
+        set->transformationMatrix.yx, set->transformationMatrix.yy,
+        default_load_flags, default_hint_style, subpixelType, lcdFilterType, defaultFormat,
+        flags
+    } };
+
+    // Font engines, and thus their glyph sets, belong to the thread that
+    // created them, so the atlases are shared per thread
+    QtFreetypeData *freetypeData = qt_getFreetypeData();
+    auto it = freetypeData->glyphAtlases.find(key);
+    if (it != freetypeData->glyphAtlases.end()) {
+        set->atlas = it.value().lock();
+        if (set->atlas)
+            return;
     }
+
+    freetypeData->glyphAtlases.removeIf([](const auto &entry) { return entry.value().expired(); });
+    set->atlas = std::make_shared<GlyphAtlas>();
+    freetypeData->glyphAtlases.insert(key, set->atlas);
 }
 
 int QFontEngineFT::getPointInOutline(glyph_t glyph, int flags, quint32 point, QFixed *xpos, QFixed *ypos, quint32 *nPoints)
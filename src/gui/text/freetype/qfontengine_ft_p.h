@@ -28,6 +28,9 @@
 
 #include <qmutex.h>
 
+#include <deque>
+#include <memory>
+#include <vector>
 #include <string.h>
 
 QT_BEGIN_NAMESPACE
@@ -122,6 +125,72 @@ public:
         QFixedPoint subPixelPosition;
     };
 
+    // Owns the glyphs of one or more glyph sets. The glyph records and their
+    // bitmaps are packed into pages, and looked up through an open addressed
+    // table keyed by glyph index and subpixel position. The records and
+    // bitmaps of glyphs that are replaced or removed are kept on free lists,
+    // by size, for the next glyphs. Glyph sets of font engines that render
+    // glyphs the same way share their atlas.
+    class GlyphAtlas
+    {
+    public:
+        GlyphAtlas() = default;
+        ~GlyphAtlas();
+
+        inline Glyph *find(glyph_t index, const QFixedPoint &subPixelPosition) const;
+        void insert(glyph_t index, const QFixedPoint &subPixelPosition, Glyph *glyph);
+        void remove(glyph_t index, const QFixedPoint &subPixelPosition);
+
+        Glyph *allocateGlyph();
+        uchar *allocateBitmap(size_t size);
+        void releaseBitmap(uchar *bitmap, size_t size);
+
+        qsizetype glyphCount() const { return m_count; }
+        size_t memoryUsage() const;
+
+        QSet<glyph_t> missingGlyphs;
+
+    private:
+        Q_DISABLE_COPY(GlyphAtlas)
+
+        struct Entry
+        {
+            glyph_t index;
+            int x;
+            int y;
+            Glyph *glyph; // nullptr for an empty slot
+        };
+
+        inline quint32 bucket(glyph_t index, int x, int y) const
+        {
+            quint64 key = quint64(index) | (quint64(quint16(x)) << 32) | (quint64(quint16(y)) << 48);
+            key *= Q_UINT64_C(0x9e3779b97f4a7c15);
+            return quint32(key >> m_shift);
+        }
+        void rehash(quint32 capacity);
+        void releaseGlyph(Glyph *glyph);
+
+        // Bitmaps larger than a quarter of the largest page get a page of their own
+        static constexpr size_t MinimumPageSize = 4096;
+        static constexpr size_t MaximumPageSize = 65536;
+        static constexpr size_t MaximumPackedBitmapSize = MaximumPageSize / 4;
+        static constexpr size_t BitmapAlignment = 8;
+
+        std::unique_ptr<Entry[]> m_entries;
+        quint32 m_capacity = 0;
+        quint32 m_count = 0;
+        int m_shift = 64;
+
+        std::deque<Glyph> m_glyphs;
+        std::vector<Glyph *> m_freeGlyphs;
+        std::vector<std::unique_ptr<uchar[]>> m_bitmapPages;
+        std::vector<std::vector<uchar *>> m_freeBitmaps; // by size / BitmapAlignment
+        uchar *m_bitmapPage = nullptr;
+        size_t m_bitmapPageSize = 0;
+        size_t m_bitmapPageUsed = 0;
+        size_t m_bitmapMemory = 0;
+    };
+
     struct QGlyphSet
     {
         QGlyphSet();
@@ -131,21 +200,19 @@ public:
 
         void removeGlyphFromCache(glyph_t index, const QFixedPoint &subPixelPosition);
         void clear();
-        inline bool useFastGlyphData(glyph_t index, const QFixedPoint &subPixelPosition) const {
-            return (index < 256 && subPixelPosition.x == 0 && subPixelPosition.y == 0);
-        }
         inline Glyph *getGlyph(glyph_t index,
                                const QFixedPoint &subPixelPositionX = QFixedPoint()) const;
         void setGlyph(glyph_t index, const QFixedPoint &spp, Glyph *glyph);
 
-        inline bool isGlyphMissing(glyph_t index) const { return missing_glyphs.contains(index); }
-        inline void setGlyphMissing(glyph_t index) const { missing_glyphs.insert(index); }
+        inline bool isGlyphMissing(glyph_t index) const { return atlas && atlas->missingGlyphs.contains(index); }
+        inline void setGlyphMissing(glyph_t index) const { if (atlas) atlas->missingGlyphs.insert(index); }
+
+        // nullptr until the first glyph of the set is loaded
+        const GlyphAtlas *glyphAtlas() const { return atlas.get(); }
 private:
+        friend class QFontEngineFT;
         Q_DISABLE_COPY(QGlyphSet);
-        mutable QHash<GlyphAndSubPixelPosition, Glyph *> glyph_data; // maps from glyph index to glyph data
-        mutable QSet<glyph_t> missing_glyphs;
-        mutable Glyph *fast_glyph_data[256]; // for fast lookup of glyphs < 256
-        mutable int fast_glyph_count;
+        std::shared_ptr<GlyphAtlas> atlas;
     };
 
     QFontEngine::FaceId faceId() const override;
@@ -294,6 +361,7 @@ private:
     friend class QFontEngineMultiFontConfig;
 
     int loadFlags(QGlyphSet *set, GlyphFormat format, int flags, bool &hsubpixel, int &vfactor) const;
+    void attachGlyphAtlas(QGlyphSet *set) const;
     bool shouldUseDesignMetrics(ShaperFlags flags) const;
     QFixed scaledBitmapMetrics(QFixed m) const;
     glyph_metrics_t scaledBitmapMetrics(const glyph_metrics_t &m, const QTransform &matrix) const;
@@ -306,6 +374,7 @@ private:
         QGlyphSet *sets[nSets];
 
         QGlyphSet *findSet(const QTransform &matrix, const QFontDef &fontDef);
+        void clear();
         TransformedGlyphSets() { std::fill(&sets[0], &sets[nSets], nullptr); }
         ~TransformedGlyphSets() { qDeleteAll(&sets[0], &sets[nSets]); }
     private:
@@ -337,12 +406,28 @@ inline size_t qHash(const QFontEngineFT::GlyphAndSubPixelPosition &g, size_t see
                       g.subPixelPosition.y.value());
 }
 
+inline QFontEngineFT::Glyph *QFontEngineFT::GlyphAtlas::find(glyph_t index,
+                                                               const QFixedPoint &subPixelPosition) const
+{
+    if (m_count == 0)
+        return nullptr;
+
+    const int x = subPixelPosition.x.value();
+    const int y = subPixelPosition.y.value();
+    const quint32 mask = m_capacity - 1;
+    for (quint32 i = bucket(index, x, y); ; i = (i + 1) & mask) {
+        const Entry &entry = m_entries[i];
+        if (!entry.glyph)
+            return nullptr;
+        if (entry.index == index && entry.x == x && entry.y == y)
+            return entry.glyph;
+    }
+}
+
 inline QFontEngineFT::Glyph *QFontEngineFT::QGlyphSet::getGlyph(glyph_t index,
                                                                 const QFixedPoint &subPixelPosition) const
 {
-    if (useFastGlyphData(index, subPixelPosition))
-        return fast_glyph_data[index];
-    return glyph_data.value(GlyphAndSubPixelPosition(index, subPixelPosition));
+    return atlas ? atlas->find(index, subPixelPosition) : nullptr;
 }
 
 Q_GUI_EXPORT FT_Library qt_getFreetype();
@@ -98,11 +98,15 @@ Q_AUTOTEST_EXPORT QList<QFontEngine *> QFontEngine_stopCollectingEngines()
 
 #define kBearingNotInitialized std::numeric_limits<qreal>::max()
 
+// The total size in bytes of the shaped runs each font engine keeps
+static constexpr qsizetype ShapedRunCacheCost = 256 * 1024;
+
 QFontEngine::QFontEngine(Type type)
     : m_type(type), ref(0),
       font_(),
       face_(),
       m_heightMetricsQueried(false),
+      m_shapedRuns(ShapedRunCacheCost),
       m_minLeftBearing(kBearingNotInitialized),
       m_minRightBearing(kBearingNotInitialized)
 {
@@ -1013,6 +1017,92 @@ QFontEngineGlyphCache *QFontEngine::glyphCache(const void *context,
     return nullptr;
 }
 
+Q_CONSTINIT static QBasicAtomicInteger<quint64> shapedRunHits = Q_BASIC_ATOMIC_INITIALIZER(0);
+Q_CONSTINIT static QBasicAtomicInteger<quint64> shapedRunMisses = Q_BASIC_ATOMIC_INITIALIZER(0);
+Q_CONSTINIT static QBasicAtomicInt shapedRunCacheEnabled = Q_BASIC_ATOMIC_INITIALIZER(-1);
+
+/*!
+    \internal
+
+    Looks up the glyphs that the text and shaping options in \a key were
+    shaped into with this font engine, and stores them in \a run. Returns
+    \c false if they are not in the cache.
+
+    The glyph data is implicitly shared, so the copy is cheap and remains
+    valid if the run is evicted afterwards.
+*/
+bool QFontEngine::findShapedRun(const ShapedRunKey &key, ShapedRun *run) const
+{
+    {
+        QMutexLocker locker(&m_shapedRunsMutex);
+        if (const ShapedRun *cached = m_shapedRuns.object(key)) {
+            *run = *cached;
+            shapedRunHits.fetchAndAddRelaxed(1);
+            return true;
+        }
+    }
+    shapedRunMisses.fetchAndAddRelaxed(1);
+    return false;
+}
+
+/*!
+    \internal
+
+    Remembers that the text and shaping options in \a key were shaped into
+    \a run with this font engine. The least recently used runs are evicted
+    when the runs take more than 256 KB.
+*/
+void QFontEngine::insertShapedRun(const ShapedRunKey &key, const ShapedRun &run) const
+{
+    const qsizetype cost = run.glyphData.size() + run.logClusters.size() * sizeof(ushort)
+            + key.text.size() * sizeof(QChar);
+    QMutexLocker locker(&m_shapedRunsMutex);
+    m_shapedRuns.insert(key, new ShapedRun(run), cost);
+}
+
+/*!
+    \internal
+
+    Returns whether QTextEngine caches shaped runs. This is the case unless
+    the \c QT_SHAPED_RUN_CACHE environment variable is set to 0.
+*/
+bool QFontEngine::isShapedRunCacheEnabled()
+{
+    int enabled = shapedRunCacheEnabled.loadRelaxed();
+    if (Q_UNLIKELY(enabled < 0)) {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("QT_SHAPED_RUN_CACHE", &ok);
+        enabled = !ok || value != 0;
+        shapedRunCacheEnabled.storeRelaxed(enabled);
+    }
+    return enabled;
+}
+
+/*!
+    \internal
+
+    Sets whether QTextEngine caches shaped runs. Runs that are already cached
+    are kept.
+*/
+void QFontEngine::setShapedRunCacheEnabled(bool enabled)
+{
+    shapedRunCacheEnabled.storeRelaxed(enabled);
+}
+
+/*!
+    \internal
+
+    Returns how often the shaped run caches of all font engines were hit and
+    missed since the application started.
+*/
+QFontEngine::ShapedRunStatistics QFontEngine::shapedRunStatistics()
+{
+    ShapedRunStatistics statistics;
+    statistics.hits = shapedRunHits.loadRelaxed();
+    statistics.misses = shapedRunMisses.loadRelaxed();
+    return statistics;
+}
+
 static inline QFixed kerning(int left, int right, const QFontEngine::KernPair *pairs, int numPairs)
 {
     uint left_right = (left << 16) + right;
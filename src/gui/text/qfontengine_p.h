@@ -17,6 +17,8 @@
 
 #include <QtGui/private/qtguiglobal_p.h>
 #include "QtCore/qatomic.h"
+#include <QtCore/qcache.h>
+#include <QtCore/qmutex.h>
 #include <QtCore/qvarlengtharray.h>
 #include <QtCore/qhashfunctions.h>
 #include "private/qtextengine_p.h"
@@ -245,6 +247,50 @@ public:
     void setGlyphCache(const void *key, QFontEngineGlyphCache *data);
     QFontEngineGlyphCache *glyphCache(const void *key, GlyphFormat format, const QTransform &transform, const QColor &color = QColor()) const;
 
+    // Glyphs that QTextEngine shaped a piece of text into, so that shaping
+    // the same text with the same options again can skip HarfBuzz.
+    enum ShapedRunFlag {
+        RightToLeft = 0x1,
+        KerningEnabled = 0x2,
+        LetterSpacing = 0x4,
+        UseDesignMetrics = 0x8
+    };
+    struct ShapedRunKey {
+        QString text;
+        QList<std::pair<quint32, quint32>> features; // sorted by tag
+        const void *language = nullptr; // the hb_language_t the text is shaped for
+        int script = 0;
+        uint flags = 0;
+
+        friend bool operator==(const ShapedRunKey &lhs, const ShapedRunKey &rhs) noexcept
+        {
+            return lhs.script == rhs.script && lhs.flags == rhs.flags
+                    && lhs.language == rhs.language && lhs.text == rhs.text
+                    && lhs.features == rhs.features;
+        }
+        friend size_t qHash(const ShapedRunKey &key, size_t seed = 0) noexcept
+        {
+            return qHashMulti(seed, key.text, key.script, key.flags, key.language,
+                              qHashRange(key.features.cbegin(), key.features.cend()));
+        }
+    };
+    struct ShapedRun {
+        QByteArray glyphData; // a QGlyphLayout of numGlyphs glyphs
+        QList<ushort> logClusters;
+        int numGlyphs = 0;
+    };
+    struct ShapedRunStatistics {
+        quint64 hits = 0;
+        quint64 misses = 0;
+    };
+    static constexpr int MaxShapedRunLength = 256;
+
+    bool findShapedRun(const ShapedRunKey &key, ShapedRun *run) const;
+    void insertShapedRun(const ShapedRunKey &key, const ShapedRun &run) const;
+    static bool isShapedRunCacheEnabled();
+    static void setShapedRunCacheEnabled(bool enabled);
+    static ShapedRunStatistics shapedRunStatistics();
+
     static const uchar *getCMap(const uchar *table, uint tableSize, bool *isSymbolFont, int *cmapSize);
     static quint32 getTrueTypeGlyphIndex(const uchar *cmap, int cmapSize, uint unicode);
 
@@ -367,6 +413,9 @@ private:
     typedef std::list<GlyphCacheEntry> GlyphCaches;
     mutable QHash<const void *, GlyphCaches> m_glyphCaches;
 
+    mutable QBasicMutex m_shapedRunsMutex;
+    mutable QCache<ShapedRunKey, ShapedRun> m_shapedRuns;
+
 private:
     mutable qreal m_minLeftBearing;
     mutable qreal m_minRightBearing;
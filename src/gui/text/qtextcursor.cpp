@@ -1423,10 +1423,9 @@ void QTextCursor::insertText(const QString &text, const QTextCharFormat &_format
         QTextBlockFormat blockFmt = blockFormat();
 
 
-        int textStart = d->priv->text.size();
+        int textStart = d->priv->text.append(text);
         int blockStart = 0;
-        d->priv->text += text;
-        int textEnd = d->priv->text.size();
+        int textEnd = textStart + text.size();
 
         for (int i = 0; i < text.size(); ++i) {
             QChar ch = text.at(i);
@@ -1670,7 +1669,7 @@ int QTextCursor::selectionEnd() const
     return qMax(d->position, d->adjusted_anchor);
 }
 
-static void getText(QString &text, QTextDocumentPrivate *priv, const QString &docText, int pos, int end)
+static void getText(QString &text, QTextDocumentPrivate *priv, const QTextDocumentBuffer &docText, int pos, int end)
 {
     while (pos < end) {
         QTextDocumentPrivate::FragmentIterator fragIt = priv->find(pos);
@@ -1679,7 +1678,7 @@ static void getText(QString &text, QTextDocumentPrivate *priv, const QString &do
         const int offsetInFragment = qMax(0, pos - fragIt.position());
         const int len = qMin(int(frag->size_array[0] - offsetInFragment), end - pos);
 
-        text += QStringView(docText.constData() + frag->stringPosition + offsetInFragment, len);
+        text += docText.mid(frag->stringPosition + offsetInFragment, len);
         pos += len;
     }
 }
@@ -1700,7 +1699,7 @@ QString QTextCursor::selectedText() const
     if (!d || !d->priv || d->position == d->anchor)
         return QString();
 
-    const QString docText = d->priv->buffer();
+    const QTextDocumentBuffer &docText = d->priv->buffer();
     QString text;
 
     QTextTable *table = d->complexSelectionTable();
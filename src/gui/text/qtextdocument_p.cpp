@@ -103,6 +103,41 @@ static bool noBlockInString(QStringView str)
         && !str.contains(QTextEndOfFrame);
 }
 
+/*!
+    \internal
+
+    Appends \a str to the buffer, and returns the position of its first
+    character.
+
+    When the current chunk is full, a new chunk is started one position
+    after the end of the current one. Fragments that are adjacent in the
+    buffer are merged, so the gap ensures that no fragment ever spans two
+    chunks, and every fragment can be accessed as a single QStringView.
+*/
+int QTextDocumentBuffer::append(QStringView str)
+{
+    if (m_chunks.isEmpty()) {
+        m_chunks.append({ 0, QString() });
+    } else if (!m_chunks.constLast().text.isEmpty()
+               && m_chunks.constLast().text.size() + str.size() > ChunkSize) {
+        Chunk &full = m_chunks.last();
+        full.text.squeeze();
+        m_chunks.append({ int(full.position + full.text.size() + 1), QString() });
+    }
+
+    Chunk &current = m_chunks.last();
+    const int position = current.position + current.text.size();
+    current.text.append(str);
+    m_characterCount += str.size();
+    return position;
+}
+
+void QTextDocumentBuffer::clear()
+{
+    m_chunks.clear();
+    m_characterCount = 0;
+}
+
 bool QTextUndoCommand::tryMerge(const QTextUndoCommand &other)
 {
     if (command != other.command)
@@ -228,7 +263,7 @@ void QTextDocumentPrivate::clear()
 
         title.clear();
         clearUndoRedoStacks(QTextDocument::UndoAndRedoStacks);
-        text = QString();
+        text.clear();
         unreachableCharacterCount = 0;
         modifiedState = 0;
         modified = false;
@@ -289,7 +324,7 @@ void QTextDocumentPrivate::setLayout(QAbstractTextDocumentLayout *layout)
 void QTextDocumentPrivate::insert_string(int pos, uint strPos, uint length, int format, QTextUndoCommand::Operation op)
 {
     // ##### optimize when only appending to the fragment!
-    Q_ASSERT(noBlockInString(QStringView{text}.mid(strPos, length)));
+    Q_ASSERT(noBlockInString(text.mid(strPos, length)));
 
     split(pos);
     uint x = fragments.insert_single(pos, length);
@@ -375,8 +410,7 @@ int QTextDocumentPrivate::insertBlock(QChar blockSeparator,
 
     beginEditBlock();
 
-    int strPos = text.size();
-    text.append(blockSeparator);
+    int strPos = text.append(QStringView(&blockSeparator, 1));
 
     int ob = blocks.findNode(pos);
     bool atBlockEnd = true;
@@ -452,8 +486,7 @@ void QTextDocumentPrivate::insert(int pos, QStringView str, int format)
 
     Q_ASSERT(noBlockInString(str));
 
-    int strPos = text.size();
-    text.append(str);
+    int strPos = text.append(str);
     insert(pos, strPos, str.size(), format);
 }
 
@@ -468,7 +501,7 @@ int QTextDocumentPrivate::remove_string(int pos, uint length, QTextUndoCommand::
 
     Q_ASSERT(blocks.size(b) > length);
     Q_ASSERT(x && fragments.position(x) == (uint)pos && fragments.size(x) == length);
-    Q_ASSERT(noBlockInString(QStringView{text}.mid(fragments.fragment(x)->stringPosition, length)));
+    Q_ASSERT(noBlockInString(text.mid(fragments.fragment(x)->stringPosition, length)));
 
     blocks.setSize(b, blocks.size(b)-length);
 
@@ -603,7 +636,7 @@ void QTextDocumentPrivate::move(int pos, int to, int length, QTextUndoCommand::O
 
         if (key+1 != blocks.position(b)) {
 //          qDebug("remove_string from %d length %d", key, X->size_array[0]);
-            Q_ASSERT(noBlockInString(QStringView{text}.mid(X->stringPosition, X->size_array[0])));
+            Q_ASSERT(noBlockInString(text.mid(X->stringPosition, X->size_array[0])));
             w = remove_string(key, X->size_array[0], op);
 
             if (needsInsert) {
@@ -1308,11 +1341,11 @@ QString QTextDocumentPrivate::plainText() const
 {
     QString result;
     result.resize(length());
-    const QChar *text_unicode = text.unicode();
     QChar *data = result.data();
     for (QTextDocumentPrivate::FragmentIterator it = begin(); it != end(); ++it) {
         const QTextFragmentData *f = *it;
-        ::memcpy(data, text_unicode + f->stringPosition, f->size_array[0] * sizeof(QChar));
+        const QStringView fragmentText = text.mid(f->stringPosition, f->size_array[0]);
+        ::memcpy(data, fragmentText.data(), f->size_array[0] * sizeof(QChar));
         data += f->size_array[0];
     }
     // remove trailing block separator
@@ -1643,29 +1676,22 @@ void QTextDocumentPrivate::compressPieceTable()
 
     const uint garbageCollectionThreshold = 96 * 1024; // bytes
 
-    //qDebug() << "unreachable bytes:" << unreachableCharacterCount * sizeof(QChar) << " -- limit" << garbageCollectionThreshold << "text size =" << text.size() << "capacity:" << text.capacity();
+    //qDebug() << "unreachable bytes:" << unreachableCharacterCount * sizeof(QChar) << " -- limit" << garbageCollectionThreshold << "text size =" << text.characterCount();
 
+    // The buffer is not reallocated when it grows, so compress it once a
+    // quarter of it is unreachable. Every character that is copied then
+    // pays for at most three that were removed.
     bool compressTable = unreachableCharacterCount * sizeof(QChar) > garbageCollectionThreshold
-                         && text.size() >= text.capacity() * 0.9;
+                         && unreachableCharacterCount * 4 > text.characterCount();
     if (!compressTable)
         return;
 
-    QString newText;
-    newText.resize(text.size());
-    QChar *newTextPtr = newText.data();
-    int newLen = 0;
-
-    for (FragmentMap::Iterator it = fragments.begin(); !it.atEnd(); ++it) {
-        memcpy(newTextPtr, text.constData() + it->stringPosition, it->size_array[0] * sizeof(QChar));
-        it->stringPosition = newLen;
-        newTextPtr += it->size_array[0];
-        newLen += it->size_array[0];
-    }
+    QTextDocumentBuffer newText;
+    for (FragmentMap::Iterator it = fragments.begin(); !it.atEnd(); ++it)
+        it->stringPosition = newText.append(text.mid(it->stringPosition, it->size_array[0]));
 
-    newText.resize(newLen);
-    newText.squeeze();
-    //qDebug() << "removed" << text.size() - newText.size() << "characters";
-    text = newText;
+    //qDebug() << "removed" << text.characterCount() - newText.characterCount() << "characters";
+    text = std::move(newText);
     unreachableCharacterCount = 0;
 }
 
@@ -36,6 +36,8 @@
 #include "private/qobject_p.h"
 #include "private/qtextformat_p.h"
 
+#include <algorithm>
+
 // #define QT_QMAP_DEBUG
 
 #ifdef QT_QMAP_DEBUG
@@ -65,6 +67,56 @@ public:
     int format;
 };
 
+// The characters of a document, including the ones that were removed but
+// can come back through undo. Text is only ever appended, and the fragments
+// refer to it by position. It is stored in chunks rather than in a single
+// string, so that typing into a large document never has to reallocate and
+// copy all of its text.
+class Q_GUI_EXPORT QTextDocumentBuffer
+{
+public:
+    static constexpr qsizetype ChunkSize = 64 * 1024;
+
+    int append(QStringView str);
+    void clear();
+
+    inline QChar at(int position) const
+    {
+        const Chunk &c = chunk(position);
+        return c.text.at(position - c.position);
+    }
+    // the text must not span several calls to append()
+    inline QStringView mid(int position, int length) const
+    {
+        const Chunk &c = chunk(position);
+        return QStringView(c.text).mid(position - c.position, length);
+    }
+
+    qsizetype characterCount() const { return m_characterCount; }
+
+private:
+    struct Chunk {
+        int position;
+        QString text;
+    };
+
+    inline const Chunk &chunk(int position) const
+    {
+        Q_ASSERT(!m_chunks.isEmpty());
+        // most lookups are for recently inserted text
+        if (position >= m_chunks.constLast().position)
+            return m_chunks.constLast();
+        auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), position,
+                                   [](int position, const Chunk &chunk) {
+            return position < chunk.position;
+        });
+        return *(it - 1);
+    }
+
+    QList<Chunk> m_chunks;
+    qsizetype m_characterCount = 0;
+};
+
 class QTextBlockData : public QFragment<3>
 {
 public:
@@ -185,7 +237,7 @@ public:
     inline int availableUndoSteps() const { return undoEnabled ? undoState : 0; }
     inline int availableRedoSteps() const { return undoEnabled ? qMax(undoStack.size() - undoState - 1, 0) : 0; }
 
-    inline QString buffer() const { return text; }
+    inline const QTextDocumentBuffer &buffer() const { return text; }
     QString plainText() const;
     inline int length() const { return fragments.length(); }
 
@@ -307,7 +359,7 @@ private:
 
     void compressPieceTable();
 
-    QString text;
+    QTextDocumentBuffer text;
     uint unreachableCharacterCount;
 
     QList<QTextUndoCommand> undoStack;
@@ -23,6 +23,7 @@
 #include <qvarlengtharray.h>
 #include <limits.h>
 #include <qbasictimer.h>
+#include <qelapsedtimer.h>
 #include "private/qfunctions_p.h"
 #include <qloggingcategory.h>
 #include <QtCore/qpointer.h>
@@ -4016,10 +4017,27 @@ void QTextDocumentLayoutPrivate::ensureLayoutedByPosition(int position) const
     }
 }
 
+// How long a single step of the lazy layout should take, so that the
+// event loop keeps running while a large document is laid out
+static constexpr qint64 LazyLayoutStepDuration = 8 * 1000 * 1000; // ns
+
 void QTextDocumentLayoutPrivate::layoutStep() const
 {
+    const int from = currentLazyLayoutPosition;
+    QElapsedTimer timer;
+    timer.start();
     ensureLayoutedByPosition(currentLazyLayoutPosition + lazyLayoutStepSize);
-    lazyLayoutStepSize = qMin(200000, lazyLayoutStepSize * 2);
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    // Size the next step by how fast this one went, rather than by the
+    // number of characters alone: a step over plain Latin text is much
+    // cheaper than one over complex scripts, tables or images.
+    const int to = currentLazyLayoutPosition == -1 ? docPrivate->length()
+                                                   : currentLazyLayoutPosition;
+    qint64 stepSize = qint64(lazyLayoutStepSize) * 2;
+    if (to > from && elapsed > 0)
+        stepSize = qMin(stepSize, qint64(to - from) * LazyLayoutStepDuration / elapsed);
+    lazyLayoutStepSize = int(qBound(qint64(1000), stepSize, qint64(1000000)));
 }
 
 void QTextDocumentLayout::setCursorWidth(int width)
@@ -1603,6 +1603,41 @@ int QTextEngine::shapeTextWithHarfbuzzNG(const QScriptItem &si,
                                          bool hasLetterSpacing,
                                          const QHash<QFont::Tag, quint32> &fontFeatures) const
 {
+    // Labels, list items and table cells are laid out over and over again,
+    // so look up short items in the font engine's cache of shaped runs first.
+    QFontEngine::ShapedRunKey shapedRunKey;
+    const bool cacheShapedRun = itemLength <= QFontEngine::MaxShapedRunLength
+            && QFontEngine::isShapedRunCacheEnabled();
+    if (cacheShapedRun) {
+        shapedRunKey.text = QString(reinterpret_cast<const QChar *>(string), itemLength);
+        shapedRunKey.script = si.analysis.script;
+        // follows the locale, which can change between two layouts
+        shapedRunKey.language = hb_language_get_default();
+        if (si.analysis.bidiLevel % 2)
+            shapedRunKey.flags |= QFontEngine::RightToLeft;
+        if (kerningEnabled)
+            shapedRunKey.flags |= QFontEngine::KerningEnabled;
+        if (hasLetterSpacing)
+            shapedRunKey.flags |= QFontEngine::LetterSpacing;
+        if (option.useDesignMetrics())
+            shapedRunKey.flags |= QFontEngine::UseDesignMetrics;
+        shapedRunKey.features.reserve(fontFeatures.size());
+        for (auto it = fontFeatures.constBegin(); it != fontFeatures.constEnd(); ++it)
+            shapedRunKey.features.append({ it.key().value(), it.value() });
+        std::sort(shapedRunKey.features.begin(), shapedRunKey.features.end());
+
+        QFontEngine::ShapedRun run;
+        if (fontEngine->findShapedRun(shapedRunKey, &run)) {
+            if (Q_UNLIKELY(!ensureSpace(run.numGlyphs)))
+                return 0;
+            QGlyphLayout cached(const_cast<char *>(run.glyphData.constData()), run.numGlyphs);
+            QGlyphLayout g = availableGlyphs(&si).mid(0, run.numGlyphs);
+            g.copy(&cached);
+            memcpy(logClusters(&si), run.logClusters.constData(), itemLength * sizeof(ushort));
+            return run.numGlyphs;
+        }
+    }
+
     uint glyphs_shaped = 0;
 
     hb_buffer_t *buffer = hb_buffer_create();
@@ -1767,6 +1802,18 @@ int QTextEngine::shapeTextWithHarfbuzzNG(const QScriptItem &si,
 
     hb_buffer_destroy(buffer);
 
+    if (cacheShapedRun) {
+        QFontEngine::ShapedRun run;
+        run.numGlyphs = glyphs_shaped;
+        run.glyphData.resize(glyphs_shaped * QGlyphLayout::SpaceNeeded);
+        QGlyphLayout cached(run.glyphData.data(), glyphs_shaped);
+        QGlyphLayout g = availableGlyphs(&si).mid(0, glyphs_shaped);
+        cached.copy(&g);
+        const ushort *log_clusters = logClusters(&si);
+        run.logClusters.assign(log_clusters, log_clusters + itemLength);
+        fontEngine->insertShapedRun(shapedRunKey, run);
+    }
+
     return glyphs_shaped;
 }
 
@@ -1074,15 +1074,16 @@ Qt::LayoutDirection QTextBlock::textDirection() const
     if (dir != Qt::LayoutDirectionAuto)
         return dir;
 
-    const QString buffer = p->buffer();
+    const QTextDocumentBuffer &buffer = p->buffer();
 
     const int pos = position();
     QTextDocumentPrivate::FragmentIterator it = p->find(pos);
     QTextDocumentPrivate::FragmentIterator end = p->find(pos + length() - 1); // -1 to omit the block separator char
     for (; it != end; ++it) {
         const QTextFragmentData * const frag = it.value();
-        const QChar *p = buffer.constData() + frag->stringPosition;
-        const QChar * const end = p + frag->size_array[0];
+        const QStringView fragmentText = buffer.mid(frag->stringPosition, frag->size_array[0]);
+        const QChar *p = fragmentText.data();
+        const QChar * const end = p + fragmentText.size();
         while (p < end) {
             uint ucs4 = p->unicode();
             if (QChar::isHighSurrogate(ucs4) && p + 1 < end) {
@@ -1117,7 +1118,7 @@ QString QTextBlock::text() const
     if (!p || !n)
         return QString();
 
-    const QString buffer = p->buffer();
+    const QTextDocumentBuffer &buffer = p->buffer();
     QString text;
     text.reserve(length());
 
@@ -1126,7 +1127,7 @@ QString QTextBlock::text() const
     QTextDocumentPrivate::FragmentIterator end = p->find(pos + length() - 1); // -1 to omit the block separator char
     for (; it != end; ++it) {
         const QTextFragmentData * const frag = it.value();
-        text += QStringView(buffer.constData() + frag->stringPosition, frag->size_array[0]);
+        text += buffer.mid(frag->stringPosition, frag->size_array[0]);
     }
 
     return text;
@@ -1745,11 +1746,11 @@ QString QTextFragment::text() const
         return QString();
 
     QString result;
-    QString buffer = p->buffer();
+    const QTextDocumentBuffer &buffer = p->buffer();
     int f = n;
     while (f != ne) {
         const QTextFragmentData * const frag = p->fragmentMap().fragment(f);
-        result += QString(buffer.constData() + frag->stringPosition, frag->size_array[0]);
+        result += buffer.mid(frag->stringPosition, frag->size_array[0]);
         f = p->fragmentMap().next(f);
     }
     return result;
@@ -7,8 +7,15 @@
 #include <QtGui/private/qfontengine_ft_p.h>
 
 #include <QtCore/QList>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
 
 #include <qpa/qplatformnativeinterface.h>
 #include <qpa/qplatformscreen.h>
@@ -21,6 +28,8 @@
 
 #include <QtCore/private/qduplicatetracker_p.h>
 
+#include <sys/stat.h>
+
 #include <fontconfig/fontconfig.h>
 #if FC_VERSION >= 20402
 #include <fontconfig/fcfreetype.h>
@@ -367,10 +376,101 @@ static inline bool requiresOpenType(int writingSystem)
             || writingSystem == QFontDatabase::Khmer || writingSystem == QFontDatabase::Nko);
 }
 
+static_assert(QFontDatabase::WritingSystemsCount <= 64);
+
+static quint64 writingSystemsToBits(const QSupportedWritingSystems &writingSystems)
+{
+    quint64 bits = 0;
+    for (int i = 0; i < QFontDatabase::WritingSystemsCount; ++i) {
+        if (writingSystems.supported(QFontDatabase::WritingSystem(i)))
+            bits |= Q_UINT64_C(1) << i;
+    }
+    return bits;
+}
+
+static QSupportedWritingSystems writingSystemsFromBits(quint64 bits)
+{
+    QSupportedWritingSystems writingSystems;
+    for (int i = 0; i < QFontDatabase::WritingSystemsCount; ++i) {
+        if (bits & (Q_UINT64_C(1) << i))
+            writingSystems.setSupported(QFontDatabase::WritingSystem(i));
+    }
+    return writingSystems;
+}
+
+namespace {
+
+// The arguments of one registerFont() call for a system font.
+struct CachedFont
+{
+    QString styleName;
+    QString foundryName;
+    QString fileName;
+    qint32 indexValue;
+    qint32 weight;
+    qint32 style;
+    qint32 stretch;
+    qint32 pixelSize;
+    quint64 writingSystems;
+    bool antialiased;
+    bool scalable;
+    bool fixedPitch;
+};
+
+QDataStream &operator<<(QDataStream &stream, const CachedFont &font)
+{
+    return stream << font.styleName << font.foundryName << font.fileName << font.indexValue
+                  << font.weight << font.style << font.stretch << font.pixelSize
+                  << font.writingSystems << font.antialiased << font.scalable << font.fixedPitch;
+}
+
+QDataStream &operator>>(QDataStream &stream, CachedFont &font)
+{
+    return stream >> font.styleName >> font.foundryName >> font.fileName >> font.indexValue
+                  >> font.weight >> font.style >> font.stretch >> font.pixelSize
+                  >> font.writingSystems >> font.antialiased >> font.scalable >> font.fixedPitch;
+}
+
+// Records what populateFromPattern() registers for the system fonts, so that
+// it can be written to the scan cache.
+struct FontconfigScan
+{
+    struct Family
+    {
+        QString name;
+        QList<CachedFont> fonts;
+    };
+
+    void addFont(const QString &familyName, const QString &styleName, const QString &foundryName,
+                 QFont::Weight weight, QFont::Style style, QFont::Stretch stretch,
+                 bool antialiased, bool scalable, int pixelSize, bool fixedPitch,
+                 const QSupportedWritingSystems &writingSystems, const FontFile &fontFile)
+    {
+        // Family names are matched case insensitively by QFontDatabase
+        const QString key = familyName.toCaseFolded();
+        auto it = familyIndex.constFind(key);
+        if (it == familyIndex.cend()) {
+            it = familyIndex.insert(key, families.size());
+            families.append(Family{ familyName, {} });
+        }
+        families[*it].fonts.append(CachedFont{ styleName, foundryName, fontFile.fileName,
+                                               fontFile.indexValue, weight, style, stretch,
+                                               pixelSize, writingSystemsToBits(writingSystems),
+                                               antialiased, scalable, fixedPitch });
+    }
+
+    QList<Family> families;
+    QHash<QString, qsizetype> familyIndex;
+    QList<std::pair<QString, QString>> aliases;
+};
+
+} // namespace
+
 static void populateFromPattern(FcPattern *pattern,
                                 QFontDatabasePrivate::ApplicationFont *applicationFont = nullptr,
                                 FT_Face face = nullptr,
-                                QFontconfigDatabase *db = nullptr)
+                                QFontconfigDatabase *db = nullptr,
+                                FontconfigScan *scan = nullptr)
 {
     QString familyName;
     QString familyNameLang;
@@ -493,6 +593,11 @@ static void populateFromPattern(FcPattern *pattern,
     }
 
     QPlatformFontDatabase::registerFont(familyName,styleName,QLatin1StringView((const char *)foundry_value),weight,style,stretch,antialias,scalable,pixel_size,fixedPitch,writingSystems,fontFile);
+    if (scan) {
+        scan->addFont(familyName, styleName, QLatin1StringView((const char *)foundry_value), weight,
+                      style, stretch, antialias, scalable, pixel_size, fixedPitch, writingSystems,
+                      *fontFile);
+    }
     if (applicationFont != nullptr && face != nullptr && db != nullptr) {
         db->addNamedInstancesForFace(face,
                                      indexValue,
@@ -539,8 +644,15 @@ static void populateFromPattern(FcPattern *pattern,
             }
             FontFile *altFontFile = new FontFile(*fontFile);
             QPlatformFontDatabase::registerFont(altFamilyName, altStyleName, QLatin1StringView((const char *)foundry_value),weight,style,stretch,antialias,scalable,pixel_size,fixedPitch,writingSystems,altFontFile);
+            if (scan) {
+                scan->addFont(altFamilyName, altStyleName, QLatin1StringView((const char *)foundry_value),
+                              weight, style, stretch, antialias, scalable, pixel_size, fixedPitch,
+                              writingSystems, *altFontFile);
+            }
         } else {
             QPlatformFontDatabase::registerAliasToFontFamily(familyName, altFamilyName);
+            if (scan)
+                scan->aliases.append({ familyName, altFamilyName });
         }
     }
 
@@ -551,14 +663,223 @@ static bool isDprScaling()
     return !qFuzzyCompare(qApp->devicePixelRatio(), qreal(1.0));
 }
 
+/*!
+    \internal
+
+    A snapshot of the system fonts found by the last full scan, stored in the
+    user's cache directory. Listing and registering every installed font is
+    what makes populateFontDatabase() slow on systems with large font
+    collections, so when the snapshot is still valid, only the family names
+    and aliases are registered from it, and each family is populated from its
+    records when QFontDatabase first needs it.
+
+    The snapshot is valid as long as fontconfig, Qt, the fontconfig
+    configuration files and the font directories are unchanged, which is what
+    fontconfig itself checks to decide whether its own caches are stale.
+    Setting QT_FONTCONFIG_CACHE=0 disables it.
+*/
+class QFontconfigScanCache
+{
+public:
+    static bool isEnabled();
+    static QByteArray validationKey();
+
+    bool load(const QByteArray &key);
+    bool populateFamily(const QString &familyName) const;
+    static void save(const FontconfigScan &scan, const QByteArray &key);
+
+private:
+    static QString fileName();
+
+    enum : quint32 {
+        Magic = 0x51464343, // 'QFCC'
+        Version = 1
+    };
+
+    QFile m_file;
+    QByteArray m_data;
+    // case folded family name -> offset and size of its records in m_data
+    QHash<QString, std::pair<qsizetype, qsizetype>> m_families;
+};
+
+bool QFontconfigScanCache::isEnabled()
+{
+    bool ok = false;
+    const int enabled = qEnvironmentVariableIntValue("QT_FONTCONFIG_CACHE", &ok);
+    return (!ok || enabled != 0) && !fileName().isEmpty();
+}
+
+QString QFontconfigScanCache::fileName()
+{
+    const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (cacheLocation.isEmpty())
+        return QString();
+    return cacheLocation + QLatin1StringView("/qtfontconfig/fonts-" QT_VERSION_STR ".cache");
+}
+
+QByteArray QFontconfigScanCache::validationKey()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const quint32 versions[] = { quint32(FcGetVersion()), quint32(QT_VERSION), Version };
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(versions), sizeof versions));
+
+    const auto addPaths = [&hash](FcStrList *list) {
+        if (!list)
+            return;
+        while (const FcChar8 *entry = FcStrListNext(list)) {
+            const char *path = reinterpret_cast<const char *>(entry);
+            hash.addData(QByteArrayView(path, qstrlen(path) + 1));
+            struct stat st;
+            if (::stat(path, &st) == 0) {
+                const qint64 times[] = { qint64(st.st_mtim.tv_sec), qint64(st.st_mtim.tv_nsec) };
+                hash.addData(QByteArrayView(reinterpret_cast<const char *>(times), sizeof times));
+            }
+        }
+        FcStrListDone(list);
+    };
+    addPaths(FcConfigGetConfigFiles(nullptr));
+    addPaths(FcConfigGetFontDirs(nullptr));
+
+    return hash.result();
+}
+
+bool QFontconfigScanCache::load(const QByteArray &key)
+{
+    m_file.setFileName(fileName());
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+    const uchar *data = m_file.map(0, m_file.size());
+    if (!data)
+        return false;
+    m_data = QByteArray::fromRawData(reinterpret_cast<const char *>(data), m_file.size());
+
+    QDataStream stream(m_data);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray fileKey;
+    stream >> magic >> version;
+    if (magic != Magic || version != Version)
+        return false;
+    stream >> fileKey;
+    if (fileKey != key)
+        return false;
+
+    struct FamilyEntry
+    {
+        QString name;
+        quint32 offset;
+        quint32 size;
+    };
+    quint32 familyCount = 0;
+    stream >> familyCount;
+    QList<FamilyEntry> families;
+    for (quint32 i = 0; i < familyCount && stream.status() == QDataStream::Ok; ++i) {
+        FamilyEntry entry;
+        stream >> entry.name >> entry.offset >> entry.size;
+        families.append(entry);
+    }
+    quint32 aliasCount = 0;
+    stream >> aliasCount;
+    QList<std::pair<QString, QString>> aliases;
+    for (quint32 i = 0; i < aliasCount && stream.status() == QDataStream::Ok; ++i) {
+        std::pair<QString, QString> alias;
+        stream >> alias.first >> alias.second;
+        aliases.append(alias);
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    const qsizetype recordsStart = stream.device()->pos();
+    const qsizetype recordsSize = m_data.size() - recordsStart;
+    m_families.reserve(families.size());
+    for (const FamilyEntry &entry : std::as_const(families)) {
+        if (qsizetype(entry.offset) + qsizetype(entry.size) > recordsSize)
+            return false;
+        m_families.insert(entry.name.toCaseFolded(),
+                          { recordsStart + entry.offset, qsizetype(entry.size) });
+    }
+
+    qCDebug(lcFontDb) << "Using fontconfig scan cache" << m_file.fileName() << "with"
+                      << families.size() << "families";
+    for (const FamilyEntry &entry : std::as_const(families))
+        QPlatformFontDatabase::registerFontFamily(entry.name);
+    for (const auto &alias : std::as_const(aliases))
+        QPlatformFontDatabase::registerAliasToFontFamily(alias.first, alias.second);
+    return true;
+}
+
+bool QFontconfigScanCache::populateFamily(const QString &familyName) const
+{
+    const auto it = m_families.constFind(familyName.toCaseFolded());
+    if (it == m_families.cend())
+        return false;
+
+    const QByteArray records = QByteArray::fromRawData(m_data.constData() + it->first, it->second);
+    QDataStream stream(records);
+    stream.setVersion(QDataStream::Qt_6_0);
+    QList<CachedFont> fonts;
+    stream >> fonts;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    for (const CachedFont &font : std::as_const(fonts)) {
+        FontFile *fontFile = new FontFile;
+        fontFile->fileName = font.fileName;
+        fontFile->indexValue = font.indexValue;
+        QPlatformFontDatabase::registerFont(familyName, font.styleName, font.foundryName,
+                                            QFont::Weight(font.weight), QFont::Style(font.style),
+                                            QFont::Stretch(font.stretch), font.antialiased,
+                                            font.scalable, font.pixelSize, font.fixedPitch,
+                                            writingSystemsFromBits(font.writingSystems), fontFile);
+    }
+    return true;
+}
+
+void QFontconfigScanCache::save(const FontconfigScan &scan, const QByteArray &key)
+{
+    QByteArray records;
+    QList<std::pair<quint32, quint32>> ranges;
+    ranges.reserve(scan.families.size());
+    {
+        QDataStream stream(&records, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        for (const FontconfigScan::Family &family : scan.families) {
+            const qsizetype offset = records.size();
+            stream << family.fonts;
+            ranges.append({ quint32(offset), quint32(records.size() - offset) });
+        }
+    }
+
+    const QString path = fileName();
+    if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+        return;
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << quint32(Magic) << quint32(Version) << key;
+    stream << quint32(scan.families.size());
+    for (qsizetype i = 0; i < scan.families.size(); ++i)
+        stream << scan.families.at(i).name << ranges.at(i).first << ranges.at(i).second;
+    stream << quint32(scan.aliases.size());
+    for (const auto &alias : scan.aliases)
+        stream << alias.first << alias.second;
+    stream.writeRawData(records.constData(), records.size());
+    if (!file.commit())
+        qCDebug(lcFontDb) << "Could not write fontconfig scan cache" << path;
+}
+
+QFontconfigDatabase::QFontconfigDatabase() = default;
+
 QFontconfigDatabase::~QFontconfigDatabase()
 {
     FcConfigDestroy(FcConfigGetCurrent());
 }
 
-void QFontconfigDatabase::populateFontDatabase()
+static bool scanSystemFonts(FontconfigScan *scan)
 {
-    FcInit();
     FcFontSet  *fonts;
 
     {
@@ -589,13 +910,36 @@ void QFontconfigDatabase::populateFontDatabase()
         FcObjectSetDestroy(os);
         FcPatternDestroy(pattern);
         if (!fonts)
-            return;
+            return false;
     }
 
     for (int i = 0; i < fonts->nfont; i++)
-        populateFromPattern(fonts->fonts[i]);
+        populateFromPattern(fonts->fonts[i], nullptr, nullptr, nullptr, scan);
 
     FcFontSetDestroy (fonts);
+    return true;
+}
+
+void QFontconfigDatabase::populateFontDatabase()
+{
+    FcInit();
+
+    m_scanCache.reset();
+    const bool useScanCache = QFontconfigScanCache::isEnabled();
+    const QByteArray scanCacheKey = useScanCache ? QFontconfigScanCache::validationKey() : QByteArray();
+    if (useScanCache) {
+        auto scanCache = std::make_unique<QFontconfigScanCache>();
+        if (scanCache->load(scanCacheKey))
+            m_scanCache = std::move(scanCache);
+    }
+
+    if (!m_scanCache) {
+        FontconfigScan scan;
+        if (!scanSystemFonts(useScanCache ? &scan : nullptr))
+            return;
+        if (useScanCache)
+            QFontconfigScanCache::save(scan, scanCacheKey);
+    }
 
     struct FcDefaultFont {
         const char *qtname;
@@ -630,6 +974,12 @@ void QFontconfigDatabase::populateFontDatabase()
 //    QApplication::setFont(font);
 }
 
+void QFontconfigDatabase::populateFamily(const QString &familyName)
+{
+    if (!m_scanCache || !m_scanCache->populateFamily(familyName))
+        QFreeTypeFontDatabase::populateFamily(familyName);
+}
+
 void QFontconfigDatabase::invalidate()
 {
     // Clear app fonts.
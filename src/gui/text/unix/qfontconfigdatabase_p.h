@@ -18,15 +18,20 @@
 #include <qpa/qplatformfontdatabase.h>
 #include <QtGui/private/qfreetypefontdatabase_p.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 class QFontEngineFT;
+class QFontconfigScanCache;
 
 class Q_GUI_EXPORT QFontconfigDatabase : public QFreeTypeFontDatabase
 {
 public:
+    QFontconfigDatabase();
     ~QFontconfigDatabase() override;
     void populateFontDatabase() override;
+    void populateFamily(const QString &familyName) override;
     void invalidate() override;
     bool supportsVariableApplicationFonts() const override;
     QFontEngineMulti *fontEngineMulti(QFontEngine *fontEngine, QChar::Script script) override;
@@ -39,6 +44,8 @@ public:
 
 private:
     void setupFontEngine(QFontEngineFT *engine, const QFontDef &fontDef) const;
+
+    std::unique_ptr<QFontconfigScanCache> m_scanCache;
 };
 
 QT_END_NAMESPACE
@@ -39,6 +39,9 @@ public:
 private:
     void fillRect(QImage *image, int x, int y, int w, int h, QRgb col);
     inline QRgb color(uchar index) const;
+    void updatePalette();
+    inline void writePixels(const short *indices, int count, unsigned char *bits,
+                            qsizetype bpl, int imageWidth, int imageHeight);
     static bool withinSizeLimit(int width, int height)
     {
         return quint64(width) * height < 16384 * 16384; // Reject unreasonable header values
@@ -96,8 +99,9 @@ private:
     int code_size, clear_code, end_code, max_code_size, max_code;
     int firstcode, oldcode, incode;
     short* table[2];
+    short* lengths;
     short* stack;
-    short *sp;
+    QRgb palette[256];
     bool needfirst;
     int x, y;
     int frame;
@@ -127,6 +131,7 @@ QGIFFormat::QGIFFormat()
     partialNewFrame = false;
     table[0] = nullptr;
     table[1] = nullptr;
+    lengths = nullptr;
     stack = nullptr;
 }
 
@@ -205,9 +210,10 @@ int QGIFFormat::decode(QImage *image, const uchar *buffer, int length,
     //    CompuServe Incorporated."
 
     if (!stack) {
-        stack = new short[(1 << max_lzw_bits) * 4];
+        stack = new short[(1 << max_lzw_bits) * 5]();
         table[0] = &stack[(1 << max_lzw_bits) * 2];
         table[1] = &stack[(1 << max_lzw_bits) * 3];
+        lengths = &stack[(1 << max_lzw_bits) * 4];
     }
 
     image->detach();
@@ -417,7 +423,6 @@ int QGIFFormat::decode(QImage *image, const uchar *buffer, int length,
                 y = top;
                 accum = 0;
                 bitcount = 0;
-                sp = stack;
                 firstcode = oldcode = 0;
                 needfirst = true;
                 out_of_bounds = left>=swidth || y>=sheight;
@@ -437,7 +442,9 @@ int QGIFFormat::decode(QImage *image, const uchar *buffer, int length,
                 for (i=0; i<clear_code; i++) {
                     table[0][i]=0;
                     table[1][i]=i;
+                    lengths[i]=1;
                 }
+                updatePalette();
                 state=ImageDataBlockSize;
             }
             count=0;
@@ -452,76 +459,85 @@ int QGIFFormat::decode(QImage *image, const uchar *buffer, int length,
                 newFrame = true;
             }
             break;
-          case ImageDataBlock:
-            count++;
-            if (bitcount != -32768) {
-                if (bitcount < 0 || bitcount > 31) {
-                    state = Error;
-                    return -1;
-                }
-                accum |= (ch << bitcount);
-                bitcount += 8;
-            }
-            while (bitcount>=code_size && state==ImageDataBlock) {
-                int code=accum&((1<<code_size)-1);
-                bitcount-=code_size;
-                accum>>=code_size;
-
-                if (code==clear_code) {
-                    if (!needfirst) {
-                        code_size=lzwsize+1;
-                        max_code_size=2*clear_code;
-                        max_code=clear_code+2;
+          case ImageDataBlock: {
+            const int h = image->height();
+            const int w = image->width();
+            // consume the whole data sub-block in one go, instead of going
+            // through the state machine for every byte
+            for (;;) {
+                count++;
+                if (bitcount != -32768) {
+                    if (bitcount < 0 || bitcount > 31) {
+                        state = Error;
+                        return -1;
                     }
-                    needfirst=true;
-                } else if (code==end_code) {
-                    bitcount = -32768;
-                    // Left the block end arrive
-                } else {
-                    if (needfirst) {
+                    accum |= (ch << bitcount);
+                    bitcount += 8;
+                }
+                while (bitcount>=code_size) {
+                    int code=accum&((1<<code_size)-1);
+                    bitcount-=code_size;
+                    accum>>=code_size;
+
+                    if (code==clear_code) {
+                        if (!needfirst) {
+                            code_size=lzwsize+1;
+                            max_code_size=2*clear_code;
+                            max_code=clear_code+2;
+                        }
+                        needfirst=true;
+                    } else if (code==end_code) {
+                        bitcount = -32768;
+                        // Left the block end arrive
+                    } else if (needfirst) {
                         firstcode=oldcode=code;
-                        if (!out_of_bounds && image->height() > y && ((frame == 0) || (firstcode != trans_index)))
-                            ((QRgb*)FAST_SCAN_LINE(bits, bpl, y))[x] = color(firstcode);
-                        x++;
-                        if (x>=swidth) out_of_bounds = true;
+                        stack[0] = firstcode;
+                        writePixels(stack, 1, bits, bpl, w, h);
                         needfirst=false;
-                        if (x>=left+width) {
-                            x=left;
-                            out_of_bounds = left>=swidth || y>=sheight;
-                            nextY(bits, bpl);
-                        }
                     } else {
                         incode=code;
-                        if (code>=max_code) {
-                            *sp++=firstcode;
-                            code=oldcode;
+                        // A code that is not in the table yet can only be
+                        // the previous string followed by its first index.
+                        const bool previousPlusFirst = code >= max_code;
+                        if (previousPlusFirst)
+                            code = oldcode;
+                        if (code >= max_code) {
+                            state = Error;
+                            return -1;
+                        }
+                        // The table knows the length of every string, so
+                        // it is written front to back without reversing.
+                        const int stringLength = lengths[code] + (previousPlusFirst ? 1 : 0);
+                        if (stringLength > (1 << max_lzw_bits) * 2) {
+                            state = Error;
+                            return -1;
                         }
+                        if (previousPlusFirst)
+                            stack[stringLength - 1] = firstcode;
+                        int pos = lengths[code];
                         while (code>=clear_code+2) {
-                            if (code >= max_code) {
+                            if (pos <= 1) {
                                 state = Error;
                                 return -1;
                             }
-                            *sp++=table[1][code];
-                            if (code==table[0][code]) {
-                                state=Error;
-                                return -1;
-                            }
-                            if (sp-stack>=(1<<(max_lzw_bits))*2) {
-                                state=Error;
+                            stack[--pos] = table[1][code];
+                            code = table[0][code];
+                            if (code >= max_code) {
+                                state = Error;
                                 return -1;
                             }
-                            code=table[0][code];
                         }
-                        if (code < 0) {
+                        if (pos != 1) {
                             state = Error;
                             return -1;
                         }
+                        stack[0]=firstcode=table[1][code];
 
-                        *sp++=firstcode=table[1][code];
                         code=max_code;
                         if (code<(1<<max_lzw_bits)) {
                             table[0][code]=oldcode;
                             table[1][code]=firstcode;
+                            lengths[code]=lengths[oldcode]+1;
                             max_code++;
                             if ((max_code>=max_code_size)
                              && (max_code_size<(1<<max_lzw_bits)))
@@ -531,27 +547,13 @@ int QGIFFormat::decode(QImage *image, const uchar *buffer, int length,
                             }
                         }
                         oldcode=incode;
-                        const int h = image->height();
-                        QRgb *line = nullptr;
-                        if (!out_of_bounds && h > y)
-                            line = (QRgb*)FAST_SCAN_LINE(bits, bpl, y);
-                        while (sp>stack) {
-                            const uchar index = *(--sp);
-                            if (!out_of_bounds && h > y && ((frame == 0) || (index != trans_index))) {
-                                line[x] = color(index);
-                            }
-                            x++;
-                            if (x>=swidth) out_of_bounds = true;
-                            if (x>=left+width) {
-                                x=left;
-                                out_of_bounds = left>=swidth || y>=sheight;
-                                nextY(bits, bpl);
-                                if (!out_of_bounds && h > y)
-                                    line = (QRgb*)FAST_SCAN_LINE(bits, bpl, y);
-                            }
-                        }
+                        writePixels(stack, stringLength, bits, bpl, w, h);
                     }
                 }
+                if (count == expectcount || !length)
+                    break;
+                length--;
+                ch = *buffer++;
             }
             partialNewFrame = true;
             if (count==expectcount) {
@@ -559,6 +561,7 @@ int QGIFFormat::decode(QImage *image, const uchar *buffer, int length,
                 state=ImageDataBlockSize;
             }
             break;
+          }
           case ExtensionLabel:
             switch (ch) {
             case 0xf9:
@@ -1030,6 +1033,49 @@ inline QRgb QGIFFormat::color(uchar index) const
     return index == trans_index ? col & Q_TRANSPARENT : col;
 }
 
+/*
+   Resolves all 256 indices for the frame whose image data follows, so
+   that writing a pixel is a plain table lookup.
+*/
+void QGIFFormat::updatePalette()
+{
+    for (int i = 0; i < 256; ++i)
+        palette[i] = color(uchar(i));
+}
+
+/*
+   Writes the \a count pixels of the color indices \a indices at the
+   current position, wrapping to the next line of the frame as needed.
+   Pixels of the transparent index leave the previous frame visible.
+*/
+inline void QGIFFormat::writePixels(const short *indices, int count, unsigned char *bits,
+                                    qsizetype bpl, int imageWidth, int imageHeight)
+{
+    const int skipIndex = frame == 0 ? -1 : trans_index;
+    while (count > 0) {
+        const int run = qMin(count, qMax(1, left + width - x));
+        if (!out_of_bounds && y < imageHeight) {
+            const int visible = qMin(run, qMin(swidth, imageWidth) - x);
+            QRgb *line = reinterpret_cast<QRgb *>(FAST_SCAN_LINE(bits, bpl, y)) + x;
+            for (int i = 0; i < visible; ++i) {
+                const uchar index = uchar(indices[i]);
+                if (index != skipIndex)
+                    line[i] = palette[index];
+            }
+        }
+        x += run;
+        indices += run;
+        count -= run;
+        if (x >= swidth)
+            out_of_bounds = true;
+        if (x >= left + width) {
+            x = left;
+            out_of_bounds = left >= swidth || y >= sheight;
+            nextY(bits, bpl);
+        }
+    }
+}
+
 //-------------------------------------------------------------------------
 //-------------------------------------------------------------------------
 //-------------------------------------------------------------------------
@@ -15,6 +15,7 @@
 #include <private/qicc_p.h>
 #include <private/qsimd_p.h>
 #include <private/qimage_p.h>   // for qt_getImageText
+#include <private/qimageiohandler_p.h>
 
 #include <stdio.h>      // jpeglib needs this to be pre-included
 #include <setjmp.h>
@@ -216,7 +217,8 @@ static bool read_jpeg_image(QImage *outImage,
                             QSize scaledSize, QRect scaledClipRect,
                             QRect clipRect, int quality,
                             Rgb888ToRgb32Converter converter,
-                            j_decompress_ptr info, struct my_error_mgr* err, bool invertCMYK)
+                            j_decompress_ptr info, struct my_error_mgr* err, bool invertCMYK,
+                            const QImageIOHandlerPrivate *handlerPrivate)
 {
     if (!setjmp(err->setjmp_buffer)) {
         // -1 means default quality.
@@ -327,6 +329,10 @@ static bool read_jpeg_image(QImage *outImage,
         if (!ensureValidImage(outImage, info, clip.size()))
             return false;
 
+        // The rows are only final when no scaling or clipping pass follows.
+        const bool streamRows = !(scaledSize.isValid() && scaledSize != clip.size())
+                && scaledClipRect.isEmpty();
+
         // Avoid memcpy() overhead if grayscale with no clipping.
         bool quickGray = (info->output_components == 1 &&
                           clip == imageRect);
@@ -343,6 +349,24 @@ static bool read_jpeg_image(QImage *outImage,
 
             (void) jpeg_start_decompress(info);
 
+            // Offset of the clip in the rows returned by libjpeg
+            int xoffset = clip.x();
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER) && LIBJPEG_TURBO_VERSION_NUMBER >= 2001000
+            // libjpeg-turbo can leave out the columns and rows outside
+            // the clip instead of decoding and dropping them. Earlier
+            // versions had bugs in skipping with merged upsampling.
+            if (clip.width() < int(info->output_width)) {
+                JDIMENSION cropX = clip.x();
+                JDIMENSION cropWidth = clip.width();
+                // cropX is rounded down to an iMCU boundary, and cropWidth
+                // widened to match
+                jpeg_crop_scanline(info, &cropX, &cropWidth);
+                xoffset = clip.x() - int(cropX);
+            }
+            if (clip.y() > 0)
+                (void) jpeg_skip_scanlines(info, clip.y());
+#endif
+
             while (info->output_scanline < info->output_height) {
                 int y = int(info->output_scanline) - clip.y();
                 if (y >= clip.height())
@@ -354,11 +378,11 @@ static bool read_jpeg_image(QImage *outImage,
                     continue;   // Haven't reached the starting line yet.
 
                 if (info->output_components == 3) {
-                    uchar *in = rows[0] + clip.x() * 3;
+                    uchar *in = rows[0] + xoffset * 3;
                     QRgb *out = (QRgb*)outImage->scanLine(y);
                     converter(out, in, clip.width());
                 } else if (info->out_color_space == JCS_CMYK) {
-                    uchar *in = rows[0] + clip.x() * 4;
+                    uchar *in = rows[0] + xoffset * 4;
                     quint32 *out = (quint32*)outImage->scanLine(y);
                     if (invertCMYK) {
                         for (int i = 0; i < clip.width(); ++i) {
@@ -371,15 +395,20 @@ static bool read_jpeg_image(QImage *outImage,
                 } else if (info->output_components == 1) {
                     // Grayscale.
                     memcpy(outImage->scanLine(y),
-                           rows[0] + clip.x(), clip.width());
+                           rows[0] + xoffset, clip.width());
                 }
+                if (streamRows && !handlerPrivate->reportScanLines(*outImage, y, 1))
+                    return false;
             }
         } else {
             // Load unclipped grayscale data directly into the QImage.
             (void) jpeg_start_decompress(info);
             while (info->output_scanline < info->output_height) {
-                uchar *row = outImage->scanLine(info->output_scanline);
+                const int y = info->output_scanline;
+                uchar *row = outImage->scanLine(y);
                 (void) jpeg_read_scanlines(info, &row, 1);
+                if (streamRows && !handlerPrivate->reportScanLines(*outImage, y, 1))
+                    return false;
             }
         }
 
@@ -400,6 +429,10 @@ static bool read_jpeg_image(QImage *outImage,
 
         if (!scaledClipRect.isEmpty())
             *outImage = outImage->copy(scaledClipRect);
+        if (!streamRows && !outImage->isNull()
+            && !handlerPrivate->reportScanLines(*outImage, 0, outImage->height())) {
+            return false;
+        }
         return !outImage->isNull();
     }
     else {
@@ -1027,7 +1060,8 @@ bool QJpegHandlerPrivate::read(QImage *image)
     if (state == ReadHeader)
     {
         const bool invertCMYK = subType != QJpegHandlerPrivate::SubType::CMYK;
-        bool success = read_jpeg_image(image, scaledSize, scaledClipRect, clipRect, quality, rgb888ToRgb32ConverterPtr, &info, &err, invertCMYK);
+        bool success = read_jpeg_image(image, scaledSize, scaledClipRect, clipRect, quality, rgb888ToRgb32ConverterPtr, &info, &err, invertCMYK,
+                                       QImageIOHandlerPrivate::get(q));
         if (success) {
             for (int i = 0; i < readTexts.size()-1; i+=2)
                 image->setText(readTexts.at(i), readTexts.at(i+1));
@@ -11,6 +11,7 @@
 #include <QtCore/private/qcore_mac_p.h>
 
 #include <QtGui/private/qguiapplication_p.h>
+#include <QtGui/private/qimagecache_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -51,6 +52,14 @@ static void qRegisterApplicationStateNotifications()
         QIOSApplicationState::handleApplicationStateChanged(UIApplicationStateActive,
             "Extension loaded, assuming state is active"_L1);
     } else {
+        // The system terminates the application if it does not free memory
+        // soon enough, so cached images are dropped without spilling them
+        [notificationCenter addObserverForName:UIApplicationDidReceiveMemoryWarningNotification
+            object:nil queue:mainQueue usingBlock:^void(NSNotification *) {
+                qCDebug(lcQpaApplication) << "Received memory warning, dropping cached images";
+                QImageCache::notifyMemoryPressure(QImageCache::MemoryPressure::Critical);
+        }];
+
         // Initialize correct startup state, which may not be the Qt default (inactive)
         UIApplicationState startupState = qt_apple_sharedApplication().applicationState;
         QIOSApplicationState::handleApplicationStateChanged(startupState, "Application loaded"_L1);
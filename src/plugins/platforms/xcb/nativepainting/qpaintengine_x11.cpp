@@ -2581,8 +2581,8 @@ bool QXRenderGlyphCache::addGlyphs(const QTextItemInt &ti,
             if (cachedGlyphs.contains(xglyphid)) {
                 continue;
             } else {
-                set->setGlyph(glyphs[i], spp, nullptr);
-                delete glyph;
+                // the glyph itself is owned by the glyph atlas of the set
+                set->removeGlyphFromCache(glyphs[i], spp);
                 glyph = 0;
             }
         }
@@ -160,6 +160,11 @@ int runRcc(int argc, char *argv[])
     QCommandLineOption noZstdOption(QStringLiteral("no-zstd"), QStringLiteral("Disable usage of zstd compression."));
     parser.addOption(noZstdOption);
 
+    QCommandLineOption zstdChunkSizeOption(QStringLiteral("zstd-chunk-size"),
+                                           QStringLiteral("Compress files larger than <size> bytes with zstd in chunks of that size, which can be decompressed independently."),
+                                           QStringLiteral("size"));
+    parser.addOption(zstdChunkSizeOption);
+
     QCommandLineOption thresholdOption(QStringLiteral("threshold"), QStringLiteral("Threshold to consider compressing files."), QStringLiteral("level"));
     parser.addOption(thresholdOption);
 
@@ -235,6 +240,15 @@ int runRcc(int argc, char *argv[])
         if (library.noZstd())
             errorMsg = "--compression-algo=zstd and --no-zstd both specified."_L1;
     }
+    if (parser.isSet(zstdChunkSizeOption)) {
+        bool ok;
+        const int size = parser.value(zstdChunkSizeOption).toInt(&ok);
+        if (!ok || size < 1024)
+            errorMsg = "Invalid zstd chunk size, must be at least 1024"_L1;
+        else if (library.noZstd() || formatVersion < 3)
+            errorMsg = "--zstd-chunk-size requires zstd compression"_L1;
+        library.setZstdChunkSize(size);
+    }
     if (parser.isSet(nocompressOption))
         library.setCompressionAlgorithm(RCCResourceLibrary::CompressionAlgorithm::None);
     if (parser.isSet(compressOption) && errorMsg.isEmpty()) {
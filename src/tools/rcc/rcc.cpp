@@ -9,6 +9,7 @@
 #include <qdebug.h>
 #include <qdir.h>
 #include <qdirlisting.h>
+#include <qendian.h>
 #include <qfile.h>
 #include <qiodevice.h>
 #include <qlocale.h>
@@ -51,6 +52,46 @@ void RCCResourceLibrary::writeByteArray(const QByteArray &other)
     }
 }
 
+#if QT_CONFIG(zstd)
+// Layout of chunked zstd content, which must match QResourcePrivate: a
+// skippable frame with the seek table (chunk size, chunk count and total
+// uncompressed size, followed by the compressed size of each chunk, all in
+// little endian), then one regular frame per chunk. Decompressing the whole
+// content at once just works, since zstd ignores skippable frames.
+enum {
+    ZstdSeekTableMagic = 0x184D2A5A,
+    ZstdSeekTableHeaderSize = 8 + 16
+};
+
+static size_t compressZstdChunked(ZSTD_CCtx *cctx, QByteArray &out, const QByteArray &data,
+                                  int chunkSize, int level)
+{
+    const qsizetype count = (data.size() + chunkSize - 1) / chunkSize;
+    const qsizetype framesStart = ZstdSeekTableHeaderSize + 4 * count;
+    out.resize(framesStart + count * ZSTD_COMPRESSBOUND(chunkSize));
+    uchar *p = reinterpret_cast<uchar *>(out.data());
+    qToLittleEndian<quint32>(ZstdSeekTableMagic, p);
+    qToLittleEndian<quint32>(quint32(framesStart - 8), p + 4);
+    qToLittleEndian<quint32>(quint32(chunkSize), p + 8);
+    qToLittleEndian<quint32>(quint32(count), p + 12);
+    qToLittleEndian<quint64>(quint64(data.size()), p + 16);
+
+    qsizetype pos = framesStart;
+    for (qsizetype i = 0; i < count; ++i) {
+        const qsizetype offset = i * chunkSize;
+        const size_t n = ZSTD_compressCCtx(cctx, p + pos, out.size() - pos,
+                                           data.constData() + offset,
+                                           qMin<qsizetype>(chunkSize, data.size() - offset),
+                                           level);
+        if (ZSTD_isError(n))
+            return n;
+        qToLittleEndian<quint32>(quint32(n), p + ZstdSeekTableHeaderSize + 4 * i);
+        pos += n;
+    }
+    return pos;
+}
+#endif
+
 static inline QString msgOpenReadFailed(const QString &fname, const QString &why)
 {
     return QString::fromLatin1("Unable to open %1 for reading: %2\n").arg(fname, why);
@@ -259,17 +300,20 @@ qint64 RCCFileInfo::writeDataBlob(RCCResourceLibrary &lib, qint64 offset,
                 compressLevel = CONSTANT_ZSTDCOMPRESSLEVEL_CHECK;
 
             QByteArray compressed(size, Qt::Uninitialized);
-            char *dst = const_cast<char *>(compressed.constData());
-            size_t n = ZSTD_compressCCtx(lib.m_zstdCCtx, dst, size,
-                                         data.constData(), data.size(),
-                                         compressLevel);
+            const bool chunked = lib.m_zstdChunkSize > 0 && data.size() > lib.m_zstdChunkSize;
+            auto compress = [&](int level) {
+                if (chunked)
+                    return compressZstdChunked(lib.m_zstdCCtx, compressed, data,
+                                               lib.m_zstdChunkSize, level);
+                return ZSTD_compressCCtx(lib.m_zstdCCtx, compressed.data(), size,
+                                         data.constData(), data.size(), level);
+            };
+            size_t n = compress(compressLevel);
             if (n * 100.0 < data.size() * 1.0 * (100 - m_compressThreshold) ) {
                 // compressing is worth it
                 if (m_compressLevel < 0) {
                     // heuristic compression, so recompress
-                    n = ZSTD_compressCCtx(lib.m_zstdCCtx, dst, size,
-                                          data.constData(), data.size(),
-                                          CONSTANT_ZSTDCOMPRESSLEVEL_STORE);
+                    n = compress(CONSTANT_ZSTDCOMPRESSLEVEL_STORE);
                 }
                 if (ZSTD_isError(n)) {
                     QString msg = QString::fromLatin1("%1: error: compression with zstd failed: %2\n")
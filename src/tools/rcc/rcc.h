@@ -87,6 +87,9 @@ public:
     void setNoZstd(bool v) { m_noZstd = v; }
     bool noZstd() const { return m_noZstd; }
 
+    void setZstdChunkSize(int size) { m_zstdChunkSize = size; }
+    int zstdChunkSize() const { return m_zstdChunkSize; }
+
 private:
     struct Strings {
         Strings();
@@ -152,6 +155,7 @@ private:
     QByteArray m_out;
     quint8 m_formatVersion;
     bool m_noZstd;
+    int m_zstdChunkSize = 0;
 };
 
 QT_END_NAMESPACE
@@ -1195,11 +1195,17 @@ void QLabelPrivate::movieUpdated(const QRect &rect)
         if (scaledcontents) {
             QRect cr = q->contentsRect();
             QRect pixmapRect(cr.topLeft(), movie->currentPixmap().size());
-            if (pixmapRect.isEmpty())
+            if (pixmapRect.isEmpty() || rect.isEmpty())
                 return;
-            r.setRect(cr.left(), cr.top(),
-                      (rect.width() * cr.width()) / pixmapRect.width(),
-                      (rect.height() * cr.height()) / pixmapRect.height());
+            // the frame may only have changed in part; cover all device
+            // pixels that the smooth scaling of that part touches
+            const int left = (rect.left() * cr.width()) / pixmapRect.width();
+            const int top = (rect.top() * cr.height()) / pixmapRect.height();
+            const int right = ((rect.right() + 1) * cr.width() + pixmapRect.width() - 1) / pixmapRect.width();
+            const int bottom = ((rect.bottom() + 1) * cr.height() + pixmapRect.height() - 1) / pixmapRect.height();
+            r.setCoords(cr.left() + left - 1, cr.top() + top - 1,
+                        cr.left() + right, cr.top() + bottom);
+            r &= cr;
         } else {
             r = q->style()->itemPixmapRect(q->contentsRect(), align, movie->currentPixmap());
             r.translate(rect.x(), rect.y());
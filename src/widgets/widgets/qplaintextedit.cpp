@@ -18,6 +18,7 @@
 #endif
 #include <qstyle.h>
 #include <qtimer.h>
+#include <qelapsedtimer.h>
 #include "private/qapplication_p.h"
 #include "private/qtextdocumentlayout_p.h"
 #include "private/qabstracttextdocumentlayout_p.h"
@@ -58,6 +59,8 @@ public:
         blockUpdate = blockDocumentSizeChanged = false;
         cursorWidth = 1;
         textLayoutFlags = 0;
+        lazyLayoutBlockNumber = -1;
+        lazyLayoutTimer = nullptr;
     }
 
     qreal width;
@@ -69,13 +72,21 @@ public:
     bool blockDocumentSizeChanged;
     int cursorWidth;
     int textLayoutFlags;
+    int lazyLayoutBlockNumber; // the first block not measured yet, or -1
+    QTimer *lazyLayoutTimer;
 
     void layoutBlock(const QTextBlock &block);
     qreal blockWidth(const QTextBlock &block);
 
     void relayout();
+    void startLazyLayout(int blockNumber);
+    void lazyLayoutStep();
 };
 
+// How long a single step of the lazy layout should take, so that the
+// event loop keeps running while a large document is measured
+static constexpr qint64 LazyLayoutStepDuration = 8 * 1000 * 1000; // ns
+
 
 
 /*! \class QPlainTextDocumentLayout
@@ -107,6 +118,10 @@ public:
  */
 QPlainTextDocumentLayout::QPlainTextDocumentLayout(QTextDocument *document)
     :QAbstractTextDocumentLayout(* new QPlainTextDocumentLayoutPrivate, document) {
+    Q_D(QPlainTextDocumentLayout);
+    d->lazyLayoutTimer = new QTimer(this);
+    d->lazyLayoutTimer->setInterval(0);
+    connect(d->lazyLayoutTimer, &QTimer::timeout, this, [d]() { d->lazyLayoutStep(); });
 }
 /*!
   Destructs a plain text document layout.
@@ -249,9 +264,59 @@ void QPlainTextDocumentLayoutPrivate::relayout()
         block.setLineCount(block.isVisible() ? 1 : 0);
         block = block.next();
     }
+    startLazyLayout(0);
     emit q->update();
 }
 
+// Blocks that are not laid out count as one line, and do not add to the
+// maximum width. They are measured in steps from the event loop, so that
+// the document size, and with it the scroll bars, settle while the view
+// only lays out the blocks it shows.
+void QPlainTextDocumentLayoutPrivate::startLazyLayout(int blockNumber)
+{
+    lazyLayoutBlockNumber = lazyLayoutBlockNumber < 0 ? blockNumber
+                                                      : qMin(lazyLayoutBlockNumber, blockNumber);
+    if (lazyLayoutTimer && !lazyLayoutTimer->isActive())
+        lazyLayoutTimer->start();
+}
+
+void QPlainTextDocumentLayoutPrivate::lazyLayoutStep()
+{
+    Q_Q(QPlainTextDocumentLayout);
+    QTextDocument *doc = q->document();
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool documentSizeChangedBlocked = blockDocumentSizeChanged;
+    blockDocumentSizeChanged = true;
+    const QSizeF oldSize = q->documentSize();
+    const int firstBlockNumber = lazyLayoutBlockNumber;
+    QTextBlock block = doc->findBlockByNumber(lazyLayoutBlockNumber);
+    while (block.isValid() && timer.nsecsElapsed() < LazyLayoutStepDuration) {
+        QTextLayout *tl = block.layout();
+        if (block.isVisible() && !tl->lineCount()) {
+            q->layoutBlock(block);
+            // keep the line count, but not the lines; the view lays the
+            // block out again when it shows it
+            tl->clearLayout();
+        }
+        block = block.next();
+    }
+    blockDocumentSizeChanged = documentSizeChangedBlocked;
+
+    if (lazyLayoutBlockNumber < firstBlockNumber) {
+        // a block laid out in this step restarted the pass further up
+    } else if (block.isValid()) {
+        lazyLayoutBlockNumber = block.blockNumber();
+    } else {
+        lazyLayoutBlockNumber = -1;
+        lazyLayoutTimer->stop();
+    }
+    const QSizeF newSize = q->documentSize();
+    if (newSize != oldSize && !blockDocumentSizeChanged)
+        emit q->documentSizeChanged(newSize);
+}
+
 
 /*! \reimp
  */
@@ -279,6 +344,7 @@ void QPlainTextDocumentLayout::documentChanged(int from, int charsRemoved, int c
             }
         }
     } else {
+        d->startLazyLayout(changeStartBlock.blockNumber());
         QTextBlock block = changeStartBlock;
         do {
             block.clearLayout();
@@ -380,18 +446,25 @@ void QPlainTextDocumentLayout::layoutBlock(const QTextBlock &block)
         QTextBlock b = doc->firstBlock();
         d->maximumWidth = 0;
         QTextBlock maximumBlock;
+        QTextBlock unmeasuredBlock;
         while (b.isValid()) {
             qreal blockMaximumWidth = blockWidth(b);
             if (blockMaximumWidth > d->maximumWidth) {
                 d->maximumWidth = blockMaximumWidth;
                 maximumBlock = b;
             }
+            if (!unmeasuredBlock.isValid() && b.isVisible() && !b.layout()->lineCount())
+                unmeasuredBlock = b;
             b = b.next();
         }
         if (maximumBlock.isValid()) {
             d->maximumWidthBlockNumber = maximumBlock.blockNumber();
             emitDocumentSizeChanged = true;
         }
+        // the lazy layout keeps no lines, so the blocks it measured have
+        // to be measured again to find the new longest line
+        if (unmeasuredBlock.isValid())
+            d->startLazyLayout(unmeasuredBlock.blockNumber());
     }
     if (emitDocumentSizeChanged && !d->blockDocumentSizeChanged)
         emit documentSizeChanged(documentSize());
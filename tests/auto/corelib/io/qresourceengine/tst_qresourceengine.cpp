@@ -109,6 +109,9 @@ void tst_QResourceEngine::compressedResource_data()
             << QFINDTESTDATA("zlib.rcc") << int(QResource::ZlibCompression) << true;
     QTest::newRow("zstd")
             << QFINDTESTDATA("zstd.rcc") << int(QResource::ZstdCompression) << QT_CONFIG(zstd);
+    QTest::newRow("zstd-chunked")
+            << QFINDTESTDATA("zstd-chunked.rcc") << int(QResource::ZstdCompression)
+            << QT_CONFIG(zstd);
 }
 
 // Note: generateResource.sh parses this line. Make sure it's a simple number.
@@ -159,10 +162,43 @@ void tst_QResourceEngine::compressedResource()
     QCOMPARE(data.size(), expectedData.size());
     QCOMPARE(data, expectedData);
 
+    if (compressionAlgo != QResource::NoCompression) {
+        // decompressed only once
+        QVERIFY(resource.uncompressedData().isSharedWith(data));
+        QVERIFY(QResource("zero.txt").uncompressedData().isSharedWith(data));
+
+        // ... and kept when unrelated resources go away
+        const QString other = QFINDTESTDATA("uncompressed.rcc");
+        QVERIFY(QResource::registerResource(other, "/other"));
+        QVERIFY(QResource::unregisterResource(other, "/other"));
+        QVERIFY(QResource("zero.txt").uncompressedData().isSharedWith(data));
+    }
+
     // decompression through the engine
     data = f.readAll();
     QCOMPARE(data.size(), expectedData.size());
     QCOMPARE(data, expectedData);
+
+    // reading ranges, across chunk boundaries if compressed in chunks
+    QVERIFY(f.seek(ZERO_FILE_LEN / 2 - 100));
+    QCOMPARE(f.read(200), expectedData.first(200));
+    QVERIFY(f.seek(ZERO_FILE_LEN - 10));
+    QCOMPARE(f.read(200), expectedData.first(10));
+    QVERIFY(f.atEnd());
+
+    const uchar *mapped = f.map(0, ZERO_FILE_LEN);
+    QVERIFY(mapped);
+    QCOMPARE(memcmp(mapped, expectedData.constData(), ZERO_FILE_LEN), 0);
+
+    // writing to a private mapping doesn't change what others read
+    uchar *writable = f.map(0, ZERO_FILE_LEN, QFile::MapPrivateOption);
+    QVERIFY(writable);
+    writable[0] = 'x';
+    QCOMPARE(mapped[0], uchar(0));
+    QCOMPARE(resource.uncompressedData(), expectedData);
+    QFile other(":/zero.txt");
+    QVERIFY(other.open(QIODevice::ReadOnly));
+    QCOMPARE(other.readAll(), expectedData);
 }
 
 
@@ -207,6 +243,7 @@ void tst_QResourceEngine::checkStructure_data()
 #if defined(BUILTIN_TESTDATA)
                                            << "uncompressed.rcc"
                                            << "zlib.rcc"
+                                           << "zstd-chunked.rcc"
                                            << "zstd.rcc"
 #endif
                                            )
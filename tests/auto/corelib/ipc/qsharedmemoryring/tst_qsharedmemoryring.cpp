@@ -0,0 +1,363 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QTest>
+#include <QtTest/QSignalSpy>
+#include <QtCore/QThread>
+
+#include <private/qsharedmemoryring_p.h>
+
+using namespace Qt::StringLiterals;
+using namespace std::chrono_literals;
+
+class tst_QSharedMemoryRing : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void createAndAttach();
+    void attachToPlainSegment();
+    void readWrite();
+    void wrapAround();
+    void full();
+    void malformedRecords_data();
+    void malformedRecords();
+    void blockingRead();
+    void blockingWrite();
+    void multipleProducers();
+    void device();
+    void closeDevice();
+
+private:
+    QNativeIpcKey key()
+    {
+        return QSharedMemory::platformSafeKey(u"tstshmring_%1-%2"_s
+                                              .arg(QCoreApplication::applicationPid())
+                                              .arg(++seq));
+    }
+
+    int seq = 0;
+};
+
+void tst_QSharedMemoryRing::createAndAttach()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producer;
+    QVERIFY2(producer.create(k, 1000), qPrintable(producer.errorString()));
+    QVERIFY(producer.isAttached());
+    QCOMPARE(producer.capacity(), 1000);
+    QCOMPARE(producer.maximumMessageSize(), 1000 / 2 - 8);
+    QCOMPARE(producer.producerMode(), QSharedMemoryRing::SingleProducer);
+
+    QSharedMemoryRing consumer;
+    QVERIFY2(consumer.attach(k), qPrintable(consumer.errorString()));
+    QCOMPARE(consumer.capacity(), 1000);
+    QVERIFY(!consumer.hasMessages());
+
+    // capacity is rounded up and too small rings are refused
+    QSharedMemoryRing other;
+    QVERIFY(!other.create(key(), 16));
+    QVERIFY(other.create(key(), 1001));
+    QCOMPARE(other.capacity(), 1008);
+}
+
+void tst_QSharedMemoryRing::attachToPlainSegment()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemory plain(k);
+    QVERIFY(plain.create(4096));
+
+    QSharedMemoryRing ring;
+    QVERIFY(!ring.attach(k));
+    QVERIFY(!ring.isAttached());
+    QVERIFY(!ring.errorString().isEmpty());
+}
+
+void tst_QSharedMemoryRing::readWrite()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producer;
+    QVERIFY(producer.create(k, 4096));
+    QSharedMemoryRing consumer;
+    QVERIFY(consumer.attach(k));
+
+    QByteArray message;
+    QVERIFY(!consumer.tryRead(&message));
+
+    QVERIFY(producer.tryWrite("hello"));
+    QVERIFY(producer.tryWrite(""));
+    QVERIFY(producer.tryWrite("world!"));
+    QVERIFY(consumer.hasMessages());
+
+    QVERIFY(consumer.tryRead(&message));
+    QCOMPARE(message, "hello");
+    QVERIFY(consumer.tryRead(&message));
+    QCOMPARE(message, "");
+    QVERIFY(consumer.tryRead(&message));
+    QCOMPARE(message, "world!");
+    QVERIFY(!consumer.tryRead(&message));
+    QVERIFY(!consumer.hasMessages());
+
+    // too big
+    QVERIFY(!producer.tryWrite(QByteArray(producer.maximumMessageSize() + 1, 'x')));
+    QVERIFY(producer.tryWrite(QByteArray(producer.maximumMessageSize(), 'x')));
+}
+
+void tst_QSharedMemoryRing::wrapAround()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producer;
+    QVERIFY(producer.create(k, 256));
+    QSharedMemoryRing consumer;
+    QVERIFY(consumer.attach(k));
+
+    // message sizes chosen so records straddle the end of the ring at
+    // varying offsets
+    QByteArray message;
+    for (int i = 0; i < 1000; ++i) {
+        const QByteArray data(i % 97, char('a' + i % 26));
+        QVERIFY2(producer.tryWrite(data), QByteArray::number(i));
+        QVERIFY(consumer.tryRead(&message));
+        QCOMPARE(message, data);
+    }
+}
+
+void tst_QSharedMemoryRing::full()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producer;
+    QVERIFY(producer.create(k, 256));
+    QSharedMemoryRing consumer;
+    QVERIFY(consumer.attach(k));
+
+    // each record is 8 bytes of header plus 8 bytes of payload
+    int written = 0;
+    while (producer.tryWrite(QByteArray::number(written).rightJustified(8, '0')))
+        ++written;
+    QCOMPARE(written, 256 / 16);
+    QVERIFY(!producer.write("x", QDeadlineTimer(10ms)));
+
+    QByteArray message;
+    QVERIFY(consumer.tryRead(&message));
+    QCOMPARE(message, "00000000");
+    QVERIFY(producer.tryWrite("x"));
+}
+
+void tst_QSharedMemoryRing::malformedRecords_data()
+{
+    QTest::addColumn<quint32>("length");
+    QTest::addColumn<bool>("wrapped");
+
+    QTest::newRow("too-long") << quint32(256 / 2) << false;
+    QTest::newRow("huge") << quint32(0x7ffffff0) << false;
+    QTest::newRow("past-write-index") << quint32(40) << false;
+    QTest::newRow("after-padding-too-long") << quint32(256 / 2) << true;
+    QTest::newRow("padding-past-write-index") << quint32(0xffffffff) << false;
+}
+
+void tst_QSharedMemoryRing::malformedRecords()
+{
+    QFETCH(quint32, length);
+    QFETCH(bool, wrapped);
+
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producer;
+    QVERIFY(producer.create(k, 256));
+    QSharedMemoryRing consumer;
+    QVERIFY(consumer.attach(k));
+
+    QByteArray message;
+    if (wrapped) {
+        // leave 16 bytes at the end of the ring, so that the next record
+        // starts at the beginning, after a padding record
+        QVERIFY(producer.tryWrite(QByteArray(112, 'a')));
+        QVERIFY(producer.tryWrite(QByteArray(112, 'b')));
+        QVERIFY(consumer.tryRead(&message));
+        QVERIFY(consumer.tryRead(&message));
+    }
+    QVERIFY(producer.tryWrite("0123456789abcdef"));
+    QVERIFY(producer.tryWrite("next"));
+
+    // overwrite the length of the first record, as another process could
+    QSharedMemory plain(k);
+    QVERIFY(plain.attach());
+    char *ring = static_cast<char *>(plain.data()) + plain.size() - producer.capacity();
+    qToUnaligned(length, ring);
+
+    QVERIFY(!consumer.tryRead(&message));
+    QVERIFY(!consumer.errorString().isEmpty());
+    // the ring has been emptied and can be used again
+    QVERIFY(!consumer.hasMessages());
+    QVERIFY(producer.tryWrite("again"));
+    QVERIFY(consumer.tryRead(&message));
+    QCOMPARE(message, "again");
+}
+
+void tst_QSharedMemoryRing::blockingRead()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producer;
+    QVERIFY(producer.create(k, 4096));
+    QSharedMemoryRing consumer;
+    QVERIFY(consumer.attach(k));
+
+    QByteArray message;
+    QVERIFY(!consumer.read(&message, QDeadlineTimer(10ms)));
+
+    constexpr int Count = 10000;
+    int written = 0;
+    QScopedPointer<QThread> thread(QThread::create([&] {
+        while (written < Count && producer.write(QByteArray::number(written), QDeadlineTimer(5s)))
+            ++written;
+    }));
+    thread->start();
+
+    for (int i = 0; i < Count; ++i) {
+        QVERIFY(consumer.read(&message, QDeadlineTimer(5s)));
+        QCOMPARE(message, QByteArray::number(i));
+    }
+    QVERIFY(thread->wait());
+    QCOMPARE(written, Count);
+}
+
+void tst_QSharedMemoryRing::blockingWrite()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producer;
+    QVERIFY(producer.create(k, 64));
+    QSharedMemoryRing consumer;
+    QVERIFY(consumer.attach(k));
+
+    constexpr int Count = 10000;
+    QList<QByteArray> received;
+    QScopedPointer<QThread> thread(QThread::create([&] {
+        QByteArray message;
+        while (received.size() < Count && consumer.read(&message, QDeadlineTimer(5s)))
+            received << message;
+    }));
+    thread->start();
+
+    // the ring only holds a few messages, so this blocks most of the time
+    for (int i = 0; i < Count; ++i)
+        QVERIFY(producer.write(QByteArray::number(i), QDeadlineTimer(5s)));
+    QVERIFY(thread->wait());
+    QCOMPARE(received.size(), Count);
+    for (int i = 0; i < Count; ++i)
+        QCOMPARE(received.at(i), QByteArray::number(i));
+}
+
+void tst_QSharedMemoryRing::multipleProducers()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing consumer;
+    QVERIFY(consumer.create(k, 512, QSharedMemoryRing::MultipleProducers));
+
+    constexpr int ProducerCount = 4;
+    constexpr int Count = 5000;
+    QList<QThread *> threads;
+    struct Result {
+        bool attached = false;
+        QSharedMemoryRing::ProducerMode mode = QSharedMemoryRing::SingleProducer;
+        int written = 0;
+    };
+    Result results[ProducerCount];
+    for (int p = 0; p < ProducerCount; ++p) {
+        threads << QThread::create([&k, p, result = &results[p]] {
+            QSharedMemoryRing producer;
+            result->attached = producer.attach(k);
+            result->mode = producer.producerMode();
+            while (result->written < Count
+                   && producer.write(QByteArray::number(p) + ':' + QByteArray::number(result->written),
+                                     QDeadlineTimer(5s))) {
+                ++result->written;
+            }
+        });
+        threads.last()->start();
+    }
+
+    // messages from each producer arrive in order
+    QList<int> next(ProducerCount, 0);
+    QByteArray message;
+    for (int n = 0; n < ProducerCount * Count; ++n) {
+        QVERIFY(consumer.read(&message, QDeadlineTimer(5s)));
+        const QList<QByteArray> parts = message.split(':');
+        QCOMPARE(parts.size(), 2);
+        const int p = parts.at(0).toInt();
+        QCOMPARE(parts.at(1).toInt(), next[p]++);
+    }
+    for (QThread *thread : std::as_const(threads)) {
+        QVERIFY(thread->wait());
+        delete thread;
+    }
+    for (const Result &result : results) {
+        QVERIFY(result.attached);
+        QCOMPARE(result.mode, QSharedMemoryRing::MultipleProducers);
+        QCOMPARE(result.written, Count);
+    }
+    QVERIFY(!consumer.hasMessages());
+}
+
+void tst_QSharedMemoryRing::device()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producerRing;
+    QVERIFY(producerRing.create(k, 256));
+    QSharedMemoryRing consumerRing;
+    QVERIFY(consumerRing.attach(k));
+
+    QSharedMemoryRingDevice writer(&producerRing);
+    QVERIFY(!writer.open(QIODevice::ReadWrite));
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+    QSharedMemoryRingDevice reader(&consumerRing);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QVERIFY(reader.isSequential());
+
+    QSignalSpy spy(&reader, &QIODevice::readyRead);
+    QCOMPARE(writer.write("Hello, "), 7);
+    QCOMPARE(writer.write("World"), 5);
+    QTRY_VERIFY(reader.bytesAvailable() >= 12);
+    QVERIFY(spy.size() > 0);
+    QCOMPARE(reader.readAll(), "Hello, World");
+
+    // writes larger than a message are split; run them from another thread
+    // since the ring is smaller than the data
+    const QByteArray big(4000, 'q');
+    qint64 written = 0;
+    QScopedPointer<QThread> thread(QThread::create([&] {
+        written = writer.write(big);
+    }));
+    thread->start();
+    QByteArray received;
+    while (received.size() < big.size()) {
+        QVERIFY(reader.waitForReadyRead(5000));
+        received += reader.readAll();
+    }
+    QCOMPARE(received, big);
+    QVERIFY(thread->wait());
+    QCOMPARE(written, big.size());
+
+    reader.close();
+    QVERIFY(!reader.isOpen());
+}
+
+void tst_QSharedMemoryRing::closeDevice()
+{
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing producer;
+    QVERIFY(producer.create(k, 256));
+    QSharedMemoryRing consumer;
+    QVERIFY(consumer.attach(k));
+
+    // closing must stop the watcher thread wherever it is, including just
+    // before it starts waiting for messages
+    QSharedMemoryRingDevice reader(&consumer);
+    for (int i = 0; i < 1000; ++i) {
+        QVERIFY(reader.open(QIODevice::ReadOnly));
+        if (i % 3 == 0)
+            QThread::yieldCurrentThread();
+        reader.close();
+    }
+}
+
+QTEST_MAIN(tst_QSharedMemoryRing)
+#include "tst_qsharedmemoryring.moc"
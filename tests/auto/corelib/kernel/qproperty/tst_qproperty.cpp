@@ -91,6 +91,7 @@ private slots:
     void noDoubleNotification();
     void groupedNotifications();
     void groupedNotificationConsistency();
+    void groupedEvaluation();
     void bindingGroupMovingBindingData();
     void bindingGroupBindingDeleted();
     void uninstalledBindingDoesNotEvaluate();
@@ -2242,6 +2243,45 @@ void tst_QProperty::groupedNotificationConsistency()
     QVERIFY(areEqual); // value changed runs after everything has been evaluated
 }
 
+void tst_QProperty::groupedEvaluation()
+{
+    QProperty<int> a(0);
+    QProperty<int> b;
+    b.setBinding([&](){ return a.value(); });
+    QProperty<int> c;
+    c.setBinding([&](){ return a.value() / 10; });
+    QProperty<int> d(0);
+    int nEvaluations = 0;
+    QProperty<int> e;
+    e.setBinding([&](){ ++nEvaluations; return b.value() + c.value() + d.value(); });
+    QProperty<int> f;
+    int nUnchangedEvaluations = 0;
+    f.setBinding([&](){ ++nUnchangedEvaluations; return c.value(); });
+    QCOMPARE(nEvaluations, 1);
+    QCOMPARE(nUnchangedEvaluations, 1);
+
+    {
+        const QScopedPropertyUpdateGroup guard;
+        a = 1;
+        d = 2;
+    }
+    // e depends on a through two bindings and on d, but is evaluated once
+    QCOMPARE(nEvaluations, 2);
+    QCOMPARE(e.value(), 3);
+    // c did not change, so f does not need to be evaluated
+    QCOMPARE(nUnchangedEvaluations, 1);
+    QCOMPARE(f.value(), 0);
+
+    {
+        const QScopedPropertyUpdateGroup guard;
+        a = 20;
+    }
+    QCOMPARE(nEvaluations, 3);
+    QCOMPARE(e.value(), 24);
+    QCOMPARE(nUnchangedEvaluations, 2);
+    QCOMPARE(f.value(), 2);
+}
+
 void tst_QProperty::bindingGroupMovingBindingData()
 {
     auto tester = std::make_unique<ClassWithNotifiedProperty>();
@@ -5,9 +5,14 @@
 #include <QtCore/qdir.h>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qplugin.h>
+#include <QtCore/qscopeguard.h>
+#include <QtCore/qtemporarydir.h>
 #include <QtCore/qversionnumber.h>
 #include <private/qfactoryloader_p.h>
 #include <private/qlibrary_p.h>
+#if QT_CONFIG(library)
+#include <private/qpluginmetadatacache_p.h>
+#endif
 #include "plugin1/plugininterface1.h"
 #include "plugin2/plugininterface2.h"
 
@@ -28,6 +33,7 @@ private slots:
     void usingTwoFactoriesFromSameDir();
     void extraSearchPath();
     void multiplePaths();
+    void metaDataCache();
     void staticPlugin_data();
     void staticPlugin();
 };
@@ -173,6 +179,88 @@ void tst_QFactoryLoader::multiplePaths()
 #endif
 }
 
+void tst_QFactoryLoader::metaDataCache()
+{
+#if !QT_CONFIG(library) || defined(Q_OS_ANDROID)
+    QSKIP("Test not applicable in this configuration.");
+#else
+    const QString libraryPath = QFileInfo(binFolder).absolutePath();
+    const QString suffix = QLatin1Char('/') + QLatin1String(binFolderC);
+    const QString pluginsPath = QFileInfo(binFolder).absoluteFilePath();
+    const QPluginMetaDataCache::FileStamp stamp = { 123456789, 4096 };
+    QCoreApplication::setLibraryPaths({ libraryPath });
+
+    // the cache is opt-in, so nothing is written unless asked for
+    if (qEnvironmentVariableIsEmpty("QT_PLUGIN_METADATA_CACHE")
+            && qEnvironmentVariableIsEmpty("QT_PLUGIN_METADATA_CACHE_DIR")) {
+        QVERIFY(!QPluginMetaDataCache::isEnabled());
+    }
+
+    // the metadata of a real plugin, to be stored in the cache
+    QPluginParsedMetaData parsed;
+    {
+        QFactoryLoader loader(PluginInterface1_iid, suffix);
+        QCOMPARE(loader.metaData().size(), 1);
+        parsed = loader.metaData().constFirst();
+        QVERIFY(!parsed.isError());
+    }
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    qputenv("QT_PLUGIN_METADATA_CACHE_DIR", QFile::encodeName(cacheDir.path()));
+    auto cleanup = qScopeGuard([] { qunsetenv("QT_PLUGIN_METADATA_CACHE_DIR"); });
+    QVERIFY(QPluginMetaDataCache::isEnabled());
+
+    QString cacheFile;
+    {
+        QPluginMetaDataCache cache(pluginsPath, {});
+        QVERIFY(cache.isValid());
+        QVERIFY(cache.fileName().startsWith(cacheDir.path()));
+        QVERIFY(!cache.find("plugin.so", stamp));
+        cache.insert("plugin.so", stamp, parsed, QString());
+        cache.insert("notaplugin.so", stamp, QPluginParsedMetaData(), "not a plugin");
+        QVERIFY(cache.save());
+        cacheFile = cache.fileName();
+    }
+    QVERIFY(QFile::exists(cacheFile));
+
+    {
+        // a different name filter uses a different cache file
+        QPluginMetaDataCache cache(pluginsPath, { "*.dll" });
+        QVERIFY(cache.fileName() != cacheFile);
+        QVERIFY(!cache.find("plugin.so", stamp));
+    }
+
+    {
+        QPluginMetaDataCache cache(pluginsPath, {});
+        std::optional<QPluginParsedMetaData> cached = cache.find("plugin.so", stamp);
+        QVERIFY(cached);
+        QVERIFY(!cached->isError());
+        QCOMPARE(cached->toCbor(), parsed.toCbor());
+
+        cached = cache.find("notaplugin.so", stamp);
+        QVERIFY(cached);
+        QVERIFY(cached->isError());
+        QCOMPARE(cached->errorString(), "not a plugin");
+
+        // modified files are not returned and get dropped
+        QVERIFY(!cache.find("plugin.so", { stamp.lastModified + 1, stamp.size }));
+        QVERIFY(cache.save());
+    }
+
+    {
+        QPluginMetaDataCache cache(pluginsPath, {});
+        QVERIFY(!cache.find("plugin.so", stamp));
+        QVERIFY(cache.find("notaplugin.so", stamp));
+    }
+
+    // a scan through QFactoryLoader must produce a cache file too
+    QFactoryLoader loader(PluginInterface1_iid, suffix);
+    QCOMPARE(loader.metaData().size(), 1);
+    QVERIFY(QFile::exists(QPluginMetaDataCache(libraryPath + suffix, {}).fileName()));
+#endif
+}
+
 Q_IMPORT_PLUGIN(StaticPlugin1)
 Q_IMPORT_PLUGIN(StaticPlugin2)
 constexpr bool IsDebug =
@@ -184,6 +184,9 @@ private slots:
 
     void streamToAndFromQByteArray();
 
+    void stream_bulkArrays_data();
+    void stream_bulkArrays();
+
     void streamRealDataTypes();
 
     void enumTest();
@@ -3253,6 +3256,123 @@ void tst_QDataStream::streamToAndFromQByteArray()
     QCOMPARE(y, x);
 }
 
+void tst_QDataStream::stream_bulkArrays_data()
+{
+    QTest::addColumn<QDataStream::ByteOrder>("byteOrder");
+    QTest::addColumn<QDataStream::FloatingPointPrecision>("precision");
+    QTest::addColumn<int>("version");
+
+    for (auto byteOrder : { QDataStream::BigEndian, QDataStream::LittleEndian }) {
+        const char *order = byteOrder == QDataStream::BigEndian ? "be" : "le";
+        for (auto precision : { QDataStream::SinglePrecision, QDataStream::DoublePrecision }) {
+            const char *fp = precision == QDataStream::SinglePrecision ? "single" : "double";
+            for (int version : { int(QDataStream::Qt_3_1), int(QDataStream::Qt_4_5),
+                                 int(QDataStream::Qt_DefaultCompiledVersion) }) {
+                QTest::addRow("%s-%s-%d", order, fp, version)
+                        << byteOrder << precision << version;
+            }
+        }
+    }
+}
+
+// Lists of these types are streamed in bulk; check that the bytes and the
+// results are the same as when streaming them one element at a time.
+template <typename T>
+static void checkBulkArray(QDataStream::ByteOrder byteOrder,
+                           QDataStream::FloatingPointPrecision precision, int version)
+{
+    QList<T> list;
+    for (int i = 0; i < 20000; ++i)
+        list.append(T(i * 37 % 251 - (std::is_signed_v<T> ? 100 : 0)));
+    if constexpr (std::is_floating_point_v<T>)
+        list.append(T(1) / T(3));
+
+    auto setUp = [&](QDataStream &s) {
+        s.setByteOrder(byteOrder);
+        s.setFloatingPointPrecision(precision);
+        s.setVersion(version);
+    };
+
+    QByteArray expected;
+    {
+        QDataStream s(&expected, QIODevice::WriteOnly);
+        setUp(s);
+        s << quint32(list.size());
+        for (T t : std::as_const(list))
+            s << t;
+    }
+    QByteArray actual;
+    {
+        QDataStream s(&actual, QIODevice::WriteOnly);
+        setUp(s);
+        s << list;
+        QCOMPARE(s.status(), QDataStream::Ok);
+    }
+    QCOMPARE(actual, expected);
+
+    QList<T> result;
+    {
+        QDataStream s(actual);
+        setUp(s);
+        s >> result;
+        QCOMPARE(s.status(), QDataStream::Ok);
+        QVERIFY(s.atEnd());
+    }
+    // Before Qt_3_3, operator>>(qint64 &) reads the two 32-bit halves in the
+    // opposite order to the one operator<<(qint64) writes them in, so those
+    // values do not round-trip. Reading a list must still give what reading
+    // its elements one by one gives.
+    if (std::is_integral_v<T> && sizeof(T) == 8 && version < QDataStream::Qt_3_3) {
+        QList<T> elementwise;
+        QDataStream s(actual);
+        setUp(s);
+        quint32 size;
+        s >> size;
+        for (quint32 i = 0; i < size; ++i) {
+            T t;
+            s >> t;
+            elementwise.append(t);
+        }
+        QCOMPARE(result, elementwise);
+    } else if constexpr (std::is_same_v<T, double>) {
+        // may have been streamed in single precision
+        QCOMPARE(result.size(), list.size());
+        for (qsizetype i = 0; i < list.size(); ++i)
+            QCOMPARE(float(result.at(i)), float(list.at(i)));
+    } else {
+        QCOMPARE(result, list);
+    }
+
+    // truncated data must not produce a partial list
+    {
+        QDataStream s(actual.chopped(1));
+        setUp(s);
+        s >> result;
+        QCOMPARE(s.status(), QDataStream::ReadPastEnd);
+        QVERIFY(result.isEmpty());
+    }
+}
+
+void tst_QDataStream::stream_bulkArrays()
+{
+    QFETCH(QDataStream::ByteOrder, byteOrder);
+    QFETCH(QDataStream::FloatingPointPrecision, precision);
+    QFETCH(int, version);
+
+    checkBulkArray<qint8>(byteOrder, precision, version);
+    checkBulkArray<quint8>(byteOrder, precision, version);
+    checkBulkArray<qint16>(byteOrder, precision, version);
+    checkBulkArray<quint16>(byteOrder, precision, version);
+    checkBulkArray<qint32>(byteOrder, precision, version);
+    checkBulkArray<quint32>(byteOrder, precision, version);
+    checkBulkArray<qint64>(byteOrder, precision, version);
+    checkBulkArray<quint64>(byteOrder, precision, version);
+    checkBulkArray<char16_t>(byteOrder, precision, version);
+    checkBulkArray<char32_t>(byteOrder, precision, version);
+    checkBulkArray<float>(byteOrder, precision, version);
+    checkBulkArray<double>(byteOrder, precision, version);
+}
+
 void tst_QDataStream::streamRealDataTypes()
 {
     // Generate QPicture from pixmap.
@@ -598,6 +598,8 @@ private slots:
     void roundTrip_data() const;
     void test_fastScanName_data() const;
     void test_fastScanName() const;
+    void test_fastScanPlainCharacters_data() const;
+    void test_fastScanPlainCharacters() const;
 
     void entityExpansionLimit() const;
 
@@ -2062,6 +2064,57 @@ void tst_QXmlStream::test_fastScanName() const
     QCOMPARE(reader.error(), errorType);
 }
 
+void tst_QXmlStream::test_fastScanPlainCharacters_data() const
+{
+    QTest::addColumn<int>("prefix");
+
+    // vary the position of the special characters relative to the
+    // vector width used by the scanners
+    for (int prefix = 0; prefix < 20; ++prefix)
+        QTest::addRow("prefix=%d", prefix) << prefix;
+}
+
+void tst_QXmlStream::test_fastScanPlainCharacters() const
+{
+    QFETCH(int, prefix);
+    const QString filler(prefix, u'x');
+    const QString blanks(prefix, u' ');
+
+    const QString xml = "<root a=\""_L1 + filler + "&amp;\t\n"_L1 + filler + "\" b='"_L1 + filler
+            + "&quot;'>"_L1 + blanks + "<c/>"_L1 + filler + u'\n' + filler
+            + "\r\n&lt;]"_L1 + filler + u'\x00e9' + filler + "</root>"_L1;
+    QXmlStreamReader reader(xml);
+
+    QVERIFY(reader.readNextStartElement());
+    QCOMPARE(reader.attributes().value("a"), filler + "&  "_L1 + filler);
+    QCOMPARE(reader.attributes().value("b"), filler + u'"');
+
+    if (prefix) {
+        QCOMPARE(reader.readNext(), QXmlStreamReader::Characters);
+        QVERIFY(reader.isWhitespace());
+        QCOMPARE(reader.text(), blanks);
+    }
+    QCOMPARE(reader.readNext(), QXmlStreamReader::StartElement);
+    QCOMPARE(reader.readNext(), QXmlStreamReader::EndElement);
+
+    QString text;
+    while (reader.readNext() == QXmlStreamReader::Characters) {
+        if (prefix)
+            QVERIFY(!reader.isWhitespace());
+        text += reader.text();
+    }
+    QCOMPARE(text, filler + u'\n' + filler + "\n<]"_L1 + filler + u'\x00e9' + filler);
+    QCOMPARE(reader.tokenType(), QXmlStreamReader::EndElement);
+    QCOMPARE(reader.lineNumber(), 4);
+    QVERIFY(!reader.hasError());
+
+    // "]]>" must still be detected after a run of plain characters
+    QXmlStreamReader bad("<root>"_L1 + filler + "]]>"_L1 + filler + "</root>"_L1);
+    while (!bad.atEnd())
+        bad.readNext();
+    QCOMPARE(bad.error(), QXmlStreamReader::NotWellFormedError);
+}
+
 void tst_QXmlStream::tokenErrorHandling_data() const
 {
     QTest::addColumn<QString>("fileName");
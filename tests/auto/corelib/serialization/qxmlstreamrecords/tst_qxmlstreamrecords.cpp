@@ -0,0 +1,163 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QTest>
+#include <QtCore/QStringEncoder>
+#include <QtCore/QThreadPool>
+
+#include <private/qxmlstreamrecords_p.h>
+
+using namespace Qt::StringLiterals;
+
+class tst_QXmlStreamRecords : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void scan_data();
+    void scan();
+    void refused_data();
+    void refused();
+    void namespaces();
+    void concurrent_data();
+    void concurrent();
+};
+
+void tst_QXmlStreamRecords::scan_data()
+{
+    QTest::addColumn<QByteArray>("document");
+    QTest::addColumn<QByteArrayList>("records");
+
+    QTest::newRow("empty-root") << "<root/>"_ba << QByteArrayList();
+    QTest::newRow("no-records") << "<root>text</root>"_ba << QByteArrayList();
+    QTest::newRow("simple")
+            << "<?xml version='1.0'?>\n<root><a>1</a><b/>\n<c x='1'>3</c></root>\n"_ba
+            << QByteArrayList{ "<a>1</a>", "<b/>", "<c x='1'>3</c>" };
+    QTest::newRow("nested")
+            << "<root><a><a><a/></a></a><b><c></c></b></root>"_ba
+            << QByteArrayList{ "<a><a><a/></a></a>", "<b><c></c></b>" };
+    QTest::newRow("markup-in-attributes")
+            << "<root><a x='>' y=\"/>\"/><b z=\"'\">t</b></root>"_ba
+            << QByteArrayList{ "<a x='>' y=\"/>\"/>", "<b z=\"'\">t</b>" };
+    QTest::newRow("comments-pi-cdata")
+            << "<!-- <x> --><root><!-- <a> --><?pi <a>?><a><![CDATA[</a>]]></a></root>"_ba
+            << QByteArrayList{ "<a><![CDATA[</a>]]></a>" };
+    QTest::newRow("utf8")
+            << "<root><n\xc3\xa4me>\xe2\x82\xac</n\xc3\xa4me></root>"_ba
+            << QByteArrayList{ "<n\xc3\xa4me>\xe2\x82\xac</n\xc3\xa4me>" };
+    QTest::newRow("utf8-bom")
+            << "\xef\xbb\xbf<root><a>1</a></root>"_ba << QByteArrayList{ "<a>1</a>" };
+}
+
+void tst_QXmlStreamRecords::scan()
+{
+    QFETCH(QByteArray, document);
+    QFETCH(QByteArrayList, records);
+
+    QXmlStreamRecordScanner scanner;
+    QVERIFY2(scanner.scan(document), qPrintable(scanner.errorString()));
+    QCOMPARE(scanner.records().size(), records.size());
+    for (qsizetype i = 0; i < records.size(); ++i) {
+        const QXmlStreamRecordScanner::Record &record = scanner.records().at(i);
+        QCOMPARE(document.sliced(record.offset, record.size), records.at(i));
+    }
+}
+
+void tst_QXmlStreamRecords::refused_data()
+{
+    QTest::addColumn<QByteArray>("document");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("dtd") << "<!DOCTYPE root [<!ENTITY e 'x'>]><root><a>&e;</a></root>"_ba;
+    QTest::newRow("latin1") << "<?xml version='1.0' encoding='ISO-8859-1'?><root/>"_ba;
+    QTest::newRow("utf16") << QByteArray("<\0r\0/\0>\0", 8);
+    // a byte order mark and no encoding declaration
+    QTest::newRow("utf16le-bom") << QByteArray("\xff\xfe<\0r\0/\0>\0", 10);
+    QTest::newRow("utf16be-bom") << QByteArray("\xfe\xff\0<\0r\0/\0>", 10);
+    QTest::newRow("utf32le-bom") << QByteArray("\xff\xfe\0\0<\0\0\0/\0\0\0>\0\0\0", 16);
+    QTest::newRow("truncated") << "<root><a>1</a><b"_ba;
+    QTest::newRow("unclosed") << "<root><a>1</a>"_ba;
+}
+
+void tst_QXmlStreamRecords::refused()
+{
+    QFETCH(QByteArray, document);
+
+    QXmlStreamRecordScanner scanner;
+    QVERIFY(!scanner.scan(document));
+    QVERIFY(!scanner.errorString().isEmpty());
+    QVERIFY(scanner.records().isEmpty());
+}
+
+void tst_QXmlStreamRecords::namespaces()
+{
+    const QByteArray document =
+            "<root xmlns='urn:default' xmlns:p='urn:p'><p:a/><b p:x='1'/></root>"_ba;
+    QXmlStreamRecordScanner scanner;
+    QVERIFY(scanner.scan(document));
+    QCOMPARE(scanner.namespaceDeclarations().size(), 2);
+    QCOMPARE(scanner.records().size(), 2);
+
+    QXmlStreamReader reader;
+    QtPrivate::setUpXmlRecordReader(reader, document, scanner.records().at(0),
+                                    scanner.namespaceDeclarations());
+    QCOMPARE(reader.tokenType(), QXmlStreamReader::StartElement);
+    QCOMPARE(reader.namespaceUri(), "urn:p"_L1);
+    QCOMPARE(reader.name(), "a"_L1);
+
+    QXmlStreamReader second;
+    QtPrivate::setUpXmlRecordReader(second, document, scanner.records().at(1),
+                                    scanner.namespaceDeclarations());
+    QCOMPARE(second.namespaceUri(), "urn:default"_L1);
+    QCOMPARE(second.attributes().value("urn:p"_L1, "x"_L1), "1"_L1);
+    QVERIFY(!second.hasError());
+}
+
+void tst_QXmlStreamRecords::concurrent_data()
+{
+    QTest::addColumn<QByteArray>("document");
+    QTest::addColumn<int>("count");
+
+    QByteArray records;
+    constexpr int Count = 5000;
+    for (int i = 0; i < Count; ++i)
+        records += "<r id='" + QByteArray::number(i) + "'><v>" + QByteArray::number(i * 2)
+                + "</v></r>\n";
+
+    QTest::newRow("scanned") << "<root>\n" + records + "</root>" << Count;
+    // parsed sequentially, with the same results
+    QTest::newRow("dtd") << "<!DOCTYPE root><root>\n" + records + "</root>" << Count;
+    QTest::newRow("empty") << "<root/>"_ba << 0;
+    QStringEncoder toUtf16(QStringEncoder::Utf16LE, QStringEncoder::Flag::WriteBom);
+    QTest::newRow("utf16-bom")
+            << QByteArray(toUtf16(QString::fromLatin1("<root>\n" + records + "</root>")))
+            << Count;
+}
+
+void tst_QXmlStreamRecords::concurrent()
+{
+    QFETCH(QByteArray, document);
+    QFETCH(int, count);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    QFuture<std::pair<int, int>> future = qParseXmlRecordsConcurrently(
+            document,
+            [](QXmlStreamReader &reader) {
+                const int id = reader.attributes().value("id"_L1).toInt();
+                int value = -1;
+                if (reader.readNextStartElement())
+                    value = reader.readElementText().toInt();
+                return std::pair(id, value);
+            }, &pool);
+
+    const QList<std::pair<int, int>> results = future.results();
+    QCOMPARE(results.size(), count);
+    for (int i = 0; i < count; ++i) {
+        QCOMPARE(results.at(i).first, i);
+        QCOMPARE(results.at(i).second, i * 2);
+    }
+}
+
+QTEST_MAIN(tst_QXmlStreamRecords)
+#include "tst_qxmlstreamrecords.moc"
@@ -6,6 +6,7 @@
 #include <qlocale.h>
 #include <qcollator.h>
 #include <private/qglobal_p.h>
+#include <private/qcollator_p.h>
 #include <QScopeGuard>
 
 #include <cstring>
@@ -23,6 +24,9 @@ private Q_SLOTS:
     void compare();
 
     void state();
+
+    void sortKeyArena_data();
+    void sortKeyArena();
 };
 
 static bool dpointer_is_null(QCollator &c)
@@ -349,6 +353,65 @@ void tst_QCollator::state()
     QCOMPARE(c.locale(), QLocale(QLocale::NorwegianBokmal));
 }
 
+void tst_QCollator::sortKeyArena_data()
+{
+    QTest::addColumn<QString>("locale");
+    QTest::addColumn<Qt::CaseSensitivity>("caseSensitivity");
+
+    QTest::newRow("c") << QString("C") << Qt::CaseSensitive;
+#if QT_CONFIG(icu) || defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+    QTest::newRow("english") << QString("en_US") << Qt::CaseSensitive;
+    QTest::newRow("german-insensitive") << QString("de_DE") << Qt::CaseInsensitive;
+    QTest::newRow("swedish") << QString("sv_SE") << Qt::CaseSensitive;
+#else
+    QTest::newRow("system") << QLocale::system().collation().name() << Qt::CaseSensitive;
+#endif
+}
+
+void tst_QCollator::sortKeyArena()
+{
+    QFETCH(QString, locale);
+    QFETCH(Qt::CaseSensitivity, caseSensitivity);
+
+    QCollator collator((QLocale(locale)));
+    collator.setCaseSensitivity(caseSensitivity);
+
+    // enough strings to be split between threads, with plenty of duplicates,
+    // shared prefixes, case and accent variants and empty strings
+    const QString alphabet = QStringLiteral("aAbB zZ\u00e4\u00c4\u00f6o-1");
+    QList<QString> strings;
+    quint32 seed = 1;
+    for (int i = 0; i < 20000; ++i) {
+        QString s;
+        seed = seed * 1103515245 + 12345;
+        for (int length = (seed >> 16) % 7; length > 0; --length) {
+            seed = seed * 1103515245 + 12345;
+            s += alphabet.at((seed >> 16) % alphabet.size());
+        }
+        strings.append(s);
+    }
+
+    QList<QString> expected = strings;
+    std::stable_sort(expected.begin(), expected.end(), collator);
+
+    QCollatorSortKeyArena arena;
+    if (arena.build(collator, strings)) {
+        QCOMPARE(arena.size(), strings.size());
+        const QList<qsizetype> order = arena.sortedIndexes();
+        QCOMPARE(order.size(), strings.size());
+        for (qsizetype i = 1; i < order.size(); ++i) {
+            // equal strings keep their relative order
+            if (collator.compare(strings.at(order.at(i - 1)), strings.at(order.at(i))) == 0)
+                QCOMPARE_LT(order.at(i - 1), order.at(i));
+        }
+    } else {
+        QCOMPARE(arena.size(), 0);
+    }
+
+    QCollatorSortKeyArena::sort(strings, collator);
+    QCOMPARE(strings, expected);
+}
+
 QTEST_APPLESS_MAIN(tst_QCollator)
 
 #include "tst_qcollator.moc"
@@ -3,6 +3,7 @@
 
 #include <QTest>
 #include <QScopedValueRollback>
+#include <QThread>
 
 #include <qtextboundaryfinder.h>
 #include <qfile.h>
@@ -11,6 +12,7 @@
 #include <qset.h>
 
 #include <algorithm>
+#include <memory>
 
 using namespace Qt::Literals::StringLiterals;
 
@@ -45,6 +47,11 @@ private slots:
     void assignmentOperator();
     void isAtSoftHyphen_data();
     void isAtSoftHyphen();
+    void longText_data();
+    void longText();
+#if QT_CONFIG(thread)
+    void concurrentConstUse();
+#endif
 };
 
 
@@ -729,6 +736,15 @@ void tst_QTextBoundaryFinder::lineBoundaries_manual_data()
         QTest::newRow("x(AL)x(BA)+(AL)x(BA)+(AL)x(AL)+") << testString << expectedBreakPositions
                                                          << expectedMandatoryBreakPositions;
     }
+    {
+        QString testString(u"12\nab"_s);
+        QList<int> expectedBreakPositions, expectedMandatoryBreakPositions;
+        expectedBreakPositions << 0 << 3 << 5;
+        expectedMandatoryBreakPositions << 0 << 3 << 5;
+
+        QTest::newRow("x(NU)x(NU)x(LF)+(AL)x(AL)+") << testString << expectedBreakPositions
+                                                    << expectedMandatoryBreakPositions;
+    }
 }
 
 void tst_QTextBoundaryFinder::lineBoundaries_manual()
@@ -857,5 +873,106 @@ void tst_QTextBoundaryFinder::isAtSoftHyphen()
     doTestData(testString, expectedSoftHyphenPositions, QTextBoundaryFinder::Line, QTextBoundaryFinder::SoftHyphen);
 }
 
+void tst_QTextBoundaryFinder::longText_data()
+{
+    QTest::addColumn<QTextBoundaryFinder::BoundaryType>("type");
+
+    QTest::newRow("grapheme") << QTextBoundaryFinder::Grapheme;
+    QTest::newRow("word") << QTextBoundaryFinder::Word;
+    QTest::newRow("sentence") << QTextBoundaryFinder::Sentence;
+    QTest::newRow("line") << QTextBoundaryFinder::Line;
+}
+
+void tst_QTextBoundaryFinder::longText()
+{
+    QFETCH(QTextBoundaryFinder::BoundaryType, type);
+
+    // Long enough to be analyzed in several pieces, split at line feeds; the
+    // result must not depend on that.
+    const QString lines[] = {
+        u"The quick brown fox jumps over the lazy dog. It's 12,345.67 km away!\r\n"_s,
+        u"Diga-nos qual\u00e9 a sua opini\u00e3o (\u00ab1990\u00bb).\n"_s,
+        u"\u65e5\u672c\u8a9e\u306e\u6587\u7ae0\u3002\u30ab\u30bf\u30ab\u30ca\n"_s,
+        u"\U0001F468\u200D\U0001F469\u200D\U0001F467 \U0001F1E9\U0001F1EA\U0001F1EB\U0001F1F7\n"_s,
+        u"e\u0301\u0308 a\u00adb\t\u0915\u094D\u0937 $12 (34)\n"_s,
+        u"1234\n"_s,
+        u"\n"_s,
+    };
+    QString text;
+    for (int i = 0; text.size() < 20000; ++i)
+        text += lines[(i * 5) % std::size(lines)];
+
+    QList<uchar> buffer(text.size() + 1);
+    QTextBoundaryFinder eager(type, text, buffer.data(), buffer.size());
+    QTextBoundaryFinder lazy(type, text);
+
+    // copy a partly analyzed finder
+    lazy.setPosition(text.size() / 2);
+    lazy.toNextBoundary();
+    QTextBoundaryFinder copy = lazy;
+
+    QList<qsizetype> eagerBoundaries, lazyBoundaries, copyBoundaries;
+    eager.toStart();
+    copy.toStart();
+    do {
+        eagerBoundaries.append(eager.position());
+    } while (eager.toNextBoundary() != -1);
+    do {
+        copyBoundaries.append(copy.position());
+    } while (copy.toNextBoundary() != -1);
+    lazy.toEnd();
+    do {
+        lazyBoundaries.prepend(lazy.position());
+    } while (lazy.toPreviousBoundary() != -1);
+    QCOMPARE(lazyBoundaries, eagerBoundaries);
+    QCOMPARE(copyBoundaries, eagerBoundaries);
+
+    for (qsizetype i = 0; i <= text.size(); ++i) {
+        eager.setPosition(i);
+        lazy.setPosition(i);
+        QCOMPARE(lazy.boundaryReasons(), eager.boundaryReasons());
+    }
+}
+
+#if QT_CONFIG(thread)
+void tst_QTextBoundaryFinder::concurrentConstUse()
+{
+    QString text;
+    for (int i = 0; text.size() < 50000; ++i)
+        text += u"Line %1 of a text that is analyzed as the finders need it.\n"_s.arg(i);
+
+    QList<uchar> buffer(text.size() + 1);
+    QTextBoundaryFinder eager(QTextBoundaryFinder::Line, text, buffer.data(), buffer.size());
+    eager.toEnd();
+    const QTextBoundaryFinder::BoundaryReasons reasons = eager.boundaryReasons();
+    QList<qsizetype> boundaries;
+    do {
+        boundaries.prepend(eager.position());
+    } while (eager.toPreviousBoundary() != -1);
+
+    // The const functions of a shared finder analyze the text too
+    QTextBoundaryFinder shared(QTextBoundaryFinder::Line, text);
+    shared.toEnd();
+    std::unique_ptr<QThread> threads[4];
+    QList<qsizetype> results[std::size(threads)];
+    QTextBoundaryFinder::BoundaryReasons sharedReasons[std::size(threads)];
+    for (size_t i = 0; i < std::size(threads); ++i) {
+        threads[i].reset(QThread::create([&, i] {
+            sharedReasons[i] = shared.boundaryReasons();
+            QTextBoundaryFinder copy = shared;
+            do {
+                results[i].prepend(copy.position());
+            } while (copy.toPreviousBoundary() != -1);
+        }));
+        threads[i]->start();
+    }
+    for (size_t i = 0; i < std::size(threads); ++i) {
+        QVERIFY(threads[i]->wait());
+        QCOMPARE(sharedReasons[i], reasons);
+        QCOMPARE(results[i], boundaries);
+    }
+}
+#endif
+
 QTEST_MAIN(tst_QTextBoundaryFinder)
 #include "tst_qtextboundaryfinder.moc"
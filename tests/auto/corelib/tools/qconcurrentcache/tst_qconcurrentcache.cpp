@@ -0,0 +1,259 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QCache>
+#include <QThread>
+
+#include <private/qconcurrentcache_p.h>
+
+#include <memory>
+#include <vector>
+
+using namespace Qt::StringLiterals;
+
+class tst_QConcurrentCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void shardCount_data();
+    void shardCount();
+    void insertAndLookup();
+    void replace();
+    void cost();
+    void remove();
+    void clear();
+    void admission();
+    void sketchGrowth();
+    void statistics();
+    void concurrentAccess();
+};
+
+void tst_QConcurrentCache::shardCount_data()
+{
+    QTest::addColumn<int>("requested");
+    QTest::addColumn<int>("expected");
+
+    QTest::newRow("1") << 1 << 1;
+    QTest::newRow("2") << 2 << 2;
+    QTest::newRow("3") << 3 << 4;
+    QTest::newRow("16") << 16 << 16;
+    QTest::newRow("17") << 17 << 32;
+}
+
+void tst_QConcurrentCache::shardCount()
+{
+    QFETCH(int, requested);
+    QFETCH(int, expected);
+
+    QConcurrentCache<int, int> cache(100, requested);
+    QCOMPARE(cache.shardCount(), expected);
+
+    QConcurrentCache<int, int> defaultCache;
+    QVERIFY(defaultCache.shardCount() >= 1);
+    QCOMPARE(defaultCache.shardCount() & (defaultCache.shardCount() - 1), 0);
+}
+
+void tst_QConcurrentCache::insertAndLookup()
+{
+    QConcurrentCache<QString, QByteArray> cache(100, 4);
+    QCOMPARE(cache.size(), 0);
+    QVERIFY(!cache.object(u"a"_s));
+
+    QVERIFY(cache.insert(u"a"_s, "alpha"));
+    QVERIFY(cache.insert(u"b"_s, "beta", 2));
+    QCOMPARE(cache.size(), 2);
+    QCOMPARE(cache.totalCost(), 3);
+    QVERIFY(cache.contains(u"a"_s));
+    QCOMPARE(cache.object(u"a"_s).value_or(QByteArray()), "alpha");
+    QCOMPARE(cache.object(u"b"_s).value_or(QByteArray()), "beta");
+    QVERIFY(!cache.contains(u"c"_s));
+    QVERIFY(!cache.object(u"c"_s));
+}
+
+void tst_QConcurrentCache::replace()
+{
+    QConcurrentCache<int, QString> cache(10, 1);
+    QVERIFY(cache.insert(1, u"one"_s, 3));
+    QVERIFY(cache.insert(1, u"uno"_s, 5));
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(cache.totalCost(), 5);
+    QCOMPARE(cache.object(1).value_or(QString()), u"uno"_s);
+
+    // too expensive: drops the existing entry, like QCache does
+    QVERIFY(!cache.insert(1, u"eins"_s, 11));
+    QVERIFY(!cache.contains(1));
+    QCOMPARE(cache.totalCost(), 0);
+}
+
+void tst_QConcurrentCache::cost()
+{
+    QConcurrentCache<int, int> cache(10, 1);
+    QCOMPARE(cache.maxCost(), 10);
+    for (int i = 0; i < 10; ++i)
+        QVERIFY(cache.insert(i, i));
+    QCOMPARE(cache.totalCost(), 10);
+
+    // making an entry more expensive evicts the least recently used ones
+    QVERIFY(cache.insert(9, 9, 10));
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(cache.totalCost(), 10);
+
+    cache.setMaxCost(5);
+    QCOMPARE(cache.maxCost(), 5);
+    QCOMPARE(cache.size(), 0);
+    QCOMPARE(cache.totalCost(), 0);
+}
+
+void tst_QConcurrentCache::remove()
+{
+    QConcurrentCache<int, int> cache(10, 2);
+    QVERIFY(cache.insert(1, 1, 4));
+    QVERIFY(cache.insert(2, 2, 1));
+    QVERIFY(cache.remove(1));
+    QVERIFY(!cache.remove(1));
+    QVERIFY(!cache.contains(1));
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(cache.totalCost(), 1);
+}
+
+void tst_QConcurrentCache::clear()
+{
+    QConcurrentCache<int, int> cache(100, 4);
+    for (int i = 0; i < 50; ++i)
+        QVERIFY(cache.insert(i, i));
+    cache.clear();
+    QCOMPARE(cache.size(), 0);
+    QCOMPARE(cache.totalCost(), 0);
+    QCOMPARE(cache.statistics().evictions, 0u);
+    QVERIFY(cache.insert(1, 1));
+    QCOMPARE(cache.object(1).value_or(-1), 1);
+}
+
+void tst_QConcurrentCache::admission()
+{
+    constexpr int Capacity = 100;
+    QConcurrentCache<int, int> cache(Capacity, 1);
+    auto get = [&](int key) {
+        if (!cache.object(key))
+            cache.insert(key, key);
+    };
+
+    // a working set in frequent use...
+    for (int round = 0; round < 4; ++round) {
+        for (int key = 0; key < Capacity; ++key)
+            get(key);
+    }
+    QCOMPARE(cache.size(), Capacity);
+
+    // ...survives a scan over keys that are used once
+    for (int key = 1000; key < 1000 + 3 * Capacity; ++key)
+        get(key);
+    int survivors = 0;
+    for (int key = 0; key < Capacity; ++key)
+        survivors += cache.contains(key);
+    QVERIFY2(survivors > Capacity * 9 / 10, QByteArray::number(survivors));
+    QVERIFY(cache.statistics().rejections > 0);
+
+    // a plain LRU cache keeps none of it
+    QCache<int, int> lru(Capacity);
+    for (int round = 0; round < 4; ++round) {
+        for (int key = 0; key < Capacity; ++key)
+            lru.insert(key, new int(key));
+    }
+    for (int key = 1000; key < 1000 + 3 * Capacity; ++key)
+        lru.insert(key, new int(key));
+    for (int key = 0; key < Capacity; ++key)
+        QVERIFY(!lru.contains(key));
+}
+
+void tst_QConcurrentCache::sketchGrowth()
+{
+    QtPrivate::QFrequencySketch sketch;
+    sketch.ensureCapacity(8);
+    const size_t seed = QHashSeed::globalSeed();
+    for (int key = 0; key < 8; ++key) {
+        for (int i = 0; i <= key; ++i)
+            sketch.increment(qHash(key, seed));
+    }
+    QList<int> before;
+    for (int key = 0; key < 8; ++key)
+        before.append(sketch.frequency(qHash(key, seed)));
+    QCOMPARE_GE(before.at(7), 8);
+
+    // growing keeps what was recorded while the cache was warming up
+    sketch.ensureCapacity(1000);
+    for (int key = 0; key < 8; ++key)
+        QCOMPARE(sketch.frequency(qHash(key, seed)), before.at(key));
+}
+
+void tst_QConcurrentCache::statistics()
+{
+    QConcurrentCache<int, int> cache(2, 1);
+    QVERIFY(cache.insert(1, 1));
+    QVERIFY(cache.insert(2, 2));
+    QVERIFY(cache.object(1));
+    QVERIFY(cache.object(1));
+    QVERIFY(!cache.object(3));
+    QVERIFY(!cache.object(3));
+    QVERIFY(!cache.object(3));
+    // 3 was asked for more often than 2, the least recently used entry
+    QVERIFY(cache.insert(3, 3));
+    // 4 was not
+    QVERIFY(!cache.insert(4, 4));
+
+    QConcurrentCache<int, int>::Statistics stats = cache.statistics();
+    QCOMPARE(stats.hits, 2u);
+    QCOMPARE(stats.misses, 3u);
+    QCOMPARE(stats.insertions, 3u);
+    QCOMPARE(stats.rejections, 1u);
+    QCOMPARE(stats.evictions, 1u);
+    QVERIFY(cache.contains(1));
+    QVERIFY(!cache.contains(2));
+    QVERIFY(cache.contains(3));
+
+    cache.resetStatistics();
+    stats = cache.statistics();
+    QCOMPARE(stats.hits + stats.misses + stats.insertions + stats.rejections + stats.evictions,
+             0u);
+}
+
+void tst_QConcurrentCache::concurrentAccess()
+{
+    constexpr int ThreadCount = 4;
+    constexpr int Iterations = 20000;
+    constexpr int KeyRange = 2000;
+    QConcurrentCache<int, QByteArray> cache(500, 8);
+
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int t = 0; t < ThreadCount; ++t) {
+        threads.emplace_back(QThread::create([&cache, t] {
+            quint32 state = 1 + t;
+            for (int i = 0; i < Iterations; ++i) {
+                state = state * 1664525u + 1013904223u;
+                // skewed towards small keys
+                const int key = int((state >> 8) % KeyRange * ((state >> 20) % KeyRange)
+                                    / KeyRange);
+                if (std::optional<QByteArray> value = cache.object(key)) {
+                    if (*value != QByteArray::number(key))
+                        qFatal("wrong value for key %d", key);
+                } else {
+                    cache.insert(key, QByteArray::number(key), 1 + key % 3);
+                }
+                if (i % 1000 == 0)
+                    cache.remove(key);
+            }
+        }));
+        threads.back()->start();
+    }
+    for (const auto &thread : threads)
+        QVERIFY(thread->wait());
+
+    QVERIFY(cache.totalCost() <= cache.maxCost());
+    const auto stats = cache.statistics();
+    QCOMPARE(stats.hits + stats.misses, quint64(ThreadCount * Iterations));
+    QVERIFY(stats.hits > 0);
+}
+
+QTEST_APPLESS_MAIN(tst_QConcurrentCache)
+#include "tst_qconcurrentcache.moc"
@@ -0,0 +1,296 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QAtomicInt>
+#include <QColorSpace>
+#include <QDir>
+#include <QImage>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <private/qimagecache_p.h>
+
+#include <memory>
+#include <vector>
+
+using namespace Qt::StringLiterals;
+
+class tst_QImageCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void insertFind();
+    void cost();
+    void evictLeastRecentlyUsed();
+    void replace();
+    void tooLarge();
+    void remove();
+    void spill_data();
+    void spill();
+    void maxSpillSize();
+    void findOrInsertOnce();
+    void memoryPressure();
+};
+
+static QImage testImage(int width, int height, QImage::Format format = QImage::Format_ARGB32)
+{
+    QImage image(width, height, format);
+    // a color table on a grayscale image would only add to its cost
+    if (image.colorCount() == 0 && image.depth() <= 8 && image.format() != QImage::Format_Grayscale8) {
+        for (int i = 0; i < (1 << image.depth()); ++i)
+            image.setColor(i, qRgb(i * 3, 255 - i, i * 7));
+    }
+    for (int y = 0; y < height; ++y) {
+        uchar *line = image.scanLine(y);
+        for (qsizetype i = 0; i < image.bytesPerLine(); ++i)
+            line[i] = uchar(i * 13 + y * 7);
+    }
+    return image;
+}
+
+void tst_QImageCache::insertFind()
+{
+    QImageCache cache;
+    const QImage image = testImage(20, 10);
+    QVERIFY(cache.insert(u"a"_s, image));
+    QVERIFY(cache.contains(u"a"_s));
+    QVERIFY(!cache.contains(u"b"_s));
+    QCOMPARE(cache.find(u"a"_s), image);
+    QVERIFY(cache.find(u"b"_s).isNull());
+    QCOMPARE(cache.count(), 1);
+
+    // the cached image shares its data with the inserted one
+    QCOMPARE(cache.find(u"a"_s).cacheKey(), image.cacheKey());
+
+    const QImageCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.hits, 2u);
+    QCOMPARE(statistics.misses, 1u);
+    QCOMPARE(statistics.insertions, 1u);
+    QVERIFY(!cache.insert(u"null"_s, QImage()));
+}
+
+void tst_QImageCache::cost()
+{
+    const QImage rgb = testImage(33, 17, QImage::Format_RGB32);
+    QCOMPARE(QImageCache::cost(rgb), rgb.sizeInBytes());
+    const QImage indexed = testImage(33, 17, QImage::Format_Indexed8);
+    QCOMPARE(QImageCache::cost(indexed), indexed.sizeInBytes() + 256 * 4);
+
+    QImageCache cache;
+    cache.insert(u"rgb"_s, rgb);
+    cache.insert(u"indexed"_s, indexed);
+    QCOMPARE(cache.totalCost(), QImageCache::cost(rgb) + QImageCache::cost(indexed));
+    cache.remove(u"rgb"_s);
+    QCOMPARE(cache.totalCost(), QImageCache::cost(indexed));
+}
+
+void tst_QImageCache::evictLeastRecentlyUsed()
+{
+    // room for three 100x100 ARGB32 images
+    QImageCache cache(3 * 100 * 100 * 4);
+    for (int i = 0; i < 3; ++i)
+        QVERIFY(cache.insert(QString::number(i), testImage(100, 100)));
+
+    QVERIFY(!cache.find(u"0"_s).isNull());
+    QVERIFY(cache.insert(u"3"_s, testImage(100, 100)));
+    QVERIFY(cache.contains(u"0"_s));
+    QVERIFY(!cache.contains(u"1"_s));
+    QVERIFY(cache.contains(u"2"_s));
+    QVERIFY(cache.contains(u"3"_s));
+    QCOMPARE(cache.statistics().evictions, 1u);
+
+    cache.setMaxCost(100 * 100 * 4);
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(cache.contains(u"3"_s));
+    QCOMPARE(cache.totalCost(), 100 * 100 * 4);
+}
+
+void tst_QImageCache::replace()
+{
+    QImageCache cache;
+    cache.insert(u"a"_s, testImage(100, 100));
+    const QImage smaller = testImage(10, 10);
+    cache.insert(u"a"_s, smaller);
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.totalCost(), QImageCache::cost(smaller));
+    QCOMPARE(cache.find(u"a"_s), smaller);
+}
+
+void tst_QImageCache::tooLarge()
+{
+    QImageCache cache(1000);
+    QVERIFY(cache.insert(u"a"_s, testImage(10, 10)));
+    // like QCache, the image it would have replaced is dropped
+    QVERIFY(!cache.insert(u"a"_s, testImage(100, 100)));
+    QVERIFY(!cache.contains(u"a"_s));
+    QCOMPARE(cache.totalCost(), 0);
+}
+
+void tst_QImageCache::remove()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable(dir.errorString()));
+    QImageCache cache(100 * 100 * 4);
+    cache.setSpillDirectory(dir.path());
+    cache.insert(u"a"_s, testImage(100, 100));
+    cache.insert(u"b"_s, testImage(100, 100));
+    QVERIFY(cache.contains(u"a"_s));
+    QVERIFY(cache.spillSize() > 0);
+
+    QVERIFY(cache.remove(u"a"_s));
+    QVERIFY(!cache.remove(u"a"_s));
+    QVERIFY(!cache.contains(u"a"_s));
+    QCOMPARE(cache.spillSize(), 0);
+
+    cache.clear();
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.totalCost(), 0);
+    QVERIFY(cache.find(u"b"_s).isNull());
+}
+
+void tst_QImageCache::spill_data()
+{
+    QTest::addColumn<QImage>("image");
+
+    QTest::newRow("argb32") << testImage(123, 45, QImage::Format_ARGB32);
+    QTest::newRow("rgb888") << testImage(77, 31, QImage::Format_RGB888);
+    QTest::newRow("indexed8") << testImage(55, 29, QImage::Format_Indexed8);
+    QTest::newRow("mono") << testImage(61, 13, QImage::Format_Mono);
+    QTest::newRow("rgba64") << testImage(19, 23, QImage::Format_RGBA64);
+    QTest::newRow("grayscale16") << testImage(41, 7, QImage::Format_Grayscale16);
+
+    QImage metadata = testImage(64, 64, QImage::Format_RGB32);
+    metadata.setDevicePixelRatio(2);
+    metadata.setDotsPerMeterX(5000);
+    metadata.setDotsPerMeterY(4000);
+    metadata.setOffset(QPoint(3, -4));
+    metadata.setText(u"Title"_s, u"Spilled"_s);
+    metadata.setColorSpace(QColorSpace::DisplayP3);
+    QTest::newRow("metadata") << metadata;
+}
+
+void tst_QImageCache::spill()
+{
+    QFETCH(QImage, image);
+
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable(dir.errorString()));
+    QImageCache cache(QImageCache::cost(image));
+    cache.setSpillDirectory(dir.path());
+    QCOMPARE(cache.spillDirectory(), dir.path());
+
+    QVERIFY(cache.insert(u"spilled"_s, image));
+    QVERIFY(cache.insert(u"other"_s, testImage(4, 4, QImage::Format_Grayscale8)));
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(cache.contains(u"spilled"_s));
+    QCOMPARE(cache.statistics().spills, 1u);
+    QVERIFY(cache.spillSize() > 0);
+
+    const QImage restored = cache.find(u"spilled"_s);
+    QCOMPARE(restored, image);
+    QCOMPARE(restored.format(), image.format());
+    QCOMPARE(restored.colorTable(), image.colorTable());
+    QCOMPARE(restored.devicePixelRatio(), image.devicePixelRatio());
+    QCOMPARE(restored.dotsPerMeterX(), image.dotsPerMeterX());
+    QCOMPARE(restored.dotsPerMeterY(), image.dotsPerMeterY());
+    QCOMPARE(restored.offset(), image.offset());
+    QCOMPARE(restored.text(), image.text());
+    QCOMPARE(restored.colorSpace(), image.colorSpace());
+    QCOMPARE(cache.statistics().diskHits, 1u);
+
+    // read back into memory, which spilled the other image in turn
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.find(u"other"_s), testImage(4, 4, QImage::Format_Grayscale8));
+
+    // moving the cache to another directory deletes the spilled files
+    const QStringList spillDirs = QDir(dir.path()).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QCOMPARE(spillDirs.size(), 1);
+    cache.setSpillDirectory(QString());
+    QVERIFY(QDir(dir.path()).entryList(QDir::Dirs | QDir::NoDotAndDotDot).isEmpty());
+    QVERIFY(!cache.contains(u"spilled"_s));
+}
+
+void tst_QImageCache::maxSpillSize()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable(dir.errorString()));
+    QImageCache cache(64 * 64 * 4);
+    cache.setSpillDirectory(dir.path());
+    QCOMPARE(cache.maxSpillSize(), qsizetype(256) << 20);
+    for (int i = 0; i < 8; ++i)
+        QVERIFY(cache.insert(QString::number(i), testImage(64, 64)));
+    QCOMPARE(cache.statistics().spills, 7u);
+
+    const qsizetype fileSize = cache.spillSize() / 7;
+    cache.setMaxSpillSize(fileSize * 3);
+    QVERIFY(cache.spillSize() <= fileSize * 3);
+    QVERIFY(!cache.contains(u"0"_s));
+    QVERIFY(cache.contains(u"6"_s));
+    QVERIFY(cache.contains(u"7"_s));
+}
+
+void tst_QImageCache::findOrInsertOnce()
+{
+    QImageCache cache;
+    QAtomicInt produced;
+    QSemaphore started;
+    constexpr int ThreadCount = 8;
+    const QImage expected = testImage(200, 100);
+
+    std::vector<std::unique_ptr<QThread>> threads;
+    QImage results[ThreadCount];
+    for (int i = 0; i < ThreadCount; ++i) {
+        threads.emplace_back(QThread::create([&, i] {
+            started.release();
+            results[i] = cache.findOrInsert(u"shared"_s, [&] {
+                produced.ref();
+                // give the other threads time to ask for the same key
+                QThread::msleep(100);
+                return expected;
+            });
+        }));
+        threads.back()->start();
+    }
+    for (const auto &thread : threads)
+        QVERIFY(thread->wait());
+
+    QCOMPARE(produced.loadRelaxed(), 1);
+    for (const QImage &result : results)
+        QCOMPARE(result, expected);
+    QCOMPARE(cache.statistics().misses, 1u);
+
+    // a producer that fails caches nothing, and the next caller tries again
+    QVERIFY(cache.findOrInsert(u"failed"_s, [] { return QImage(); }).isNull());
+    QVERIFY(!cache.contains(u"failed"_s));
+    QCOMPARE(cache.findOrInsert(u"failed"_s, [&] { return expected; }), expected);
+}
+
+void tst_QImageCache::memoryPressure()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable(dir.errorString()));
+    QImageCache cache(4 * 50 * 50 * 4);
+    cache.setSpillDirectory(dir.path());
+    for (int i = 0; i < 4; ++i)
+        cache.insert(QString::number(i), testImage(50, 50));
+
+    QImageCache::notifyMemoryPressure(QImageCache::MemoryPressure::Moderate);
+    QCOMPARE(cache.totalCost(), 2 * 50 * 50 * 4);
+    QVERIFY(cache.contains(u"2"_s));
+    QVERIFY(cache.contains(u"0"_s)); // spilled
+    QCOMPARE(cache.statistics().spills, 2u);
+
+    QCOMPARE(cache.trim(50 * 50 * 4), 50 * 50 * 4);
+
+    cache.handleMemoryPressure(QImageCache::MemoryPressure::Critical);
+    QCOMPARE(cache.totalCost(), 0);
+    QCOMPARE(cache.count(), 0);
+    QVERIFY(!cache.contains(u"3"_s));
+    QCOMPARE(cache.statistics().spills, 3u);
+    QCOMPARE(cache.find(u"0"_s), testImage(50, 50));
+}
+
+QTEST_MAIN(tst_QImageCache)
+#include "tst_qimagecache.moc"
@@ -0,0 +1,289 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QBuffer>
+#include <QImage>
+#include <QImageReader>
+#include <QMutex>
+#include <QScopeGuard>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <QThreadPool>
+
+#include <private/qimagedecodequeue_p.h>
+
+#include <memory>
+
+using namespace Qt::StringLiterals;
+
+class tst_QImageDecodeQueue : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void decodeFiles();
+    void decodeDevice();
+    void unreadable();
+    void priority();
+    void cancel();
+    void memoryBudget();
+    void memoryBudgetUnscaledDecode();
+
+private:
+    QString fileName(int i) const { return m_dir.filePath(QString::number(i) + u".png"_s); }
+
+    QTemporaryDir m_dir;
+    static constexpr int ImageCount = 24;
+};
+
+static QImage testImage(int i)
+{
+    QImage image(40 + i * 7, 30 + i * 3, i % 3 ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixel(x, y, qRgba(x * 3 + i, y * 5, (x + y) & 0xff, 255 - i));
+    }
+    return image;
+}
+
+// Blocks the single thread of a pool, so that requests stay pending
+// until release() is called.
+class PoolBlocker
+{
+public:
+    explicit PoolBlocker(QThreadPool *pool)
+    {
+        // shared with the task, which may still be returning from
+        // acquire() when the blocker is destroyed
+        pool->start([started = m_started, release = m_release] {
+            started->release();
+            release->acquire();
+        });
+        m_started->acquire();
+    }
+    ~PoolBlocker() { release(); }
+    void release()
+    {
+        if (!m_released) {
+            m_released = true;
+            m_release->release();
+        }
+    }
+
+private:
+    std::shared_ptr<QSemaphore> m_started = std::make_shared<QSemaphore>();
+    std::shared_ptr<QSemaphore> m_release = std::make_shared<QSemaphore>();
+    bool m_released = false;
+};
+
+// Stops the first read past a given offset until the gate is released, so
+// that a test can see how far a decode got.
+class GatedBuffer : public QBuffer
+{
+public:
+    GatedBuffer(const QByteArray &data, qint64 gateOffset, QSemaphore *reached, QSemaphore *gate)
+        : m_gateOffset(gateOffset), m_reached(reached), m_gate(gate)
+    {
+        setData(data);
+        // unbuffered, so that reading the header does not read ahead
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        if (!m_passed && pos() + maxSize > m_gateOffset) {
+            m_passed = true;
+            m_reached->release();
+            m_gate->acquire();
+        }
+        return QBuffer::readData(data, maxSize);
+    }
+
+private:
+    qint64 m_gateOffset;
+    QSemaphore *m_reached;
+    QSemaphore *m_gate;
+    bool m_passed = false;
+};
+
+void tst_QImageDecodeQueue::initTestCase()
+{
+    QVERIFY2(m_dir.isValid(), qPrintable(m_dir.errorString()));
+    for (int i = 0; i < ImageCount; ++i)
+        QVERIFY(testImage(i).save(fileName(i)));
+}
+
+void tst_QImageDecodeQueue::decodeFiles()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    QImageDecodeQueue queue(&pool);
+    QCOMPARE(queue.threadPool(), &pool);
+    QCOMPARE(queue.maxThreadCount(), 4);
+
+    const QSize targetSize(64, 64);
+    QList<QFuture<QImage>> futures;
+    for (int i = 0; i < ImageCount; ++i)
+        futures.append(queue.decode(fileName(i), targetSize, QImage::Format_ARGB32_Premultiplied));
+
+    for (int i = 0; i < ImageCount; ++i) {
+        const QImage image = futures.at(i).result();
+        QCOMPARE(image.format(), QImage::Format_ARGB32_Premultiplied);
+
+        QImageReader reader(fileName(i));
+        const QSize size = reader.size();
+        if (size.width() > targetSize.width() || size.height() > targetSize.height())
+            reader.setScaledSize(size.scaled(targetSize, Qt::KeepAspectRatio));
+        QCOMPARE(image, reader.read().convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    }
+    QVERIFY(queue.waitForDone());
+    QCOMPARE(queue.pendingCount(), 0);
+}
+
+void tst_QImageDecodeQueue::decodeDevice()
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(testImage(3).save(&buffer, "png"));
+    buffer.close();
+
+    QImageDecodeQueue queue;
+    const QImage image = queue.decode(&buffer).result();
+    QCOMPARE(image, testImage(3));
+}
+
+void tst_QImageDecodeQueue::unreadable()
+{
+    QByteArray data("This is not an image");
+    QBuffer buffer(&data);
+
+    QImageDecodeQueue queue;
+    QFuture<QImage> fromDevice = queue.decode(&buffer);
+    QFuture<QImage> fromFile = queue.decode(m_dir.filePath(u"missing.png"_s));
+    QVERIFY(fromDevice.result().isNull());
+    QVERIFY(fromFile.result().isNull());
+    QVERIFY(!fromDevice.isCanceled());
+}
+
+void tst_QImageDecodeQueue::priority()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    QImageDecodeQueue queue(&pool);
+
+    QMutex mutex;
+    QList<int> order;
+    {
+        PoolBlocker blocker(&pool);
+        const int priorities[] = { 0, 5, 1, 5, -3, 2 };
+        for (int i = 0; i < int(std::size(priorities)); ++i) {
+            queue.decode(fileName(i), QSize(), QImage::Format_Invalid, priorities[i])
+                    .then(QtFuture::Launch::Sync, [&mutex, &order, i](const QImage &) {
+                        QMutexLocker locker(&mutex);
+                        order.append(i);
+                    });
+        }
+        QCOMPARE(queue.pendingCount(), 6);
+    }
+    QVERIFY(queue.waitForDone());
+    QCOMPARE(order, QList<int>({ 1, 3, 5, 2, 0, 4 }));
+}
+
+void tst_QImageDecodeQueue::cancel()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    QImageDecodeQueue queue(&pool);
+
+    QFuture<QImage> canceled;
+    QFuture<QImage> cleared;
+    QFuture<QImage> decoded;
+    {
+        PoolBlocker blocker(&pool);
+        canceled = queue.decode(fileName(0));
+        decoded = queue.decode(fileName(1));
+        canceled.cancel();
+        blocker.release();
+        QVERIFY(queue.waitForDone());
+
+        PoolBlocker secondBlocker(&pool);
+        cleared = queue.decode(fileName(2));
+        QCOMPARE(queue.pendingCount(), 1);
+        queue.clear();
+        QCOMPARE(queue.pendingCount(), 0);
+    }
+    QVERIFY(queue.waitForDone());
+
+    QVERIFY(canceled.isCanceled());
+    QVERIFY(canceled.isFinished());
+    QCOMPARE(canceled.resultCount(), 0);
+    QVERIFY(cleared.isCanceled());
+    QVERIFY(cleared.isFinished());
+    QCOMPARE(decoded.result(), testImage(1));
+}
+
+void tst_QImageDecodeQueue::memoryBudget()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    QImageDecodeQueue queue(&pool);
+    // smaller than any of the images, so that they are decoded one at a time
+    queue.setMemoryBudget(16);
+    QCOMPARE(queue.memoryBudget(), qsizetype(16));
+
+    QList<QFuture<QImage>> futures;
+    for (int i = 0; i < ImageCount; ++i)
+        futures.append(queue.decode(fileName(i)));
+    for (int i = 0; i < ImageCount; ++i)
+        QCOMPARE(futures.at(i).result(), testImage(i));
+}
+
+void tst_QImageDecodeQueue::memoryBudgetUnscaledDecode()
+{
+    // BMP cannot decode at a smaller size, so a thumbnail still takes the
+    // memory of the whole image while it is decoded.
+    QImage image(1024, 1024, QImage::Format_RGB32);
+    image.fill(Qt::darkCyan);
+    QByteArray data;
+    {
+        QBuffer buffer(&data);
+        QVERIFY(buffer.open(QIODevice::WriteOnly));
+        QVERIFY(image.save(&buffer, "BMP"));
+    }
+    QBuffer probeBuffer(&data);
+    QImageReader probe(&probeBuffer, "bmp");
+    QVERIFY(probe.canRead());
+    QVERIFY(!probe.supportsOption(QImageIOHandler::ScaledSize));
+
+    QSemaphore reached;
+    QSemaphore gate;
+    GatedBuffer first(data, data.size() / 2, &reached, &gate);
+    GatedBuffer second(data, data.size() / 2, &reached, &gate);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    QImageDecodeQueue queue(&pool);
+    // room for two thumbnails, but not for two whole images
+    queue.setMemoryBudget(qsizetype(image.sizeInBytes()) * 3 / 2);
+    // let the decodes finish if the test fails, before the queue waits for them
+    auto releaseGate = qScopeGuard([&gate] { gate.release(2); });
+    const QFuture<QImage> firstImage = queue.decode(&first, QSize(64, 64));
+    const QFuture<QImage> secondImage = queue.decode(&second, QSize(64, 64));
+
+    // One of them is decoding, and the other waits for its memory
+    QVERIFY(reached.tryAcquire(1, 10000));
+    QVERIFY(!reached.tryAcquire(1, 300));
+    gate.release();
+    QVERIFY(reached.tryAcquire(1, 10000));
+    gate.release();
+    releaseGate.dismiss();
+
+    QCOMPARE(firstImage.result().size(), QSize(64, 64));
+    QCOMPARE(secondImage.result().size(), QSize(64, 64));
+}
+
+QTEST_MAIN(tst_QImageDecodeQueue)
+#include "tst_qimagedecodequeue.moc"
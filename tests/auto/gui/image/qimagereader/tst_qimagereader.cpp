@@ -17,6 +17,8 @@
 #include <QTemporaryDir>
 #include <QTemporaryFile>
 
+#include <private/qimagereader_p.h>
+
 #include <algorithm>
 
 // #define DEBUG_WRITE_OUTPUT
@@ -71,6 +73,13 @@ private slots:
     void setScaledClipRect_data();
     void setScaledClipRect();
 
+    void clipRectOffset_data();
+    void clipRectOffset();
+
+    void scanLineCallback_data();
+    void scanLineCallback();
+    void scanLineCallbackCancel();
+
     void setFormat();
 
     void imageFormat_data();
@@ -578,6 +587,142 @@ void tst_QImageReader::setScaledClipRect()
     QCOMPARE(originalImage.copy(newRect), image);
 }
 
+static QByteArray generatedPng(QImage::Format format)
+{
+    QImage image(45, 37, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixel(x, y, qRgb(x * 5, y * 7, (x * y) & 0xff));
+    }
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, "png");
+    if (!writer.write(image.convertToFormat(format)))
+        return QByteArray();
+    return data;
+}
+
+void tst_QImageReader::clipRectOffset_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QRect>("clipRect");
+
+    const auto file = [this](const QString &fileName) {
+        QFile file(prefix + fileName);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    };
+
+    QTest::newRow("PNG: kollada") << file("kollada.png") << QRect(13, 21, 50, 50);
+    QTest::newRow("PNG: kollada, full width") << file("kollada.png") << QRect(0, 21, 436, 50);
+    QTest::newRow("PNG: kollada, bottom") << file("kollada.png") << QRect(100, 110, 500, 500);
+    QTest::newRow("PNG: kollada-16bpc") << file("kollada-16bpc.png") << QRect(13, 21, 50, 50);
+    QTest::newRow("PNG: basn0g16") << file("basn0g16.png") << QRect(3, 5, 17, 11);
+    QTest::newRow("PNG: basn4a16") << file("basn4a16.png") << QRect(3, 5, 17, 11);
+    QTest::newRow("PNG: interlaced") << file("txts.png") << QRect(13, 21, 50, 30);
+    QTest::newRow("PNG: Mono") << generatedPng(QImage::Format_Mono) << QRect(16, 3, 20, 20);
+    QTest::newRow("PNG: Mono, unaligned") << generatedPng(QImage::Format_Mono) << QRect(5, 3, 20, 20);
+    QTest::newRow("PNG: Indexed8") << generatedPng(QImage::Format_Indexed8) << QRect(5, 3, 20, 20);
+    QTest::newRow("PNG: Grayscale8") << generatedPng(QImage::Format_Grayscale8) << QRect(5, 3, 20, 20);
+    QTest::newRow("PNG: RGB32") << generatedPng(QImage::Format_RGB32) << QRect(5, 3, 20, 20);
+
+    if (QImageReader::supportedImageFormats().contains("jpeg")) {
+        QTest::newRow("JPEG: beavis") << file("beavis.jpg") << QRect(13, 21, 50, 50);
+        QTest::newRow("JPEG: beavis, iMCU aligned") << file("beavis.jpg") << QRect(16, 32, 48, 64);
+        QTest::newRow("JPEG: YCbCr_rgb") << file("YCbCr_rgb.jpg") << QRect(9, 17, 40, 20);
+        QTest::newRow("JPEG: YCbCr_cmyk") << file("YCbCr_cmyk.jpg") << QRect(9, 17, 40, 20);
+    }
+}
+
+void tst_QImageReader::clipRectOffset()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QRect, clipRect);
+    QVERIFY(!data.isEmpty());
+
+    QBuffer buffer(&data);
+    QImageReader reader(&buffer);
+    reader.setClipRect(clipRect);
+    const QImage image = reader.read();
+    QVERIFY2(!image.isNull(), qPrintable(reader.errorString()));
+
+    buffer.seek(0);
+    QImageReader originalReader(&buffer);
+    const QImage originalImage = originalReader.read();
+    QVERIFY(!originalImage.isNull());
+    QCOMPARE(image, originalImage.copy(clipRect.intersected(originalImage.rect())));
+}
+
+void tst_QImageReader::scanLineCallback_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<QRect>("clipRect");
+    QTest::addColumn<QSize>("scaledSize");
+
+    QTest::newRow("PNG") << "kollada.png" << QRect() << QSize();
+    QTest::newRow("PNG, clipped") << "kollada.png" << QRect(13, 21, 50, 50) << QSize();
+    QTest::newRow("PNG, interlaced") << "txts.png" << QRect() << QSize();
+    if (QImageReader::supportedImageFormats().contains("jpeg")) {
+        QTest::newRow("JPEG") << "beavis.jpg" << QRect() << QSize();
+        QTest::newRow("JPEG, clipped") << "beavis.jpg" << QRect(13, 21, 50, 50) << QSize();
+        QTest::newRow("JPEG, scaled") << "beavis.jpg" << QRect() << QSize(37, 19);
+    }
+}
+
+void tst_QImageReader::scanLineCallback()
+{
+    QFETCH(QString, fileName);
+    QFETCH(QRect, clipRect);
+    QFETCH(QSize, scaledSize);
+
+    QImageReader reader(prefix + fileName);
+    reader.setClipRect(clipRect);
+    reader.setScaledSize(scaledSize);
+
+    // each row is reported once, in order, and holds its final pixels
+    QList<QByteArray> rows;
+    const QImageReaderScanLineScope scope(&reader,
+            [&rows](const QImage &image, int firstLine, int lineCount) {
+                if (firstLine != rows.size())
+                    return false;
+                for (int y = firstLine; y < firstLine + lineCount; ++y) {
+                    const qsizetype size = qsizetype(image.width()) * image.depth() / 8;
+                    rows.append(QByteArray(reinterpret_cast<const char *>(image.constScanLine(y)), size));
+                }
+                return true;
+            });
+
+    const QImage image = reader.read();
+    QVERIFY2(!image.isNull(), qPrintable(reader.errorString()));
+    QCOMPARE(rows.size(), image.height());
+    for (int y = 0; y < image.height(); ++y) {
+        const QByteArray row(reinterpret_cast<const char *>(image.constScanLine(y)), rows.at(y).size());
+        QCOMPARE(rows.at(y), row);
+    }
+}
+
+void tst_QImageReader::scanLineCallbackCancel()
+{
+    QImageReader reader(prefix + "kollada.png");
+    int reportedLines = 0;
+    QImage image;
+    {
+        const QImageReaderScanLineScope scope(&reader,
+                [&reportedLines](const QImage &, int, int lineCount) {
+                    reportedLines += lineCount;
+                    return reportedLines < 10;
+                });
+        QVERIFY(!reader.read(&image));
+    }
+    QCOMPARE(reportedLines, 10);
+    QCOMPARE(reader.error(), QImageReader::InvalidDataError);
+
+    // the callback only applies within the scope
+    QImageReader other(prefix + "kollada.png");
+    QVERIFY(other.read(&image));
+    QCOMPARE(reportedLines, 10);
+}
+
 void tst_QImageReader::setFormat()
 {
     QByteArray ppmImage = "P1 2 2\n1 0\n0 1";
@@ -1703,6 +1848,7 @@ void tst_QImageReader::supportsOption_data()
                                 QImageIOHandler::CompressionRatio,
                                 QImageIOHandler::Size,
                                 QImageIOHandler::ImageFormat,
+                                QImageIOHandler::ClipRect,
                             };
 }
 
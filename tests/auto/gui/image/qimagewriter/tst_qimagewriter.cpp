@@ -7,6 +7,7 @@
 #include <QImage>
 #include <QImageReader>
 #include <QImageWriter>
+#include <QBuffer>
 #include <QPainter>
 #include <QSet>
 #include <QTemporaryDir>
@@ -59,6 +60,9 @@ private slots:
 
     void writeEmpty();
 
+    void pngCompression_data();
+    void pngCompression();
+
 private:
     QTemporaryDir m_temporaryDir;
     QString prefix;
@@ -578,5 +582,68 @@ void tst_QImageWriter::writeEmpty()
     QVERIFY(!QFileInfo(fileName).exists());
 }
 
+void tst_QImageWriter::pngCompression_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("compression");
+
+    // The large images are compressed in strips on several threads.
+    const QImage::Format formats[] = {
+        QImage::Format_RGB32, QImage::Format_ARGB32, QImage::Format_ARGB32_Premultiplied,
+        QImage::Format_RGB888, QImage::Format_BGR888, QImage::Format_RGBX8888,
+        QImage::Format_RGBA8888, QImage::Format_Grayscale8, QImage::Format_RGBA64,
+    };
+    const QSize sizes[] = { QSize(97, 61), QSize(1201, 1033) };
+    for (QImage::Format format : formats) {
+        for (const QSize &size : sizes) {
+            for (int compression : { 0, 20, 50, 100 }) {
+                QTest::addRow("%d-%dx%d-%d", int(format), size.width(), size.height(), compression)
+                        << format << size << compression;
+            }
+        }
+    }
+}
+
+void tst_QImageWriter::pngCompression()
+{
+    QFETCH(QImage::Format, format);
+    QFETCH(QSize, size);
+    QFETCH(int, compression);
+
+    // flat areas, gradients and noise, so that every filter gets picked
+    QImage image(size, QImage::Format_ARGB32);
+    quint32 noise = 4711;
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            noise = noise * 1103515245 + 12345;
+            if (y < image.height() / 3)
+                line[x] = qRgba(x / 64 * 40, 90, y / 16 * 8, 255);
+            else if (x < image.width() / 2)
+                line[x] = qRgba(x & 0xff, y & 0xff, (x + y) & 0xff, (x * 3) & 0xff);
+            else
+                line[x] = qRgba(noise >> 8, noise >> 16, noise >> 24, 200 + (x & 0x1f));
+        }
+    }
+    image.convertTo(format);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, "png");
+    writer.setCompression(compression);
+    QVERIFY2(writer.write(image), qPrintable(writer.errorString()));
+
+    QImage read = QImage::fromData(data, "png");
+    QVERIFY(!read.isNull());
+    QCOMPARE(read.size(), image.size());
+    if (image.format() == QImage::Format_ARGB32_Premultiplied)
+        image.convertTo(QImage::Format_ARGB32);
+    else if (image.format() == QImage::Format_RGBA64)
+        read.convertTo(QImage::Format_RGBA64);
+    QCOMPARE(read.convertToFormat(image.format()), image);
+}
+
 QTEST_MAIN(tst_QImageWriter)
 #include "tst_qimagewriter.moc"
@@ -42,6 +42,10 @@ private slots:
     void infiniteLoop();
 #endif
     void emptyMovie();
+    void cacheAll_data();
+    void cacheAll();
+    void updatedRect_data();
+    void updatedRect();
     void bindings();
     void automatedBindings();
 #ifndef QT_NO_ICO
@@ -227,6 +231,101 @@ void tst_QMovie::emptyMovie()
     QCOMPARE(movie.currentFrameNumber(), -1);
 }
 
+void tst_QMovie::cacheAll_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<QByteArray>("cacheLimit");
+#ifdef QTEST_HAVE_GIF
+    QTest::newRow("comicsecard") << QString("animations/comicsecard.gif") << QByteArray();
+    QTest::newRow("trolltech") << QString("animations/trolltech.gif") << QByteArray();
+    // keep no decoded frames, so that all are composed from compressed ones
+    QTest::newRow("trolltech, compressed") << QString("animations/trolltech.gif") << QByteArray("0");
+#endif
+}
+
+void tst_QMovie::cacheAll()
+{
+    QFETCH(QString, fileName);
+    QFETCH(QByteArray, cacheLimit);
+
+    QList<QImage> frames;
+    QMovie uncached(QFINDTESTDATA(fileName));
+    const int frameCount = uncached.frameCount();
+    QVERIFY(frameCount > 0);
+    for (int i = 0; i < frameCount; ++i) {
+        QVERIFY(uncached.jumpToFrame(i));
+        frames.append(uncached.currentImage());
+    }
+
+    if (!cacheLimit.isEmpty())
+        qputenv("QT_MOVIE_CACHE_LIMIT", cacheLimit);
+    QMovie movie(QFINDTESTDATA(fileName));
+    qunsetenv("QT_MOVIE_CACHE_LIMIT");
+    movie.setCacheMode(QMovie::CacheAll);
+
+    for (int i = 0; i < frameCount; ++i) {
+        QVERIFY(movie.jumpToFrame(i));
+        QCOMPARE(movie.currentImage(), frames.at(i));
+    }
+    // jump around, so that frames are also composed from other key frames
+    for (int i : { 0, frameCount - 1, 1, frameCount / 2, frameCount / 2 + 1, 2 }) {
+        i = qMin(i, frameCount - 1);
+        QVERIFY(movie.jumpToFrame(i));
+        QCOMPARE(movie.currentImage(), frames.at(i));
+    }
+}
+
+void tst_QMovie::updatedRect_data()
+{
+    cacheAll_data();
+}
+
+void tst_QMovie::updatedRect()
+{
+    QFETCH(QString, fileName);
+    QFETCH(QByteArray, cacheLimit);
+
+    for (QMovie::CacheMode cacheMode : { QMovie::CacheNone, QMovie::CacheAll }) {
+        if (!cacheLimit.isEmpty())
+            qputenv("QT_MOVIE_CACHE_LIMIT", cacheLimit);
+        QMovie movie(QFINDTESTDATA(fileName));
+        qunsetenv("QT_MOVIE_CACHE_LIMIT");
+        movie.setCacheMode(cacheMode);
+        QSignalSpy updatedSpy(&movie, &QMovie::updated);
+
+        QImage previous;
+        for (int i = 0; i < movie.frameCount(); ++i) {
+            QVERIFY(movie.jumpToFrame(i));
+            const QImage current = movie.currentImage();
+            // nothing is emitted for a frame that equals the previous one
+            if (updatedSpy.isEmpty()) {
+                QCOMPARE(cacheMode, QMovie::CacheAll);
+                QCOMPARE(current, previous);
+                continue;
+            }
+            QCOMPARE(updatedSpy.size(), 1);
+            const QRect rect = updatedSpy.takeFirst().at(0).toRect();
+            QVERIFY(!rect.isEmpty());
+            if (previous.isNull() || cacheMode == QMovie::CacheNone) {
+                QCOMPARE(rect, current.rect());
+            } else {
+                QVERIFY(current.rect().contains(rect));
+                // outside of the updated rect, nothing may have changed
+                QImage masked = current.copy();
+                QImage previousMasked = previous.copy();
+                for (int y = rect.top(); y <= rect.bottom(); ++y) {
+                    for (int x = rect.left(); x <= rect.right(); ++x) {
+                        masked.setPixel(x, y, 0);
+                        previousMasked.setPixel(x, y, 0);
+                    }
+                }
+                QCOMPARE(masked, previousMasked);
+            }
+            previous = current;
+        }
+    }
+}
+
 void tst_QMovie::bindings()
 {
     QMovie movie;
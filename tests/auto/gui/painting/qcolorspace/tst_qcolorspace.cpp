@@ -10,6 +10,7 @@
 #include <qrgbafloat.h>
 
 #include <private/qcolorspace_p.h>
+#include <private/qcolortransform_p.h>
 
 Q_DECLARE_METATYPE(QColorSpace::NamedColorSpace)
 Q_DECLARE_METATYPE(QColorSpace::Primaries)
@@ -49,6 +50,9 @@ private slots:
     void imageConversionOverAnyGamutFP2();
     void imageConversionOverNonThreeComponentMatrix_data();
     void imageConversionOverNonThreeComponentMatrix();
+    void imageConversionLut3D_data();
+    void imageConversionLut3D();
+    void imageConversionLut3DCmyk();
     void loadImage();
 
     void primaries();
@@ -723,6 +727,112 @@ void tst_QColorSpace::imageConversionOverNonThreeComponentMatrix()
     }
 }
 
+void tst_QColorSpace::imageConversionLut3D_data()
+{
+    QTest::addColumn<QColorSpace>("fromColorSpace");
+    QTest::addColumn<QColorSpace>("toColorSpace");
+    QTest::addColumn<bool>("usesLut3D");
+
+    QString prefix = QFINDTESTDATA("resources/");
+    QFile file1(prefix + "VideoHD.icc");
+    QFile file2(prefix + "sRGB_ICC_v4_Appearance.icc");
+    QVERIFY(file1.open(QFile::ReadOnly));
+    QVERIFY(file2.open(QFile::ReadOnly));
+    QColorSpace hdtvColorSpace = QColorSpace::fromIccProfile(file1.readAll());
+    QColorSpace srgbPcsColorSpace = QColorSpace::fromIccProfile(file2.readAll());
+
+    // The Lab connection space bends too sharply for the grid to follow it
+    QTest::newRow("sRGB PCSLab -> sRGB") << srgbPcsColorSpace << QColorSpace(QColorSpace::SRgb) << false;
+    QTest::newRow("sRGB -> sRGB PCSLab") << QColorSpace(QColorSpace::SRgb) << srgbPcsColorSpace << false;
+    QTest::newRow("HDTV -> sRGB") << hdtvColorSpace << QColorSpace(QColorSpace::SRgb) << true;
+    QTest::newRow("sRGB -> HDTV") << QColorSpace(QColorSpace::SRgb) << hdtvColorSpace << true;
+    QTest::newRow("sRGB PCSLab -> HDTV") << srgbPcsColorSpace << hdtvColorSpace << false;
+    QTest::newRow("HDTV -> sRGB PCSLab") << hdtvColorSpace << srgbPcsColorSpace << false;
+}
+
+void tst_QColorSpace::imageConversionLut3D()
+{
+    QFETCH(QColorSpace, fromColorSpace);
+    QFETCH(QColorSpace, toColorSpace);
+    QFETCH(bool, usesLut3D);
+
+    // Matrix-shaper transforms are computed directly
+    QColorTransform matrixTransform = QColorSpace(QColorSpace::SRgb).transformationToColorSpace(QColorSpace::DisplayP3);
+    QVERIFY(!QColorTransformPrivate::get(matrixTransform)->prepareLut3D());
+
+    // Images are baked into a table from a size on, single rows never are.
+    QVERIFY(QColorTransformPrivate::shouldUseLut3D(512 * 256));
+    QVERIFY(!QColorTransformPrivate::shouldUseLut3D(512));
+
+    QImage testImage(512, 256, QImage::Format_ARGB32);
+    testImage.setColorSpace(fromColorSpace);
+    for (int y = 0; y < 256; ++y) {
+        for (int x = 0; x < 512; ++x) {
+            testImage.setPixel(x, y, qRgba(x & 0xff, y, (x * 7 + y * 13 + (x >> 8) * 128) & 0xff,
+                                           y < 128 ? 255 : x | 1));
+        }
+    }
+
+    const QImage::Format formats[] = { QImage::Format_RGB32, QImage::Format_ARGB32,
+                                       QImage::Format_ARGB32_Premultiplied, QImage::Format_RGBA64 };
+    for (QImage::Format format : formats) {
+        const QImage source = testImage.convertToFormat(format);
+        const QColorTransform transform = fromColorSpace.transformationToColorSpace(toColorSpace);
+        QCOMPARE(QColorTransformPrivate::get(transform)->prepareLut3D(), usesLut3D);
+        const QImage baked = source.colorTransformed(transform);
+
+        // The colors are compared premultiplied, the way they are drawn, so
+        // that rounding of the premultiplied formats is not magnified.
+        int maxError = 0;
+        for (int y = 0; y < source.height(); ++y) {
+            const QImage direct = source.copy(0, y, source.width(), 1).colorTransformed(transform);
+            for (int x = 0; x < source.width(); ++x) {
+                const QRgba64 a = baked.pixelColor(x, y).rgba64().premultiplied();
+                const QRgba64 b = direct.pixelColor(x, 0).rgba64().premultiplied();
+                maxError = std::max({ maxError, qAbs(a.red() - b.red()), qAbs(a.green() - b.green()),
+                                      qAbs(a.blue() - b.blue()) });
+                QCOMPARE(a.alpha(), b.alpha());
+            }
+        }
+        // 16 bit output is never converted through the table, so only
+        // rounding differs, where a row is opaque and the image is not
+        const int tolerance = format == QImage::Format_RGBA64 ? 1 : 3 * 257;
+        QVERIFY2(maxError <= tolerance, qPrintable(QString::number(maxError / 257.0)));
+    }
+}
+
+void tst_QColorSpace::imageConversionLut3DCmyk()
+{
+    QFile file(QFINDTESTDATA("resources/CGATS001Compat-v2-micro.icc"));
+    QVERIFY(file.open(QFile::ReadOnly));
+    const QColorSpace cmykColorSpace = QColorSpace::fromIccProfile(file.readAll());
+    QVERIFY(cmykColorSpace.isValid());
+
+    QImage testImage(512, 256, QImage::Format_RGB32);
+    testImage.setColorSpace(QColorSpace::SRgb);
+    for (int y = 0; y < 256; ++y) {
+        for (int x = 0; x < 512; ++x)
+            testImage.setPixel(x, y, qRgb(x & 0xff, y, (x * 7 + y * 13 + (x >> 8) * 128) & 0xff));
+    }
+
+    // A table is only kept if it gets all four components right, K included
+    const QColorTransform transform = testImage.colorSpace().transformationToColorSpace(cmykColorSpace);
+    QColorTransformPrivate::get(transform)->prepareLut3D();
+    const QImage baked = testImage.colorTransformed(transform, QImage::Format_CMYK8888);
+    QCOMPARE(baked.format(), QImage::Format_CMYK8888);
+
+    int maxError = 0;
+    for (int y = 0; y < testImage.height(); ++y) {
+        const QImage direct = testImage.copy(0, y, testImage.width(), 1)
+                                      .colorTransformed(transform, QImage::Format_CMYK8888);
+        const uchar *a = baked.constScanLine(y);
+        const uchar *b = direct.constScanLine(0);
+        for (int i = 0; i < testImage.width() * 4; ++i)
+            maxError = std::max(maxError, qAbs(a[i] - b[i]));
+    }
+    QVERIFY2(maxError <= 3, qPrintable(QString::number(maxError)));
+}
+
 void tst_QColorSpace::loadImage()
 {
     QString prefix = QFINDTESTDATA("resources/");
@@ -0,0 +1,394 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMetaEnum>
+#include <QPainter>
+#if QT_CONFIG(process)
+#include <QProcess>
+#endif
+#include <QTemporaryDir>
+
+#include <QtCore/private/qsimd_p.h>
+
+using namespace Qt::StringLiterals;
+
+// The raster engine chooses SIMD implementations of its composition, fetch
+// and store functions at startup. This test paints the same scenes in a child
+// process that has every SIMD extension beyond the baseline of the build
+// turned off with QT_NO_CPU_FEATURE, so that it runs the generic code, and
+// compares the pixels. The images painted on and drawn are made by this
+// process and handed to the child, so that only the painting differs.
+//
+// Most combinations must give exactly the same bytes. The exceptions, listed
+// in tolerance(), are older SIMD conversions that round differently from the
+// generic ones.
+
+static constexpr char referenceDirVariable[] = "TST_QDRAWHELPER_REFERENCE_DIR";
+
+class tst_QDrawHelper : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void sameAsGeneric_data();
+    void sameAsGeneric();
+    void writeReferenceImages();
+
+private:
+    QTemporaryDir m_referenceDir;
+    QHash<QByteArray, QByteArray> m_references;
+    QString m_skipReason;
+};
+
+static const char *const compositionModeNames[] = {
+    "SourceOver", "DestinationOver", "Clear", "Source", "Destination", "SourceIn",
+    "DestinationIn", "SourceOut", "DestinationOut", "SourceAtop", "DestinationAtop", "Xor",
+    "Plus", "Multiply", "Screen", "Overlay", "Darken", "Lighten",
+    "ColorDodge", "ColorBurn", "HardLight", "SoftLight", "Difference", "Exclusion",
+};
+static_assert(std::size(compositionModeNames) == QPainter::CompositionMode_Exclusion + 1);
+
+// The extensions that the raster engine checks for at runtime, and that can be
+// turned off because the build does not require them.
+static QString extensionsAboveBaseline()
+{
+    QStringList extensions;
+#if defined(Q_PROCESSOR_X86)
+#  ifndef __SSE3__
+    extensions << u"sse3"_s;
+#  endif
+#  ifndef __SSSE3__
+    extensions << u"ssse3"_s;
+#  endif
+#  ifndef __SSE4_1__
+    extensions << u"sse4.1"_s;
+#  endif
+#  ifndef __SSE4_2__
+    extensions << u"sse4.2"_s;
+#  endif
+#  ifndef __AVX__
+    extensions << u"avx"_s;
+#  endif
+#  ifndef __F16C__
+    extensions << u"f16c"_s;
+#  endif
+#  ifndef __FMA__
+    extensions << u"fma"_s;
+#  endif
+#  ifndef __AVX2__
+    extensions << u"avx2"_s;
+#  endif
+#  ifndef __AVX512F__
+    extensions << u"avx512f"_s;
+#  endif
+#endif
+    return extensions.join(u' ');
+}
+
+// How far a channel may be off, in 16 bit precision, where one step of 8 bit
+// precision is 257; 0 requires the same bytes.
+static int tolerance(QImage::Format format, QImage::Format sourceFormat)
+{
+    switch (format) {
+    case QImage::Format_ARGB32:
+    case QImage::Format_RGBA8888:
+        // unpremultiplied with a reciprocal when stored
+        return 257;
+    case QImage::Format_RGBA16FPx4:
+        // the same, and half precision is coarse where the alpha is small,
+        // like after ColorBurn
+        return 2 * 257;
+    case QImage::Format_RGBX16FPx4:
+    case QImage::Format_RGBA16FPx4_Premultiplied:
+        // the last bit of half precision
+        return 32;
+    case QImage::Format_RGBX32FPx4:
+    case QImage::Format_RGBA32FPx4:
+    case QImage::Format_RGBA32FPx4_Premultiplied:
+        // the last bits of single precision
+        return 1;
+    default:
+        break;
+    }
+    // premultiplied with different rounding when fetched
+    if (sourceFormat == QImage::Format_ARGB32)
+        return 257;
+    return 0;
+}
+
+static QImage backgroundImage(QImage::Format format)
+{
+    // odd sizes and offsets, so that every span has an unaligned start and end
+    QImage background(67, 17, QImage::Format_RGBA64);
+    for (int y = 0; y < background.height(); ++y) {
+        for (int x = 0; x < background.width(); ++x) {
+            background.setPixelColor(x, y, QColor::fromRgba64((x * 977) & 0xffff, (y * 3931) & 0xffff,
+                                                              ((x + y) * 1009) & 0xffff,
+                                                              0xffff - ((x * y * 71) & 0xffff)));
+        }
+    }
+    return background.convertToFormat(format);
+}
+
+// What is drawn on the background, either an image or, for an invalid format,
+// solid fills.
+static const QImage::Format sourceFormats[] = {
+    QImage::Format_Invalid, QImage::Format_ARGB32_Premultiplied, QImage::Format_ARGB32,
+    QImage::Format_RGB32, QImage::Format_A2RGB30_Premultiplied, QImage::Format_RGB30,
+    QImage::Format_RGBA64_Premultiplied, QImage::Format_RGBA64, QImage::Format_Indexed8,
+    QImage::Format_RGB16, QImage::Format_RGB888, QImage::Format_RGBA16FPx4_Premultiplied,
+    QImage::Format_RGBA32FPx4_Premultiplied,
+};
+
+static QByteArray dataTag(QImage::Format format, QImage::Format sourceFormat, int mode)
+{
+    const QMetaEnum formats = QMetaEnum::fromType<QImage::Format>();
+    const QByteArray source = sourceFormat == QImage::Format_Invalid
+            ? QByteArray("Fill")
+            : QByteArray(formats.valueToKey(sourceFormat) + qstrlen("Format_"));
+    return QByteArray(formats.valueToKey(format) + qstrlen("Format_")) + '-' + source + '-'
+            + compositionModeNames[mode];
+}
+
+static QImage sourceImage(QImage::Format format)
+{
+    if (format == QImage::Format_Invalid)
+        return QImage();
+    QImage image(29, 11, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            image.setPixel(x, y, qRgba((x * 37 + y * 11) & 0xff, (x * 13 + y * 71) & 0xff,
+                                       (x * 89 + y * 5) & 0xff, ((x + y) * 23) & 0xff));
+        }
+    }
+    return image.convertToFormat(format);
+}
+
+static QImage render(const QImage &background, const QImage &source, QPainter::CompositionMode mode)
+{
+    QImage image = background.copy();
+    QPainter painter(&image);
+    painter.setCompositionMode(mode);
+    if (source.isNull()) {
+        painter.fillRect(QRect(5, 1, 59, 5), QColor(200, 120, 40, 150));
+        painter.fillRect(QRect(3, 6, 61, 3), QColor(250, 60, 10));
+        painter.setOpacity(0.6);
+        painter.fillRect(QRect(2, 8, 61, 4), QColor(20, 220, 140, 90));
+        painter.fillRect(QRect(7, 12, 50, 4), QColor(250, 60, 10));
+    } else {
+        painter.drawImage(QPoint(1, 0), source);
+        painter.drawImage(QPoint(37, 3), source);
+        painter.setOpacity(0.6);
+        painter.drawImage(QPoint(20, 6), source);
+    }
+    painter.end();
+    return image;
+}
+
+// The padding at the end of the scan lines is not written by the painting,
+// so only the pixels themselves are compared.
+static QByteArray pixelData(const QImage &image)
+{
+    const qsizetype lineSize = qsizetype(image.width()) * image.depth() / 8;
+    QByteArray data;
+    data.reserve(lineSize * image.height());
+    for (int y = 0; y < image.height(); ++y)
+        data.append(reinterpret_cast<const char *>(image.constScanLine(y)), lineSize);
+    return data;
+}
+
+static void writeImage(QDataStream &stream, const QImage &image)
+{
+    stream << int(image.format()) << image.size() << image.colorTable() << pixelData(image);
+}
+
+static QImage readImage(QDataStream &stream)
+{
+    int format;
+    QSize size;
+    QList<QRgb> colorTable;
+    QByteArray data;
+    stream >> format >> size >> colorTable >> data;
+    QImage image(size, QImage::Format(format));
+    image.setColorTable(colorTable);
+    const qsizetype lineSize = qsizetype(image.width()) * image.depth() / 8;
+    if (data.size() != lineSize * image.height())
+        return QImage();
+    for (int y = 0; y < image.height(); ++y)
+        memcpy(image.scanLine(y), data.constData() + y * lineSize, lineSize);
+    return image;
+}
+
+void tst_QDrawHelper::initTestCase()
+{
+    if (qEnvironmentVariableIsSet(referenceDirVariable))
+        return; // this is the child process
+#if !QT_CONFIG(process)
+    m_skipReason = u"This test needs QProcess"_s;
+#elif !defined(Q_PROCESSOR_X86)
+    m_skipReason = u"Only x86 chooses SIMD implementations at runtime"_s;
+#else
+    if (extensionsAboveBaseline().isEmpty()
+        || !(qCpuHasFeature(SSSE3) || qCpuHasFeature(SSE4_1) || qCpuHasFeature(AVX2))) {
+        m_skipReason = u"The SIMD code paths are the same as the generic ones here"_s;
+        return;
+    }
+
+    QVERIFY2(m_referenceDir.isValid(), qPrintable(m_referenceDir.errorString()));
+    QFile inputs(m_referenceDir.filePath(u"inputs"_s));
+    QVERIFY2(inputs.open(QIODevice::WriteOnly), qPrintable(inputs.errorString()));
+    QDataStream inputStream(&inputs);
+    for (int format = QImage::Format_RGB32; format < QImage::NImageFormats; ++format)
+        writeImage(inputStream, backgroundImage(QImage::Format(format)));
+    for (QImage::Format sourceFormat : sourceFormats)
+        writeImage(inputStream, sourceImage(sourceFormat));
+    inputs.close();
+
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(u"QT_NO_CPU_FEATURE"_s, extensionsAboveBaseline());
+    environment.insert(QLatin1StringView(referenceDirVariable), m_referenceDir.path());
+    QProcess process;
+    process.setProcessEnvironment(environment);
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(QCoreApplication::applicationFilePath(), { u"writeReferenceImages"_s });
+    QVERIFY2(process.waitForFinished(120000), qPrintable(process.errorString()));
+    const QByteArray output = process.readAll();
+    QVERIFY2(process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0,
+             output.constData());
+
+    QFile references(m_referenceDir.filePath(u"references"_s));
+    QVERIFY2(references.open(QIODevice::ReadOnly), qPrintable(references.errorString()));
+    QDataStream referenceStream(&references);
+    referenceStream >> m_references;
+    QCOMPARE(referenceStream.status(), QDataStream::Ok);
+#endif
+}
+
+void tst_QDrawHelper::sameAsGeneric_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<QImage::Format>("sourceFormat");
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<int>("tolerance");
+
+    for (int format = QImage::Format_RGB32; format < QImage::NImageFormats; ++format) {
+        for (QImage::Format sourceFormat : sourceFormats) {
+            for (int mode = 0; mode <= QPainter::CompositionMode_Exclusion; ++mode) {
+                QTest::newRow(dataTag(QImage::Format(format), sourceFormat, mode).constData())
+                        << QImage::Format(format) << sourceFormat << mode
+                        << tolerance(QImage::Format(format), sourceFormat);
+            }
+        }
+    }
+}
+
+void tst_QDrawHelper::sameAsGeneric()
+{
+    if (!m_skipReason.isEmpty())
+        QSKIP(qPrintable(m_skipReason));
+
+    QFETCH(QImage::Format, format);
+    QFETCH(QImage::Format, sourceFormat);
+    QFETCH(int, mode);
+    QFETCH(int, tolerance);
+
+    const QImage image = render(backgroundImage(format), sourceImage(sourceFormat),
+                                QPainter::CompositionMode(mode));
+    const QByteArray reference = m_references.value(QTest::currentDataTag());
+    const QByteArray actual = pixelData(image);
+    QCOMPARE(actual.size(), reference.size());
+
+    const qsizetype lineSize = qsizetype(image.width()) * image.depth() / 8;
+    const qsizetype bytesPerPixel = image.depth() / 8;
+    auto pixelMessage = [&](qsizetype start) {
+        const qsizetype pixel = start / bytesPerPixel;
+        return u"Pixel (%1, %2) differs: %3 here, %4 in the generic code"_s
+                .arg(pixel % image.width())
+                .arg(pixel / image.width())
+                .arg(QLatin1StringView(actual.mid(start, bytesPerPixel).toHex()))
+                .arg(QLatin1StringView(reference.mid(start, bytesPerPixel).toHex()));
+    };
+
+    if (tolerance == 0) {
+        for (qsizetype i = 0; i < actual.size(); ++i) {
+            if (actual.at(i) != reference.at(i))
+                QFAIL(qPrintable(pixelMessage(i - i % bytesPerPixel)));
+        }
+        return;
+    }
+
+    QImage referenceImage(image.width(), image.height(), format);
+    for (int y = 0; y < referenceImage.height(); ++y)
+        memcpy(referenceImage.scanLine(y), reference.constData() + y * lineSize, lineSize);
+
+    // compare in 16 bit precision, where one step of 8 bit precision is 257
+    const QImage actual64 = image.convertToFormat(QImage::Format_RGBA64_Premultiplied);
+    const QImage reference64 = referenceImage.convertToFormat(QImage::Format_RGBA64_Premultiplied);
+    for (int y = 0; y < actual64.height(); ++y) {
+        const QRgba64 *actualLine = reinterpret_cast<const QRgba64 *>(actual64.constScanLine(y));
+        const QRgba64 *referenceLine = reinterpret_cast<const QRgba64 *>(reference64.constScanLine(y));
+        for (int x = 0; x < actual64.width(); ++x) {
+            const QRgba64 a = actualLine[x];
+            const QRgba64 r = referenceLine[x];
+            const int difference = qMax(qMax(qAbs(a.red() - r.red()), qAbs(a.green() - r.green())),
+                                        qMax(qAbs(a.blue() - r.blue()), qAbs(a.alpha() - r.alpha())));
+            if (difference > tolerance)
+                QFAIL(qPrintable(pixelMessage(y * lineSize + x * bytesPerPixel)));
+        }
+    }
+}
+
+void tst_QDrawHelper::writeReferenceImages()
+{
+    const QString path = qEnvironmentVariable(referenceDirVariable);
+    if (path.isEmpty())
+        QSKIP("Only used by the child process started by initTestCase()");
+#ifndef __SSSE3__
+    QVERIFY2(!qCpuHasFeature(SSSE3), "QT_NO_CPU_FEATURE did not turn off SSSE3");
+#endif
+#ifndef __SSE4_1__
+    QVERIFY2(!qCpuHasFeature(SSE4_1), "QT_NO_CPU_FEATURE did not turn off SSE4.1");
+#endif
+#ifndef __AVX2__
+    QVERIFY2(!qCpuHasFeature(AVX2), "QT_NO_CPU_FEATURE did not turn off AVX2");
+#endif
+
+    QFile inputs(path + u"/inputs"_s);
+    QVERIFY2(inputs.open(QIODevice::ReadOnly), qPrintable(inputs.errorString()));
+    QDataStream inputStream(&inputs);
+    QList<QImage> backgrounds;
+    for (int format = QImage::Format_RGB32; format < QImage::NImageFormats; ++format)
+        backgrounds.append(readImage(inputStream));
+    QList<QImage> sources;
+    for (qsizetype i = 0; i < qsizetype(std::size(sourceFormats)); ++i)
+        sources.append(readImage(inputStream));
+    QCOMPARE(inputStream.status(), QDataStream::Ok);
+
+    QHash<QByteArray, QByteArray> references;
+    for (int format = QImage::Format_RGB32; format < QImage::NImageFormats; ++format) {
+        const QImage &background = backgrounds.at(format - QImage::Format_RGB32);
+        QCOMPARE(background.format(), QImage::Format(format));
+        for (qsizetype i = 0; i < sources.size(); ++i) {
+            QCOMPARE(sources.at(i).format(), sourceFormats[i]);
+            for (int mode = 0; mode <= QPainter::CompositionMode_Exclusion; ++mode) {
+                const QImage image = render(background, sources.at(i), QPainter::CompositionMode(mode));
+                references.insert(dataTag(QImage::Format(format), sourceFormats[i], mode),
+                                  pixelData(image));
+            }
+        }
+    }
+
+    QFile file(path + u"/references"_s);
+    QVERIFY2(file.open(QIODevice::WriteOnly), qPrintable(file.errorString()));
+    QDataStream stream(&file);
+    stream << references;
+    QCOMPARE(stream.status(), QDataStream::Ok);
+}
+
+QTEST_MAIN(tst_QDrawHelper)
+#include "tst_qdrawhelper.moc"
@@ -14,11 +14,13 @@
 #include <qthread.h>
 #include <limits.h>
 #include <math.h>
+#include <memory>
 #include <qpaintengine.h>
 #include <qpixmap.h>
 #include <qrandom.h>
 
 #include <private/qdrawhelper_p.h>
+#include <private/qpaintengine_raster_p.h>
 #include <qpainter.h>
 #include <qpainterpath.h>
 #include <qqueue.h>
@@ -286,6 +288,9 @@ private slots:
     void hdrColors();
 #endif
 
+    void pathCache_data();
+    void pathCache();
+
 private:
     void fillData();
     void setPenColor(QPainter& p);
@@ -5547,6 +5552,119 @@ void tst_QPainter::hdrColors()
 }
 #endif
 
+void tst_QPainter::pathCache_data()
+{
+    QTest::addColumn<bool>("antialiased");
+    QTest::addColumn<bool>("stroke");
+
+    QTest::newRow("fill, aliased") << false << false;
+    QTest::newRow("fill, antialiased") << true << false;
+    QTest::newRow("stroke, aliased") << false << true;
+    QTest::newRow("stroke, antialiased") << true << true;
+}
+
+void tst_QPainter::pathCache()
+{
+    QFETCH(bool, antialiased);
+    QFETCH(bool, stroke);
+
+    const qsizetype cachedBefore = [] {
+        QImage image(1, 1, QImage::Format_ARGB32_Premultiplied);
+        QPainter p(&image);
+        return static_cast<QRasterPaintEngine *>(p.paintEngine())->pathCacheStatistics().cachedBytes;
+    }();
+
+    const QPoint positions[] = { { 20, 20 }, { 60, 25 }, { 100, 90 }, { -15, 40 },
+                                 { 130, -10 }, { 35, 70 }, { 60, 25 } };
+    QPainterPath path;
+    path.moveTo(0, 0);
+    path.cubicTo(40, -20, 50, 30, 20, 35);
+    path.lineTo(-5, 20);
+    path.addEllipse(QRectF(3.5, 2.25, 15, 11));
+    path.setFillRule(Qt::WindingFill);
+    QPainterPath changedPath = path;
+    changedPath.lineTo(10, 40);
+
+    const auto draw = [&](QImage *image, const QPainterPath &path, bool cached) {
+        image->fill(Qt::white);
+        QPainter p(image);
+        auto *engine = static_cast<QRasterPaintEngine *>(p.paintEngine());
+        engine->setPathCacheEnabled(cached);
+        p.setRenderHint(QPainter::Antialiasing, antialiased);
+        if (stroke) {
+            p.setPen(QPen(QColor(0, 0, 255, 160), 3.5, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin));
+            p.setBrush(Qt::NoBrush);
+        } else {
+            p.setPen(Qt::NoPen);
+            p.setBrush(QColor(255, 0, 0, 128));
+        }
+        for (const QPoint &position : positions) {
+            p.setTransform(QTransform::fromTranslate(position.x(), position.y()).rotate(20));
+            p.drawPath(path);
+        }
+        // clipped, and with a scale that needs its own spans
+        p.setClipRect(30, 30, 50, 40);
+        p.setTransform(QTransform::fromTranslate(25, 25).rotate(20));
+        p.drawPath(path);
+        p.setTransform(QTransform::fromScale(1.5, 1.5));
+        p.drawPath(path);
+        p.drawPath(path);
+        return engine->pathCacheStatistics();
+    };
+
+    QImage expected(160, 120, QImage::Format_ARGB32_Premultiplied);
+    const QRasterPaintEngine::PathCacheStatistics uncachedStatistics = draw(&expected, path, false);
+    QCOMPARE(uncachedStatistics.hits, 0u);
+    QCOMPARE(uncachedStatistics.misses, 0u);
+
+    // The cache is per thread, so draw on a new one to start with an empty
+    // cache. The statistics are per engine, and an image keeps its engine,
+    // so every pass needs its own image.
+    QImage image(expected.size(), expected.format());
+    QImage other(expected.size(), expected.format());
+    QImage changed(expected.size(), expected.format());
+    QRasterPaintEngine::PathCacheStatistics statistics;
+    QRasterPaintEngine::PathCacheStatistics otherStatistics;
+    QRasterPaintEngine::PathCacheStatistics changedStatistics;
+    std::unique_ptr<QThread> thread(QThread::create([&] {
+        statistics = draw(&image, path, true);
+        otherStatistics = draw(&other, path, true);
+        changedStatistics = draw(&changed, changedPath, true);
+    }));
+    thread->start();
+    QVERIFY(thread->wait());
+
+    QCOMPARE(image, expected);
+    // The first draw only marks the path as cacheable
+    QCOMPARE(statistics.misses, 2u);
+    QCOMPARE(statistics.hits, quint64(std::size(positions)) - 2 + 1 + 1);
+    QVERIFY(statistics.cachedBytes > cachedBefore);
+
+    // Another engine on the same thread finds the spans cached by the first one
+    QCOMPARE(other, expected);
+    QCOMPARE(otherStatistics.misses, 0u);
+    QCOMPARE(otherStatistics.hits, quint64(std::size(positions)) + 3);
+
+    // A changed path is cached anew
+    QCOMPARE(changedStatistics.misses, 2u);
+    QCOMPARE(draw(&expected, changedPath, false).hits, 0u);
+    QCOMPARE(changed, expected);
+
+    // The spans are released when their thread finishes, and are not seen
+    // by other threads
+    QImage fresh(expected.size(), expected.format());
+    thread.reset(QThread::create([&] { statistics = draw(&fresh, changedPath, true); }));
+    thread->start();
+    QVERIFY(thread->wait());
+    QCOMPARE(statistics.misses, 2u);
+    QCOMPARE(fresh, expected);
+
+    QImage empty(1, 1, QImage::Format_ARGB32_Premultiplied);
+    QPainter p(&empty);
+    QCOMPARE(static_cast<QRasterPaintEngine *>(p.paintEngine())->pathCacheStatistics().cachedBytes,
+             cachedBefore);
+}
+
 QTEST_MAIN(tst_QPainter)
 
 #include "tst_qpainter.moc"
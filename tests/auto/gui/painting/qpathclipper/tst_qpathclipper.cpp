@@ -61,6 +61,8 @@ private slots:
 
     void qtbug3778();
     void qtbug60024();
+
+    void largePolygons();
 };
 
 Q_DECLARE_METATYPE(QPainterPath)
@@ -1528,6 +1530,36 @@ void tst_QPathClipper::qtbug60024()
     QVERIFY(path1.intersected(path2).isEmpty());
 }
 
+static QPainterPath jaggedPolygon(const QPointF &center, int vertexCount, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QPolygonF polygon;
+    for (int i = 0; i < vertexCount; ++i) {
+        const qreal angle = 2 * M_PI * i / vertexCount;
+        const qreal radius = 100 + random.bounded(15.0);
+        polygon << center + QPointF(cos(angle) * radius, sin(angle) * radius);
+    }
+    QPainterPath path;
+    path.addPolygon(polygon);
+    path.closeSubpath();
+    return path;
+}
+
+void tst_QPathClipper::largePolygons()
+{
+    // many crossing edges, each scan line crossing a lot of them
+    const int subjectIndex = paths.size();
+    paths << jaggedPolygon(QPointF(0, 0), 1500, 1);
+    paths << jaggedPolygon(QPointF(60, 40), 1500, 2);
+
+    clipTest(subjectIndex, subjectIndex + 1, QPathClipper::BoolAnd);
+    clipTest(subjectIndex, subjectIndex + 1, QPathClipper::BoolOr);
+    clipTest(subjectIndex, subjectIndex + 1, QPathClipper::BoolSub);
+    clipTest(subjectIndex + 1, subjectIndex, QPathClipper::BoolSub);
+
+    paths.resize(subjectIndex);
+}
+
 QTEST_MAIN(tst_QPathClipper)
 
 
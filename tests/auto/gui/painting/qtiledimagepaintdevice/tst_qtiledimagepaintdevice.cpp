@@ -0,0 +1,279 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QBitmap>
+#include <QImage>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QPainterPath>
+#include <QThreadPool>
+
+#include <private/qtiledimagepaintdevice_p.h>
+
+class tst_QTiledImagePaintDevice : public QObject
+{
+    Q_OBJECT
+private slots:
+    void sameAsDirect_data();
+    void sameAsDirect();
+    void severalPainters();
+    void flushWhilePainting();
+};
+
+enum Scene {
+    Paths,
+    RectsAndLines,
+    ClippingAndTransform,
+    Images,
+    CompositionAndOpacity,
+    Text,
+    BrushesAndScaling,
+    LargePaths,
+};
+
+static void paintScene(QPainter *painter, Scene scene)
+{
+    switch (scene) {
+    case Paths:
+        painter->setRenderHint(QPainter::Antialiasing);
+        for (int i = 0; i < 200; ++i) {
+            QPainterPath path;
+            path.moveTo(i * 1.7, (i * 37) % 300);
+            path.cubicTo(i * 3.1, 20, 300 - i, i * 2.3, (i * 53) % 300, 290 - i);
+            path.closeSubpath();
+            painter->setPen(QPen(QColor::fromHsv(i % 360, 200, 200), 0.5 + (i % 7)));
+            painter->setBrush(QColor::fromHsv((i * 7) % 360, 150, 250, 120));
+            painter->drawPath(path);
+        }
+        break;
+    case RectsAndLines:
+        for (int i = 0; i < 100; ++i) {
+            painter->setRenderHint(QPainter::Antialiasing, i % 2);
+            painter->fillRect(QRectF(i * 2.5, i * 1.3, 40.5, 25.25), QColor::fromHsv(i * 3, 255, 200));
+            painter->setPen(QPen(Qt::black, i % 5, Qt::DashLine));
+            painter->drawLine(QLineF(0, i * 3, 300, 300 - i * 3));
+            painter->drawEllipse(QRect(i * 3, 150, 30, 20));
+            painter->drawPoint(i * 3, 10);
+        }
+        painter->setPen(QPen(Qt::darkBlue, 12, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin));
+        painter->drawPolyline(QPolygon({ QPoint(10, 280), QPoint(150, 200), QPoint(290, 280) }));
+        break;
+    case ClippingAndTransform: {
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->translate(150, 150);
+        painter->setClipRect(QRect(-120, -120, 200, 230));
+        for (int i = 0; i < 36; ++i) {
+            painter->rotate(10);
+            QLinearGradient gradient(0, 0, 140, 0);
+            gradient.setColorAt(0, Qt::red);
+            gradient.setColorAt(1, Qt::blue);
+            painter->setBrush(gradient);
+            painter->setPen(Qt::NoPen);
+            painter->drawRect(QRectF(10, -3, 130, 6));
+        }
+        painter->setClipPath([] {
+            QPainterPath path;
+            path.addEllipse(QPointF(0, 0), 60, 60);
+            return path;
+        }(), Qt::IntersectClip);
+        painter->scale(1.5, 0.75);
+        painter->fillRect(QRect(-100, -100, 200, 200), QBrush(Qt::darkGreen, Qt::Dense4Pattern));
+        break;
+    }
+    case Images: {
+        QImage image(64, 48, QImage::Format_ARGB32);
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x)
+                image.setPixel(x, y, qRgba(x * 4, y * 5, (x + y) * 2, 128 + x));
+        }
+        painter->drawImage(QPoint(5, 7), image);
+        painter->drawImage(QRectF(100.5, 20, 150, 110), image);
+        painter->setRenderHint(QPainter::SmoothPixmapTransform);
+        painter->rotate(12);
+        painter->drawImage(QRectF(60, 140, 200, 120), image, QRectF(8, 8, 40, 30));
+        break;
+    }
+    case CompositionAndOpacity:
+        painter->fillRect(QRect(0, 0, 300, 300), QColor(20, 40, 60));
+        painter->setOpacity(0.6);
+        painter->setRenderHint(QPainter::Antialiasing);
+        for (int i = 0; i < 40; ++i) {
+            painter->setCompositionMode(i % 3 ? QPainter::CompositionMode_Plus
+                                              : QPainter::CompositionMode_Multiply);
+            painter->setBrush(QColor::fromHsv(i * 9, 200, 255));
+            painter->setPen(Qt::NoPen);
+            painter->drawEllipse(QPointF(i * 7.3, 150 + (i % 5) * 20), 35, 25);
+        }
+        break;
+    case BrushesAndScaling: {
+        QImage texture(13, 7, QImage::Format_RGB32);
+        texture.fill(Qt::red);
+        texture.setPixel(3, 3, qRgb(0, 255, 0));
+        painter->setBrushOrigin(3.5, 2);
+        painter->fillRect(QRect(5, 10, 290, 100), QBrush(texture));
+        // pixmap textures and pixmaps are replayed as images
+        painter->fillRect(QRect(5, 115, 140, 40), QBrush(QPixmap::fromImage(texture)));
+        QImage mask(11, 5, QImage::Format_Mono);
+        mask.fill(0);
+        for (int x = 0; x < mask.width(); x += 2)
+            mask.setPixel(x, x % 5, 1);
+        QBrush bitmapBrush(Qt::darkMagenta);
+        bitmapBrush.setTexture(QBitmap::fromImage(mask));
+        painter->fillRect(QRect(150, 115, 145, 40), bitmapBrush);
+        painter->setPen(Qt::darkCyan);
+        painter->drawPixmap(QPointF(7, 160), QBitmap::fromImage(mask));
+        painter->drawTiledPixmap(QRect(30, 160, 100, 30), QPixmap::fromImage(texture), QPointF(2, 1));
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        painter->scale(1.5, 0.75);
+        for (int i = 0; i < 30; ++i) {
+            painter->setBrush(QBrush(QColor::fromHsv(i * 11, 255, 200, 150), Qt::BrushStyle(1 + i % 14)));
+            painter->drawEllipse(QRectF(i * 5.5, 20 + i * 9.3, 40.5, 25.25));
+        }
+        QImage image(64, 48, QImage::Format_ARGB32_Premultiplied);
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x)
+                image.setPixel(x, y, qPremultiply(qRgba(x * 4, y * 5, (x + y) * 2, 128 + x)));
+        }
+        painter->setRenderHint(QPainter::SmoothPixmapTransform);
+        painter->drawImage(QRectF(100.5, 20, 80, 110), image);
+        painter->drawPixmap(QPointF(13.5, 311.25), QPixmap::fromImage(image));
+        break;
+    }
+    case LargePaths:
+        // filled paths and clip paths that cover many tiles, all of which
+        // replay them at the same time
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        for (int i = 0; i < 6; ++i) {
+            QPainterPath clip;
+            clip.addEllipse(QRectF(5 + i * 7, 3 + i * 5, 290 - i * 11, 280 - i * 9));
+            clip.addRect(QRectF(100 + i * 3, 20, 60, 250));
+            painter->setClipPath(clip);
+            QPainterPath path;
+            path.moveTo(0, i * 13);
+            for (int j = 0; j < 12; ++j) {
+                path.cubicTo(j * 25 + 8, 300 - i * 17, j * 25 + 17, i * 11,
+                             j * 25 + 25, (j * 71 + i * 29) % 300);
+            }
+            path.lineTo(300, 300);
+            path.lineTo(0, 300);
+            path.closeSubpath();
+            painter->setBrush(QColor::fromHsv(i * 50, 180, 230, 150));
+            painter->drawPath(path);
+        }
+        break;
+    case Text: {
+        QFont font;
+        font.setPixelSize(17);
+        font.setUnderline(true);
+        painter->setFont(font);
+        painter->setPen(Qt::darkRed);
+        for (int i = 0; i < 12; ++i)
+            painter->drawText(QPointF(5 + i * 3, 20 + i * 23), QStringLiteral("Tiled text %1").arg(i));
+        break;
+    }
+    }
+}
+
+void tst_QTiledImagePaintDevice::sameAsDirect_data()
+{
+    QTest::addColumn<int>("scene");
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<QSize>("tileSize");
+
+    const std::pair<Scene, const char *> scenes[] = {
+        { Paths, "paths" },
+        { RectsAndLines, "rects-and-lines" },
+        { ClippingAndTransform, "clipping-and-transform" },
+        { Images, "images" },
+        { CompositionAndOpacity, "composition-and-opacity" },
+        { Text, "text" },
+        { BrushesAndScaling, "brushes-and-scaling" },
+        { LargePaths, "large-paths" },
+    };
+    for (const auto &[scene, name] : scenes) {
+        QTest::addRow("%s-argb32pm-64", name)
+                << int(scene) << QImage::Format_ARGB32_Premultiplied << QSize(64, 64);
+        QTest::addRow("%s-argb32pm-odd", name)
+                << int(scene) << QImage::Format_ARGB32_Premultiplied << QSize(77, 31);
+        QTest::addRow("%s-rgb888-64", name) << int(scene) << QImage::Format_RGB888 << QSize(64, 64);
+        QTest::addRow("%s-mono-64", name) << int(scene) << QImage::Format_Mono << QSize(64, 64);
+    }
+    // many tiles per path
+    QTest::addRow("large-paths-argb32pm-16")
+            << int(LargePaths) << QImage::Format_ARGB32_Premultiplied << QSize(16, 16);
+}
+
+void tst_QTiledImagePaintDevice::sameAsDirect()
+{
+    QFETCH(int, scene);
+    QFETCH(QImage::Format, format);
+    QFETCH(QSize, tileSize);
+
+    QImage expected(300, 300, format);
+    expected.fill(Qt::white);
+    {
+        QPainter painter(&expected);
+        paintScene(&painter, Scene(scene));
+    }
+
+    QImage actual(300, 300, format);
+    actual.fill(Qt::white);
+    QTiledImagePaintDevice device(&actual, tileSize);
+    {
+        QPainter painter(&device);
+        paintScene(&painter, Scene(scene));
+    }
+    QVERIFY(device.commandCount() > 0);
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    device.flush(&pool);
+    QCOMPARE(device.commandCount(), 0);
+
+    QCOMPARE(actual, expected);
+}
+
+void tst_QTiledImagePaintDevice::severalPainters()
+{
+    QImage expected(200, 100, QImage::Format_ARGB32_Premultiplied);
+    expected.fill(Qt::transparent);
+    QImage actual = expected;
+    QTiledImagePaintDevice device(&actual, QSize(32, 32));
+
+    auto paint = [](QPaintDevice *target) {
+        {
+            QPainter painter(target);
+            painter.translate(50, 0);
+            painter.setBrush(Qt::red);
+            painter.drawRect(10, 10, 50, 50);
+        }
+        // a new painter starts over with the default state
+        QPainter painter(target);
+        painter.drawRect(10, 10, 50, 50);
+    };
+    paint(&expected);
+    paint(&device);
+    device.flush();
+    QCOMPARE(actual, expected);
+}
+
+void tst_QTiledImagePaintDevice::flushWhilePainting()
+{
+    QImage image(100, 100, QImage::Format_RGB32);
+    image.fill(Qt::white);
+    QTiledImagePaintDevice device(&image);
+    QPainter painter(&device);
+    painter.fillRect(10, 10, 20, 20, Qt::black);
+    QTest::ignoreMessage(QtWarningMsg,
+                         "QTiledImagePaintDevice::flush: The device is still being painted on");
+    device.flush();
+    QCOMPARE(image.pixel(15, 15), qRgb(255, 255, 255));
+    painter.end();
+    device.flush();
+    QCOMPARE(image.pixel(15, 15), qRgb(0, 0, 0));
+}
+
+QTEST_MAIN(tst_QTiledImagePaintDevice)
+#include "tst_qtiledimagepaintdevice.moc"
@@ -6,8 +6,13 @@
 
 
 #include <qfont.h>
+#include <qimage.h>
+#include <qpainter.h>
 #include <private/qfont_p.h>
 #include <private/qfontengine_p.h>
+#if QT_CONFIG(freetype)
+#include <private/qfontengine_ft_p.h>
+#endif
 
 class tst_QFontCache : public QObject
 {
@@ -23,6 +28,7 @@ private slots:
     void engineDataFamilies_data();
     void engineDataFamilies();
     void threadedAccess();
+    void sharedGlyphAtlas();
 
     void clear();
 };
@@ -249,5 +255,106 @@ void tst_QFontCache::threadedAccess()
     QVERIFY2(!messageHandler.receivedMessage, qPrintable(messageHandler.messages.join('\n')));
 }
 
+#if QT_CONFIG(freetype)
+static QFontEngineFT *freetypeEngine(const QFont &font)
+{
+    QFontEngine *engine = QFontPrivate::get(font)->engineForScript(QChar::Script_Latin);
+    if (engine && engine->type() == QFontEngine::Multi)
+        engine = static_cast<QFontEngineMulti *>(engine)->engine(0);
+    if (!engine || engine->type() != QFontEngine::Freetype)
+        return nullptr;
+    return static_cast<QFontEngineFT *>(engine);
+}
+
+static QImage drawText(const QFont &font, const QString &text)
+{
+    QImage image(400, 40, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    painter.setFont(font);
+    painter.drawText(QPointF(5, 30), text);
+    return image;
+}
+#endif
+
+void tst_QFontCache::sharedGlyphAtlas()
+{
+#if QT_CONFIG(freetype)
+    // Fonts that only differ in their style hint match the same font, but
+    // get font engines of their own
+    QFont font1;
+    font1.setPixelSize(17);
+    font1.setStyleHint(QFont::Serif);
+    QFont font2 = font1;
+    font2.setStyleHint(QFont::Cursive);
+    QFont font3 = font1;
+    font3.setPixelSize(18);
+
+    QFontEngineFT *engine1 = freetypeEngine(font1);
+    QFontEngineFT *engine2 = freetypeEngine(font2);
+    QFontEngineFT *engine3 = freetypeEngine(font3);
+    if (!engine1 || !engine2 || !engine3)
+        QSKIP("This test requires FreeType font engines");
+    if (engine1 == engine2 || !(engine1->faceId() == engine2->faceId()))
+        QSKIP("The fonts do not resolve to separate engines for the same face");
+
+    const QString text = QStringLiteral("The quick brown fox jumps over the lazy dog");
+    const QImage image1 = drawText(font1, text);
+    const QImage image2 = drawText(font2, text);
+    drawText(font3, text);
+    QCOMPARE(image1, image2);
+
+    const QFontEngineFT::GlyphAtlas *atlas1 = engine1->loadGlyphSet(QTransform())->glyphAtlas();
+    const QFontEngineFT::GlyphAtlas *atlas2 = engine2->loadGlyphSet(QTransform())->glyphAtlas();
+    const QFontEngineFT::GlyphAtlas *atlas3 = engine3->loadGlyphSet(QTransform())->glyphAtlas();
+    QVERIFY(atlas1);
+    QCOMPARE(atlas1, atlas2);
+    QVERIFY(atlas3);
+    QVERIFY(atlas1 != atlas3);
+
+    const qsizetype glyphCount = atlas1->glyphCount();
+    QVERIFY(glyphCount > 0);
+    QVERIFY(atlas1->memoryUsage() > 0);
+
+    // Drawing the same text again only uses the glyphs that are already there
+    QCOMPARE(drawText(font2, text), image1);
+    QCOMPARE(atlas1->glyphCount(), glyphCount);
+
+    // A glyph loaded by one engine is found by the other one, and removing
+    // it from the cache removes it for both
+    const glyph_t glyph = engine1->glyphIndex('q');
+    QVERIFY(glyph != 0);
+    QFontEngineFT::Glyph *loaded = engine1->loadGlyphFor(glyph, QFixedPoint(), QFontEngine::Format_A8,
+                                                         QTransform());
+    QVERIFY(loaded);
+    QFontEngineFT::QGlyphSet *set1 = engine1->loadGlyphSet(QTransform());
+    QFontEngineFT::QGlyphSet *set2 = engine2->loadGlyphSet(QTransform());
+    QCOMPARE(set2->getGlyph(glyph), loaded);
+    const qsizetype loadedCount = atlas1->glyphCount();
+    set2->removeGlyphFromCache(glyph, QFixedPoint());
+    QVERIFY(!set1->getGlyph(glyph));
+    QCOMPARE(atlas1->glyphCount(), loadedCount - 1);
+    QVERIFY(engine2->loadGlyphFor(glyph, QFixedPoint(), QFontEngine::Format_A8, QTransform()));
+    QVERIFY(set1->getGlyph(glyph));
+    QCOMPARE(atlas1->glyphCount(), loadedCount);
+
+    // Glyphs rendered again in another format, or removed and loaded again,
+    // reuse the memory they had
+    size_t memoryUsage = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (i == 1)
+            memoryUsage = atlas1->memoryUsage();
+        QVERIFY(engine1->loadGlyphFor(glyph, QFixedPoint(), QFontEngine::Format_Mono, QTransform()));
+        QVERIFY(engine2->loadGlyphFor(glyph, QFixedPoint(), QFontEngine::Format_A8, QTransform()));
+        set1->removeGlyphFromCache(glyph, QFixedPoint());
+        QVERIFY(engine1->loadGlyphFor(glyph, QFixedPoint(), QFontEngine::Format_A8, QTransform()));
+    }
+    QCOMPARE(atlas1->memoryUsage(), memoryUsage);
+    QCOMPARE(atlas1->glyphCount(), loadedCount);
+#else
+    QSKIP("This test requires FreeType");
+#endif
+}
+
 QTEST_MAIN(tst_QFontCache)
 #include "tst_qfontcache.moc"
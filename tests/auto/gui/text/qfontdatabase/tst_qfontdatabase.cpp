@@ -3,6 +3,8 @@
 
 #include <QTest>
 #include <QSignalSpy>
+#include <QDir>
+#include <QStandardPaths>
 
 #include <qfontdatabase.h>
 #include <qfontinfo.h>
@@ -11,10 +13,14 @@
 #include <private/qrawfont_p.h>
 #include <private/qfont_p.h>
 #include <private/qfontengine_p.h>
+#include <private/qfontdatabase_p.h>
 #include <qpa/qplatformfontdatabase.h>
 #include <qpa/qplatformintegration.h>
 
 #include <QtGui/private/qguiapplication_p.h>
+#if QT_CONFIG(fontconfig)
+#include <QtGui/private/qfontconfigdatabase_p.h>
+#endif
 
 using namespace Qt::StringLiterals;
 
@@ -72,6 +78,8 @@ private slots:
 
     void addApplicationFontFallback();
 
+    void fontconfigScanCache();
+
 private:
     QString m_ledFont;
     QString m_testFont;
@@ -760,5 +768,62 @@ void tst_QFontDatabase::addApplicationFontFallback()
     QVERIFY(QFontDatabase::removeApplicationFallbackFontFamily(QChar::Script_Latin, u"QtTestFallbackFont"_s));
 }
 
+void tst_QFontDatabase::fontconfigScanCache()
+{
+#if QT_CONFIG(fontconfig)
+    if (!dynamic_cast<QFontconfigDatabase *>(QGuiApplicationPrivate::platformIntegration()->fontDatabase()))
+        QSKIP("This test requires the fontconfig font database");
+
+    QStandardPaths::setTestModeEnabled(true);
+    QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                  + "/qtfontconfig"_L1);
+    cacheDir.removeRecursively();
+    auto cleanup = qScopeGuard([&cacheDir] {
+        qunsetenv("QT_FONTCONFIG_CACHE");
+        cacheDir.removeRecursively();
+        QFontDatabasePrivate::instance()->invalidate();
+        QStandardPaths::setTestModeEnabled(false);
+    });
+
+    const auto fonts = [] {
+        QStringList fonts;
+        const QStringList families = QFontDatabase::families();
+        for (const QString &family : families) {
+            QStringList writingSystems;
+            for (QFontDatabase::WritingSystem writingSystem : QFontDatabase::writingSystems(family))
+                writingSystems << QString::number(writingSystem);
+            fonts << family + u':' + writingSystems.join(u',');
+            const QStringList styles = QFontDatabase::styles(family);
+            for (const QString &style : styles) {
+                fonts << family + u':' + style + u':'
+                                + QString::number(QFontDatabase::weight(family, style)) + u':'
+                                + QString::number(QFontDatabase::isFixedPitch(family, style));
+            }
+        }
+        return fonts;
+    };
+
+    qputenv("QT_FONTCONFIG_CACHE", "0");
+    QFontDatabasePrivate::instance()->invalidate();
+    const QStringList scanned = fonts();
+    QVERIFY(!scanned.isEmpty());
+    QVERIFY(cacheDir.isEmpty());
+    qunsetenv("QT_FONTCONFIG_CACHE");
+
+    // The first population scans the fonts and writes the cache...
+    QFontDatabasePrivate::instance()->invalidate();
+    QCOMPARE(fonts(), scanned);
+    QCOMPARE(cacheDir.entryList(QDir::Files).size(), 1);
+
+    // ...the second one populates the families from it
+    QFontDatabasePrivate::instance()->invalidate();
+    QCOMPARE(fonts(), scanned);
+    QCOMPARE(QFontInfo(QFont(QFontDatabase::families().constFirst())).family(),
+             QFontDatabase::families().constFirst());
+#else
+    QSKIP("This test requires fontconfig");
+#endif
+}
+
 QTEST_MAIN(tst_QFontDatabase)
 #include "tst_qfontdatabase.moc"
@@ -4,6 +4,7 @@
 
 #include <QTest>
 #include <QSignalSpy>
+#include <QRandomGenerator>
 
 #include <qtextdocument.h>
 #include <qdebug.h>
@@ -182,6 +183,8 @@ private slots:
 
     void delayedLayout();
     void undoContentChangeIndices();
+    void largeDocumentEdits_data();
+    void largeDocumentEdits();
 
     void restoreStrokeFromHtml();
     void restoreForegroundGradientFromHtml();
@@ -4048,6 +4051,66 @@ void tst_QTextDocument::undoContentChangeIndices() // QTBUG-113865
     QVERIFY(documentLength >= changeEnd);
 }
 
+void tst_QTextDocument::largeDocumentEdits_data()
+{
+    QTest::addColumn<bool>("undo");
+    QTest::newRow("undo") << true;
+    QTest::newRow("no undo") << false;
+}
+
+// Edits a document whose text is stored in many chunks, and compares it
+// to the same edits applied to a plain string.
+void tst_QTextDocument::largeDocumentEdits()
+{
+    QFETCH(bool, undo);
+
+    QTextDocument doc;
+    doc.setUndoRedoEnabled(undo);
+    QTextCursor cursor(&doc);
+    QString expected;
+
+    // a single insertion that is larger than a chunk
+    const QString big = QString("0123456789abcdef").repeated(10000);
+    cursor.insertText(big);
+    expected += big;
+
+    QRandomGenerator random(1);
+    for (int i = 0; i < 20000; ++i) {
+        const int position = random.bounded(int(expected.size()) + 1);
+        cursor.setPosition(position);
+        if (i % 3 == 2 && position < expected.size()) {
+            const int length = qMin(int(random.bounded(200)), int(expected.size()) - position);
+            cursor.setPosition(position + length, QTextCursor::KeepAnchor);
+            cursor.removeSelectedText();
+            expected.remove(position, length);
+        } else {
+            const QString text = QString("text %1 ").arg(i).repeated(1 + i % 5);
+            cursor.insertText(text);
+            expected.insert(position, text);
+        }
+    }
+    QCOMPARE(doc.toPlainText(), expected);
+
+    QTextCursor block(&doc);
+    block.setPosition(expected.size() / 2);
+    block.select(QTextCursor::WordUnderCursor);
+    QVERIFY(!block.selectedText().isEmpty());
+    QVERIFY(expected.contains(block.selectedText()));
+
+    if (undo) {
+        while (doc.isUndoAvailable())
+            doc.undo();
+        QVERIFY(doc.toPlainText().isEmpty());
+        while (doc.isRedoAvailable())
+            doc.redo();
+        QCOMPARE(doc.toPlainText(), expected);
+    }
+
+    QTextDocument *clone = doc.clone();
+    QCOMPARE(clone->toPlainText(), expected);
+    delete clone;
+}
+
 void tst_QTextDocument::restoreStrokeFromHtml()
 {
     QTextDocument document;
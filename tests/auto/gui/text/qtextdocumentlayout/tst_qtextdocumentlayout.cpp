@@ -9,6 +9,7 @@
 #include <qdebug.h>
 #include <qpainter.h>
 #include <qtexttable.h>
+#include <qsignalspy.h>
 #ifndef QT_NO_WIDGETS
 #include <qtextedit.h>
 #include <qscrollbar.h>
@@ -37,6 +38,7 @@ private slots:
     void floatingTablePageBreak();
     void imageAtRightAlignedTab();
     void blockVisibility();
+    void lazyLayout();
 #ifndef QT_NO_TEXTHTMLPARSER
     void testHitTest();
 
@@ -333,6 +335,33 @@ void tst_QTextDocumentLayout::blockVisibility()
     QCOMPARE(doc->size(), halfSize);
 }
 
+void tst_QTextDocumentLayout::lazyLayout()
+{
+    QStringList lines;
+    for (int i = 0; i < 20000; ++i)
+        lines << QStringLiteral("Line %1 of a document that is laid out in steps").arg(i);
+    const QString text = lines.join(u'\n');
+
+    // Hit testing the last block lays out the whole document right away
+    QTextDocument reference;
+    reference.setPlainText(text);
+    QAbstractTextDocumentLayout *referenceLayout = reference.documentLayout();
+    QVERIFY(referenceLayout->blockBoundingRect(reference.lastBlock()).isValid());
+    const qreal height = referenceLayout->documentSize().height();
+
+    QAbstractTextDocumentLayout *layout = doc->documentLayout();
+    QSignalSpy spy(layout, &QAbstractTextDocumentLayout::documentSizeChanged);
+    doc->setPlainText(text);
+
+    // Only the start of the document is laid out, the rest is laid out from
+    // the event loop while the reported size grows
+    QCOMPARE(spy.size(), 1);
+    QVERIFY(spy.constFirst().at(0).toSizeF().height() < height);
+    QTRY_COMPARE_WITH_TIMEOUT(spy.constLast().at(0).toSizeF().height(), height, 30000);
+    QVERIFY(spy.size() > 2);
+    QCOMPARE(layout->documentSize().height(), height);
+}
+
 #ifndef QT_NO_TEXTHTMLPARSER
 void tst_QTextDocumentLayout::largeImage()
 {
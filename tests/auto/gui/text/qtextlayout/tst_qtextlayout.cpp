@@ -13,7 +13,10 @@
 
 
 #include <private/qtextengine_p.h>
+#include <private/qfontengine_p.h>
 #include <qtextlayout.h>
+#include <qglyphrun.h>
+#include <qscopeguard.h>
 
 #include <qdebug.h>
 
@@ -128,6 +131,8 @@ private slots:
     void min_maximumWidth_data();
     void min_maximumWidth();
     void negativeLineWidth();
+    void shapedRunCache_data();
+    void shapedRunCache();
 
 private:
     QFont testFont;
@@ -2761,5 +2766,77 @@ void tst_QTextLayout::negativeLineWidth()
     }
 }
 
+void tst_QTextLayout::shapedRunCache_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<qreal>("letterSpacing");
+    QTest::addColumn<bool>("kerning");
+    QTest::addColumn<bool>("smallCaps");
+
+    QTest::newRow("latin") << QStringLiteral("Office affine AVAVA") << 0.0 << true << false;
+    QTest::newRow("latin, no kerning") << QStringLiteral("Office affine AVAVA") << 0.0 << false << false;
+    QTest::newRow("latin, letter spacing") << QStringLiteral("Office affine AVAVA") << 2.0 << true << false;
+    QTest::newRow("latin, small caps") << QStringLiteral("Office affine AVAVA") << 0.0 << true << true;
+    QTest::newRow("arabic") << QStringLiteral("\u0627\u0644\u0639\u0631\u0628\u064A\u0629 abc")
+                            << 0.0 << true << false;
+    QTest::newRow("surrogates") << QStringLiteral("a\U0001F600b\U00010400c") << 0.0 << true << false;
+}
+
+void tst_QTextLayout::shapedRunCache()
+{
+    QFETCH(QString, text);
+    QFETCH(qreal, letterSpacing);
+    QFETCH(bool, kerning);
+    QFETCH(bool, smallCaps);
+
+    // Use a real font rather than the box engine, so that there is kerning,
+    // ligatures and font merging to cache.
+    QFont font;
+    font.setPixelSize(TESTFONT_SIZE);
+    font.setLetterSpacing(QFont::AbsoluteSpacing, letterSpacing);
+    font.setKerning(kerning);
+    if (smallCaps)
+        font.setCapitalization(QFont::SmallCaps);
+
+    const auto layOut = [&] {
+        QTextLayout layout(text, font);
+        layout.beginLayout();
+        layout.createLine();
+        layout.endLayout();
+
+        QList<QGlyphRun> runs = layout.glyphRuns();
+        QList<qreal> cursorPositions;
+        for (int i = 0; i <= text.size(); ++i)
+            cursorPositions.append(layout.lineAt(0).cursorToX(i));
+        return std::make_pair(runs, cursorPositions);
+    };
+
+    const bool wasEnabled = QFontEngine::isShapedRunCacheEnabled();
+    auto restore = qScopeGuard([wasEnabled] {
+        QFontEngine::setShapedRunCacheEnabled(wasEnabled);
+    });
+
+    QFontEngine::setShapedRunCacheEnabled(false);
+    const auto expected = layOut();
+
+    QFontEngine::setShapedRunCacheEnabled(true);
+    const QFontEngine::ShapedRunStatistics before = QFontEngine::shapedRunStatistics();
+    const auto first = layOut();
+    const auto second = layOut();
+    const QFontEngine::ShapedRunStatistics after = QFontEngine::shapedRunStatistics();
+
+    QVERIFY(after.hits > before.hits);
+    QCOMPARE(first.second, expected.second);
+    QCOMPARE(second.second, expected.second);
+    QCOMPARE(first.first.size(), expected.first.size());
+    QCOMPARE(second.first.size(), expected.first.size());
+    for (qsizetype i = 0; i < expected.first.size(); ++i) {
+        QCOMPARE(first.first.at(i).glyphIndexes(), expected.first.at(i).glyphIndexes());
+        QCOMPARE(first.first.at(i).positions(), expected.first.at(i).positions());
+        QCOMPARE(second.first.at(i).glyphIndexes(), expected.first.at(i).glyphIndexes());
+        QCOMPARE(second.first.at(i).positions(), expected.first.at(i).positions());
+    }
+}
+
 QTEST_MAIN(tst_QTextLayout)
 #include "tst_qtextlayout.moc"
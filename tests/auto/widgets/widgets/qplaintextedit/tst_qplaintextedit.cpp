@@ -119,6 +119,8 @@ private slots:
     void layoutAfterMultiLineRemove();
     void undoCommandRemovesAndReinsertsBlock();
     void taskQTBUG_43562_lineCountCrash();
+    void lazyLayout();
+    void lazyLayoutLongestLineShrinking();
 #if !defined(QT_NO_CONTEXTMENU) && !defined(QT_NO_CLIPBOARD)
     void contextMenu();
 #endif
@@ -1677,6 +1679,73 @@ void tst_QPlainTextEdit::taskQTBUG_43562_lineCountCrash()
     disconnect(ed->document(), SIGNAL(contentsChange(int, int, int)), 0, 0);
 }
 
+void tst_QPlainTextEdit::lazyLayout()
+{
+    QStringList lines;
+    for (int i = 0; i < 5000; ++i)
+        lines << QStringLiteral("Line %1 of a document that is measured in steps").arg(i).repeated(1 + i % 3);
+    const QString text = lines.join(u'\n');
+
+    // Laying out every block gives the final line count
+    QTextDocument reference;
+    reference.setDocumentLayout(new QPlainTextDocumentLayout(&reference));
+    static_cast<QPlainTextDocumentLayout *>(reference.documentLayout())->setTextWidth(300);
+    reference.setPlainText(text);
+    for (QTextBlock block = reference.begin(); block.isValid(); block = block.next())
+        reference.documentLayout()->blockBoundingRect(block);
+    const qreal height = reference.documentLayout()->documentSize().height();
+    QVERIFY(height > reference.blockCount());
+
+    QTextDocument document;
+    QPlainTextDocumentLayout *layout = new QPlainTextDocumentLayout(&document);
+    document.setDocumentLayout(layout);
+    layout->setTextWidth(300);
+    QSignalSpy spy(layout, &QAbstractTextDocumentLayout::documentSizeChanged);
+    document.setPlainText(text);
+
+    // The blocks count as one line until they are measured from the event loop
+    QCOMPARE(layout->documentSize().height(), qreal(document.blockCount()));
+    QTRY_COMPARE(layout->documentSize().height(), height);
+    QCOMPARE(spy.constLast().at(0).toSizeF().height(), height);
+    QCOMPARE(document.begin().layout()->lineCount(), 0);
+}
+
+void tst_QPlainTextEdit::lazyLayoutLongestLineShrinking()
+{
+    QStringList lines;
+    for (int i = 0; i < 2000; ++i)
+        lines << QStringLiteral("Line %1").arg(i).repeated(1 + i % 5);
+    const int longestLine = 1234;
+    lines[longestLine] = QString(400, u'x');
+
+    auto maximumWidth = [](const QStringList &lines) {
+        QTextDocument reference;
+        reference.setDocumentLayout(new QPlainTextDocumentLayout(&reference));
+        reference.setPlainText(lines.join(u'\n'));
+        for (QTextBlock block = reference.begin(); block.isValid(); block = block.next())
+            reference.documentLayout()->blockBoundingRect(block);
+        return reference.documentLayout()->documentSize().width();
+    };
+
+    // no text width, as with QPlainTextEdit::NoWrap
+    QTextDocument document;
+    QPlainTextDocumentLayout *layout = new QPlainTextDocumentLayout(&document);
+    document.setDocumentLayout(layout);
+    document.setPlainText(lines.join(u'\n'));
+    const qreal longestWidth = maximumWidth(lines);
+    QTRY_COMPARE(layout->documentSize().width(), longestWidth);
+    QCOMPARE(document.findBlockByNumber(longestLine + 1).layout()->lineCount(), 0);
+
+    // Shortening the longest line measures the other blocks again
+    QTextCursor cursor(document.findBlockByNumber(longestLine));
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.insertText(QStringLiteral("x"));
+    lines[longestLine] = QStringLiteral("x");
+    const qreal width = maximumWidth(lines);
+    QVERIFY(width < longestWidth);
+    QTRY_COMPARE(layout->documentSize().width(), width);
+}
+
 #if !defined(QT_NO_CONTEXTMENU) && !defined(QT_NO_CLIPBOARD)
 void tst_QPlainTextEdit::contextMenu()
 {
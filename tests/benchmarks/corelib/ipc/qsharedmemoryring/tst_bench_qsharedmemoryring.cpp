@@ -0,0 +1,263 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QTest>
+
+#include <private/qsharedmemoryring_p.h>
+
+#ifdef BENCHMARK_QLOCALSOCKET
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+#endif
+
+using namespace Qt::StringLiterals;
+
+// Compares the message round-trip latency and one-way throughput of
+// QSharedMemoryRing against QLocalSocket. Both ends run in the same process,
+// in different threads, which is representative of the per-message costs.
+class tst_QSharedMemoryRing : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void pingPong_data();
+    void pingPong();
+    void throughput_data();
+    void throughput();
+
+private:
+    QNativeIpcKey key()
+    {
+        return QSharedMemory::platformSafeKey(u"benchshmring_%1-%2"_s
+                                              .arg(QCoreApplication::applicationPid())
+                                              .arg(++seq));
+    }
+    void ringPingPong(int size);
+    void ringThroughput(int size);
+#ifdef BENCHMARK_QLOCALSOCKET
+    void socketPingPong(int size);
+    void socketThroughput(int size);
+#endif
+
+    int seq = 0;
+};
+
+static void addRows()
+{
+    QTest::addColumn<bool>("useSocket");
+    QTest::addColumn<int>("size");
+    for (int size : { 16, 256, 4096 }) {
+        QTest::addRow("ring:%d", size) << false << size;
+#ifdef BENCHMARK_QLOCALSOCKET
+        QTest::addRow("localsocket:%d", size) << true << size;
+#endif
+    }
+}
+
+void tst_QSharedMemoryRing::pingPong_data()
+{
+    addRows();
+}
+
+void tst_QSharedMemoryRing::pingPong()
+{
+    QFETCH(bool, useSocket);
+    QFETCH(int, size);
+#ifdef BENCHMARK_QLOCALSOCKET
+    if (useSocket)
+        return socketPingPong(size);
+#else
+    Q_UNUSED(useSocket);
+#endif
+    ringPingPong(size);
+}
+
+void tst_QSharedMemoryRing::throughput_data()
+{
+    addRows();
+}
+
+void tst_QSharedMemoryRing::throughput()
+{
+    QFETCH(bool, useSocket);
+    QFETCH(int, size);
+#ifdef BENCHMARK_QLOCALSOCKET
+    if (useSocket)
+        return socketThroughput(size);
+#else
+    Q_UNUSED(useSocket);
+#endif
+    ringThroughput(size);
+}
+
+void tst_QSharedMemoryRing::ringPingPong(int size)
+{
+    const QNativeIpcKey requestKey = key();
+    const QNativeIpcKey replyKey = key();
+    QSharedMemoryRing requests, replies;
+    QVERIFY(requests.create(requestKey, 64 * 1024));
+    QVERIFY(replies.create(replyKey, 64 * 1024));
+
+    QScopedPointer<QThread> echo(QThread::create([&] {
+        QSharedMemoryRing in, out;
+        QVERIFY(in.attach(requestKey));
+        QVERIFY(out.attach(replyKey));
+        QByteArray message;
+        while (in.read(&message) && !message.isEmpty())
+            out.write(message);
+    }));
+    echo->start();
+
+    const QByteArray message(size, 'x');
+    QByteArray reply;
+    QBENCHMARK {
+        requests.write(message);
+        replies.read(&reply);
+    }
+    QCOMPARE(reply, message);
+
+    requests.write({});
+    QVERIFY(echo->wait());
+}
+
+void tst_QSharedMemoryRing::ringThroughput(int size)
+{
+    constexpr int Count = 10000;
+    const QNativeIpcKey k = key();
+    QSharedMemoryRing ring;
+    QVERIFY(ring.create(k, 1024 * 1024));
+
+    QSemaphore start, done;
+    bool quit = false;
+    QScopedPointer<QThread> consumer(QThread::create([&] {
+        QSharedMemoryRing in;
+        QVERIFY(in.attach(k));
+        QByteArray message;
+        for (;;) {
+            start.acquire();
+            if (quit)
+                break;
+            for (int i = 0; i < Count; ++i)
+                in.read(&message);
+            done.release();
+        }
+    }));
+    consumer->start();
+
+    const QByteArray message(size, 'x');
+    QBENCHMARK {
+        start.release();
+        for (int i = 0; i < Count; ++i)
+            ring.write(message);
+        done.acquire();
+    }
+
+    quit = true;
+    start.release();
+    QVERIFY(consumer->wait());
+}
+
+#ifdef BENCHMARK_QLOCALSOCKET
+void tst_QSharedMemoryRing::socketPingPong(int size)
+{
+    const QString name = u"benchshmring_socket_%1"_s.arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(name);
+    QLocalServer server;
+    QVERIFY(server.listen(name));
+
+    QScopedPointer<QThread> echo(QThread::create([&] {
+        QLocalSocket socket;
+        socket.connectToServer(name);
+        QVERIFY(socket.waitForConnected());
+        QByteArray buffer(size, Qt::Uninitialized);
+        for (;;) {
+            qint64 got = 0;
+            while (got < size) {
+                if (!socket.bytesAvailable() && !socket.waitForReadyRead(-1))
+                    return;
+                got += socket.read(buffer.data() + got, size - got);
+            }
+            socket.write(buffer);
+            socket.waitForBytesWritten(-1);
+        }
+    }));
+    echo->start();
+
+    QVERIFY(server.waitForNewConnection(5000));
+    QLocalSocket *socket = server.nextPendingConnection();
+    QVERIFY(socket);
+
+    const QByteArray message(size, 'x');
+    QByteArray reply(size, Qt::Uninitialized);
+    QBENCHMARK {
+        socket->write(message);
+        socket->waitForBytesWritten(-1);
+        qint64 got = 0;
+        while (got < size) {
+            if (!socket->bytesAvailable())
+                socket->waitForReadyRead(-1);
+            got += socket->read(reply.data() + got, size - got);
+        }
+    }
+    QCOMPARE(reply, message);
+
+    socket->disconnectFromServer();
+    QVERIFY(echo->wait());
+}
+
+void tst_QSharedMemoryRing::socketThroughput(int size)
+{
+    constexpr int Count = 10000;
+    const QString name = u"benchshmring_socket_%1"_s.arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(name);
+    QLocalServer server;
+    QVERIFY(server.listen(name));
+
+    QSemaphore start, done;
+    bool quit = false;
+    QScopedPointer<QThread> consumer(QThread::create([&] {
+        QLocalSocket socket;
+        socket.connectToServer(name);
+        QVERIFY(socket.waitForConnected());
+        QByteArray buffer(64 * 1024, Qt::Uninitialized);
+        for (;;) {
+            start.acquire();
+            if (quit)
+                break;
+            qint64 remaining = qint64(Count) * size;
+            while (remaining > 0) {
+                if (!socket.bytesAvailable() && !socket.waitForReadyRead(-1))
+                    return;
+                remaining -= socket.read(buffer.data(), qMin(remaining, qint64(buffer.size())));
+            }
+            done.release();
+        }
+    }));
+    consumer->start();
+
+    QVERIFY(server.waitForNewConnection(5000));
+    QLocalSocket *socket = server.nextPendingConnection();
+    QVERIFY(socket);
+
+    const QByteArray message(size, 'x');
+    QBENCHMARK {
+        start.release();
+        for (int i = 0; i < Count; ++i)
+            socket->write(message);
+        while (socket->bytesToWrite())
+            socket->waitForBytesWritten(-1);
+        done.acquire();
+    }
+
+    quit = true;
+    start.release();
+    QVERIFY(consumer->wait());
+}
+#endif
+
+QTEST_MAIN(tst_QSharedMemoryRing)
+
+#include "tst_bench_qsharedmemoryring.moc"
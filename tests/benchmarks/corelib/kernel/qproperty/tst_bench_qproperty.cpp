@@ -4,6 +4,8 @@
 #include <QScopedPointer>
 #include <QProperty>
 
+#include <vector>
+
 #include <qtest.h>
 
 #include "propertytester.h"
@@ -26,6 +28,9 @@ private slots:
     void cppNotifyingReadOnce();
     void cppNotifyingDirect();
     void cppNotifyingDirectReadOnce();
+
+    void fanIn_data();
+    void fanIn();
 };
 
 void tst_QProperty::cppOldBinding()
@@ -202,6 +207,49 @@ void tst_QProperty::cppNotifyingDirectReadOnce()
     QCOMPARE(tester->yNotified.value(), i);
 }
 
+void tst_QProperty::fanIn_data()
+{
+    QTest::addColumn<bool>("grouped");
+
+    QTest::newRow("individual") << false;
+    QTest::newRow("grouped") << true;
+}
+
+// Writes a row of properties that a layer of bindings depends on, each on
+// two neighbouring ones, which are in turn summed up by a single binding.
+void tst_QProperty::fanIn()
+{
+    QFETCH(bool, grouped);
+
+    constexpr int Width = 100;
+    std::vector<QProperty<int>> inputs(Width);
+    std::vector<QProperty<int>> layer(Width);
+    for (int i = 0; i < Width; ++i) {
+        layer[i].setBinding([&inputs, i]() {
+            return inputs[i].value() + inputs[(i + 1) % Width].value();
+        });
+    }
+    QProperty<int> sum;
+    sum.setBinding([&layer]() {
+        int result = 0;
+        for (const QProperty<int> &property : layer)
+            result += property.value();
+        return result;
+    });
+
+    int value = 0;
+    QBENCHMARK {
+        ++value;
+        if (grouped)
+            Qt::beginPropertyUpdateGroup();
+        for (QProperty<int> &input : inputs)
+            input = value;
+        if (grouped)
+            Qt::endPropertyUpdateGroup();
+    }
+    QCOMPARE(sum.value(), 2 * Width * value);
+}
+
 QTEST_MAIN(tst_QProperty)
 
 #include "tst_bench_qproperty.moc"
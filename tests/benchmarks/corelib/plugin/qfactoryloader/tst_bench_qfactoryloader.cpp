@@ -0,0 +1,74 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDirListing>
+#include <QtCore/QFileInfo>
+#include <QtCore/QLibraryInfo>
+#include <QtCore/QScopeGuard>
+#include <QtCore/QTemporaryDir>
+#include <QTest>
+
+#include <private/qfactoryloader_p.h>
+
+using namespace Qt::StringLiterals;
+
+// Measures the cost of the directory scan QFactoryLoader does on construction,
+// which dominates plugin-related application startup time.
+class tst_QFactoryLoader : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir cacheDir;
+
+private slots:
+    void initTestCase();
+    void scan_data();
+    void scan();
+};
+
+void tst_QFactoryLoader::initTestCase()
+{
+    QVERIFY(cacheDir.isValid());
+    const QString pluginsPath = QLibraryInfo::path(QLibraryInfo::PluginsPath);
+    if (!QFileInfo(pluginsPath).isDir())
+        QSKIP("Qt plugins directory not found");
+    QCoreApplication::setLibraryPaths({ pluginsPath });
+}
+
+void tst_QFactoryLoader::scan_data()
+{
+    QTest::addColumn<QString>("suffix");
+    QTest::addColumn<bool>("cached");
+
+    const QString pluginsPath = QLibraryInfo::path(QLibraryInfo::PluginsPath);
+    for (const auto &dirEntry : QDirListing(pluginsPath, QDirListing::IteratorFlag::DirsOnly)) {
+        const QString suffix = u'/' + dirEntry.fileName();
+        QTest::addRow("%ls-uncached", qUtf16Printable(dirEntry.fileName())) << suffix << false;
+        QTest::addRow("%ls-cached", qUtf16Printable(dirEntry.fileName())) << suffix << true;
+    }
+}
+
+void tst_QFactoryLoader::scan()
+{
+    QFETCH(QString, suffix);
+    QFETCH(bool, cached);
+
+    if (cached)
+        qputenv("QT_PLUGIN_METADATA_CACHE_DIR", QFile::encodeName(cacheDir.path()));
+    auto cleanup = qScopeGuard([] { qunsetenv("QT_PLUGIN_METADATA_CACHE_DIR"); });
+
+    // no plugin implements this, so no library is ever kept alive between
+    // iterations and each one re-examines every file in the directory
+    static constexpr char iid[] = "org.qt-project.Qt.QBenchmarkFactoryInterface";
+    if (cached)
+        QFactoryLoader warmUp(iid, suffix);
+
+    QBENCHMARK {
+        QFactoryLoader loader(iid, suffix);
+    }
+}
+
+QTEST_MAIN(tst_QFactoryLoader)
+
+#include "tst_bench_qfactoryloader.moc"
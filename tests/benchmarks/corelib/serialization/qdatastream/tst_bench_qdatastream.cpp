@@ -0,0 +1,111 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QBuffer>
+#include <QDataStream>
+
+#include <QTest>
+
+// Compares streaming large lists of numbers as a whole, which is done in
+// bulk, with streaming them one element at a time.
+class tst_QDataStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void writeInts_data() { addRows(); }
+    void writeInts() { write<qint32>(); }
+    void readInts_data() { addRows(); }
+    void readInts() { read<qint32>(); }
+    void writeDoubles_data() { addRows(); }
+    void writeDoubles() { write<double>(); }
+    void readDoubles_data() { addRows(); }
+    void readDoubles() { read<double>(); }
+
+private:
+    static void addRows();
+    template <typename T> void write();
+    template <typename T> void read();
+};
+
+static constexpr qsizetype Count = 1000 * 1000;
+
+void tst_QDataStream::addRows()
+{
+    QTest::addColumn<QDataStream::ByteOrder>("byteOrder");
+    QTest::addColumn<bool>("elementWise");
+
+    QTest::newRow("bigendian-list") << QDataStream::BigEndian << false;
+    QTest::newRow("bigendian-elementwise") << QDataStream::BigEndian << true;
+    QTest::newRow("littleendian-list") << QDataStream::LittleEndian << false;
+    QTest::newRow("littleendian-elementwise") << QDataStream::LittleEndian << true;
+}
+
+template <typename T>
+static QList<T> makeList()
+{
+    QList<T> list(Count);
+    for (qsizetype i = 0; i < Count; ++i)
+        list[i] = T(i * 7 % 1000);
+    return list;
+}
+
+template <typename T>
+void tst_QDataStream::write()
+{
+    QFETCH(QDataStream::ByteOrder, byteOrder);
+    QFETCH(bool, elementWise);
+
+    const QList<T> list = makeList<T>();
+    QByteArray data;
+    data.reserve(Count * sizeof(T) + 4);
+    QBENCHMARK {
+        data.clear();
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setByteOrder(byteOrder);
+        if (elementWise) {
+            stream << quint32(list.size());
+            for (T t : list)
+                stream << t;
+        } else {
+            stream << list;
+        }
+    }
+    QCOMPARE(data.size(), Count * qsizetype(sizeof(T)) + 4);
+}
+
+template <typename T>
+void tst_QDataStream::read()
+{
+    QFETCH(QDataStream::ByteOrder, byteOrder);
+    QFETCH(bool, elementWise);
+
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setByteOrder(byteOrder);
+        stream << makeList<T>();
+    }
+
+    QList<T> list;
+    QBENCHMARK {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        QDataStream stream(&buffer);
+        stream.setByteOrder(byteOrder);
+        if (elementWise) {
+            quint32 size;
+            stream >> size;
+            list.resize(size);
+            for (T &t : list)
+                stream >> t;
+        } else {
+            stream >> list;
+        }
+    }
+    QCOMPARE(list.size(), Count);
+}
+
+QTEST_MAIN(tst_QDataStream)
+
+#include "tst_bench_qdatastream.moc"
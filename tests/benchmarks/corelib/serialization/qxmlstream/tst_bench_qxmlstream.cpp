@@ -0,0 +1,161 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QBuffer>
+#include <QXmlStreamReader>
+
+#include <QTest>
+
+#include <private/qxmlstreamrecords_p.h>
+
+using namespace Qt::StringLiterals;
+
+class tst_QXmlStreamReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void readAll_data();
+    void readAll();
+    void readRecords_data();
+    void readRecords();
+};
+
+// Generates a record-oriented document of roughly \a size bytes whose records
+// are dominated by the kind of content named by \a kind.
+static QByteArray generateDocument(QByteArrayView kind, qsizetype size)
+{
+    const QByteArray sentence = "The quick brown fox jumps over the lazy dog, "
+                                "and the d\xc3\xa9j\xc3\xa0 vu of it all is 42 & counting. ";
+    QByteArray record;
+    if (kind == "text") {
+        record = "<record>" + sentence.repeated(8).replace("&", "&amp;") + "</record>\n";
+    } else if (kind == "attributes") {
+        record = "<record id=\"1234567\" name=\"" + QByteArray(sentence).replace("&", "&amp;")
+                + "\" kind='plain attribute value of a moderate length'/>\n";
+    } else if (kind == "indented") {
+        record = "<record>\n" + QByteArray(16, ' ') + "<field>value</field>\n"
+                + QByteArray(16, ' ') + "<field>value</field>\n" + QByteArray(8, ' ')
+                + "</record>\n" + QByteArray(8, ' ');
+    } else {
+        Q_UNREACHABLE();
+    }
+
+    QByteArray document = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<records>\n";
+    document.reserve(size + record.size() + 16);
+    while (document.size() < size)
+        document += record;
+    document += "</records>\n";
+    return document;
+}
+
+void tst_QXmlStreamReader::readAll_data()
+{
+    QTest::addColumn<QByteArray>("document");
+    QTest::addColumn<bool>("fromDevice");
+
+    for (const char *kind : { "text", "attributes", "indented" }) {
+        const QByteArray document = generateDocument(kind, 4 * 1024 * 1024);
+        QTest::addRow("%s-bytearray", kind) << document << false;
+        QTest::addRow("%s-device", kind) << document << true;
+    }
+}
+
+void tst_QXmlStreamReader::readAll()
+{
+    QFETCH(QByteArray, document);
+    QFETCH(bool, fromDevice);
+
+    qsizetype characters = 0;
+    QBENCHMARK {
+        QBuffer buffer(&document);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QXmlStreamReader reader;
+        if (fromDevice)
+            reader.setDevice(&buffer);
+        else
+            reader.addData(document);
+
+        characters = 0;
+        while (!reader.atEnd()) {
+            switch (reader.readNext()) {
+            case QXmlStreamReader::Characters:
+                characters += reader.text().size();
+                break;
+            case QXmlStreamReader::StartElement:
+                for (const QXmlStreamAttribute &attribute : reader.attributes())
+                    characters += attribute.value().size();
+                break;
+            default:
+                break;
+            }
+        }
+        QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    }
+    QVERIFY(characters > 0);
+}
+
+void tst_QXmlStreamReader::readRecords_data()
+{
+    QTest::addColumn<QByteArray>("document");
+    QTest::addColumn<bool>("concurrent");
+
+    for (const char *kind : { "text", "attributes", "indented" }) {
+        const QByteArray document = generateDocument(kind, 16 * 1024 * 1024);
+        QTest::addRow("%s-sequential", kind) << document << false;
+        QTest::addRow("%s-concurrent", kind) << document << true;
+    }
+}
+
+// Counts the characters of one record, the way a typical per-record parser
+// would walk it.
+static qsizetype parseRecord(QXmlStreamReader &reader)
+{
+    qsizetype characters = 0;
+    int depth = 1;
+    while (depth && !reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::Characters:
+            characters += reader.text().size();
+            break;
+        case QXmlStreamReader::StartElement:
+            ++depth;
+            for (const QXmlStreamAttribute &attribute : reader.attributes())
+                characters += attribute.value().size();
+            break;
+        case QXmlStreamReader::EndElement:
+            --depth;
+            break;
+        default:
+            break;
+        }
+    }
+    return characters;
+}
+
+void tst_QXmlStreamReader::readRecords()
+{
+    QFETCH(QByteArray, document);
+    QFETCH(bool, concurrent);
+
+    qsizetype characters = 0;
+    QBENCHMARK {
+        characters = 0;
+        if (concurrent) {
+            QFuture<qsizetype> future = qParseXmlRecordsConcurrently(document, parseRecord);
+            for (qsizetype count : future.results())
+                characters += count;
+        } else {
+            QXmlStreamReader reader(document);
+            QVERIFY(reader.readNextStartElement());
+            while (reader.readNextStartElement())
+                characters += parseRecord(reader);
+            QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+        }
+    }
+    QVERIFY(characters > 0);
+}
+
+QTEST_MAIN(tst_QXmlStreamReader)
+
+#include "tst_bench_qxmlstream.moc"
@@ -0,0 +1,104 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QCollator>
+#include <QThreadPool>
+
+#include <QTest>
+
+#include <private/qcollator_p.h>
+
+#include <algorithm>
+
+// Compares ways of sorting a large list of names: by QCollator::compare(),
+// by one QCollatorSortKey per string and by a QCollatorSortKeyArena.
+class tst_QCollator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sort_data();
+    void sort();
+};
+
+// Generates \a count pseudo-random, name-like strings of mixed case, with
+// a few accented letters.
+static QList<QString> generateNames(qsizetype count)
+{
+    static const char16_t syllables[][4] = {
+        u"an", u"be", u"ch", u"dé", u"el", u"fr", u"gö", u"ha", u"in", u"jo",
+        u"ka", u"lä", u"ma", u"nø", u"or", u"pe", u"qu", u"ri", u"så", u"th",
+    };
+    constexpr quint32 SyllableCount = std::size(syllables);
+
+    QList<QString> names;
+    names.reserve(count);
+    quint32 seed = 42;
+    const auto next = [&seed] { return (seed = seed * 1103515245 + 12345) >> 16; };
+    for (qsizetype i = 0; i < count; ++i) {
+        QString name;
+        for (quint32 n = 2 + next() % 4; n > 0; --n)
+            name += QStringView(syllables[next() % SyllableCount]);
+        name[0] = name.at(0).toUpper();
+        names.append(name);
+    }
+    return names;
+}
+
+void tst_QCollator::sort_data()
+{
+    QTest::addColumn<QString>("locale");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QString>("method");
+
+    for (const char *locale : { "C", "en_US", "sv_SE" }) {
+        for (int count : { 10000, 1000000 }) {
+            for (const char *method : { "compare", "sortKey", "arena", "arena-one-worker" }) {
+                QTest::addRow("%s-%d-%s", locale, count, method)
+                        << QString::fromLatin1(locale) << count << QString::fromLatin1(method);
+            }
+        }
+    }
+}
+
+void tst_QCollator::sort()
+{
+    QFETCH(QString, locale);
+    QFETCH(int, count);
+    QFETCH(QString, method);
+
+    const QCollator collator((QLocale(locale)));
+    const QList<QString> names = generateNames(count);
+    QThreadPool singleThread;
+    singleThread.setMaxThreadCount(1);
+
+    QList<QString> sorted;
+    QBENCHMARK {
+        sorted = names;
+        if (method == u"compare") {
+            std::sort(sorted.begin(), sorted.end(), collator);
+        } else if (method == u"sortKey") {
+            QList<std::pair<QCollatorSortKey, qsizetype>> keys;
+            keys.reserve(sorted.size());
+            for (qsizetype i = 0; i < sorted.size(); ++i)
+                keys.emplace_back(collator.sortKey(sorted.at(i)), i);
+            std::sort(keys.begin(), keys.end(), [](const auto &lhs, const auto &rhs) {
+                return lhs.first.compare(rhs.first) < 0;
+            });
+            QList<QString> result;
+            result.reserve(keys.size());
+            for (const auto &key : std::as_const(keys))
+                result.append(names.at(key.second));
+            sorted = std::move(result);
+        } else {
+            // one worker thread and the calling thread share the key computation
+            QCollatorSortKeyArena::sort(sorted, collator,
+                                        method == u"arena" ? nullptr : &singleThread);
+        }
+    }
+    QCOMPARE(sorted.size(), names.size());
+}
+
+QTEST_MAIN(tst_QCollator)
+
+#include "tst_bench_qcollator.moc"
@@ -0,0 +1,106 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QCache>
+#include <QMutex>
+#include <QTest>
+#include <QThread>
+
+#include <private/qconcurrentcache_p.h>
+
+#include <memory>
+#include <vector>
+
+// Compares a QConcurrentCache with a QCache behind a mutex, as used from
+// several threads looking up keys with a skewed distribution and inserting
+// the ones that were missing.
+class tst_QConcurrentCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void lookupAndInsert_data();
+    void lookupAndInsert();
+};
+
+class LockedCache
+{
+public:
+    explicit LockedCache(qsizetype maxCost) : cache(maxCost) { }
+
+    std::optional<QByteArray> object(int key)
+    {
+        const QMutexLocker locker(&mutex);
+        if (const QByteArray *value = cache.object(key))
+            return *value;
+        return std::nullopt;
+    }
+    void insert(int key, const QByteArray &value)
+    {
+        const QMutexLocker locker(&mutex);
+        cache.insert(key, new QByteArray(value));
+    }
+
+private:
+    QMutex mutex;
+    QCache<int, QByteArray> cache;
+};
+
+static constexpr int MaxCost = 10000;
+static constexpr int KeyRange = 100000;
+static constexpr int OperationsPerThread = 100000;
+
+void tst_QConcurrentCache::lookupAndInsert_data()
+{
+    QTest::addColumn<bool>("concurrent");
+    QTest::addColumn<int>("threadCount");
+
+    for (int threadCount : { 1, 4, 16 }) {
+        QTest::addRow("locked-qcache-%d", threadCount) << false << threadCount;
+        QTest::addRow("qconcurrentcache-%d", threadCount) << true << threadCount;
+    }
+}
+
+template <typename Cache>
+static void run(Cache &cache, int threadCount)
+{
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back(QThread::create([&cache, t] {
+            quint32 state = 1 + t;
+            for (int i = 0; i < OperationsPerThread; ++i) {
+                state = state * 1664525u + 1013904223u;
+                // skewed towards small keys
+                const int key = int(quint64((state >> 8) % KeyRange) * ((state >> 16) % KeyRange)
+                                    / KeyRange);
+                if (!cache.object(key))
+                    cache.insert(key, QByteArray::number(key));
+            }
+        }));
+        threads.back()->start();
+    }
+    for (const auto &thread : threads)
+        thread->wait();
+}
+
+void tst_QConcurrentCache::lookupAndInsert()
+{
+    QFETCH(bool, concurrent);
+    QFETCH(int, threadCount);
+
+    if (concurrent) {
+        QBENCHMARK {
+            QConcurrentCache<int, QByteArray> cache(MaxCost);
+            run(cache, threadCount);
+        }
+    } else {
+        QBENCHMARK {
+            LockedCache cache(MaxCost);
+            run(cache, threadCount);
+        }
+    }
+}
+
+QTEST_MAIN(tst_QConcurrentCache)
+
+#include "tst_bench_qconcurrentcache.moc"
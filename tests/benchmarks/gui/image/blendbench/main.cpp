@@ -71,6 +71,9 @@ private slots:
 
     void unalignedBlendArgb32_data();
     void unalignedBlendArgb32();
+
+    void blendFormats_data();
+    void blendFormats();
 };
 
 void BlendBench::blendBench_data()
@@ -184,6 +187,68 @@ void BlendBench::unalignedBlendArgb32()
     qFreeAligned(dstMemory);
 }
 
+void BlendBench::blendFormats_data()
+{
+    // Every destination format with the most common composition modes, or
+    // with all of them when running with --extended.
+    QList<int> modes = { QPainter::CompositionMode_SourceOver, QPainter::CompositionMode_Source,
+                         QPainter::CompositionMode_Plus };
+    if (qApp->arguments().contains("--extended")) {
+        modes.clear();
+        for (int mode = 0; mode < 24; ++mode)
+            modes.append(mode);
+    }
+
+    QTest::addColumn<int>("brushType");
+    QTest::addColumn<int>("compositionMode");
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<bool>("constAlpha");
+
+    const QMetaEnum formats = QMetaEnum::fromType<QImage::Format>();
+    for (int format = QImage::Format_RGB32; format < QImage::NImageFormats; ++format) {
+        for (int brush = ImageBrush; brush <= SolidBrush; ++brush) {
+            for (int mode : std::as_const(modes)) {
+                for (bool constAlpha : { false, true }) {
+                    QTest::addRow("%s; brush=%s; mode=%s%s", formats.valueToKey(format) + qstrlen("Format_"),
+                                  brushTypes[brush].data(), compositionModes[mode].data(),
+                                  constAlpha ? "; opacity=0.7" : "")
+                        << brush << mode << QImage::Format(format) << constAlpha;
+                }
+            }
+        }
+    }
+}
+
+void BlendBench::blendFormats()
+{
+    QFETCH(int, brushType);
+    QFETCH(int, compositionMode);
+    QFETCH(QImage::Format, format);
+    QFETCH(bool, constAlpha);
+
+    QImage img(512, 512, format);
+    img.fill(QColor(60, 120, 180, 200));
+    QImage src(512, 512, QImage::Format_ARGB32_Premultiplied);
+    paint(&src);
+    if (img.depth() > 32 || img.pixelFormat().typeInterpretation() == QPixelFormat::FloatingPoint)
+        src.convertTo(QImage::Format_RGBA64_Premultiplied);
+    QPainter p(&img);
+    p.setPen(Qt::NoPen);
+
+    p.setCompositionMode(QPainter::CompositionMode(compositionMode));
+    if (brushType == ImageBrush) {
+        p.setBrush(QBrush(src));
+    } else if (brushType == SolidBrush) {
+        p.setBrush(QColor(127, 127, 127, 127));
+    }
+    if (constAlpha)
+        p.setOpacity(0.7f);
+
+    QBENCHMARK {
+        p.drawRect(0, 0, 512, 512);
+    }
+}
+
 QTEST_MAIN(BlendBench)
 
 #include "main.moc"
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <private/qimagecache_p.h>
+
+#include <memory>
+#include <vector>
+
+class tst_QImageCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void find_data();
+    void find();
+    void spillRoundTrip();
+};
+
+static constexpr int KeyCount = 256;
+
+static QImage thumbnail(int i)
+{
+    QImage image(128, 128, QImage::Format_ARGB32_Premultiplied);
+    image.fill(qRgba(i, 255 - i, i * 3, 255));
+    return image;
+}
+
+void tst_QImageCache::find_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+}
+
+// Looks up cached thumbnails from several threads at once, the way
+// decoding workers and the GUI thread share one cache.
+void tst_QImageCache::find()
+{
+    QFETCH(int, threadCount);
+
+    QImageCache cache;
+    QStringList keys;
+    for (int i = 0; i < KeyCount; ++i) {
+        keys.append(QString::number(i));
+        cache.insert(keys.last(), thumbnail(i));
+    }
+
+    QBENCHMARK {
+        std::vector<std::unique_ptr<QThread>> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back(QThread::create([&cache, &keys, t] {
+                for (int round = 0; round < 64; ++round) {
+                    for (int i = 0; i < KeyCount; ++i) {
+                        if (cache.find(keys.at((i + t * 31) % KeyCount)).isNull())
+                            qFatal("Cache miss");
+                    }
+                }
+            }));
+            threads.back()->start();
+        }
+        for (const auto &thread : threads)
+            thread->wait();
+    }
+}
+
+// Evicts thumbnails to disk and reads them back.
+void tst_QImageCache::spillRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QImageCache cache(QImageCache::cost(thumbnail(0)));
+    cache.setSpillDirectory(dir.path());
+    for (int i = 0; i < 32; ++i)
+        cache.insert(QString::number(i), thumbnail(i));
+
+    int i = 0;
+    QBENCHMARK {
+        QVERIFY(!cache.find(QString::number(i)).isNull());
+        i = (i + 1) % 32;
+    }
+}
+
+QTEST_MAIN(tst_QImageCache)
+#include "tst_bench_qimagecache.moc"
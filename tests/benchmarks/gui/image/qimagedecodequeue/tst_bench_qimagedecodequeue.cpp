@@ -0,0 +1,107 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QImage>
+#include <QImageReader>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QThreadPool>
+
+#include <private/qimagedecodequeue_p.h>
+
+using namespace Qt::StringLiterals;
+
+// Decodes a folder of photo sized images into thumbnails, the way a
+// gallery view does, once with QImageReader on the calling thread and
+// once through QImageDecodeQueue.
+
+class tst_QImageDecodeQueue : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void thumbnails_data();
+    void thumbnails();
+
+private:
+    QStringList m_files[2];
+    QTemporaryDir m_dir;
+};
+
+static constexpr int ImageCount = 64;
+static constexpr QSize ThumbnailSize(256, 256);
+
+void tst_QImageDecodeQueue::initTestCase()
+{
+    QVERIFY2(m_dir.isValid(), qPrintable(m_dir.errorString()));
+    const QByteArray formats[] = { "png", "jpeg" };
+    for (int f = 0; f < 2; ++f) {
+        if (!QImageReader::supportedImageFormats().contains(formats[f]))
+            continue;
+        for (int i = 0; i < ImageCount; ++i) {
+            QImage image(1600 + i * 8, 1200, QImage::Format_RGB32);
+            QPainter painter(&image);
+            QLinearGradient gradient(0, 0, image.width(), image.height());
+            gradient.setColorAt(0, QColor::fromHsv(i * 5, 200, 255));
+            gradient.setColorAt(1, QColor::fromHsv(i * 11 % 360, 255, 80));
+            painter.fillRect(image.rect(), gradient);
+            painter.setPen(QPen(Qt::white, 9));
+            for (int j = 0; j < 40; ++j)
+                painter.drawEllipse(QPoint((j * 97 + i * 13) % image.width(), (j * 61) % 1200), 80, 50);
+            painter.end();
+
+            const QString fileName = m_dir.filePath(u"%1.%2"_s.arg(i).arg(QLatin1StringView(formats[f])));
+            QVERIFY(image.save(fileName, formats[f].constData()));
+            m_files[f].append(fileName);
+        }
+    }
+}
+
+void tst_QImageDecodeQueue::thumbnails_data()
+{
+    QTest::addColumn<int>("fileFormat");
+    QTest::addColumn<bool>("queued");
+
+    QTest::newRow("png-reader") << 0 << false;
+    QTest::newRow("png-queue") << 0 << true;
+    QTest::newRow("jpeg-reader") << 1 << false;
+    QTest::newRow("jpeg-queue") << 1 << true;
+}
+
+void tst_QImageDecodeQueue::thumbnails()
+{
+    QFETCH(int, fileFormat);
+    QFETCH(bool, queued);
+
+    const QStringList &files = m_files[fileFormat];
+    if (files.isEmpty())
+        QSKIP("The image format is not supported");
+
+    if (queued) {
+        QThreadPool pool;
+        QImageDecodeQueue queue(&pool);
+        QBENCHMARK {
+            QList<QFuture<QImage>> futures;
+            futures.reserve(files.size());
+            for (const QString &fileName : files)
+                futures.append(queue.decode(fileName, ThumbnailSize, QImage::Format_ARGB32_Premultiplied));
+            for (const QFuture<QImage> &future : std::as_const(futures))
+                QVERIFY(!future.result().isNull());
+        }
+    } else {
+        QBENCHMARK {
+            for (const QString &fileName : files) {
+                QImageReader reader(fileName);
+                reader.setScaledSize(reader.size().scaled(ThumbnailSize, Qt::KeepAspectRatio));
+                QImage image = reader.read();
+                QVERIFY(!image.isNull());
+                image.convertTo(QImage::Format_ARGB32_Premultiplied);
+            }
+        }
+    }
+}
+
+QTEST_MAIN(tst_QImageDecodeQueue)
+#include "tst_bench_qimagedecodequeue.moc"
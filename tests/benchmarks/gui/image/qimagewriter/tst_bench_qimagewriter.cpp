@@ -0,0 +1,84 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QBuffer>
+#include <QImage>
+#include <QImageWriter>
+#include <QLinearGradient>
+#include <QPainter>
+
+class tst_QImageWriter : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void writePng_data();
+    void writePng();
+
+private:
+    QImage m_screenshot;
+    QImage m_photo;
+};
+
+void tst_QImageWriter::initTestCase()
+{
+    // flat colors, text and lines, like a screen shot or a map
+    m_screenshot = QImage(2560, 1440, QImage::Format_RGB32);
+    m_screenshot.fill(QColor(240, 240, 240));
+    {
+        QPainter painter(&m_screenshot);
+        for (int i = 0; i < 60; ++i) {
+            const QRect rect((i * 331) % 2400, (i * 197) % 1300, 160 + i * 3, 90 + i);
+            painter.fillRect(rect, QColor::fromHsv(i * 6, 60, 250));
+            painter.setPen(Qt::black);
+            painter.drawRect(rect);
+            painter.drawText(rect.adjusted(6, 6, -6, -6), QStringLiteral("Item %1: lorem ipsum dolor").arg(i));
+        }
+    }
+
+    // smooth gradients with noise, like a photo
+    m_photo = QImage(2560, 1440, QImage::Format_ARGB32);
+    quint32 noise = 4711;
+    for (int y = 0; y < m_photo.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(m_photo.scanLine(y));
+        for (int x = 0; x < m_photo.width(); ++x) {
+            noise = noise * 1103515245 + 12345;
+            const int n = int(noise >> 28) - 8;
+            line[x] = qRgba(qBound(0, x / 10 + n, 255), qBound(0, y / 6 + n, 255),
+                            qBound(0, (x + y) / 16 + n, 255), 255);
+        }
+    }
+}
+
+void tst_QImageWriter::writePng_data()
+{
+    QTest::addColumn<bool>("photo");
+    QTest::addColumn<int>("compression");
+
+    for (int compression : { 0, 20, 50, 80, 100 }) {
+        QTest::addRow("screenshot-%d", compression) << false << compression;
+        QTest::addRow("photo-%d", compression) << true << compression;
+    }
+}
+
+void tst_QImageWriter::writePng()
+{
+    QFETCH(bool, photo);
+    QFETCH(int, compression);
+
+    const QImage &image = photo ? m_photo : m_screenshot;
+    QByteArray data;
+    QBENCHMARK {
+        data.clear();
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        QImageWriter writer(&buffer, "png");
+        writer.setCompression(compression);
+        QVERIFY(writer.write(image));
+    }
+    qDebug("%lld bytes", qint64(data.size()));
+}
+
+QTEST_MAIN(tst_QImageWriter)
+#include "tst_bench_qimagewriter.moc"
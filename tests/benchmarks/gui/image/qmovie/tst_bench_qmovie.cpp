@@ -0,0 +1,201 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QBuffer>
+#include <QImageReader>
+#include <QMovie>
+
+#include <vector>
+
+// Plays a large animated GIF that is generated on the fly: a full first
+// frame, followed by frames that only repaint a sprite moving across it.
+
+class tst_QMovie : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void decode();
+    void play_data();
+    void play();
+
+private:
+    QByteArray m_gif;
+};
+
+static constexpr int Width = 1024;
+static constexpr int Height = 768;
+static constexpr int SpriteWidth = 256;
+static constexpr int SpriteHeight = 192;
+static constexpr int FrameCount = 32;
+
+static void appendWord(QByteArray *data, int value)
+{
+    data->append(char(value & 0xff));
+    data->append(char(value >> 8));
+}
+
+// Compresses 8 bit color indices the way GIF expects them.
+static QByteArray lzwEncode(const std::vector<uchar> &indices)
+{
+    constexpr int ClearCode = 256;
+    constexpr int EndCode = 257;
+    constexpr int MaxCode = 4096;
+
+    QByteArray packed;
+    quint32 accum = 0;
+    int bits = 0;
+    int codeSize = 9;
+    const auto write = [&](int code) {
+        accum |= quint32(code) << bits;
+        bits += codeSize;
+        while (bits >= 8) {
+            packed.append(char(accum & 0xff));
+            accum >>= 8;
+            bits -= 8;
+        }
+    };
+
+    std::vector<short> table(MaxCode * 256, -1);
+    int nextCode = EndCode + 1;
+    write(ClearCode);
+    int prefix = indices.front();
+    for (size_t i = 1; i < indices.size(); ++i) {
+        const uchar index = indices[i];
+        short &entry = table[prefix * 256 + index];
+        if (entry >= 0) {
+            prefix = entry;
+            continue;
+        }
+        write(prefix);
+        if (nextCode < MaxCode) {
+            entry = short(nextCode++);
+            if (nextCode > (1 << codeSize) && codeSize < 12)
+                ++codeSize;
+        } else {
+            write(ClearCode);
+            std::fill(table.begin(), table.end(), -1);
+            nextCode = EndCode + 1;
+            codeSize = 9;
+        }
+        prefix = index;
+    }
+    write(prefix);
+    write(EndCode);
+    if (bits > 0)
+        packed.append(char(accum & 0xff));
+
+    QByteArray blocks;
+    blocks.append(char(8)); // minimum code size
+    for (qsizetype i = 0; i < packed.size(); i += 255) {
+        const qsizetype size = qMin<qsizetype>(255, packed.size() - i);
+        blocks.append(char(size));
+        blocks.append(packed.mid(i, size));
+    }
+    blocks.append(char(0));
+    return blocks;
+}
+
+static void appendFrame(QByteArray *gif, const QRect &rect, int frame)
+{
+    // graphic control extension: keep the previous frame, 20 ms delay
+    gif->append("\x21\xf9\x04\x04", 4);
+    appendWord(gif, 2);
+    gif->append("\x00\x00", 2);
+
+    gif->append(char(0x2c));
+    appendWord(gif, rect.x());
+    appendWord(gif, rect.y());
+    appendWord(gif, rect.width());
+    appendWord(gif, rect.height());
+    gif->append(char(0));
+
+    std::vector<uchar> indices;
+    indices.reserve(size_t(rect.width()) * rect.height());
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        for (int x = rect.left(); x <= rect.right(); ++x)
+            indices.push_back(uchar((x / 16 + y / 16 * 5 + frame * 7) ^ ((x * y) >> 11)));
+    }
+    gif->append(lzwEncode(indices));
+}
+
+void tst_QMovie::initTestCase()
+{
+    if (!QImageReader::supportedImageFormats().contains("gif"))
+        QSKIP("GIF support is not available");
+
+    m_gif = QByteArray("GIF89a");
+    appendWord(&m_gif, Width);
+    appendWord(&m_gif, Height);
+    m_gif.append("\xf7\x00\x00", 3); // 256 global colors
+    for (int i = 0; i < 256; ++i) {
+        m_gif.append(char(i));
+        m_gif.append(char(255 - i));
+        m_gif.append(char(i * 5));
+    }
+    m_gif.append("\x21\xff\x0bNETSCAPE2.0\x03\x01\x00\x00\x00", 19);
+
+    appendFrame(&m_gif, QRect(0, 0, Width, Height), 0);
+    for (int frame = 1; frame < FrameCount; ++frame) {
+        const QPoint position((frame * 24) % (Width - SpriteWidth),
+                              (frame * 18) % (Height - SpriteHeight));
+        appendFrame(&m_gif, QRect(position, QSize(SpriteWidth, SpriteHeight)), frame);
+    }
+    m_gif.append(char(0x3b));
+
+    QBuffer buffer(&m_gif);
+    QImageReader reader(&buffer, "gif");
+    QCOMPARE(reader.imageCount(), FrameCount);
+    const QImage first = reader.read();
+    QCOMPARE(first.size(), QSize(Width, Height));
+    QCOMPARE(first.pixel(100, 50), qRgb(23, 232, 115));
+}
+
+// Decodes all frames, which is dominated by the LZW decompression.
+void tst_QMovie::decode()
+{
+    QBENCHMARK {
+        QBuffer buffer(&m_gif);
+        QImageReader reader(&buffer, "gif");
+        int frames = 0;
+        QImage image;
+        while (reader.read(&image))
+            ++frames;
+        QCOMPARE(frames, FrameCount);
+    }
+}
+
+void tst_QMovie::play_data()
+{
+    QTest::addColumn<QMovie::CacheMode>("cacheMode");
+    QTest::addColumn<QByteArray>("cacheLimit");
+
+    QTest::newRow("CacheNone") << QMovie::CacheNone << QByteArray();
+    QTest::newRow("CacheAll") << QMovie::CacheAll << QByteArray("1024");
+    QTest::newRow("CacheAll, compressed") << QMovie::CacheAll << QByteArray("0");
+}
+
+// Plays the movie three times, the way a looping animation shows it.
+void tst_QMovie::play()
+{
+    QFETCH(QMovie::CacheMode, cacheMode);
+    QFETCH(QByteArray, cacheLimit);
+
+    QBENCHMARK {
+        QBuffer buffer(&m_gif);
+        buffer.open(QIODevice::ReadOnly);
+        if (!cacheLimit.isEmpty())
+            qputenv("QT_MOVIE_CACHE_LIMIT", cacheLimit);
+        QMovie movie(&buffer, "gif");
+        qunsetenv("QT_MOVIE_CACHE_LIMIT");
+        movie.setCacheMode(cacheMode);
+        for (int loop = 0; loop < 3; ++loop) {
+            for (int frame = 0; frame < FrameCount; ++frame)
+                QVERIFY(movie.jumpToFrame(frame));
+        }
+    }
+}
+
+QTEST_MAIN(tst_QMovie)
+#include "tst_bench_qmovie.moc"
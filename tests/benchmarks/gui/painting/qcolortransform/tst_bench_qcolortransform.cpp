@@ -0,0 +1,103 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QColorSpace>
+#include <QColorTransform>
+#include <QFile>
+#include <QImage>
+
+// Converts images between color spaces. Large images with an ICC profile
+// that goes through element based processing are converted through a
+// baked 3D lookup table, while small ones are converted pixel by pixel;
+// compare the time per pixel of the two sizes.
+
+class tst_QColorTransform : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void convert_data();
+    void convert();
+
+private:
+    QColorSpace m_videoHd;
+    QColorSpace m_srgbLab;
+};
+
+void tst_QColorTransform::initTestCase()
+{
+    const QString prefix = QFINDTESTDATA("../../../../auto/gui/painting/qcolorspace/resources/");
+    if (prefix.isEmpty())
+        QSKIP("The ICC profiles of tst_qcolorspace were not found");
+    QFile videoHd(prefix + "VideoHD.icc");
+    QFile srgbLab(prefix + "sRGB_ICC_v4_Appearance.icc");
+    QVERIFY(videoHd.open(QIODevice::ReadOnly));
+    QVERIFY(srgbLab.open(QIODevice::ReadOnly));
+    m_videoHd = QColorSpace::fromIccProfile(videoHd.readAll());
+    m_srgbLab = QColorSpace::fromIccProfile(srgbLab.readAll());
+    QVERIFY(m_videoHd.isValid());
+    QVERIFY(m_srgbLab.isValid());
+}
+
+void tst_QColorTransform::convert_data()
+{
+    QTest::addColumn<QColorSpace>("from");
+    QTest::addColumn<QColorSpace>("to");
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<int>("size");
+
+    const QColorSpace srgb(QColorSpace::SRgb);
+    const QColorSpace displayP3(QColorSpace::DisplayP3);
+    const struct {
+        const char *name;
+        QColorSpace from;
+        QColorSpace to;
+    } transforms[] = {
+        { "DisplayP3->sRGB", displayP3, srgb },
+        { "VideoHD->sRGB", m_videoHd, srgb },
+        { "sRGB->VideoHD", srgb, m_videoHd },
+        { "sRGB PCSLab->DisplayP3", m_srgbLab, displayP3 },
+    };
+    const struct {
+        const char *name;
+        QImage::Format format;
+    } formats[] = {
+        { "RGB32", QImage::Format_RGB32 },
+        { "ARGB32PM", QImage::Format_ARGB32_Premultiplied },
+        { "RGBA64", QImage::Format_RGBA64 },
+    };
+    for (const auto &transform : transforms) {
+        for (const auto &format : formats) {
+            for (int size : { 128, 2048 }) {
+                QTest::addRow("%s %s %dx%d", transform.name, format.name, size, size)
+                        << transform.from << transform.to << format.format << size;
+            }
+        }
+    }
+}
+
+void tst_QColorTransform::convert()
+{
+    QFETCH(QColorSpace, from);
+    QFETCH(QColorSpace, to);
+    QFETCH(QImage::Format, format);
+    QFETCH(int, size);
+
+    QImage image(size, size, QImage::Format_ARGB32);
+    for (int y = 0; y < size; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < size; ++x)
+            line[x] = qRgba(x * 255 / size, y * 255 / size, (x ^ y) & 0xff, 255 - (x & 0x3f));
+    }
+    image.convertTo(format);
+    image.setColorSpace(from);
+
+    QBENCHMARK {
+        const QImage converted = image.convertedToColorSpace(to);
+        QVERIFY(!converted.isNull());
+    }
+}
+
+QTEST_MAIN(tst_QColorTransform)
+#include "tst_bench_qcolortransform.moc"
@@ -0,0 +1,96 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <QtMath>
+
+#include <private/qpaintengine_raster_p.h>
+
+// Draws the same paths over and over at different positions, the way map
+// markers, icons or chart symbols are drawn, with and without the raster
+// engine caching their coverage.
+
+class tst_QPainterPathCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void draw_data();
+    void draw();
+};
+
+static QPainterPath gear(int teeth, qreal radius)
+{
+    QPainterPath path;
+    for (int i = 0; i < teeth; ++i) {
+        const qreal a = 2 * M_PI * i / teeth;
+        const qreal b = 2 * M_PI * (i + 0.5) / teeth;
+        const QPointF outer(qCos(a) * radius, qSin(a) * radius);
+        const QPointF inner(qCos(b) * radius * 0.75, qSin(b) * radius * 0.75);
+        if (i == 0)
+            path.moveTo(outer);
+        else
+            path.lineTo(outer);
+        path.quadTo(QPointF(qCos(b) * radius * 1.1, qSin(b) * radius * 1.1), inner);
+    }
+    path.closeSubpath();
+    path.addEllipse(QPointF(0, 0), radius * 0.3, radius * 0.3);
+    return path;
+}
+
+void tst_QPainterPathCache::draw_data()
+{
+    QTest::addColumn<bool>("cached");
+    QTest::addColumn<bool>("antialiased");
+    QTest::addColumn<bool>("stroke");
+    QTest::addColumn<int>("radius");
+
+    for (bool stroke : { false, true }) {
+        for (bool antialiased : { false, true }) {
+            for (int radius : { 8, 48 }) {
+                for (bool cached : { false, true }) {
+                    QTest::addRow("%s, %s, radius %d, %s", stroke ? "stroke" : "fill",
+                                  antialiased ? "antialiased" : "aliased", radius,
+                                  cached ? "cached" : "uncached")
+                            << cached << antialiased << stroke << radius;
+                }
+            }
+        }
+    }
+}
+
+void tst_QPainterPathCache::draw()
+{
+    QFETCH(bool, cached);
+    QFETCH(bool, antialiased);
+    QFETCH(bool, stroke);
+    QFETCH(int, radius);
+
+    const QPainterPath path = gear(24, radius);
+    QImage image(1024, 768, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter p(&image);
+    static_cast<QRasterPaintEngine *>(p.paintEngine())->setPathCacheEnabled(cached);
+    p.setRenderHint(QPainter::Antialiasing, antialiased);
+    if (stroke) {
+        p.setPen(QPen(QColor(0, 0, 160, 200), 2.5));
+        p.setBrush(Qt::NoBrush);
+    } else {
+        p.setPen(Qt::NoPen);
+        p.setBrush(QColor(200, 40, 40, 220));
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < 200; ++i) {
+            p.resetTransform();
+            p.translate((i * 97) % 1024, (i * 61) % 768);
+            p.rotate(30);
+            p.drawPath(path);
+        }
+    }
+}
+
+QTEST_MAIN(tst_QPainterPathCache)
+#include "tst_bench_qpainterpathcache.moc"
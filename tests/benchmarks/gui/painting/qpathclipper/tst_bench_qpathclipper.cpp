@@ -0,0 +1,77 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QRandomGenerator>
+#include <QtMath>
+
+// Boolean operations on large overlapping polygons, like the outlines of
+// regions in a map that are combined with each other.
+
+class tst_QPathClipper : public QObject
+{
+    Q_OBJECT
+private slots:
+    void operation_data();
+    void operation();
+};
+
+static QPainterPath jaggedPolygon(const QPointF &center, int vertexCount, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QPolygonF polygon;
+    polygon.reserve(vertexCount);
+    for (int i = 0; i < vertexCount; ++i) {
+        const qreal angle = 2 * M_PI * i / vertexCount;
+        const qreal radius = 1000 + random.bounded(100.0);
+        polygon << center + QPointF(qCos(angle) * radius, qSin(angle) * radius);
+    }
+    QPainterPath path;
+    path.addPolygon(polygon);
+    path.closeSubpath();
+    return path;
+}
+
+enum Operation { United, Intersected, Subtracted };
+
+void tst_QPathClipper::operation_data()
+{
+    QTest::addColumn<int>("operation");
+    QTest::addColumn<int>("vertexCount");
+
+    for (int vertexCount : { 1000, 5000, 20000 }) {
+        QTest::addRow("united, %d", vertexCount) << int(United) << vertexCount;
+        QTest::addRow("intersected, %d", vertexCount) << int(Intersected) << vertexCount;
+        QTest::addRow("subtracted, %d", vertexCount) << int(Subtracted) << vertexCount;
+    }
+}
+
+void tst_QPathClipper::operation()
+{
+    QFETCH(int, operation);
+    QFETCH(int, vertexCount);
+
+    const QPainterPath subject = jaggedPolygon(QPointF(0, 0), vertexCount, 1);
+    const QPainterPath clip = jaggedPolygon(QPointF(600, 400), vertexCount, 2);
+
+    QBENCHMARK {
+        QPainterPath result;
+        switch (operation) {
+        case United:
+            result = subject.united(clip);
+            break;
+        case Intersected:
+            result = subject.intersected(clip);
+            break;
+        case Subtracted:
+            result = subject.subtracted(clip);
+            break;
+        }
+        QVERIFY(!result.isEmpty());
+    }
+}
+
+QTEST_MAIN(tst_QPathClipper)
+#include "tst_bench_qpathclipper.moc"
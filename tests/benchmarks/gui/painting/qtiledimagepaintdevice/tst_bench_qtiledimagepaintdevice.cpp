@@ -0,0 +1,83 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <QRandomGenerator>
+
+#include <private/qtiledimagepaintdevice_p.h>
+
+#include <vector>
+
+class tst_QTiledImagePaintDevice : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void paths_data();
+    void paths();
+
+private:
+    struct Shape
+    {
+        QPainterPath path;
+        QColor color;
+    };
+    std::vector<Shape> m_shapes;
+};
+
+static constexpr int ImageSize = 2048;
+
+void tst_QTiledImagePaintDevice::initTestCase()
+{
+    QRandomGenerator random(4711);
+    m_shapes.reserve(10000);
+    for (int i = 0; i < 10000; ++i) {
+        const QPointF origin(random.bounded(double(ImageSize)), random.bounded(double(ImageSize)));
+        auto around = [&](double radius) {
+            return origin + QPointF(random.bounded(2 * radius) - radius,
+                                    random.bounded(2 * radius) - radius);
+        };
+        QPainterPath path(origin);
+        path.cubicTo(around(60), around(60), around(60));
+        path.quadTo(around(40), around(40));
+        path.closeSubpath();
+        m_shapes.push_back({ path, QColor::fromRgba(random.generate() | 0x40000000) });
+    }
+}
+
+void tst_QTiledImagePaintDevice::paths_data()
+{
+    QTest::addColumn<bool>("tiled");
+
+    QTest::newRow("direct") << false;
+    QTest::newRow("tiled") << true;
+}
+
+void tst_QTiledImagePaintDevice::paths()
+{
+    QFETCH(bool, tiled);
+
+    QImage image(ImageSize, ImageSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QTiledImagePaintDevice device(&image);
+    QPaintDevice *target = tiled ? static_cast<QPaintDevice *>(&device) : &image;
+
+    QBENCHMARK {
+        QPainter painter(target);
+        painter.setRenderHint(QPainter::Antialiasing);
+        for (const Shape &shape : m_shapes) {
+            painter.setPen(QPen(shape.color.darker(), 1.5));
+            painter.setBrush(shape.color);
+            painter.drawPath(shape.path);
+        }
+        painter.end();
+        if (tiled)
+            device.flush();
+    }
+}
+
+QTEST_MAIN(tst_QTiledImagePaintDevice)
+#include "tst_bench_qtiledimagepaintdevice.moc"
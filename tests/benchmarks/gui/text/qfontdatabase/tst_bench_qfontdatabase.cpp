@@ -0,0 +1,66 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QDir>
+#include <QStandardPaths>
+
+#include <private/qfontdatabase_p.h>
+
+// Populates the font database the way an application does when it starts:
+// it lists the font families and lays out some text in the default font.
+// With fontconfig, the populated database is either built by scanning the
+// installed fonts or loaded from the scan cache of the previous start. The
+// cache is written to the test mode cache location, and removed afterwards.
+
+class tst_QFontDatabase : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cleanup();
+    void populate_data();
+    void populate();
+};
+
+void tst_QFontDatabase::cleanup()
+{
+    qunsetenv("QT_FONTCONFIG_CACHE");
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+         + QLatin1String("/qtfontconfig")).removeRecursively();
+    QFontDatabasePrivate::instance()->invalidate();
+    QStandardPaths::setTestModeEnabled(false);
+}
+
+void tst_QFontDatabase::populate_data()
+{
+    QTest::addColumn<bool>("scanCache");
+
+    QTest::newRow("scan") << false;
+    QTest::newRow("scan cache") << true;
+}
+
+void tst_QFontDatabase::populate()
+{
+    QFETCH(bool, scanCache);
+
+    QStandardPaths::setTestModeEnabled(true);
+    if (!scanCache)
+        qputenv("QT_FONTCONFIG_CACHE", "0");
+
+    // Make sure the cache is up to date before measuring
+    QFontDatabasePrivate::instance()->invalidate();
+    if (QFontDatabase::families().isEmpty())
+        QSKIP("There are no fonts available");
+
+    QBENCHMARK {
+        QFontDatabasePrivate::instance()->invalidate();
+        QVERIFY(!QFontDatabase::families().isEmpty());
+        QFontMetrics metrics(QFontDatabase::systemFont(QFontDatabase::GeneralFont));
+        QVERIFY(metrics.horizontalAdvance(QStringLiteral("Hello world")) > 0);
+    }
+}
+
+QTEST_MAIN(tst_QFontDatabase)
+#include "tst_bench_qfontdatabase.moc"
@@ -0,0 +1,153 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QImage>
+#include <QPainter>
+
+#include <private/qfont_p.h>
+#include <private/qfontengine_ft_p.h>
+
+#include <set>
+
+// Draws text with the raster engine, which takes the glyphs from the glyph
+// cache of the FreeType font engines, and measures how much memory the
+// cached glyphs take. Fonts that only differ in their style hint get font
+// engines of their own that render the glyphs the same way.
+
+class tst_QFontEngine : public QObject
+{
+    Q_OBJECT
+private slots:
+    void drawText_data();
+    void drawText();
+    void glyphCacheMemory_data();
+    void glyphCacheMemory();
+};
+
+static const QFont::StyleHint styleHints[] = {
+    QFont::AnyStyle, QFont::Serif, QFont::Cursive, QFont::Fantasy
+};
+
+static QList<QFont> fonts(int pixelSize, int count)
+{
+    QList<QFont> fonts;
+    for (int i = 0; i < count; ++i) {
+        QFont font;
+        font.setPixelSize(pixelSize);
+        font.setStyleHint(styleHints[i]);
+        fonts.append(font);
+    }
+    return fonts;
+}
+
+static QFontEngineFT *freetypeEngine(const QFont &font)
+{
+    QFontEngine *engine = QFontPrivate::get(font)->engineForScript(QChar::Script_Latin);
+    if (engine && engine->type() == QFontEngine::Multi)
+        engine = static_cast<QFontEngineMulti *>(engine)->engine(0);
+    if (!engine || engine->type() != QFontEngine::Freetype)
+        return nullptr;
+    return static_cast<QFontEngineFT *>(engine);
+}
+
+static QStringList paragraph()
+{
+    return {
+        QStringLiteral("Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod"),
+        QStringLiteral("tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim"),
+        QStringLiteral("veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea"),
+        QStringLiteral("commodo consequat. 0123456789 !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~"),
+    };
+}
+
+void tst_QFontEngine::drawText_data()
+{
+    QTest::addColumn<int>("pixelSize");
+    QTest::addColumn<int>("engineCount");
+
+    for (int pixelSize : { 12, 24, 48 }) {
+        for (int engineCount : { 1, 4 }) {
+            QTest::addRow("%dpx, %d engines", pixelSize, engineCount)
+                    << pixelSize << engineCount;
+        }
+    }
+}
+
+void tst_QFontEngine::drawText()
+{
+    QFETCH(int, pixelSize);
+    QFETCH(int, engineCount);
+
+    const QList<QFont> drawFonts = fonts(pixelSize, engineCount);
+    if (!freetypeEngine(drawFonts.constFirst()))
+        QSKIP("This benchmark requires FreeType font engines");
+
+    const QStringList lines = paragraph();
+    QImage image(1024, 768, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter p(&image);
+    p.setPen(Qt::black);
+
+    QBENCHMARK {
+        qreal y = pixelSize;
+        for (int i = 0; y < image.height(); ++i) {
+            p.setFont(drawFonts.at(i % drawFonts.size()));
+            // odd offsets, so that different subpixel positions are used
+            p.drawText(QPointF(4 + 0.25 * (i % 4), y), lines.at(i % lines.size()));
+            y += pixelSize * 1.2;
+        }
+    }
+}
+
+void tst_QFontEngine::glyphCacheMemory_data()
+{
+    drawText_data();
+}
+
+// Reports the memory used by the glyph caches of the engines, after drawing
+// all printable ASCII characters at all subpixel positions.
+void tst_QFontEngine::glyphCacheMemory()
+{
+    QFETCH(int, pixelSize);
+    QFETCH(int, engineCount);
+
+    const QList<QFont> drawFonts = fonts(pixelSize, engineCount);
+    if (!freetypeEngine(drawFonts.constFirst()))
+        QSKIP("This benchmark requires FreeType font engines");
+
+    QString ascii;
+    for (char16_t c = 0x20; c < 0x7f; ++c)
+        ascii.append(QChar(c));
+
+    QImage image(2048, 256, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter p(&image);
+    for (const QFont &font : drawFonts) {
+        p.setFont(font);
+        for (int i = 0; i < 4; ++i)
+            p.drawText(QPointF(4 + 0.25 * i, 4 + pixelSize), ascii);
+    }
+    p.end();
+
+    std::set<const QFontEngineFT::GlyphAtlas *> atlases;
+    for (const QFont &font : drawFonts) {
+        QFontEngineFT *engine = freetypeEngine(font);
+        QVERIFY(engine);
+        if (const QFontEngineFT::GlyphAtlas *atlas = engine->loadGlyphSet(QTransform())->glyphAtlas())
+            atlases.insert(atlas);
+    }
+    QVERIFY(!atlases.empty());
+
+    size_t memory = 0;
+    qsizetype glyphs = 0;
+    for (const QFontEngineFT::GlyphAtlas *atlas : atlases) {
+        memory += atlas->memoryUsage();
+        glyphs += atlas->glyphCount();
+    }
+    qDebug("%zu glyph atlases, %lld glyphs", atlases.size(), qlonglong(glyphs));
+    QTest::setBenchmarkResult(qreal(memory), QTest::BytesAllocated);
+}
+
+QTEST_MAIN(tst_QFontEngine)
+#include "tst_bench_qfontengine.moc"
@@ -2,17 +2,45 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QTextCursor>
 #include <QTextDocument>
+#include <QTimer>
 #include <qtest.h>
 
+#include <private/qtextdocumentlayout_p.h>
+
 class tst_QTextDocument : public QObject
 {
     Q_OBJECT
 private slots:
     void mightBeRichText_data();
     void mightBeRichText();
+    void firstPaint_data();
+    void firstPaint();
+    void layoutResponsiveness_data();
+    void layoutResponsiveness();
+    void edit_data();
+    void edit();
 };
 
+static QString logFile(int lines)
+{
+    QString text;
+    text.reserve(lines * 64);
+    for (int i = 0; i < lines; ++i) {
+        text += QString::fromLatin1("2024-05-%1 12:%2:%3 [worker %4] processed request %5 in %6 ms\n")
+                        .arg(i % 28 + 1, 2, 10, QLatin1Char('0'))
+                        .arg(i % 60, 2, 10, QLatin1Char('0'))
+                        .arg(i * 7 % 60, 2, 10, QLatin1Char('0'))
+                        .arg(i % 16).arg(i).arg(i * 13 % 1000);
+    }
+    return text;
+}
+
 void tst_QTextDocument::mightBeRichText_data()
 {
     QTest::addColumn<QString>("source");
@@ -41,6 +69,96 @@ void tst_QTextDocument::mightBeRichText()
     }
 }
 
+void tst_QTextDocument::firstPaint_data()
+{
+    QTest::addColumn<int>("lines");
+    QTest::newRow("10000 lines") << 10000;
+    QTest::newRow("100000 lines") << 100000;
+    QTest::newRow("500000 lines") << 500000;
+}
+
+// The time from setting the text of a large document until its first page
+// is painted, the rest of the document is laid out later.
+void tst_QTextDocument::firstPaint()
+{
+    QFETCH(int, lines);
+    const QString text = logFile(lines);
+    QImage image(800, 600, QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK {
+        QTextDocument doc;
+        doc.setPlainText(text);
+        QPainter painter(&image);
+        doc.drawContents(&painter, image.rect());
+    }
+}
+
+void tst_QTextDocument::layoutResponsiveness_data()
+{
+    firstPaint_data();
+}
+
+// The longest time the event loop is blocked while a large document is laid
+// out in the background.
+void tst_QTextDocument::layoutResponsiveness()
+{
+    QFETCH(int, lines);
+    QTextDocument doc;
+    doc.setPlainText(logFile(lines));
+    auto layout = qobject_cast<QTextDocumentLayout *>(doc.documentLayout());
+    QVERIFY(layout);
+
+    qint64 longestStall = 0;
+    QElapsedTimer sinceLastTick;
+    QTimer ticker;
+    ticker.setInterval(0);
+    connect(&ticker, &QTimer::timeout, this, [&] {
+        longestStall = qMax(longestStall, sinceLastTick.restart());
+    });
+    sinceLastTick.start();
+    ticker.start();
+    QTRY_COMPARE_WITH_TIMEOUT(layout->layoutStatus(), 100, 600000);
+
+    QTest::setBenchmarkResult(longestStall, QTest::WalltimeMilliseconds);
+}
+
+void tst_QTextDocument::edit_data()
+{
+    QTest::addColumn<int>("lines");
+    QTest::addColumn<bool>("undo");
+
+    for (int lines : { 16000, 160000, 1600000 }) {
+        for (bool undo : { true, false }) {
+            QTest::addRow("%d MB, %s", lines / 16000, undo ? "undo" : "no undo")
+                    << lines << undo;
+        }
+    }
+}
+
+// Types and deletes characters all over a large document, without a
+// layout; only the storage of the text is measured.
+void tst_QTextDocument::edit()
+{
+    QFETCH(int, lines);
+    QFETCH(bool, undo);
+
+    QTextDocument doc;
+    doc.setUndoRedoEnabled(undo);
+    doc.setPlainText(logFile(lines));
+    QTextCursor cursor(&doc);
+    QRandomGenerator random(42);
+
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            cursor.setPosition(random.bounded(doc.characterCount() - 1));
+            cursor.insertText(QStringLiteral("edit"));
+            cursor.deletePreviousChar();
+            cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, 5);
+            cursor.removeSelectedText();
+        }
+    }
+}
+
 QTEST_MAIN(tst_QTextDocument)
 
 #include "main.moc"
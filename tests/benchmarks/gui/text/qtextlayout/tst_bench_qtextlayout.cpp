@@ -0,0 +1,80 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QTextLayout>
+
+#include <private/qfontengine_p.h>
+
+// Lays out the same short strings over and over, the way the cells of a
+// table or the items of a list are laid out whenever they are repainted,
+// with and without the font engines caching the shaped runs.
+
+class tst_QTextLayout : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cleanup();
+    void layoutCells_data();
+    void layoutCells();
+};
+
+void tst_QTextLayout::cleanup()
+{
+    QFontEngine::setShapedRunCacheEnabled(true);
+}
+
+void tst_QTextLayout::layoutCells_data()
+{
+    QTest::addColumn<QStringList>("cells");
+    QTest::addColumn<bool>("cached");
+
+    QStringList latin;
+    for (int i = 0; i < 50; ++i) {
+        latin << QStringLiteral("Item %1").arg(i)
+              << QStringLiteral("Office supplies, affine AVAVA %1").arg(i % 7)
+              << QStringLiteral("%1.%2 EUR").arg(i * 17).arg(i % 100, 2, 10, QLatin1Char('0'));
+    }
+    QStringList arabic;
+    for (int i = 0; i < 50; ++i) {
+        arabic << QStringLiteral("العربية %1").arg(i)
+               << QStringLiteral("مرحبا بالعالم");
+    }
+
+    for (bool cached : { false, true }) {
+        QTest::addRow("latin, %s", cached ? "cached" : "uncached") << latin << cached;
+        QTest::addRow("arabic, %s", cached ? "cached" : "uncached") << arabic << cached;
+    }
+}
+
+void tst_QTextLayout::layoutCells()
+{
+    QFETCH(QStringList, cells);
+    QFETCH(bool, cached);
+
+    QFont font;
+    font.setPixelSize(14);
+    QFontEngine::setShapedRunCacheEnabled(cached);
+    const QFontEngine::ShapedRunStatistics before = QFontEngine::shapedRunStatistics();
+
+    QBENCHMARK {
+        for (const QString &cell : std::as_const(cells)) {
+            QTextLayout layout(cell, font);
+            layout.beginLayout();
+            layout.createLine();
+            layout.endLayout();
+            QVERIFY(layout.lineAt(0).naturalTextWidth() > 0);
+        }
+    }
+
+    const QFontEngine::ShapedRunStatistics after = QFontEngine::shapedRunStatistics();
+    const quint64 lookups = (after.hits - before.hits) + (after.misses - before.misses);
+    if (lookups > 0) {
+        qDebug("shaped run cache: %llu hits, %llu misses (%.1f%% hit rate)",
+               after.hits - before.hits, after.misses - before.misses,
+               100.0 * (after.hits - before.hits) / lookups);
+    }
+}
+
+QTEST_MAIN(tst_QTextLayout)
+#include "tst_bench_qtextlayout.moc"